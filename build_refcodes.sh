@@ -16,15 +16,21 @@
 
 TOPDIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
 REF_CODES=( basic_perf                     \
+    buffer_lookup                          \
     cholesky/tiled_host                    \
     cholesky/tiled_hstreams                \
     cholesky/tiled_hstreams_host_multicard \
+    enqueue_allocs                         \
     hello_world                            \
+    host_enqueue_scaling                   \
+    host_task_rate                         \
     io_perf                                \
     lu/tiled_host                          \
     lu/tiled_hstreams                      \
     matMult                                \
-    matMult_host_multicard )
+    matMult_host_multicard                 \
+    numa_placement                         \
+    stream_priority )
 for ref_code in "${REF_CODES[@]}"
 do
     echo "************************************************************************"
@@ -24,7 +24,13 @@ HOST_TARGET=$(HOST_BIN_DIR)$(HOST_LIBNAME)
 
 HOST_SOURCE_FILES= \
 	hStreams_COIWrapper.cpp \
+	hStreams_Dag.cpp \
+	hStreams_Graph.cpp \
+	hStreams_HostCallbacks.cpp \
+	hStreams_HostEvent.cpp \
+	hStreams_HostNuma.cpp \
 	hStreams_HostSideSinkWorker.cpp \
+	hStreams_HostXferEngine.cpp \
 	hStreams_LogBuffer.cpp \
 	hStreams_LogBufferCollection.cpp \
 	hStreams_LogDomain.cpp \
@@ -42,7 +48,9 @@ HOST_SOURCE_FILES= \
 	hStreams_PhysStream.cpp \
 	hStreams_PhysStreamCOI.cpp \
 	hStreams_PhysStreamHost.cpp \
+	hStreams_RCU.cpp \
 	hStreams_RefCountDestroyed.cpp \
+	hStreams_WaitPolicy.cpp \
 	hStreams_app_api_sink.cpp \
 	hStreams_app_api_source.cpp \
 	hStreams_app_api_workers_source.cpp \
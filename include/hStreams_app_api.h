@@ -51,6 +51,15 @@ extern "C" {
 /// hStreams_app_memset() and hStreams_app_memcpy(). There are also four functions which perform
 /// remote matrix multiplication using kernels from the Intel(R) Math Kernel Library (Intel(R) MKL).
 /// Their parameters correspond to those used by the Intel(R) MKL routines.
+/// @defgroup hStreams_AppApi_Dag Task DAG runtime
+/// @ingroup hStreams_AppApi
+/// Instead of picking the streams and enforcing the dependencies between the
+/// actions by hand, the computations can be expressed as a set of tasks, each
+/// declaring the sink-side function to run and the buffers it reads and
+/// writes. The runtime infers the dependencies between the tasks from the
+/// buffers, picks a stream for each of them, inserts the waits for the tasks
+/// running in the other streams and transfers the buffers to where they are
+/// needed. The tasks on the critical path are submitted first.
 ///////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////
@@ -832,6 +841,191 @@ hStreams_app_zgemm(
     const void *B, const int64_t ldB, const void *beta,
     void *C, const int64_t ldC, HSTR_EVENT    *out_pEvent);
 
+///////////////////////////////////////////////////////////////////
+///
+// hStreams_app_dag_create
+/// @ingroup hStreams_AppApi_Dag
+/// @brief Create an empty set of tasks, to be executed in a set of logical streams
+///
+/// @param  in_NumLogStreams
+///         [in] Number of entries in the \c in_pLogStreamIDs array
+///
+/// @param  in_pLogStreamIDs
+///         [in] The logical streams to execute the tasks in. The special pair
+///         of values <tt>(0, NULL)</tt> stands for all of the logical streams
+///         existing at the time of the call.
+///
+/// @param  in_BytesPerCostUnit
+///         [in] How many bytes a transfer moves in the time it takes to
+///         execute a task of cost 1, see hStreams_app_dag_add_task(). Used for
+///         weighing the transfers needed to execute a task in a stream
+///         against the time the task would have to wait for that stream. 0
+///         for the transfers not to be taken into account.
+///
+/// @param  out_pDag
+///         [out] The DAG, to be destroyed by hStreams_app_dag_destroy()
+///
+/// @return If successful, \c hStreams_app_dag_create() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NULL_PTR if \c out_pDag is NULL
+/// @arg \c HSTR_RESULT_INCONSISTENT_ARGS if \c in_NumLogStreams is 0 and \c
+///     in_pLogStreamIDs is not NULL and vice versa.
+/// @arg \c HSTR_RESULT_NOT_FOUND if one of the logical streams doesn't exist,
+///     or there are no logical streams at all
+///
+/// @thread_safety Thread safe.
+///
+///////////////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_app_dag_create(
+    uint32_t            in_NumLogStreams,
+    HSTR_LOG_STR       *in_pLogStreamIDs,
+    uint64_t            in_BytesPerCostUnit,
+    HSTR_DAG           *out_pDag);
+
+///////////////////////////////////////////////////////////////////
+///
+// hStreams_app_dag_add_task
+/// @ingroup hStreams_AppApi_Dag
+/// @brief Add a task to a DAG
+///
+/// The tasks are to be added in an order in which executing them one after
+/// another would give the intended results. A task depends on the tasks added
+/// before it which access any of the same buffers, if either of them writes
+/// the buffer. The dependencies are tracked per buffer, regardless of which
+/// parts of the buffers the tasks access.
+///
+/// @param  in_Dag
+///         [in] The DAG
+///
+/// @param  in_pFunctionName
+///         [in] Name of the sink-side function to execute, as for
+///         hStreams_EnqueueCompute()
+///
+/// @param  in_NumScalarArgs
+///         [in] Number of scalar arguments
+///
+/// @param  in_NumHeapArgs
+///         [in] Number of heap arguments
+///
+/// @param  in_pArgs
+///         [in] Arguments, the scalar ones first, as for
+///         hStreams_EnqueueCompute(). The heap arguments are source-side proxy
+///         addresses within the buffers. The array is copied.
+///
+/// @param  in_pHeapArgAccess
+///         [in] How the task accesses the memory of each of the heap
+///         arguments, NULL if it both reads and writes all of them
+///
+/// @param  in_Cost
+///         [in] The cost of the task relative to the others, e.g. the number
+///         of floating point operations; 0 is taken as 1. The tasks heading the
+///         costliest chains of tasks are submitted first.
+///
+/// @param  out_pTaskID
+///         [out] If not NULL, the index of the task, counting from 0 in the
+///         order the tasks are added in
+///
+/// @return If successful, \c hStreams_app_dag_add_task() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_Dag is not a valid DAG, e.g. it has been
+///     destroyed, or a heap argument is not within an allocated buffer
+/// @arg \c HSTR_RESULT_NULL_PTR if \c in_pFunctionName is NULL, or \c in_pArgs
+///     is NULL while there are arguments
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if an access mode is invalid
+///
+/// @thread_safety Not thread safe with respect to the other calls using the same DAG.
+///
+///////////////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_app_dag_add_task(
+    HSTR_DAG            in_Dag,
+    const char         *in_pFunctionName,
+    uint32_t            in_NumScalarArgs,
+    uint32_t            in_NumHeapArgs,
+    uint64_t           *in_pArgs,
+    HSTR_ACCESS_MODE   *in_pHeapArgAccess,
+    uint64_t            in_Cost,
+    uint32_t           *out_pTaskID);
+
+///////////////////////////////////////////////////////////////////
+///
+// hStreams_app_dag_execute
+/// @ingroup hStreams_AppApi_Dag
+/// @brief Execute the tasks of a DAG and wait for them to complete
+///
+/// The tasks are submitted once all the tasks they depend on have been
+/// submitted. Of the tasks ready to be submitted, \c in_Policy decides which
+/// one goes first. Each task goes to the stream in which it is estimated to
+/// finish first, taking into account the tasks already submitted to the
+/// streams, the tasks it depends on and the transfers it needs. Then:
+/// \arg The instantiations of the task's buffers in the stream's logical
+///     domain which are not up to date are refreshed with a transfer,
+///     preferably from the source logical domain.
+/// \arg The tasks and transfers in other streams the task or its transfers
+///     depend on are waited for, with a single hStreams_EventStreamWait() per
+///     task. The dependencies within a stream are left to the stream.
+///
+/// To begin with, the buffers' instantiations in the source logical domain
+/// are taken to be up to date and all the others not to be. Once all the
+/// tasks have completed, the instantiations in the source logical domain of
+/// the buffers written by the tasks are brought up to date.
+///
+/// A DAG may be executed any number of times.
+///
+/// @param  in_Dag
+///         [in] The DAG
+///
+/// @param  in_Policy
+///         [in] The order of submitting the tasks ready to be submitted
+///
+/// @return If successful, \c hStreams_app_dag_execute() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_Dag is not a valid DAG, e.g. it has been
+///     destroyed, a buffer has been deallocated or a task's buffers are not all
+///     instantiated in the logical domain of any of the streams
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if \c in_Policy is invalid
+/// @arg The errors of hStreams_EnqueueComputeEx(), hStreams_EnqueueData1D(),
+///     hStreams_EnqueueDataXDomain1D() and hStreams_EventStreamWait(). The
+///     actions submitted before the error are waited for before returning.
+///
+/// @thread_safety Not thread safe with respect to the other calls using the
+///     same DAG. The tasks may be executed concurrently with other actions
+///     in the same streams, as long as those don't access the same buffers.
+///     The dependencies are not enforced with the \c HSTR_DEP_POLICY_NONE
+///     dependence policy.
+///
+///////////////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_app_dag_execute(
+    HSTR_DAG            in_Dag,
+    HSTR_DAG_POLICY     in_Policy);
+
+///////////////////////////////////////////////////////////////////
+///
+// hStreams_app_dag_destroy
+/// @ingroup hStreams_AppApi_Dag
+/// @brief Destroy a DAG
+///
+/// @param  in_Dag
+///         [in] The DAG
+///
+/// @return If successful, \c hStreams_app_dag_destroy() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_Dag is not a valid DAG, e.g. it has been
+///     destroyed
+///
+/// @thread_safety Not thread safe with respect to the other calls using the same DAG.
+///
+///////////////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_app_dag_destroy(
+    HSTR_DAG            in_Dag);
+
 
 #ifdef __cplusplus
 }
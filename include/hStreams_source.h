@@ -110,11 +110,14 @@ extern "C" {
 ///  they will be loaded, again searching the SINK_LD_LIBRARY_PATH for each of the
 ///  libraries specified there.
 ///
+///  If no MICs are available, or the COI library is not installed at all, only the
+///  source physical domain (\c HSTR_SRC_PHYS_DOMAIN) can be used.
+///
 ///
 /// @return If successful, \c hStreams_InitInVersion() returns \c HSTR_RESULT_SUCCESS.
 ///     Otherwise, it returns one of the following errors:
 /// @arg \c HSTR_RESULT_DEVICE_NOT_INITIALIZED if the library cannot be initialized properly,
-///     e.g. because no MICs are available
+///     e.g. because one of the MICs could not be set up
 ///
 /// @arg \c HSTR_RESULT_OUT_OF_RANGE if the \c interface_version argument does not correspond
 ///     to a valid interface version supported by the library
@@ -160,7 +163,8 @@ hStreams_IsInitialized();
 /// @brief Finalize hStreams-related state.
 ///
 /// Destroys hStreams internal structures and clears the state of the library.
-/// All logical domains, streams and buffers are destroyed as a result of this call.
+/// All logical domains, streams and buffers, as well as the graphs and the DAGs
+/// not destroyed yet, are destroyed as a result of this call.
 ///
 /// @return If successful, \c hStreams_Fini() returns \c HSTR_RESULT_SUCCESS.
 ///     Otherwise, it returns one of the following errors:
@@ -539,6 +543,57 @@ hStreams_StreamCreate(
     HSTR_LOG_DOM        in_LogDomainID,
     const HSTR_CPU_MASK in_CPUmask);
 
+/////////////////////////////////////////////////////////
+///
+// hStreams_StreamCreateEx
+/// @ingroup hStreams_Source_StreamMgmt
+/// @brief Register a logical stream, specifying the way it executes the
+///     actions enqueued in it
+///
+/// Same as \c hStreams_StreamCreate(), except that the stream may be made
+/// out-of-order by passing \c HSTR_STREAM_OUT_OF_ORDER. With the
+/// \c HSTR_DEP_POLICY_BUFFERS and \c HSTR_DEP_POLICY_ACCESS_MODES dependence
+/// policies, the computes enqueued in an out-of-order stream then only wait
+/// for the earlier actions accessing the same buffers, and for the barriers
+/// (e.g. \c hStreams_EventStreamWait() with \c in_NumAddresses == 0).
+/// Computes which don't depend on each other may thus execute in any order,
+/// and those whose inputs are ready may overtake the ones still waiting,
+/// e.g. for a transfer in another stream.
+///
+/// @note Logical streams which fully overlap map to the same physical stream,
+///     so they must be created with the same flags.
+///
+/// @param  in_LogStreamID
+///         [in] The ID of the logical stream to be created.
+///
+/// @param  in_LogDomainID
+///         [in] The ID of the logical domain to create the stream in.
+///
+/// @param  in_CPUmask
+///         [in] The mask describing the HW threads that are used by this logical
+///         stream.
+///
+/// @param  in_Flags
+///         [in] \c HSTR_STREAM_IN_ORDER or \c HSTR_STREAM_OUT_OF_ORDER
+///
+/// @return If successful, \c hStreams_StreamCreateEx() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the errors returned by \c hStreams_StreamCreate()
+///     or one of the following errors:
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if \c in_Flags is not one of the values of
+///     \c HSTR_STREAM_FLAGS
+/// @arg \c HSTR_RESULT_INCONSISTENT_ARGS if \c in_CPUmask is equal to the mask of
+///     another logical stream in the logical domain, created with different flags
+///
+/// @thread_safety Thread safe.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_StreamCreateEx(
+    HSTR_LOG_STR        in_LogStreamID,
+    HSTR_LOG_DOM        in_LogDomainID,
+    const HSTR_CPU_MASK in_CPUmask,
+    HSTR_STREAM_FLAGS   in_Flags);
+
 /////////////////////////////////////////////////////////
 ///
 // hStreams_StreamDestroy
@@ -663,6 +718,129 @@ hStreams_GetLogStreamDetails(
     HSTR_LOG_DOM      in_LogDomainID,
     HSTR_CPU_MASK     out_CPUmask);
 
+/////////////////////////////////////////////////////////
+///
+// hStreams_GetLogStreamDepStats
+/// @ingroup hStreams_Source_StreamMgmt
+/// @brief Query how many dependencies the actions of a logical stream have
+///     been submitted with, and how many were pruned before the submission
+///
+/// Before an action is submitted, the duplicates and the already completed
+/// actions are dropped from the list of actions it depends on. So are they
+/// from the events waited for by \c hStreams_StreamSynchronize() and
+/// \c hStreams_ThreadSynchronize(), which count as well.
+///
+/// @note Logical streams which fully overlap map to the same physical stream,
+///     and share the counters.
+///
+/// @param  in_LogStreamID
+///         [in] ID of logical stream to look up
+///
+/// @param  out_pNumSubmitted
+///         [out] The number of dependencies submitted
+///
+/// @param  out_pNumPruned
+///         [out] The number of dependencies pruned
+///
+/// @return If successful, \c hStreams_GetLogStreamDepStats() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NULL_PTR if \c out_pNumSubmitted or \c out_pNumPruned is \c NULL
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_LogStreamID is out of range
+///
+/// @thread_safety Thread safe.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_GetLogStreamDepStats(
+    HSTR_LOG_STR      in_LogStreamID,
+    uint64_t         *out_pNumSubmitted,
+    uint64_t         *out_pNumPruned);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_StreamSetPriority
+/// @ingroup hStreams_Source_StreamMgmt
+/// @brief Set the priority of the actions enqueued in a logical stream from
+///     now on
+///
+/// The logical streams are created with \c HSTR_STREAM_PRIORITY_NORMAL.
+///
+/// The priorities tell apart the logical streams which map to the same
+/// physical stream, i.e. which belong to the same logical domain and have
+/// the same CPU mask. The actions of such streams are executed one after
+/// another by the same worker; that worker executes the actions of the
+/// highest priority whose input dependencies have completed first. E.g.
+/// latency-sensitive requests enqueued in a high-priority stream only wait
+/// for the action being executed at the time, rather than for all the
+/// background work enqueued before them in a low-priority stream.
+///
+/// The computes of an in-order stream are only implicitly ordered with
+/// respect to the other actions of the same priority. An action of a higher
+/// priority may thus overtake the ones of a lower priority enqueued before
+/// it, unless it depends on them, through the buffers they access or through
+/// \c hStreams_EventStreamWait(). With the \c HSTR_DEP_POLICY_NONE dependence
+/// policy the actions of different priorities aren't ordered at all, and
+/// with \c HSTR_DEP_POLICY_CONSERVATIVE they are always executed in the
+/// order of enqueueing.
+///
+/// Changing the priority of an in-order stream doesn't reorder its computes:
+/// the ones enqueued after the call wait for the last compute enqueued before
+/// it with the former priority, of any of the logical streams mapped to the
+/// same physical stream.
+///
+/// @note Only the host-side streams take the priorities into account. The
+///     actions enqueued in the streams on the coprocessors are still executed
+///     in the order of enqueueing.
+///
+/// @param  in_LogStreamID
+///         [in] ID of logical stream
+///
+/// @param  in_Priority
+///         [in] One of the values of \c HSTR_STREAM_PRIORITY
+///
+/// @return If successful, \c hStreams_StreamSetPriority() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if \c in_Priority is not one of the values of
+///     \c HSTR_STREAM_PRIORITY
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_LogStreamID is out of range
+///
+/// @thread_safety Thread safe. The actions enqueued concurrently with the call
+///     may be enqueued with either of the priorities.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_StreamSetPriority(
+    HSTR_LOG_STR            in_LogStreamID,
+    HSTR_STREAM_PRIORITY    in_Priority);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_StreamGetPriority
+/// @ingroup hStreams_Source_StreamMgmt
+/// @brief Query the priority of a logical stream
+///
+/// @param  in_LogStreamID
+///         [in] ID of logical stream
+///
+/// @param  out_pPriority
+///         [out] The priority set through \c hStreams_StreamSetPriority()
+///
+/// @return If successful, \c hStreams_StreamGetPriority() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NULL_PTR if \c out_pPriority is \c NULL
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_LogStreamID is out of range
+///
+/// @thread_safety Thread safe.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_StreamGetPriority(
+    HSTR_LOG_STR            in_LogStreamID,
+    HSTR_STREAM_PRIORITY   *out_pPriority);
+
 /////////////////////////////////////////////////////////
 ///
 // hStreams_GetOversubscriptionLevel
@@ -783,6 +961,202 @@ hStreams_EnqueueCompute(
     uint16_t       in_ReturnValueSize);
 
 
+/////////////////////////////////////////////////////////
+///
+// hStreams_GetFunctionHandle
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Resolve a user-defined function once, for enqueueing it by a handle
+///
+/// Looks up the function in all the physical domains and returns a handle
+/// which can be passed to \c hStreams_EnqueueComputeByHandle(). Enqueueing
+/// by the handle saves looking up the function by its name every time, which
+/// matters for applications enqueueing many small actions. Asking for the
+/// handle of the same function again returns the same handle. Handles stay
+/// valid until \c hStreams_Fini().
+///
+/// @param  in_pFunctionName
+///         [in] Null-terminated string with name of the function
+///
+/// @param  out_pFunctionHandle
+///         [out] The handle of the function
+///
+/// @return If successful, \c hStreams_GetFunctionHandle() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if the library had not been initialized properly
+/// @arg \c HSTR_RESULT_BAD_NAME if \c in_pFunctionName is \c NULL
+/// @arg \c HSTR_RESULT_BAD_NAME if \c in_pFunctionName is longer than \c
+///     HSTR_MAX_FUNC_NAME_SIZE
+/// @arg \c HSTR_RESULT_BAD_NAME if no symbol named \c in_pFunctionName is found
+///     in any of the physical domains
+/// @arg \c HSTR_RESULT_NULL_PTR if \c out_pFunctionHandle is \c NULL
+///
+/// @thread_safety Thread safe.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_GetFunctionHandle(
+    const char       *in_pFunctionName,
+    HSTR_FUNC_HANDLE *out_pFunctionHandle);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_EnqueueComputeByHandle
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Enqueue an execution of a user-defined function in a stream, with
+///     the function identified by its handle
+///
+/// Same as \c hStreams_EnqueueCompute(), except that the function is
+/// identified by a handle obtained from \c hStreams_GetFunctionHandle().
+///
+/// @param  in_LogStreamID
+///         [in] ID of logical stream associated to enqueue the action in
+///
+/// @param  in_FunctionHandle
+///         [in] Handle of the function to be executed
+///
+/// @param  in_NumScalarArgs
+///         [in] Number of arguments to be copied by value for remote invocation
+///
+/// @param  in_NumHeapArgs
+///         [in] Number of arguments which are buffer addreses to be translated
+///         to sink-side instantiations' addresses
+///
+/// @param  in_pArgs
+///         [in] Array of in_NumScalarArgs+in_NumHeapArgs arguments as 64-bit unsigned
+///         integers with scalar args first and buffer args second
+///
+/// @param  out_pEvent
+///         [out] pointer to event which will be signaled once the action
+///         completes
+///
+/// @param  out_pReturnValue
+///         [out] pointer to host-side memory the remote invocation can
+///         asynchronously write to
+///
+/// @param  in_ReturnValueSize
+///         [in] the size of the asynchronous return value memory
+///
+/// @return If successful, \c hStreams_EnqueueComputeByHandle() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if the library had not been initialized properly
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_LogStreamID is not a valid logical stream ID
+/// @arg \c HSTR_RESULT_NOT_FOUND if at least one of the buffer arguments is not
+///     in a buffer that had been instantiated for \c in_LogStreamID's logical domain
+/// @arg \c HSTR_RESULT_BAD_NAME if \c in_FunctionHandle has not been returned by
+///     \c hStreams_GetFunctionHandle() since the library was initialized
+/// @arg \c HSTR_RESULT_BAD_NAME if the function is not present on the
+///     streams's sink endpoint
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if \c in_ReturnValueSize exceeds \c
+///     HSTR_RETURN_SIZE_LIMIT
+/// @arg \c HSTR_RESULT_INCONSISTENT_ARGS if <tt>in_ReturnValueSize != 0</tt>
+///     and \c in_pReturnValue is \c NULL or <tt>in_ReturnValueSize == 0</tt> and \c
+///     in_pReturnValue is not \c NULL
+/// @arg \c HSTR_RESULT_TOO_MANY_ARGS if <tt>in_NumScalarArgs +
+///     in_NumHeapArgs > HSTR_ARGS_SUPPORTED</tt>
+/// @arg \c HSTR_RESULT_NULL_PTR <tt>in_numScalarArgs + in_numHeapArgs > 0</tt> but
+///     \c in_pArgs is \c NULL
+///
+/// @thread_safety As \c hStreams_EnqueueCompute().
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_EnqueueComputeByHandle(
+    HSTR_LOG_STR      in_LogStreamID,
+    HSTR_FUNC_HANDLE  in_FunctionHandle,
+    uint32_t          in_numScalarArgs,
+    uint32_t          in_numHeapArgs,
+    uint64_t         *in_pArgs,
+    HSTR_EVENT       *out_pEvent,
+    void             *out_ReturnValue,
+    uint16_t          in_ReturnValueSize);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_EnqueueComputeEx
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Enqueue an execution of a user-defined function in a stream,
+///     declaring how the function accesses each of its heap arguments
+///
+/// Same as \c hStreams_EnqueueCompute(), except that the function declares
+/// whether it reads, writes, or both reads and writes each of the buffers
+/// passed as heap arguments. With the \c HSTR_DEP_POLICY_ACCESS_MODES
+/// dependence policy, actions which only read the same buffer do not wait
+/// for each other, only for the last action writing it. With the other
+/// policies, the access modes are ignored and each of the buffers is taken
+/// as both read and written, as with \c hStreams_EnqueueCompute().
+///
+/// The function may also declare how much memory it accesses from each of
+/// the heap arguments. With the \c HSTR_DEP_POLICY_BUFFERS and
+/// \c HSTR_DEP_POLICY_ACCESS_MODES dependence policies, the dependences
+/// are tracked per byte range, so the function then only waits for the
+/// actions accessing memory overlapping what it accesses, e.g. for those
+/// working on the same tile of a matrix rather than on the whole matrix.
+/// Otherwise, the function is taken as accessing the whole buffers.
+///
+/// @param  in_LogStreamID
+///         [in] ID of logical stream associated to enqueue the action in
+///
+/// @param  in_pFuncName
+///         [in] Null-terminated string with name of the function to be executed
+///
+/// @param  in_NumScalarArgs
+///         [in] Number of arguments to be copied by value for remote invocation
+///
+/// @param  in_NumHeapArgs
+///         [in] Number of arguments which are buffer addreses to be translated
+///         to sink-side instantiations' addresses
+///
+/// @param  in_pArgs
+///         [in] Array of in_NumScalarArgs+in_NumHeapArgs arguments as 64-bit unsigned
+///         integers with scalar args first and buffer args second
+///
+/// @param  in_pHeapArgAccess
+///         [in] Array of in_NumHeapArgs access modes, one for each of the heap
+///         arguments, in the same order
+///
+/// @param  in_pHeapArgSizes
+///         [in] optional, array of in_NumHeapArgs sizes, in bytes, of the memory
+///         the function accesses starting from each of the heap arguments.
+///         If \c NULL, the function may access the whole buffers.
+///
+/// @param  out_pEvent
+///         [out] pointer to event which will be signaled once the action
+///         completes
+///
+/// @param  out_pReturnValue
+///         [out] pointer to host-side memory the remote invocation can
+///         asynchronously write to
+///
+/// @param  in_ReturnValueSize
+///         [in] the size of the asynchronous return value memory
+///
+/// @return If successful, \c hStreams_EnqueueComputeEx() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the errors returned by \c hStreams_EnqueueCompute()
+///     or one of the following errors:
+/// @arg \c HSTR_RESULT_NULL_PTR if \c in_NumHeapArgs is not 0 but
+///     \c in_pHeapArgAccess is \c NULL
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if one of the access modes is not
+///     \c HSTR_ACCESS_READ, \c HSTR_ACCESS_WRITE nor \c HSTR_ACCESS_READ_WRITE
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if the memory accessed from one of the heap
+///     arguments doesn't fit in the argument's buffer
+///
+/// @thread_safety As \c hStreams_EnqueueCompute().
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_EnqueueComputeEx(
+    HSTR_LOG_STR      in_LogStreamID,
+    const char       *in_pFunctionName,
+    uint32_t          in_numScalarArgs,
+    uint32_t          in_numHeapArgs,
+    uint64_t         *in_pArgs,
+    HSTR_ACCESS_MODE *in_pHeapArgAccess,
+    uint64_t         *in_pHeapArgSizes,
+    HSTR_EVENT       *out_pEvent,
+    void             *out_ReturnValue,
+    uint16_t          in_ReturnValueSize);
+
+
 /////////////////////////////////////////////////////////
 ///
 // hStreams_EnqueueData1D
@@ -915,6 +1289,223 @@ hStreams_EnqueueDataXDomain1D(
     HSTR_LOG_DOM        in_srcLogDomain,
     HSTR_EVENT         *out_pEvent);
 
+/////////////////////////////////////////////////////////
+///
+// hStreams_EnqueueData2D
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Enqueue a 2-dimensional (pitched) data transfer in a logical stream.
+///
+/// Copies \c in_Height rows of \c in_Width bytes each. Consecutive rows start
+/// \c in_WritePitch bytes apart at the destination and \c in_ReadPitch bytes
+/// apart at the source, which allows e.g. moving a tile out of or into a larger
+/// row-major matrix with a single action instead of one \c
+/// hStreams_EnqueueData1D() per row.
+///
+/// The transfer has a single completion event. The rows are handed over to the
+/// implementation all at once, so that it can batch them: the host side copies
+/// them all in one go while the transfers to and from the cards issue one DMA
+/// per row without a round-trip through the source in between.
+///
+/// @note As with \c hStreams_EnqueueData1D(), the transfer is permitted to
+///     execute out-of-order subject to dependence policy. Dependences are tracked
+///     over the whole range of memory spanned by the rows, from the first byte of
+///     the first row to the last byte of the last one.
+/// @sa \c HSTR_OPTIONS.dep_policy
+///
+/// @param  in_LogStreamID
+///         [in] The ID of the logical stream to insert the data transfer action in.
+///
+/// @param  in_pWriteAddr
+///         [in] Source proxy pointer to the first byte of the first row to write to
+///
+/// @param  in_WritePitch
+///         [in] The distance, in bytes, between the starts of consecutive rows at
+///         the destination, at least \c in_Width
+///
+/// @param  in_pReadAddr
+///         [in] Source proxy pointer to the first byte of the first row to read from
+///
+/// @param  in_ReadPitch
+///         [in] The distance, in bytes, between the starts of consecutive rows at
+///         the source, at least \c in_Width
+///
+/// @param  in_Width
+///         [in] The size, in bytes, of each row
+///
+/// @param  in_Height
+///         [in] The number of rows
+///
+/// @param  in_XferDirection
+///         [in] The direction in which the memory transfer should occur
+///
+/// @param  out_pEvent
+///         [out] optional, the pointer for the completion event
+///
+/// @return If successful, \c hStreams_EnqueueData2D() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the errors returned by \c hStreams_EnqueueData1D()
+///     or one of the following errors:
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if \c in_Width or \c in_Height is 0
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if there is more than one row and
+///     \c in_WritePitch or \c in_ReadPitch is smaller than \c in_Width
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if the memory spanned by the rows on either
+///     side falls outside of the buffer's boundaries
+///
+/// @thread_safety As \c hStreams_EnqueueData1D().
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_EnqueueData2D(
+    HSTR_LOG_STR        in_LogStreamID,
+    void               *in_pWriteAddr,
+    uint64_t            in_WritePitch,
+    void               *in_pReadAddr,
+    uint64_t            in_ReadPitch,
+    uint64_t            in_Width,
+    uint64_t            in_Height,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_EnqueueData3D
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Enqueue a 3-dimensional (pitched) data transfer in a logical stream.
+///
+/// As \c hStreams_EnqueueData2D(), for \c in_Depth slices of \c in_Height rows
+/// each. Consecutive slices start \c in_WriteSlicePitch bytes apart at the
+/// destination and \c in_ReadSlicePitch bytes apart at the source.
+///
+/// @param  in_LogStreamID
+///         [in] The ID of the logical stream to insert the data transfer action in.
+///
+/// @param  in_pWriteAddr
+///         [in] Source proxy pointer to the first byte of the first row to write to
+///
+/// @param  in_WritePitch
+///         [in] The distance, in bytes, between the starts of consecutive rows at
+///         the destination, at least \c in_Width
+///
+/// @param  in_WriteSlicePitch
+///         [in] The distance, in bytes, between the starts of consecutive slices
+///         at the destination, at least <tt>(in_Height - 1) * in_WritePitch + in_Width</tt>
+///
+/// @param  in_pReadAddr
+///         [in] Source proxy pointer to the first byte of the first row to read from
+///
+/// @param  in_ReadPitch
+///         [in] The distance, in bytes, between the starts of consecutive rows at
+///         the source, at least \c in_Width
+///
+/// @param  in_ReadSlicePitch
+///         [in] The distance, in bytes, between the starts of consecutive slices
+///         at the source, at least <tt>(in_Height - 1) * in_ReadPitch + in_Width</tt>
+///
+/// @param  in_Width
+///         [in] The size, in bytes, of each row
+///
+/// @param  in_Height
+///         [in] The number of rows in each slice
+///
+/// @param  in_Depth
+///         [in] The number of slices
+///
+/// @param  in_XferDirection
+///         [in] The direction in which the memory transfer should occur
+///
+/// @param  out_pEvent
+///         [out] optional, the pointer for the completion event
+///
+/// @return If successful, \c hStreams_EnqueueData3D() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the errors returned by \c hStreams_EnqueueData2D()
+///     or one of the following errors:
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if \c in_Depth is 0
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if there is more than one slice and
+///     \c in_WriteSlicePitch or \c in_ReadSlicePitch is smaller than the
+///     memory spanned by the rows of a slice
+///
+/// @thread_safety As \c hStreams_EnqueueData1D().
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_EnqueueData3D(
+    HSTR_LOG_STR        in_LogStreamID,
+    void               *in_pWriteAddr,
+    uint64_t            in_WritePitch,
+    uint64_t            in_WriteSlicePitch,
+    void               *in_pReadAddr,
+    uint64_t            in_ReadPitch,
+    uint64_t            in_ReadSlicePitch,
+    uint64_t            in_Width,
+    uint64_t            in_Height,
+    uint64_t            in_Depth,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_EnqueueDataList
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Enqueue the transfers of a list of unrelated memory regions in a
+///     logical stream, as a single action.
+///
+/// Moves \c in_pSizes[i] bytes from \c in_pReadAddrs[i] to \c in_pWriteAddrs[i]
+/// for each i lower than \c in_NumRegions. The regions may lie in any of the
+/// buffers. Compared to one \c hStreams_EnqueueData1D() per region, the
+/// dependencies of all the regions are resolved at once, the stream's lock is
+/// taken once and there is a single completion event, which makes moving many
+/// small blocks much cheaper. The regions moved between host-side buffers are
+/// copied by a single action.
+///
+/// @note The regions may be moved in any order, or concurrently, so no region
+///     should read the memory another one writes.
+///
+/// @note As with \c hStreams_EnqueueData1D(), the transfer is permitted to
+///     execute out-of-order subject to dependence policy. Later actions
+///     accessing any of the regions wait for the whole transfer.
+/// @sa \c HSTR_OPTIONS.dep_policy
+///
+/// @param  in_LogStreamID
+///         [in] The ID of the logical stream to insert the data transfer action in.
+///
+/// @param  in_NumRegions
+///         [in] The number of regions to move
+///
+/// @param  in_pWriteAddrs
+///         [in] Source proxy pointers to the memory locations to write to
+///
+/// @param  in_pReadAddrs
+///         [in] Source proxy pointers to the memory locations to read from
+///
+/// @param  in_pSizes
+///         [in] The sizes, in bytes, of the regions
+///
+/// @param  in_XferDirection
+///         [in] The direction in which all the memory transfers should occur
+///
+/// @param  out_pEvent
+///         [out] optional, the pointer for the completion event of the whole list
+///
+/// @return If successful, \c hStreams_EnqueueDataList() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, nothing is enqueued and it returns one of the errors
+///     returned by \c hStreams_EnqueueData1D() for any of the regions, or one
+///     of the following errors:
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if \c in_NumRegions is 0
+/// @arg \c HSTR_RESULT_NULL_PTR if \c in_pWriteAddrs, \c in_pReadAddrs or
+///     \c in_pSizes is \c NULL
+///
+/// @thread_safety As \c hStreams_EnqueueData1D().
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_EnqueueDataList(
+    HSTR_LOG_STR        in_LogStreamID,
+    uint32_t            in_NumRegions,
+    void              **in_pWriteAddrs,
+    void              **in_pReadAddrs,
+    uint64_t           *in_pSizes,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent);
+
 /////////////////////////////////////////////////////////
 ///
 // hStreams_StreamSynchronize
@@ -936,7 +1527,9 @@ hStreams_EnqueueDataXDomain1D(
 ///
 /// @see HSTR_OPTIONS.time_out_ms_val
 ///
-/// @thread_safety Thread safe.
+/// @thread_safety Thread safe. The operations waited for are the ones enqueued
+///     before the call; other threads may keep enqueueing, to this stream or
+///     any other, while the calling thread waits.
 ///
 /////////////////////////////////////////////////////////
 DllAccess HSTR_RESULT
@@ -960,7 +1553,9 @@ hStreams_StreamSynchronize(
 ///
 /// @see HSTR_OPTIONS.time_out_ms_val
 ///
-/// @thread_safety Thread safe.
+/// @thread_safety Thread safe. Other threads may keep enqueueing while the
+///     calling thread waits; whether the operations they enqueue during the
+///     call are waited for is unspecified.
 ///
 /////////////////////////////////////////////////////////
 DllAccess HSTR_RESULT
@@ -1093,6 +1688,242 @@ hStreams_EventStreamWait(
     void         **in_pAddresses,
     HSTR_EVENT    *out_pEvent);
 
+/////////////////////////////////////////////////////////
+///
+// hStreams_EnqueueHostCallback
+/// @ingroup hStreams_Source_Sync
+/// @brief Enqueue a call to a host-side function, made once all the actions
+///     previously enqueued in a logical stream have completed
+///
+/// \c in_Callback is called with \c in_LogStreamID and \c in_pUserData on a
+/// thread internal to the library, so that no thread of the application has
+/// to block in \c hStreams_EventWait() just to act on a stream reaching a
+/// given point. Like a barrier, the call waits for all the actions
+/// enqueued before it in the stream, and all the actions enqueued after it
+/// wait for the callback to return.
+///
+/// The callbacks of one stream are called in the order in which they were
+/// enqueued. They may be called from the same thread as the callbacks of the
+/// other streams, so they should return quickly and hand any lengthy work
+/// over to a stream. A callback may enqueue actions into any stream,
+/// its own included, but must not wait for actions which are to wait for it
+/// or for a later callback, e.g. by synchronizing its own stream, as that
+/// would never return. \c hStreams_StreamSynchronize() waits for the
+/// callbacks already enqueued into the stream.
+///
+/// With the \c HSTR_DEP_POLICY_NONE dependency policy, the callback does not
+/// wait for the actions enqueued before it, nor do the later ones wait for it.
+///
+/// @param  in_LogStreamID
+///         [in] ID of the logical stream into which to enqueue the callback.
+///
+/// @param  in_Callback
+///         [in] The function to call.
+///
+/// @param  in_pUserData
+///         [in] Passed to \c in_Callback as is.
+///
+/// @param  out_pEvent
+///         [out] The event signaled once \c in_Callback has returned. If no
+///         handle is needed, set this to NULL.
+///
+/// @return If successful, \c hStreams_EnqueueHostCallback() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NOT_FOUND if a logical stream with ID \c in_LogStreamID doesn't
+///     exist
+/// @arg \c HSTR_RESULT_NULL_PTR if \c in_Callback is NULL
+/// @arg \c HSTR_RESULT_NOT_PERMITTED if the actions of the stream are being
+///     captured by \c hStreams_GraphBeginCapture()
+///
+/// @thread_safety All actions enqueued through concurrent calls to \c
+///     hStreams_EnqueueHostCallback() and any other function that enqueues actions
+///     into the same stream are guaranteed to be correctly inserted into the
+///     stream's queue, although in an unspecified order.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_EnqueueHostCallback(
+    HSTR_LOG_STR        in_LogStreamID,
+    HSTR_HOST_CALLBACK  in_Callback,
+    void               *in_pUserData,
+    HSTR_EVENT         *out_pEvent);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_GraphBeginCapture
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Start recording the actions enqueued in a stream into a graph,
+///     instead of enqueueing them
+///
+/// Until \c hStreams_GraphEndCapture() is called for the stream, the calls to
+/// \c hStreams_EnqueueCompute(), \c hStreams_EnqueueComputeByHandle(),
+/// \c hStreams_EnqueueComputeEx(), \c hStreams_EnqueueData1D(),
+/// \c hStreams_EnqueueDataXDomain1D() and \c hStreams_EventStreamWait() with
+/// \c in_LogStreamID don't enqueue anything. Instead, after the usual
+/// validation, the actions are recorded into a graph, along with the
+/// sink-side functions and buffer instantiations they have been resolved to.
+/// \c hStreams_GraphLaunch() then enqueues all of them with a single call,
+/// which skips the lookups and the validation.
+///
+/// The actions being captured have no events of their own, so the calls
+/// above fail with \c HSTR_RESULT_NOT_PERMITTED if asked for one through
+/// \c out_pEvent. \c hStreams_GraphLaunch() returns an event for the whole
+/// launch. The events passed to \c hStreams_EventStreamWait() are recorded
+/// as they are, and waited for by each launch.
+///
+/// @param  in_LogStreamID
+///         [in] ID of the logical stream to capture the actions of
+///
+/// @return If successful, \c hStreams_GraphBeginCapture() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_LogStreamID is not a valid logical stream ID
+/// @arg \c HSTR_RESULT_NOT_PERMITTED if the actions of the stream are already
+///     being captured
+///
+/// @thread_safety Thread safe. The actions enqueued in the stream from other
+///     threads while it's being captured are captured as well.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_GraphBeginCapture(
+    HSTR_LOG_STR      in_LogStreamID);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_GraphEndCapture
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Stop recording the actions enqueued in a stream and return the
+///     graph recorded
+///
+/// @param  in_LogStreamID
+///         [in] ID of the logical stream whose actions have been captured
+///
+/// @param  out_pGraph
+///         [out] The graph, to be destroyed by \c hStreams_GraphDestroy()
+///
+/// @return If successful, \c hStreams_GraphEndCapture() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NULL_PTR if \c out_pGraph is \c NULL
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_LogStreamID is not a valid logical stream ID
+/// @arg \c HSTR_RESULT_NOT_PERMITTED if the actions of the stream are not being captured
+///
+/// @thread_safety Thread safe, as long as no action is being enqueued in the
+///     stream concurrently.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_GraphEndCapture(
+    HSTR_LOG_STR      in_LogStreamID,
+    HSTR_GRAPH       *out_pGraph);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_GraphLaunch
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Enqueue the actions of a graph in the stream they have been captured from
+///
+/// The actions are enqueued in the order of capture, atomically with respect
+/// to the other actions enqueued in the stream. They wait for the earlier
+/// actions of the stream, and the later actions wait for them, just as if
+/// they had been enqueued one by one. The return values of the computes are
+/// written to the locations given during the capture.
+///
+/// The buffers the actions access must not be deallocated while the graph
+/// is in use.
+///
+/// @param  in_Graph
+///         [in] The graph
+///
+/// @param  out_pEvent
+///         [out] If not \c NULL, pointer to event which will be signaled once
+///         all of the actions launched complete
+///
+/// @return If successful, \c hStreams_GraphLaunch() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_Graph is not a valid graph, e.g. it has
+///     been destroyed, or the stream it has been captured from has been
+///     destroyed since
+/// @arg The errors of the enqueueing functions captured, except for the ones
+///     found by their validation. The actions preceding the failed one then
+///     stay enqueued.
+///
+/// @thread_safety Thread safe. Launches of the same graph are serialized.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_GraphLaunch(
+    HSTR_GRAPH        in_Graph,
+    HSTR_EVENT       *out_pEvent);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_GraphSetScalarArg
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Change the value of a scalar argument of a compute in a graph,
+///     for the later launches
+///
+/// @param  in_Graph
+///         [in] The graph
+///
+/// @param  in_ActionIndex
+///         [in] The index of the compute among all the actions captured into
+///         the graph, in the order of capture, starting from 0
+///
+/// @param  in_ArgIndex
+///         [in] The index of the argument among the compute's scalar arguments
+///
+/// @param  in_Value
+///         [in] The new value of the argument
+///
+/// @return If successful, \c hStreams_GraphSetScalarArg() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_Graph is not a valid graph, e.g. it has
+///     been destroyed
+/// @arg \c HSTR_RESULT_OUT_OF_RANGE if \c in_ActionIndex is not lower than the
+///     number of actions captured, or \c in_ArgIndex is not lower than the
+///     number of scalar arguments of the compute
+/// @arg \c HSTR_RESULT_INCONSISTENT_ARGS if the action is not a compute
+///
+/// @thread_safety Thread safe. The launches of the graph in progress
+///     are not affected.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_GraphSetScalarArg(
+    HSTR_GRAPH        in_Graph,
+    uint32_t          in_ActionIndex,
+    uint32_t          in_ArgIndex,
+    uint64_t          in_Value);
+
+/////////////////////////////////////////////////////////
+///
+// hStreams_GraphDestroy
+/// @ingroup hStreams_Source_StreamUsage
+/// @brief Destroy a graph
+///
+/// The actions already launched from the graph are not affected.
+///
+/// @param  in_Graph
+///         [in] The graph
+///
+/// @return If successful, \c hStreams_GraphDestroy() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if hStreams had not been initialized properly.
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_Graph is not a valid graph, e.g. it has
+///     been destroyed
+///
+/// @thread_safety Thread safe, as long as the graph is not used concurrently.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_GraphDestroy(
+    HSTR_GRAPH        in_Graph);
+
 /////////////////////////////////////////////////////////
 ///
 // hStreams_Alloc1D
@@ -1438,6 +2269,51 @@ hStreams_GetBufferProps(
     void                *in_Address,
     HSTR_BUFFER_PROPS   *out_BufferProps);
 
+/////////////////////////////////////////////////////////
+///
+// hStreams_GetBufferNumaNode
+/// @ingroup hStreams_Source_MemMgmt
+/// @brief Returns the NUMA node of the host memory holding the buffer's
+///     instantiation for a logical domain.
+///
+/// Instantiations for logical domains of \c HSTR_SRC_PHYS_DOMAIN are allocated
+/// by hStreams in the memory closest to the CPUs of the logical domain. If
+/// all of them belong to one NUMA node, the memory is placed on that node;
+/// if they span several nodes, it's spread over them. Small buffers, of less
+/// than 64 KiB, aren't placed.
+///
+/// @param  in_Address
+///         [in] Source proxy address anywhere in a buffer.
+/// @param  in_LogDomainID
+///         [in] ID of the logical domain of the instantiation.
+/// @param  out_pNumaNode
+///         [out] The NUMA node, or -1 if the instantiation wasn't placed on a
+///         single node by hStreams. That's the case for \c HSTR_SRC_LOG_DOMAIN,
+///         whose memory is provided by the application; for the
+///         instantiations aliasing it; for those which aren't in the host's
+///         memory; and wherever the NUMA topology of the host is unknown.
+///
+/// @return If successful, \c hStreams_GetBufferNumaNode() returns
+///     \c HSTR_RESULT_SUCCESS. Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_INITIALIZED if \c hStreams had not been initialized
+///         properly.
+/// @arg \c HSTR_RESULT_NULL_PTR if \c in_Address is \c NULL.
+/// @arg \c HSTR_RESULT_NULL_PTR if \c out_pNumaNode is \c NULL.
+/// @arg \c HSTR_RESULT_NOT_FOUND if \c in_Address does not belong to any buffer.
+/// @arg \c HSTR_RESULT_DOMAIN_OUT_OF_RANGE if \c in_LogDomainID is not a valid
+///         logical domain ID.
+/// @arg \c HSTR_RESULT_NOT_FOUND if the buffer is not instantiated for the
+///         logical domain.
+///
+/// @thread_safety Thread safe.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_GetBufferNumaNode(
+    void                *in_Address,
+    HSTR_LOG_DOM         in_LogDomainID,
+    int32_t             *out_pNumaNode);
+
 /////////////////////////////////////////////////////////
 ///
 // hStreams_GetLastError
@@ -1543,6 +2419,35 @@ DllAccess HSTR_RESULT
 hStreams_Cfg_SetMKLInterface(
     HSTR_MKL_INTERFACE in_MKLInterface);
 
+/////////////////////////////////////////////////////////
+///
+// hStreams_Cfg_SetHostBufferAliasing
+/// @ingroup hStreams_Configuration
+/// @brief Share the memory supplied by the user among all the logical domains
+///     on the host
+///
+/// @param  in_Enable
+///         [in] Whether to add \c HSTR_BUF_PROP_HOST_ALIASED to the properties
+///         of all the buffers created afterwards, including those created by
+///         hStreams_app_create_buf()
+///
+/// The instances of such buffers for the logical domains of the source
+/// physical domain are the memory supplied by the user, and transfers between
+/// \c HSTR_SRC_LOG_DOMAIN and those logical domains only resolve the
+/// dependencies. The setting is in effect until hStreams_Fini() is called.
+///
+/// @return If successful, \c hStreams_Cfg_SetHostBufferAliasing() returns \c HSTR_RESULT_SUCCESS.
+///     Otherwise, it returns one of the following errors:
+/// @arg \c HSTR_RESULT_NOT_PERMITTED if the hetero-streams library has been
+///     already initialized
+///
+/// @thread_safety Not thread safe.
+///
+/////////////////////////////////////////////////////////
+DllAccess HSTR_RESULT
+hStreams_Cfg_SetHostBufferAliasing(
+    bool in_Enable);
+
 /////////////////////////////////////////////////////////
 ///
 // hStreams_SetOptions
@@ -287,17 +287,98 @@ typedef enum {
     /// Everything submitted to an hStream depends on everything before it
     HSTR_DEP_POLICY_CONSERVATIVE = 0,
 
-    /// Dependendencies are based on the existence of RAW, WAW, WAE to the same buffer
+    /// Dependendencies are based on the existence of RAW, WAW, WAE to the same buffer.
+    /// They are tracked per byte range, so that the transfers, and the computes
+    /// declaring how much memory they access through \c hStreams_EnqueueComputeEx(),
+    /// only depend on the actions accessing overlapping parts of the buffers.
     HSTR_DEP_POLICY_BUFFERS,
 
-    /// Dependencies ignored, for perf debug testing only; must be last
+    /// Dependencies ignored, for perf debug testing only
     HSTR_DEP_POLICY_NONE,
 
+    /// As \c HSTR_DEP_POLICY_BUFFERS, but taking into account the access modes
+    /// of the heap arguments declared through \c hStreams_EnqueueComputeEx():
+    /// actions only reading a buffer don't wait for each other, only for the
+    /// last action writing it, while an action writing a buffer waits for all
+    /// the actions reading it since. Added after the others so as not to
+    /// change their values.
+    HSTR_DEP_POLICY_ACCESS_MODES,
+
     /// One past the max supported value; = to # of supported values
     HSTR_DEP_POLICY_SIZE
 
 } HSTR_DEP_POLICY_VALUES;
 
+/// @brief This is the type associated with the ways an action accesses a buffer
+typedef int HSTR_ACCESS_MODE;
+
+/// @brief Possible values of \c HSTR_ACCESS_MODE
+typedef enum {
+    /// The action only reads the buffer
+    HSTR_ACCESS_READ = 1,
+
+    /// The action only writes the buffer
+    HSTR_ACCESS_WRITE = 2,
+
+    /// The action both reads and writes the buffer
+    HSTR_ACCESS_READ_WRITE = HSTR_ACCESS_READ | HSTR_ACCESS_WRITE
+
+} HSTR_ACCESS_MODE_VALUES;
+
+/// @brief This is the type associated with the flags a stream is created with
+typedef int HSTR_STREAM_FLAGS;
+
+/// @brief Possible values of \c HSTR_STREAM_FLAGS
+typedef enum {
+    /// The computes in the stream execute in the order they were enqueued in
+    HSTR_STREAM_IN_ORDER = 0,
+
+    /// The computes in the stream only wait for the actions they depend on
+    /// through the buffers they access, so that a compute whose inputs are
+    /// ready may execute ahead of the ones enqueued before it. Only taken
+    /// into account with the \c HSTR_DEP_POLICY_BUFFERS and
+    /// \c HSTR_DEP_POLICY_ACCESS_MODES dependence policies.
+    HSTR_STREAM_OUT_OF_ORDER = 1
+
+} HSTR_STREAM_FLAGS_VALUES;
+
+/// @brief This is the type associated with the priority of a logical stream
+typedef int HSTR_STREAM_PRIORITY;
+
+/// @brief Possible values of \c HSTR_STREAM_PRIORITY, from the lowest
+typedef enum {
+    /// For background work, e.g. batches of large computations
+    HSTR_STREAM_PRIORITY_LOW = 0,
+
+    /// The priority the logical streams are created with
+    HSTR_STREAM_PRIORITY_NORMAL,
+
+    /// For latency-sensitive work, e.g. requests to be served as soon as possible
+    HSTR_STREAM_PRIORITY_HIGH,
+
+    /// One past the max supported value; = to # of supported values
+    HSTR_STREAM_PRIORITY_SIZE
+
+} HSTR_STREAM_PRIORITY_VALUES;
+
+/// @brief This is the type associated with the orders in which
+///     \c hStreams_app_dag_execute() submits the tasks ready to run
+typedef int HSTR_DAG_POLICY;
+
+/// @brief Possible values of \c HSTR_DAG_POLICY
+typedef enum {
+    /// Of the tasks whose predecessors have all been submitted, the one
+    /// heading the costliest chain of tasks still to be submitted goes first
+    HSTR_DAG_POLICY_CRITICAL_PATH = 0,
+
+    /// The tasks ready to run go in the order they have been added in
+    HSTR_DAG_POLICY_FIFO,
+
+    /// One past the max supported value; = to # of supported values
+    HSTR_DAG_POLICY_SIZE
+
+} HSTR_DAG_POLICY_VALUES;
+
 ///@brief Type associated with hStream's KMP affinity policy
 typedef int HSTR_KMP_AFFINITY;
 
@@ -418,8 +499,17 @@ typedef enum {
     ///  return \c HSTR_RESULT_NOT_IMPLEMENTED if that flag is set.
     HSTR_BUF_PROP_AFFINITIZED = 8,
 
+    /// The instances for all the logical domains of the source physical
+    ///  domain are the instance associated with \c HSTR_SRC_LOG_DOMAIN,
+    ///  i.e. the memory supplied by the user. Transfers between them only
+    ///  resolve dependencies, no bytes are copied. Unlike with
+    ///  \c HSTR_BUF_PROP_ALIASED, the logical domains of the other physical
+    ///  domains get instances of their own.
+    ///  See also hStreams_Cfg_SetHostBufferAliasing().
+    HSTR_BUF_PROP_HOST_ALIASED = 16,
+
     /// First invalid value of bitmask. Value of last flag * 2.
-    HSTR_BUF_PROP_INVALID_VALUE = 16
+    HSTR_BUF_PROP_INVALID_VALUE = 32
 } HSTR_BUFFER_PROP_FLAGS_VALUES;
 
 /// @brief Type associated with hStream memory allocation policy regarding
@@ -473,6 +563,27 @@ typedef uint64_t HSTR_LOG_STR;
 typedef uint32_t HSTR_LOG_DOM;
 typedef int32_t  HSTR_PHYS_DOM;
 
+/////////////////////////////////////////////////////////////////////
+/// HSTR_FUNC_HANDLE identifies a sink-side function resolved once by
+/// hStreams_GetFunctionHandle(), for use with
+/// hStreams_EnqueueComputeByHandle(). 0 is never a valid handle.
+
+typedef uint64_t HSTR_FUNC_HANDLE;
+
+/////////////////////////////////////////////////////////////////////
+/// HSTR_GRAPH identifies a sequence of actions captured from a stream by
+/// hStreams_GraphBeginCapture() and hStreams_GraphEndCapture(), for use
+/// with hStreams_GraphLaunch(). 0 is never a valid graph.
+
+typedef uint64_t HSTR_GRAPH;
+
+/////////////////////////////////////////////////////////////////////
+/// HSTR_DAG identifies a set of tasks created by hStreams_app_dag_create(),
+/// to be scheduled onto streams by hStreams_app_dag_execute(). 0 is never a
+/// valid DAG.
+
+typedef uint64_t HSTR_DAG;
+
 /////////////////////////////////////////////////////////////////////
 
 /////////////////////////////////////////////////////////////////////
@@ -481,6 +592,11 @@ typedef int32_t  HSTR_PHYS_DOM;
 /* Function pointer declaration pointing to a function that has same prototype for hStreams fatal error function. */
 typedef void (*hStreams_FatalError_Prototype_Fptr)(int);
 
+/// A host-side function run by hStreams_EnqueueHostCallback() once all the
+/// preceding actions in a stream have completed. It is passed the ID of the
+/// logical stream it was enqueued into and the user data it was enqueued with.
+typedef void (*HSTR_HOST_CALLBACK)(HSTR_LOG_STR, void *);
+
 // End public function decl types
 /////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2014-2016 Intel Corporation.
+ *
+ * This file is subject to the Intel Sample Source Code License. A copy
+ * of the Intel Sample Source Code License is included.
+ */
+
+//********************************************************************************
+// Measures how fast the library maps an address to the buffer containing it,
+// which it does for every argument and every transfer enqueued. Many buffers
+// are allocated side by side in one large chunk of memory, then the buffers
+// containing a large number of addresses are queried:
+//  - random: each address is picked at random from the whole chunk,
+//  - repeated: the same buffer is queried a few times in a row, as happens
+//    when a few consecutive actions work on the same tile.
+//
+// API level:
+//  core APIs in hStreams_source.h
+// Functionality exercised
+//     init
+//     alloc1D
+//     get buffer number of logical domains
+//     dealloc
+//     fini
+//
+//      USAGE: buffer_lookup [-b buffers] [-n lookups] [-r repeats] [-i iterations]
+//
+//********************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <hStreams_source.h>
+#include "dtime.h"  // elapsed time measurement.
+
+#define NBUFFERS 10000                          // Buffers to look up in
+#define NLOOKUPS 1000000                        // Addresses looked up per iteration
+#define REPEATS 4                               // Lookups in a row of the same buffer
+#define ITERATIONS 3                            // Timing iterations per mode
+#define BUF_SIZE 4096                           // Size of each buffer
+
+static void usage(const char *myname)
+{
+    fprintf(stderr, "USAGE: %s [-b buffers] [-n lookups] [-r repeats] [-i iterations]\n", myname);
+    exit(1);
+}
+
+// Look up the buffer of each of the addresses
+static HSTR_RESULT lookupAll(std::vector<char *> const &addrs)
+{
+    uint64_t num_log_doms;
+    for (size_t i = 0; i < addrs.size(); ++i) {
+        CHECK_HSTR_RESULT(hStreams_GetBufferNumLogDomains(addrs[i], &num_log_doms));
+    }
+    return HSTR_RESULT_SUCCESS;
+}
+
+static HSTR_RESULT timeLookups(const char *mode, std::vector<char *> const &addrs, int iterations)
+{
+    for (int iter = 0; iter < iterations; ++iter) {
+        double timeBegin = dtimeGet();
+        CHECK_HSTR_RESULT(lookupAll(addrs));
+        double timeEnd = dtimeGet();
+
+        printf("%-8s %zu lookups: %.3f ms, %.1f ns per lookup\n",
+               mode, addrs.size(), 1.0e3 * (timeEnd - timeBegin),
+               1.0e9 * (timeEnd - timeBegin) / addrs.size());
+    }
+    return HSTR_RESULT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    int nbuffers = NBUFFERS;
+    int nlookups = NLOOKUPS;
+    int repeats = REPEATS;
+    int iterations = ITERATIONS;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-b") == 0) {
+            nbuffers = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            nlookups = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            repeats = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+            iterations = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (nbuffers <= 0 || nlookups <= 0 || repeats <= 0 || iterations <= 0) {
+        usage(argv[0]);
+    }
+
+    dtimeInit();
+    CHECK_HSTR_RESULT(hStreams_Init());
+
+    std::vector<char> heap((size_t) nbuffers * BUF_SIZE);
+    for (int b = 0; b < nbuffers; ++b) {
+        CHECK_HSTR_RESULT(hStreams_Alloc1D(&heap[(size_t) b * BUF_SIZE], BUF_SIZE));
+    }
+
+    // The addresses are picked up front so as not to time the random number
+    // generator. Fixed seed, for the runs to be comparable.
+    srand(1);
+    std::vector<char *> random_addrs(nlookups);
+    for (int i = 0; i < nlookups; ++i) {
+        size_t offset = ((size_t) rand() * ((size_t) RAND_MAX + 1) + rand()) % heap.size();
+        random_addrs[i] = &heap[offset];
+    }
+    std::vector<char *> repeated_addrs(nlookups);
+    for (int i = 0; i < nlookups; ++i) {
+        // Runs of addresses within the buffer of the run's first random address
+        size_t buf_offset = (random_addrs[i - i % repeats] - &heap[0]) / BUF_SIZE * BUF_SIZE;
+        repeated_addrs[i] = &heap[buf_offset + rand() % BUF_SIZE];
+    }
+
+    printf("%d buffers of %d bytes, %d lookups in a row of the same buffer in the repeated mode\n",
+           nbuffers, BUF_SIZE, repeats);
+    CHECK_HSTR_RESULT(timeLookups("random", random_addrs, iterations));
+    CHECK_HSTR_RESULT(timeLookups("repeated", repeated_addrs, iterations));
+
+    for (int b = 0; b < nbuffers; ++b) {
+        CHECK_HSTR_RESULT(hStreams_DeAlloc(&heap[(size_t) b * BUF_SIZE]));
+    }
+    CHECK_HSTR_RESULT(hStreams_Fini());
+    return 0;
+}
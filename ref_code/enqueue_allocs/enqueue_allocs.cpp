@@ -0,0 +1,247 @@
+/*
+ * Copyright 2014-2016 Intel Corporation.
+ *
+ * This file is subject to the Intel Sample Source Code License. A copy
+ * of the Intel Sample Source Code License is included.
+ */
+
+//********************************************************************************
+// Checks that enqueueing computes into a host-side stream doesn't allocate
+// memory once the stream has warmed up.
+//
+// The global operator new and delete, as well as malloc and friends, are
+// replaced by versions which count the allocations made by any thread of the
+// process, the library's worker threads included. After a few warm-up rounds,
+// each round enqueues a number of computes (the queue depth, -d) and then waits
+// for the last of them, with the allocations being counted. Any allocation is
+// reported as a failure.
+//
+// The library keeps the memory of executed actions for reuse, up to the
+// deepest backlog seen so far. To have every round reach the same depth, each
+// of them starts with a compute which holds the stream's worker until all the
+// others have been enqueued, enqueue_allocs_gate, a function defined in this
+// file. The others are only enqueued once the gate is running, so the worker
+// finds all of them in its queue at once. The executable is linked with
+// -rdynamic so that the host-side streams can find it.
+//
+// The other tasks are calls to hStreams_null_func_1heap_arg, an empty
+// sink-side function shipped with the library, with a single buffer argument.
+// They are enqueued by function name or, with -h, by a function handle.
+//
+// API level:
+//  core APIs in hStreams_source.h
+// Functionality exercised
+//     init
+//     add log domain
+//     stream create
+//     alloc1D
+//     get function handle
+//     enqueue compute, by name and by handle
+//     event wait
+//     fini
+//
+//      USAGE: enqueue_allocs [-d depth] [-r rounds] [-h]
+//
+//********************************************************************************
+
+#include <atomic>
+#include <errno.h>
+#include <new>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hStreams_source.h>
+
+#define DEPTH 1000                              // Computes enqueued per round
+#define ROUNDS 10                               // Counted rounds
+#define WARMUP_ROUNDS 3                         // Rounds before counting
+
+// The glibc implementation, which the replacements below forward to
+extern "C" {
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t num, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void *ptr);
+}
+
+static std::atomic<bool> counting(false);
+static std::atomic<uint64_t> num_allocs(0);
+static std::atomic<bool> gate_running(false);
+static std::atomic<bool> gate_open(false);
+
+// Holds the stream's worker until the gate is opened
+extern "C" void enqueue_allocs_gate()
+{
+    gate_running = true;
+    while (!gate_open.load()) {
+        sched_yield();
+    }
+}
+
+static void countAlloc()
+{
+    if (counting.load(std::memory_order_relaxed)) {
+        num_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+extern "C" void *malloc(size_t size)
+{
+    countAlloc();
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t num, size_t size)
+{
+    countAlloc();
+    return __libc_calloc(num, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    countAlloc();
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    countAlloc();
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr == NULL ? ENOMEM : 0;
+}
+
+extern "C" void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+void *operator new(size_t size)
+{
+    countAlloc();
+    void *ptr = __libc_malloc(size ? size : 1);
+    if (ptr == NULL) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    __libc_free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    __libc_free(ptr);
+}
+
+static void usage(const char *myname)
+{
+    fprintf(stderr, "USAGE: %s [-d depth] [-r rounds] [-h]\n", myname);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    int depth = DEPTH;
+    int rounds = ROUNDS;
+    bool by_handle = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+            depth = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            rounds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-h") == 0) {
+            by_handle = true;
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (depth <= 0 || rounds <= 0) {
+        usage(argv[0]);
+    }
+
+    CHECK_HSTR_RESULT(hStreams_Init());
+
+    // A logical domain and a stream on a single host thread
+    uint32_t num_threads, max_freq;
+    uint64_t mem_types, mem_avail[HSTR_MEM_TYPE_SIZE];
+    HSTR_CPU_MASK max_mask, avoid_mask, use_mask;
+    HSTR_ISA_TYPE isa;
+    CHECK_HSTR_RESULT(hStreams_GetPhysDomainDetails(HSTR_SRC_PHYS_DOMAIN, &num_threads, &isa,
+                      &max_freq, max_mask, avoid_mask, &mem_types, mem_avail));
+    HSTR_CPU_MASK_ZERO(use_mask);
+    int cpu = 0;
+    while (!HSTR_CPU_MASK_ISSET(cpu, max_mask)) {
+        ++cpu;
+    }
+    HSTR_CPU_MASK_SET(cpu, use_mask);
+
+    HSTR_LOG_DOM log_dom;
+    HSTR_OVERLAP_TYPE overlap;
+    CHECK_HSTR_RESULT(hStreams_AddLogDomain(HSTR_SRC_PHYS_DOMAIN, use_mask, &log_dom, &overlap));
+    HSTR_LOG_STR stream = 0;
+    CHECK_HSTR_RESULT(hStreams_StreamCreate(stream, log_dom, use_mask));
+
+    char heap_arg[64];
+    CHECK_HSTR_RESULT(hStreams_Alloc1D(heap_arg, sizeof(heap_arg)));
+    uint64_t args[1] = { (uint64_t) heap_arg };
+    const char *func_name = "hStreams_null_func_1heap_arg";
+    HSTR_FUNC_HANDLE func_handle;
+    CHECK_HSTR_RESULT(hStreams_GetFunctionHandle(func_name, &func_handle));
+
+    uint64_t max_allocs = 0;
+    for (int round = -WARMUP_ROUNDS; round < rounds; ++round) {
+        num_allocs = 0;
+        gate_running = false;
+        gate_open = false;
+        counting = round >= 0;
+        CHECK_HSTR_RESULT(hStreams_EnqueueCompute(stream, "enqueue_allocs_gate",
+                          0, 0, NULL, NULL, NULL, 0));
+        while (!gate_running.load()) {
+            sched_yield();
+        }
+        // Wait for the last compute rather than synchronize the stream, as
+        // only the computes are to be counted
+        HSTR_EVENT last;
+        for (int task = 0; task < depth; ++task) {
+            HSTR_EVENT *event = (task + 1 == depth) ? &last : NULL;
+            if (by_handle) {
+                CHECK_HSTR_RESULT(hStreams_EnqueueComputeByHandle(stream, func_handle,
+                                  0, 1, args, event, NULL, 0));
+            } else {
+                CHECK_HSTR_RESULT(hStreams_EnqueueCompute(stream, func_name,
+                                  0, 1, args, event, NULL, 0));
+            }
+        }
+        gate_open = true;
+        CHECK_HSTR_RESULT(hStreams_EventWait(1, &last, true, -1, NULL, NULL));
+        counting = false;
+        if (round >= 0 && num_allocs > max_allocs) {
+            max_allocs = num_allocs;
+        }
+    }
+
+    printf("by %s, depth %d, %d rounds: at most %lu allocations per round, %.3f per compute\n",
+           by_handle ? "handle" : "name", depth, rounds, (unsigned long) max_allocs,
+           (double) max_allocs / depth);
+
+    CHECK_HSTR_RESULT(hStreams_DeAlloc(heap_arg));
+    CHECK_HSTR_RESULT(hStreams_Fini());
+
+    if (max_allocs != 0) {
+        printf("FAILED: enqueueing computes allocates memory\n");
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+}
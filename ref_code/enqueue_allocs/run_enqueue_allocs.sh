@@ -0,0 +1,13 @@
+#                                                                      #
+# Copyright 2014-2016 Intel Corporation.                               #
+#                                                                      #
+# This file is subject to the Intel Sample Source Code License. A copy #
+# of the Intel Sample Source Code License is included.                 #
+#                                                                      #
+
+source ../common/setEnv.sh
+cd ../../bin/host
+for depth in 16 1000 10000; do
+    ./enqueue_allocs -d $depth $* || exit 1
+    ./enqueue_allocs -d $depth -h $* || exit 1
+done
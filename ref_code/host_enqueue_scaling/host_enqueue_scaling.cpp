@@ -0,0 +1,175 @@
+/*
+ * Copyright 2014-2016 Intel Corporation.
+ *
+ * This file is subject to the Intel Sample Source Code License. A copy
+ * of the Intel Sample Source Code License is included.
+ */
+
+//********************************************************************************
+// Measures how the aggregate enqueue rate scales with the number of threads
+// enqueueing at the same time. Every thread enqueues into a host-side stream
+// and a buffer of its own, so whatever keeps the rate from growing with the
+// number of threads is contention inside hStreams itself, e.g. on the tables
+// of streams, domains and buffers every enqueue has to look into.
+//
+// The tasks are calls to hStreams_null_func_1heap_arg, an empty sink-side
+// function shipped with the library, enqueued by a function handle.
+//
+// API level:
+//  core APIs in hStreams_source.h
+// Functionality exercised
+//     init
+//     add log domain
+//     stream create
+//     alloc1D
+//     get function handle
+//     enqueue compute by handle, from many threads
+//     thread synchronize
+//     fini
+//
+//      USAGE: host_enqueue_scaling [-n tasks] [-i iterations] [-t max-threads]
+//
+//********************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <omp.h>
+
+#include <hStreams_source.h>
+#include "dtime.h"  // elapsed time measurement.
+
+#define NTASKS 200000                           // Tasks enqueued per thread per iteration
+#define ITERATIONS 3                            // Timing iterations per number of threads
+#define BUF_SIZE 64                             // Size of each thread's buffer
+
+static void usage(const char *myname)
+{
+    fprintf(stderr, "USAGE: %s [-n tasks] [-i iterations] [-t max-threads]\n", myname);
+    exit(1);
+}
+
+// Enqueue ntasks tasks into the stream, each taking the buffer as its argument
+static HSTR_RESULT enqueueTasks(HSTR_LOG_STR stream, HSTR_FUNC_HANDLE func_handle,
+                                uint64_t *args, int ntasks)
+{
+    for (int task = 0; task < ntasks; ++task) {
+        CHECK_HSTR_RESULT(hStreams_EnqueueComputeByHandle(stream, func_handle,
+                          0, 1, args, NULL, NULL, 0));
+    }
+    return HSTR_RESULT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    int ntasks = NTASKS;
+    int iterations = ITERATIONS;
+    int max_threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            ntasks = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+            iterations = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            max_threads = atoi(argv[++i]);
+            if (max_threads <= 0) {
+                usage(argv[0]);
+            }
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (ntasks <= 0 || iterations <= 0) {
+        usage(argv[0]);
+    }
+
+    dtimeInit();
+    CHECK_HSTR_RESULT(hStreams_Init());
+
+    // A single logical domain over all of the host's CPUs
+    uint32_t num_threads, max_freq;
+    uint64_t mem_types, mem_avail[HSTR_MEM_TYPE_SIZE];
+    HSTR_CPU_MASK max_mask, avoid_mask;
+    HSTR_ISA_TYPE isa;
+    CHECK_HSTR_RESULT(hStreams_GetPhysDomainDetails(HSTR_SRC_PHYS_DOMAIN, &num_threads, &isa,
+                      &max_freq, max_mask, avoid_mask, &mem_types, mem_avail));
+    int num_cpus = HSTR_CPU_MASK_COUNT(max_mask);
+    if (max_threads == 0 || max_threads > num_cpus) {
+        max_threads = num_cpus;
+    }
+
+    HSTR_LOG_DOM log_dom;
+    HSTR_OVERLAP_TYPE overlap;
+    CHECK_HSTR_RESULT(hStreams_AddLogDomain(HSTR_SRC_PHYS_DOMAIN, max_mask, &log_dom, &overlap));
+
+    // One stream per enqueueing thread, each on a different CPU so that they
+    // don't end up sharing the same physical stream
+    HSTR_FUNC_HANDLE func_handle;
+    CHECK_HSTR_RESULT(hStreams_GetFunctionHandle("hStreams_null_func_1heap_arg", &func_handle));
+    std::vector<char> heap(max_threads * BUF_SIZE);
+    std::vector<uint64_t> args(max_threads);
+    int cpu = 0;
+    for (int t = 0; t < max_threads; ++t) {
+        while (!HSTR_CPU_MASK_ISSET(cpu, max_mask)) {
+            ++cpu;
+        }
+        HSTR_CPU_MASK use_mask;
+        HSTR_CPU_MASK_ZERO(use_mask);
+        HSTR_CPU_MASK_SET(cpu, use_mask);
+        ++cpu;
+        CHECK_HSTR_RESULT(hStreams_StreamCreate(t, log_dom, use_mask));
+
+        char *buf = &heap[t * BUF_SIZE];
+        CHECK_HSTR_RESULT(hStreams_Alloc1D(buf, BUF_SIZE));
+        args[t] = (uint64_t) buf;
+
+        // Warm-up
+        CHECK_HSTR_RESULT(hStreams_EnqueueComputeByHandle(t, func_handle,
+                          0, 1, &args[t], NULL, NULL, 0));
+    }
+    CHECK_HSTR_RESULT(hStreams_ThreadSynchronize());
+
+    omp_set_dynamic(0);
+    int nthreads = 1;
+    while (nthreads <= max_threads) {
+        for (int iter = 0; iter < iterations; ++iter) {
+            HSTR_RESULT hret = HSTR_RESULT_SUCCESS;
+            double timeBegin = 0.0;
+#pragma omp parallel num_threads(nthreads)
+            {
+                int t = omp_get_thread_num();
+#pragma omp barrier
+#pragma omp master
+                timeBegin = dtimeGet();
+                HSTR_RESULT my_hret = enqueueTasks(t, func_handle, &args[t], ntasks);
+                if (my_hret != HSTR_RESULT_SUCCESS) {
+#pragma omp critical
+                    hret = my_hret;
+                }
+            }
+            if (hret != HSTR_RESULT_SUCCESS) {
+                return hret;
+            }
+            CHECK_HSTR_RESULT(hStreams_ThreadSynchronize());
+            double timeEnd = dtimeGet();
+
+            printf("%3d threads, %d tasks each: %.3f ms, %.0f tasks/s\n",
+                   nthreads, ntasks, 1.0e3 * (timeEnd - timeBegin),
+                   (double) nthreads * ntasks / (timeEnd - timeBegin));
+        }
+        // Double the number of threads each time, but finish with all of them
+        if (nthreads < max_threads && nthreads * 2 > max_threads) {
+            nthreads = max_threads;
+        } else {
+            nthreads *= 2;
+        }
+    }
+
+    for (int t = 0; t < max_threads; ++t) {
+        CHECK_HSTR_RESULT(hStreams_DeAlloc(&heap[t * BUF_SIZE]));
+    }
+    CHECK_HSTR_RESULT(hStreams_Fini());
+    return 0;
+}
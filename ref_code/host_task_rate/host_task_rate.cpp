@@ -0,0 +1,138 @@
+/*
+ * Copyright 2014-2016 Intel Corporation.
+ *
+ * This file is subject to the Intel Sample Source Code License. A copy
+ * of the Intel Sample Source Code License is included.
+ */
+
+//********************************************************************************
+// Measures how many tasks per second a single host-side stream can get through.
+// The tasks are calls to hStreams_null_func_1heap_arg, an empty sink-side
+// function shipped with the library, so what is measured is the per-task
+// overhead of enqueueing, dependency tracking and executing on the host
+// stream's worker thread.
+//
+// The tasks are enqueued by function name, or with -h by a function handle
+// obtained once from hStreams_GetFunctionHandle.
+//
+// API level:
+//  core APIs in hStreams_source.h
+// Functionality exercised
+//     init
+//     add log domain
+//     stream create
+//     alloc1D
+//     get function handle
+//     enqueue compute, by name and by handle
+//     stream synchronize
+//     fini
+//
+//      USAGE: host_task_rate [-n tasks] [-i iterations] [-h]
+//
+//********************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hStreams_source.h>
+#include "dtime.h"  // elapsed time measurement.
+
+#define NTASKS 1000000                          // Tasks enqueued per iteration
+#define ITERATIONS 5                            // Timing iterations
+
+static void usage(const char *myname)
+{
+    fprintf(stderr, "USAGE: %s [-n tasks] [-i iterations] [-h]\n", myname);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    int ntasks = NTASKS;
+    int iterations = ITERATIONS;
+    bool by_handle = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            ntasks = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-h") == 0) {
+            by_handle = true;
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (ntasks <= 0 || iterations <= 0) {
+        usage(argv[0]);
+    }
+
+    dtimeInit();
+    CHECK_HSTR_RESULT(hStreams_Init());
+
+    // A logical domain and a stream on a single host thread, so that the
+    // worker and the enqueueing thread don't compete for the same CPU
+    uint32_t num_threads, max_freq;
+    uint64_t mem_types, mem_avail[HSTR_MEM_TYPE_SIZE];
+    HSTR_CPU_MASK max_mask, avoid_mask, use_mask;
+    HSTR_ISA_TYPE isa;
+    CHECK_HSTR_RESULT(hStreams_GetPhysDomainDetails(HSTR_SRC_PHYS_DOMAIN, &num_threads, &isa,
+                      &max_freq, max_mask, avoid_mask, &mem_types, mem_avail));
+    HSTR_CPU_MASK_ZERO(use_mask);
+    int cpu = 0;
+    while (!HSTR_CPU_MASK_ISSET(cpu, max_mask)) {
+        ++cpu;
+    }
+    // Leave the first CPU to the enqueueing thread, if there's more than one
+    if (HSTR_CPU_MASK_COUNT(max_mask) > 1) {
+        ++cpu;
+        while (!HSTR_CPU_MASK_ISSET(cpu, max_mask)) {
+            ++cpu;
+        }
+    }
+    HSTR_CPU_MASK_SET(cpu, use_mask);
+
+    HSTR_LOG_DOM log_dom;
+    HSTR_OVERLAP_TYPE overlap;
+    CHECK_HSTR_RESULT(hStreams_AddLogDomain(HSTR_SRC_PHYS_DOMAIN, use_mask, &log_dom, &overlap));
+    HSTR_LOG_STR stream = 0;
+    CHECK_HSTR_RESULT(hStreams_StreamCreate(stream, log_dom, use_mask));
+
+    char heap_arg[64];
+    CHECK_HSTR_RESULT(hStreams_Alloc1D(heap_arg, sizeof(heap_arg)));
+    uint64_t args[1] = { (uint64_t) heap_arg };
+    const char *func_name = "hStreams_null_func_1heap_arg";
+    HSTR_FUNC_HANDLE func_handle;
+    CHECK_HSTR_RESULT(hStreams_GetFunctionHandle(func_name, &func_handle));
+
+    // Warm-up
+    CHECK_HSTR_RESULT(hStreams_EnqueueCompute(stream, func_name,
+                      0, 1, args, NULL, NULL, 0));
+    CHECK_HSTR_RESULT(hStreams_StreamSynchronize(stream));
+
+    for (int iter = 0; iter < iterations; ++iter) {
+        double timeBegin = dtimeGet();
+        if (by_handle) {
+            for (int task = 0; task < ntasks; ++task) {
+                CHECK_HSTR_RESULT(hStreams_EnqueueComputeByHandle(stream, func_handle,
+                                  0, 1, args, NULL, NULL, 0));
+            }
+        } else {
+            for (int task = 0; task < ntasks; ++task) {
+                CHECK_HSTR_RESULT(hStreams_EnqueueCompute(stream, func_name,
+                                  0, 1, args, NULL, NULL, 0));
+            }
+        }
+        CHECK_HSTR_RESULT(hStreams_StreamSynchronize(stream));
+        double timeEnd = dtimeGet();
+
+        printf("by %s, %d tasks: %.3f ms, %.0f tasks/s\n",
+               by_handle ? "handle" : "name", ntasks, 1.0e3 * (timeEnd - timeBegin),
+               ntasks / (timeEnd - timeBegin));
+    }
+
+    CHECK_HSTR_RESULT(hStreams_DeAlloc(heap_arg));
+    CHECK_HSTR_RESULT(hStreams_Fini());
+    return 0;
+}
@@ -0,0 +1,299 @@
+/*
+ * Copyright 2014-2016 Intel Corporation.
+ *
+ * This file is subject to the Intel Sample Source Code License. A copy
+ * of the Intel Sample Source Code License is included.
+ */
+
+//********************************************************************************
+// Measures the memory bandwidth of a streaming kernel run by host-side streams
+// when the buffers are local to the streams' CPUs and when they are remote.
+//
+// A logical domain is created with the CPUs of the first NUMA node, with one
+// single-CPU stream for each of them (or for the first -t of them). Each
+// stream runs the STREAM triad, a[i] = b[i] + 3 * c[i], on its slice of three
+// arrays of doubles.
+//
+// Local:  the arrays are ordinary buffers, so hStreams allocates the
+//         instances for the logical domain itself, on the domain's node.
+// Remote: the arrays are allocated with HSTR_BUF_PROP_HOST_ALIASED, so the
+//         streams work on the application's memory, which the benchmark
+//         first touches from the CPUs of another NUMA node.
+//
+// The node of the instances is queried with hStreams_GetBufferNumaNode. The
+// CPUs of each node are found the same way: a small buffer is instantiated
+// for a single-CPU logical domain on each of the host's CPUs, and the CPUs
+// are grouped by the node of their instance. On a machine with a single NUMA
+// node, both cases use local memory.
+//
+// The tasks run numa_placement_triad, a function defined in this file. The
+// executable is linked with -rdynamic so that the host-side streams can find it.
+//
+// API level:
+//  core APIs in hStreams_source.h
+// Functionality exercised
+//     init
+//     get physical domain details
+//     add log domain, remove log domains
+//     stream create
+//     alloc1D, alloc1DEx with HSTR_BUF_PROP_HOST_ALIASED
+//     get buffer NUMA node
+//     enqueue data transfer
+//     enqueue compute
+//     thread synchronize
+//     fini
+//
+//      USAGE: numa_placement [-m MiB-per-array] [-i iterations] [-t streams]
+//
+//********************************************************************************
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <hStreams_source.h>
+#include "dtime.h"  // elapsed time measurement.
+
+#define ARRAY_MB 64                             // Size of each of the arrays
+#define ITERATIONS 10                           // Triads timed in each case
+#define PROBE_BYTES (64 * 1024)                 // Smallest buffer placed by hStreams
+
+// a[i] = b[i] + 3 * c[i] for count elements, the arguments point to a slice
+extern "C" void numa_placement_triad(uint64_t count, uint64_t a, uint64_t b, uint64_t c)
+{
+    double *pa = (double *) a;
+    const double *pb = (const double *) b;
+    const double *pc = (const double *) c;
+    for (uint64_t i = 0; i < count; ++i) {
+        pa[i] = pb[i] + 3.0 * pc[i];
+    }
+}
+
+static void usage(const char *myname)
+{
+    fprintf(stderr, "USAGE: %s [-m MiB-per-array] [-i iterations] [-t streams]\n", myname);
+    exit(1);
+}
+
+// The CPUs of each NUMA node, as placed by hStreams; empty for the nodes
+// without CPUs. The CPUs whose node hStreams doesn't know are left out.
+static HSTR_RESULT probeNodes(std::vector<std::vector<int> > &nodes)
+{
+    uint32_t num_threads, max_freq;
+    uint64_t mem_types, mem_avail[HSTR_MEM_TYPE_SIZE];
+    HSTR_CPU_MASK max_mask, avoid_mask;
+    HSTR_ISA_TYPE isa;
+    CHECK_HSTR_RESULT(hStreams_GetPhysDomainDetails(HSTR_SRC_PHYS_DOMAIN, &num_threads, &isa,
+                      &max_freq, max_mask, avoid_mask, &mem_types, mem_avail));
+
+    std::vector<int> cpus;
+    std::vector<HSTR_LOG_DOM> doms;
+    for (int cpu = 0; cpu < (int)(sizeof(HSTR_CPU_MASK) * 8); ++cpu) {
+        if (!HSTR_CPU_MASK_ISSET(cpu, max_mask)) {
+            continue;
+        }
+        HSTR_CPU_MASK cpu_mask;
+        HSTR_CPU_MASK_ZERO(cpu_mask);
+        HSTR_CPU_MASK_SET(cpu, cpu_mask);
+        HSTR_LOG_DOM log_dom;
+        HSTR_OVERLAP_TYPE overlap;
+        CHECK_HSTR_RESULT(hStreams_AddLogDomain(HSTR_SRC_PHYS_DOMAIN, cpu_mask, &log_dom, &overlap));
+        cpus.push_back(cpu);
+        doms.push_back(log_dom);
+    }
+
+    // Instantiated for all the logical domains, each on its CPU's node
+    std::vector<char> probe(PROBE_BYTES);
+    CHECK_HSTR_RESULT(hStreams_Alloc1D(&probe[0], PROBE_BYTES));
+    nodes.clear();
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        int32_t node;
+        CHECK_HSTR_RESULT(hStreams_GetBufferNumaNode(&probe[0], doms[i], &node));
+        if (node < 0) {
+            continue;
+        }
+        if ((size_t) node >= nodes.size()) {
+            nodes.resize(node + 1);
+        }
+        nodes[node].push_back(cpus[i]);
+    }
+    CHECK_HSTR_RESULT(hStreams_DeAlloc(&probe[0]));
+    if (!doms.empty()) {
+        CHECK_HSTR_RESULT(hStreams_RmLogDomains((uint32_t) doms.size(), &doms[0]));
+    }
+    return HSTR_RESULT_SUCCESS;
+}
+
+// Allocates untouched memory and touches it from the CPUs given
+static double *allocTouchedOn(uint64_t bytes, std::vector<int> const &cpus)
+{
+    cpu_set_t old_set, new_set;
+    sched_getaffinity(0, sizeof(old_set), &old_set);
+    CPU_ZERO(&new_set);
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        CPU_SET(cpus[i], &new_set);
+    }
+    sched_setaffinity(0, sizeof(new_set), &new_set);
+
+    void *mem = NULL;
+    if (posix_memalign(&mem, 4096, bytes) != 0) {
+        fprintf(stderr, "Could not allocate %lu bytes\n", (unsigned long) bytes);
+        exit(1);
+    }
+    memset(mem, 0, bytes);
+
+    sched_setaffinity(0, sizeof(old_set), &old_set);
+    return (double *) mem;
+}
+
+// Runs the triads, best is the highest bandwidth in GB/s
+static HSTR_RESULT runTriads(std::vector<HSTR_LOG_STR> const &streams, double *a, double *b,
+                             double *c, uint64_t count, int iterations, double &best)
+{
+    uint64_t slice = count / streams.size();
+    best = 0;
+    for (int iter = 0; iter < iterations; ++iter) {
+        double timeBegin = dtimeGet();
+        for (size_t s = 0; s < streams.size(); ++s) {
+            uint64_t first = s * slice;
+            uint64_t len = (s + 1 == streams.size()) ? count - first : slice;
+            uint64_t args[4] = { len, (uint64_t)(a + first), (uint64_t)(b + first),
+                                 (uint64_t)(c + first)
+                               };
+            CHECK_HSTR_RESULT(hStreams_EnqueueCompute(streams[s], "numa_placement_triad",
+                              1, 3, args, NULL, NULL, 0));
+        }
+        CHECK_HSTR_RESULT(hStreams_ThreadSynchronize());
+        double seconds = dtimeGet() - timeBegin;
+        // Two arrays read, one written
+        double gbps = 3.0 * sizeof(double) * count / seconds * 1.0e-9;
+        if (gbps > best) {
+            best = gbps;
+        }
+    }
+    return HSTR_RESULT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    int array_mb = ARRAY_MB;
+    int iterations = ITERATIONS;
+    int max_streams = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-m") == 0) {
+            array_mb = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+            iterations = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            max_streams = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (array_mb <= 0 || iterations <= 0 || max_streams < 0) {
+        usage(argv[0]);
+    }
+
+    dtimeInit();
+    CHECK_HSTR_RESULT(hStreams_Init());
+
+    std::vector<std::vector<int> > nodes;
+    CHECK_HSTR_RESULT(probeNodes(nodes));
+    int local_node = -1, remote_node = -1;
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        if (nodes[node].empty()) {
+            continue;
+        }
+        if (local_node == -1) {
+            local_node = (int) node;
+        } else if (remote_node == -1) {
+            remote_node = (int) node;
+        }
+    }
+    if (local_node == -1) {
+        fprintf(stderr, "hStreams doesn't know the NUMA node of any of the host's CPUs\n");
+        CHECK_HSTR_RESULT(hStreams_Fini());
+        return 1;
+    }
+    if (remote_node == -1) {
+        printf("Only one NUMA node with CPUs, the remote case uses local memory too\n");
+        remote_node = local_node;
+    }
+    std::vector<int> const &local_cpus = nodes[local_node];
+
+    HSTR_CPU_MASK dom_mask;
+    HSTR_CPU_MASK_ZERO(dom_mask);
+    for (size_t i = 0; i < local_cpus.size(); ++i) {
+        HSTR_CPU_MASK_SET(local_cpus[i], dom_mask);
+    }
+    HSTR_LOG_DOM log_dom;
+    HSTR_OVERLAP_TYPE overlap;
+    CHECK_HSTR_RESULT(hStreams_AddLogDomain(HSTR_SRC_PHYS_DOMAIN, dom_mask, &log_dom, &overlap));
+
+    size_t num_streams = local_cpus.size();
+    if (max_streams > 0 && (size_t) max_streams < num_streams) {
+        num_streams = max_streams;
+    }
+    std::vector<HSTR_LOG_STR> streams;
+    for (size_t s = 0; s < num_streams; ++s) {
+        HSTR_CPU_MASK stream_mask;
+        HSTR_CPU_MASK_ZERO(stream_mask);
+        HSTR_CPU_MASK_SET(local_cpus[s], stream_mask);
+        CHECK_HSTR_RESULT(hStreams_StreamCreate((HSTR_LOG_STR) s, log_dom, stream_mask));
+        streams.push_back((HSTR_LOG_STR) s);
+    }
+
+    uint64_t bytes = (uint64_t) array_mb * 1024 * 1024;
+    uint64_t count = bytes / sizeof(double);
+    printf("%d MiB arrays, %d iterations, %lu streams on the CPUs of node %d\n",
+           array_mb, iterations, (unsigned long) num_streams, local_node);
+
+    // Local: instances allocated by hStreams for the logical domain
+    {
+        double *arrays[3];
+        for (int i = 0; i < 3; ++i) {
+            arrays[i] = allocTouchedOn(bytes, nodes[remote_node]);
+            CHECK_HSTR_RESULT(hStreams_Alloc1D(arrays[i], bytes));
+            CHECK_HSTR_RESULT(hStreams_EnqueueData1D(streams[0], arrays[i], arrays[i], bytes,
+                              HSTR_SRC_TO_SINK, NULL));
+        }
+        CHECK_HSTR_RESULT(hStreams_ThreadSynchronize());
+        int32_t numa_node;
+        CHECK_HSTR_RESULT(hStreams_GetBufferNumaNode(arrays[0], log_dom, &numa_node));
+        double gbps;
+        CHECK_HSTR_RESULT(runTriads(streams, arrays[0], arrays[1], arrays[2], count, iterations, gbps));
+        printf("local : instances placed by hStreams, node %2d: %8.2f GB/s\n", numa_node, gbps);
+        for (int i = 0; i < 3; ++i) {
+            CHECK_HSTR_RESULT(hStreams_DeAlloc(arrays[i]));
+            free(arrays[i]);
+        }
+    }
+
+    // Remote: the streams work on the application's memory, touched on the other node
+    {
+        double *arrays[3];
+        HSTR_BUFFER_PROPS props = { HSTR_MEM_TYPE_NORMAL, HSTR_MEM_ALLOC_PREFERRED,
+                                    HSTR_BUF_PROP_HOST_ALIASED
+                                  };
+        for (int i = 0; i < 3; ++i) {
+            arrays[i] = allocTouchedOn(bytes, nodes[remote_node]);
+            CHECK_HSTR_RESULT(hStreams_Alloc1DEx(arrays[i], bytes, &props, -1, NULL));
+        }
+        double gbps;
+        CHECK_HSTR_RESULT(runTriads(streams, arrays[0], arrays[1], arrays[2], count, iterations, gbps));
+        printf("remote: application memory touched on node %2d: %8.2f GB/s\n", remote_node, gbps);
+        for (int i = 0; i < 3; ++i) {
+            CHECK_HSTR_RESULT(hStreams_DeAlloc(arrays[i]));
+            free(arrays[i]);
+        }
+    }
+
+    CHECK_HSTR_RESULT(hStreams_Fini());
+    return 0;
+}
@@ -0,0 +1,10 @@
+#                                                                      #
+# Copyright 2014-2016 Intel Corporation.                               #
+#                                                                      #
+# This file is subject to the Intel Sample Source Code License. A copy #
+# of the Intel Sample Source Code License is included.                 #
+#                                                                      #
+
+source ../common/setEnv.sh
+cd ../../bin/host
+./numa_placement $*
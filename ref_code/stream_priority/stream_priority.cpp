@@ -0,0 +1,201 @@
+/*
+ * Copyright 2014-2016 Intel Corporation.
+ *
+ * This file is subject to the Intel Sample Source Code License. A copy
+ * of the Intel Sample Source Code License is included.
+ */
+
+//********************************************************************************
+// Measures the latency of short, latency-sensitive requests sharing a host
+// CPU with a background stream that is kept busy with long-running tasks.
+//
+// Two logical streams are created with the same CPU mask, so they map onto
+// the same physical stream and the same host worker thread. The background
+// stream is kept topped up with a queue of depth spin tasks; the request stream
+// submits a short task at a time, on a buffer of its own, and waits for it.
+// The request latency is measured first with both streams at the default
+// priority, then with the background stream at HSTR_STREAM_PRIORITY_LOW and
+// the request stream at HSTR_STREAM_PRIORITY_HIGH.
+//
+// The tasks run stream_priority_spin, a function defined in this file which
+// busy-waits for the number of microseconds given as its argument and then
+// bumps a completion counter, which is how the background queue is kept full. The
+// executable is linked with -rdynamic so that the host-side streams can find it.
+//
+// API level:
+//  core APIs in hStreams_source.h
+// Functionality exercised
+//     init
+//     add log domain
+//     stream create
+//     stream set priority
+//     alloc1D
+//     enqueue compute
+//     event wait
+//     stream synchronize
+//     fini
+//
+//      USAGE: stream_priority [-n requests] [-b background-task-us]
+//                             [-r request-task-us] [-q background-queue-depth]
+//
+//********************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <hStreams_source.h>
+#include "dtime.h"  // elapsed time measurement.
+
+#define NREQUESTS 200                           // Requests timed per setting
+#define BACKGROUND_US 2000                      // Duration of a background task
+#define REQUEST_US 50                           // Duration of a request task
+#define QUEUE_DEPTH 16                          // Background tasks kept in flight
+
+// Busy-waits for usecs microseconds, then counts itself done in *done. The
+// host-side streams run in this process, so the counter can be shared.
+extern "C" void stream_priority_spin(uint64_t usecs, uint64_t done, uint64_t buf)
+{
+    double end = dtimeGet() + usecs * 1.0e-6;
+    while (dtimeGet() < end) {
+        ++*(volatile uint64_t *) buf;
+    }
+    ++*(std::atomic<uint64_t> *) done;
+}
+
+static void usage(const char *myname)
+{
+    fprintf(stderr, "USAGE: %s [-n requests] [-b background-task-us] "
+            "[-r request-task-us] [-q background-queue-depth]\n", myname);
+    exit(1);
+}
+
+// Tops up the background stream to depth tasks which haven't completed yet
+static HSTR_RESULT feedBackground(HSTR_LOG_STR stream, uint64_t *args,
+                                  std::atomic<uint64_t> &done, uint64_t &enqueued, int depth)
+{
+    while (enqueued - done < (uint64_t) depth) {
+        CHECK_HSTR_RESULT(hStreams_EnqueueCompute(stream, "stream_priority_spin",
+                          2, 1, args, NULL, NULL, 0));
+        ++enqueued;
+    }
+    return HSTR_RESULT_SUCCESS;
+}
+
+static double percentile(std::vector<double> const &sorted, double pct)
+{
+    size_t idx = (size_t)(pct / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+int main(int argc, char **argv)
+{
+    int nrequests = NREQUESTS;
+    int background_us = BACKGROUND_US;
+    int request_us = REQUEST_US;
+    int depth = QUEUE_DEPTH;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            nrequests = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-b") == 0) {
+            background_us = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            request_us = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-q") == 0) {
+            depth = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (nrequests <= 0 || background_us < 0 || request_us < 0 || depth <= 0) {
+        usage(argv[0]);
+    }
+
+    dtimeInit();
+    CHECK_HSTR_RESULT(hStreams_Init());
+
+    // A single host CPU shared by both streams, so that the requests compete
+    // with the background work for the same worker thread
+    uint32_t num_threads, max_freq;
+    uint64_t mem_types, mem_avail[HSTR_MEM_TYPE_SIZE];
+    HSTR_CPU_MASK max_mask, avoid_mask, use_mask;
+    HSTR_ISA_TYPE isa;
+    CHECK_HSTR_RESULT(hStreams_GetPhysDomainDetails(HSTR_SRC_PHYS_DOMAIN, &num_threads, &isa,
+                      &max_freq, max_mask, avoid_mask, &mem_types, mem_avail));
+    HSTR_CPU_MASK_ZERO(use_mask);
+    int cpu = 0;
+    while (!HSTR_CPU_MASK_ISSET(cpu, max_mask)) {
+        ++cpu;
+    }
+    // Leave the first CPU to the enqueueing thread, if there's more than one
+    if (HSTR_CPU_MASK_COUNT(max_mask) > 1) {
+        ++cpu;
+        while (!HSTR_CPU_MASK_ISSET(cpu, max_mask)) {
+            ++cpu;
+        }
+    }
+    HSTR_CPU_MASK_SET(cpu, use_mask);
+
+    HSTR_LOG_DOM log_dom;
+    HSTR_OVERLAP_TYPE overlap;
+    CHECK_HSTR_RESULT(hStreams_AddLogDomain(HSTR_SRC_PHYS_DOMAIN, use_mask, &log_dom, &overlap));
+    HSTR_LOG_STR background = 0, requests = 1;
+    CHECK_HSTR_RESULT(hStreams_StreamCreate(background, log_dom, use_mask));
+    CHECK_HSTR_RESULT(hStreams_StreamCreate(requests, log_dom, use_mask));
+
+    // Separate buffers, so that the requests don't depend on the background tasks
+    uint64_t background_buf[8], request_buf[8];
+    CHECK_HSTR_RESULT(hStreams_Alloc1D(background_buf, sizeof(background_buf)));
+    CHECK_HSTR_RESULT(hStreams_Alloc1D(request_buf, sizeof(request_buf)));
+    std::atomic<uint64_t> done(0), requests_done(0);
+    uint64_t enqueued = 0;
+    uint64_t background_args[3] = { (uint64_t) background_us, (uint64_t) &done,
+                                    (uint64_t) background_buf
+                                  };
+    uint64_t request_args[3] = { (uint64_t) request_us, (uint64_t) &requests_done,
+                                 (uint64_t) request_buf
+                               };
+
+    printf("%d requests of %d us against background tasks of %d us, %d in flight\n",
+           nrequests, request_us, background_us, depth);
+
+    for (int prioritized = 0; prioritized < 2; ++prioritized) {
+        CHECK_HSTR_RESULT(hStreams_StreamSetPriority(background,
+                          prioritized ? HSTR_STREAM_PRIORITY_LOW : HSTR_STREAM_PRIORITY_NORMAL));
+        CHECK_HSTR_RESULT(hStreams_StreamSetPriority(requests,
+                          prioritized ? HSTR_STREAM_PRIORITY_HIGH : HSTR_STREAM_PRIORITY_NORMAL));
+
+        std::vector<double> latencies;
+        latencies.reserve(nrequests);
+        double timeBegin = dtimeGet();
+        for (int req = 0; req < nrequests; ++req) {
+            CHECK_HSTR_RESULT(feedBackground(background, background_args, done, enqueued, depth));
+
+            HSTR_EVENT request_done;
+            double sent = dtimeGet();
+            CHECK_HSTR_RESULT(hStreams_EnqueueCompute(requests, "stream_priority_spin",
+                              2, 1, request_args, &request_done, NULL, 0));
+            CHECK_HSTR_RESULT(hStreams_EventWait(1, &request_done, true, HSTR_TIME_INFINITE,
+                                                 NULL, NULL));
+            latencies.push_back(1.0e3 * (dtimeGet() - sent));
+        }
+        double timeEnd = dtimeGet();
+        CHECK_HSTR_RESULT(hStreams_StreamSynchronize(background));
+
+        std::sort(latencies.begin(), latencies.end());
+        printf("priorities %-3s: request latency p50 %8.3f ms, p90 %8.3f ms, "
+               "p99 %8.3f ms, max %8.3f ms; %.1f s total\n",
+               prioritized ? "on" : "off",
+               percentile(latencies, 50), percentile(latencies, 90),
+               percentile(latencies, 99), latencies.back(), timeEnd - timeBegin);
+    }
+
+    CHECK_HSTR_RESULT(hStreams_DeAlloc(background_buf));
+    CHECK_HSTR_RESULT(hStreams_DeAlloc(request_buf));
+    CHECK_HSTR_RESULT(hStreams_Fini());
+    return 0;
+}
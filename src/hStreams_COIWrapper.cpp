@@ -14,6 +14,7 @@
 
 #include "hStreams_COIWrapper.h"
 #include "hStreams_helpers_common.h"
+#include "hStreams_Logger.h"
 
 #include <iostream>
 #include <cstdlib>
@@ -64,6 +65,33 @@ DEFINE_STATIC_HANDLE(COIPipelineDestroy);
 DEFINE_STATIC_HANDLE(COIPipelineRunFunction);
 DEFINE_STATIC_HANDLE(COIResultGetName);
 
+bool hStreams_COIWrapper::available_ = false;
+
+namespace
+{
+// Used in place of COIResultGetName when the COI library is not present, as
+// the in-library host events report their status with HSTR_COIRESULT values
+const char *COIResultGetName_fallback(HSTR_COIRESULT result)
+{
+    switch (result) {
+    case HSTR_COI_SUCCESS:
+        return "COI_SUCCESS";
+    case HSTR_COI_OUT_OF_RANGE:
+        return "COI_OUT_OF_RANGE";
+    case HSTR_COI_INVALID_POINTER:
+        return "COI_INVALID_POINTER";
+    case HSTR_COI_INVALID_HANDLE:
+        return "COI_INVALID_HANDLE";
+    case HSTR_COI_ARGUMENT_MISMATCH:
+        return "COI_ARGUMENT_MISMATCH";
+    case HSTR_COI_TIME_OUT_REACHED:
+        return "COI_TIME_OUT_REACHED";
+    default:
+        return "COI_ERROR";
+    }
+}
+} // anonymous namespace
+
 
 hStreams_COIWrapper::hStreams_COIWrapper()
 {
@@ -76,9 +104,11 @@ hStreams_COIWrapper::hStreams_COIWrapper()
     }
     initialized = true;
 
+    hStreams_COIWrapper::COIResultGetName = COIResultGetName_fallback;
+
+    //Open COI library
+    LIB_HANDLER::handle_t COI_handler;
     try {
-        //Open COI library
-        LIB_HANDLER::handle_t COI_handler;
         hStreams_LibLoader::load(
 #ifdef _WIN32
             "coi_host.dll",
@@ -86,6 +116,14 @@ hStreams_COIWrapper::hStreams_COIWrapper()
             "libcoi_host.so.0",
 #endif
             COI_handler);
+    } catch (hStreams_exception const &e) {
+        // Not an error, hStreams can still use the host
+        HSTR_LOG(HSTR_INFO_TYPE_MISC)
+                << "COI library is not available, only the host will be used: " << e.what();
+        return;
+    }
+
+    try {
 
         //Fetch COI functions' symbols
         FETCH_COI_FUNCTION_ADDRESS(COIEngineGetInfo);
@@ -124,9 +162,14 @@ hStreams_COIWrapper::hStreams_COIWrapper()
             (hStreams_COIWrapper::COIProcessLoadLibraryFromFile_handler_t)
             hStreams_LibLoader::fetchVersionedFunctionAddress(COI_handler, "COIProcessLoadLibraryFromFile", "COI_2.0");
 #endif
+        available_ = true;
     } catch (hStreams_exception const &e) {
         std::cerr << "Error while loading shared libraries: " << e.what() << std::endl;
         exit(e.error_code());
     }
 }
 
+bool hStreams_COIWrapper::isAvailable()
+{
+    return available_;
+}
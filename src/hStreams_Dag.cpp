@@ -0,0 +1,507 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+
+#include "hStreams_Dag.h"
+#include "hStreams_core_api_workers_source.h"
+#include "hStreams_internal_vars_source.h"
+#include "hStreams_LogBuffer.h"
+#include "hStreams_RCU.h"
+#include "hStreams_exceptions.h"
+#include "hStreams_helpers_source.h"
+#include "hStreams_Logger.h"
+
+#include <algorithm>
+#include <queue>
+#include <set>
+
+namespace
+{
+// hStreams_EventWait() takes at most that many events at a time
+const uint32_t max_events_per_wait = 0xFFFF;
+
+// The order of the tasks in the ready queue: whether a should go after b
+class ReadyTaskOrder
+{
+public:
+    ReadyTaskOrder(HSTR_DAG_POLICY policy, std::vector<uint64_t> const &bottom_levels)
+        : policy_(policy), bottom_levels_(&bottom_levels) {}
+
+    bool operator()(uint32_t a, uint32_t b) const
+    {
+        if (policy_ == HSTR_DAG_POLICY_CRITICAL_PATH &&
+                (*bottom_levels_)[a] != (*bottom_levels_)[b]) {
+            return (*bottom_levels_)[a] < (*bottom_levels_)[b];
+        }
+        // Otherwise the ones added first go first
+        return a > b;
+    }
+private:
+    HSTR_DAG_POLICY policy_;
+    std::vector<uint64_t> const *bottom_levels_;
+};
+} // anonymous namespace
+
+/// @brief The bookkeeping of a single \c hStreams_Dag::execute()
+class hStreams_Dag::ExecState
+{
+public:
+    ExecState(uint32_t num_buffers, uint32_t num_domains, uint32_t num_streams, uint32_t num_tasks)
+        : instances(num_buffers), instantiated(num_buffers, std::vector<bool>(num_domains, false)),
+          written(num_buffers, false), stream_avail(num_streams, 0), waited(num_streams),
+          task_finish(num_tasks, 0), num_waits(0), num_waited_events(0), num_transfers(0)
+    {
+        Instance stale = {false, -1, std::vector<uint64_t>()};
+        for (uint32_t buf = 0; buf < num_buffers; ++buf) {
+            instances[buf].assign(num_domains, stale);
+            // The source domain's instantiations are taken to be up to date
+            instances[buf][0].valid = true;
+            instantiated[buf][0] = true;
+        }
+    }
+
+    std::vector<Action> actions;
+    /// @brief Per buffer, per logical domain
+    std::vector<std::vector<Instance> > instances;
+    std::vector<std::vector<bool> > instantiated;
+    /// @brief Whether a task has written the buffer
+    std::vector<bool> written;
+    /// @brief The estimated time each stream is done with its tasks at
+    std::vector<uint64_t> stream_avail;
+    /// @brief The actions of the other streams each stream has waited for
+    std::vector<std::set<uint64_t> > waited;
+    std::vector<uint64_t> task_finish;
+
+    uint64_t num_waits;
+    uint64_t num_waited_events;
+    uint64_t num_transfers;
+
+    uint64_t addAction(HSTR_EVENT event, uint32_t stream)
+    {
+        Action action = {event, stream};
+        actions.push_back(action);
+        return actions.size() - 1;
+    }
+
+    /// @brief Add the event of an action to the ones \c stream is to wait
+    ///     for, unless it's the stream's own or has already been waited for
+    void addWait(uint32_t stream, int64_t action, std::vector<HSTR_EVENT> &events)
+    {
+        if (action < 0 || actions[action].stream == stream) {
+            return;
+        }
+        if (waited[stream].insert(action).second) {
+            events.push_back(actions[action].event);
+        }
+    }
+};
+
+hStreams_Dag::hStreams_Dag(std::vector<HSTR_LOG_STR> const &streams,
+                           std::vector<HSTR_LOG_DOM> const &stream_domains,
+                           uint64_t bytes_per_cost_unit)
+    : streams_(streams), bytes_per_cost_unit_(bytes_per_cost_unit)
+{
+    domains_.push_back(HSTR_SRC_LOG_DOMAIN);
+    for (uint32_t idx = 0; idx < stream_domains.size(); ++idx) {
+        std::vector<HSTR_LOG_DOM>::iterator it = std::find(domains_.begin(), domains_.end(),
+                stream_domains[idx]);
+        stream_domains_.push_back((uint32_t)(it - domains_.begin()));
+        if (it == domains_.end()) {
+            domains_.push_back(stream_domains[idx]);
+        }
+    }
+}
+
+uint32_t hStreams_Dag::numTasks() const
+{
+    return (uint32_t) tasks_.size();
+}
+
+uint32_t hStreams_Dag::addTask(const char *func_name,
+                               uint32_t num_scalar_args, uint32_t num_heap_args,
+                               uint64_t const *args, HSTR_ACCESS_MODE const *heap_arg_access,
+                               uint64_t cost)
+{
+    uint32_t task_idx = (uint32_t) tasks_.size();
+    Task task;
+    task.func_name = func_name;
+    task.num_scalar_args = num_scalar_args;
+    task.args.assign(args, args + num_scalar_args + num_heap_args);
+    task.cost = cost == 0 ? 1 : cost;
+    task.bottom_level = 0;
+
+    {
+        // See EnqueueCompute_worker_throw
+        hStreams_RCU_Read_Scope tables_read_scope;
+
+        for (uint32_t idx = 0; idx < num_heap_args; ++idx) {
+            HSTR_ACCESS_MODE access = heap_arg_access ? heap_arg_access[idx] : HSTR_ACCESS_READ_WRITE;
+            if (access != HSTR_ACCESS_READ && access != HSTR_ACCESS_WRITE &&
+                    access != HSTR_ACCESS_READ_WRITE) {
+                throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                           << "Invalid access mode of heap argument "
+                                           << idx
+                                           << ": "
+                                           << access
+                                          );
+            }
+            task.heap_arg_access.push_back(access);
+
+            hStreams_LogBuffer *log_buf = log_buffers.lookupLogBuffer(args[num_scalar_args + idx]);
+            if (NULL == log_buf) {
+                throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                           << "Did not find a corresponding buffer for heap argument "
+                                           << idx
+                                           << " == "
+                                           << (void *) args[num_scalar_args + idx]
+                                          );
+            }
+
+            std::map<void *, uint32_t>::iterator it = buffer_indices_.find(log_buf->getStart());
+            uint32_t buf_idx;
+            if (it != buffer_indices_.end()) {
+                buf_idx = it->second;
+            } else {
+                Buffer buf;
+                buf.start = log_buf->getStart();
+                buf.len = log_buf->getLen();
+                buf.last_writer = -1;
+                buf_idx = (uint32_t) buffers_.size();
+                buffers_.push_back(buf);
+                buffer_indices_[buf.start] = buf_idx;
+            }
+
+            // The same buffer may be passed more than once
+            std::vector<uint32_t>::iterator pos = std::find(task.buffers.begin(), task.buffers.end(), buf_idx);
+            if (pos == task.buffers.end()) {
+                task.buffers.push_back(buf_idx);
+                task.buffer_access.push_back(access);
+            } else {
+                task.buffer_access[pos - task.buffers.begin()] |= access;
+            }
+        }
+    }
+
+    // Infer the edges. The readers since the last writer all depend on it, so
+    // a writer only needs to depend on them if there are any.
+    for (uint32_t idx = 0; idx < task.buffers.size(); ++idx) {
+        Buffer &buf = buffers_[task.buffers[idx]];
+        if (task.buffer_access[idx] & HSTR_ACCESS_WRITE) {
+            if (!buf.readers.empty()) {
+                task.preds.insert(task.preds.end(), buf.readers.begin(), buf.readers.end());
+            } else if (buf.last_writer >= 0) {
+                task.preds.push_back((uint32_t) buf.last_writer);
+            }
+            buf.last_writer = task_idx;
+            buf.readers.clear();
+        } else {
+            if (buf.last_writer >= 0) {
+                task.preds.push_back((uint32_t) buf.last_writer);
+            }
+            buf.readers.push_back(task_idx);
+        }
+    }
+    std::sort(task.preds.begin(), task.preds.end());
+    task.preds.erase(std::unique(task.preds.begin(), task.preds.end()), task.preds.end());
+    for (uint32_t idx = 0; idx < task.preds.size(); ++idx) {
+        tasks_[task.preds[idx]].succs.push_back(task_idx);
+    }
+
+    tasks_.push_back(task);
+    return task_idx;
+}
+
+void hStreams_Dag::execute(HSTR_DAG_POLICY policy)
+{
+    if (policy < 0 || policy >= HSTR_DAG_POLICY_SIZE) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "Invalid DAG policy: "
+                                   << policy
+                                  );
+    }
+
+    uint32_t num_tasks = (uint32_t) tasks_.size();
+    ExecState state((uint32_t) buffers_.size(), (uint32_t) domains_.size(),
+                    (uint32_t) streams_.size(), num_tasks);
+
+    // The buffers may have been instantiated in more domains since the tasks
+    // have been added
+    std::vector<HSTR_LOG_DOM> buf_domains;
+    for (uint32_t buf_idx = 0; buf_idx < buffers_.size(); ++buf_idx) {
+        uint64_t num_buf_domains;
+        detail::GetBufferNumLogDomains_impl_throw(buffers_[buf_idx].start, &num_buf_domains);
+        if (num_buf_domains == 0) {
+            continue;
+        }
+        buf_domains.resize(num_buf_domains);
+        detail::GetBufferLogDomains_impl_throw(buffers_[buf_idx].start, num_buf_domains,
+                                               &buf_domains[0], &num_buf_domains);
+        for (uint32_t dom_idx = 1; dom_idx < domains_.size(); ++dom_idx) {
+            state.instantiated[buf_idx][dom_idx] = std::find(buf_domains.begin(), buf_domains.end(),
+                                                   domains_[dom_idx]) != buf_domains.end();
+        }
+    }
+
+    // The tasks are added in a topological order, so the successors of a task
+    // come after it
+    std::vector<uint64_t> bottom_levels(num_tasks);
+    for (uint32_t idx = num_tasks; idx-- > 0;) {
+        uint64_t longest_succ = 0;
+        for (uint32_t succ = 0; succ < tasks_[idx].succs.size(); ++succ) {
+            longest_succ = std::max(longest_succ, bottom_levels[tasks_[idx].succs[succ]]);
+        }
+        bottom_levels[idx] = tasks_[idx].cost + longest_succ;
+    }
+
+    std::priority_queue<uint32_t, std::vector<uint32_t>, ReadyTaskOrder> ready(
+        ReadyTaskOrder(policy, bottom_levels));
+    std::vector<uint32_t> num_preds_left(num_tasks);
+    for (uint32_t idx = 0; idx < num_tasks; ++idx) {
+        num_preds_left[idx] = (uint32_t) tasks_[idx].preds.size();
+        if (num_preds_left[idx] == 0) {
+            ready.push(idx);
+        }
+    }
+
+    try {
+        while (!ready.empty()) {
+            uint32_t task_idx = ready.top();
+            ready.pop();
+            submitTask(state, task_idx, pickStream(state, task_idx));
+            for (uint32_t succ = 0; succ < tasks_[task_idx].succs.size(); ++succ) {
+                if (--num_preds_left[tasks_[task_idx].succs[succ]] == 0) {
+                    ready.push(tasks_[task_idx].succs[succ]);
+                }
+            }
+        }
+        for (uint32_t buf_idx = 0; buf_idx < buffers_.size(); ++buf_idx) {
+            writeBack(state, buf_idx);
+        }
+    } catch (...) {
+        // Don't leave the actions running behind the caller's back
+        try {
+            waitForAll(state);
+        } catch (...) {
+            HSTR_ERROR(HSTR_INFO_TYPE_SYNC) << "Couldn't wait for the tasks already submitted";
+        }
+        throw;
+    }
+    waitForAll(state);
+
+    HSTR_DEBUG1(HSTR_INFO_TYPE_SYNC)
+            << "DAG of " << num_tasks << " tasks executed with "
+            << state.num_transfers << " transfers and "
+            << state.num_waits << " cross-stream waits for "
+            << state.num_waited_events << " events";
+}
+
+uint32_t hStreams_Dag::pickStream(ExecState &state, uint32_t task_idx)
+{
+    Task const &task = tasks_[task_idx];
+    uint64_t preds_finish = 0;
+    for (uint32_t idx = 0; idx < task.preds.size(); ++idx) {
+        preds_finish = std::max(preds_finish, state.task_finish[task.preds[idx]]);
+    }
+
+    int64_t best = -1;
+    uint64_t best_finish = 0, best_stale_bytes = 0;
+    for (uint32_t stream_idx = 0; stream_idx < streams_.size(); ++stream_idx) {
+        uint32_t dom_idx = stream_domains_[stream_idx];
+        bool instantiated = true;
+        uint64_t stale_bytes = 0;
+        for (uint32_t idx = 0; idx < task.buffers.size() && instantiated; ++idx) {
+            uint32_t buf_idx = task.buffers[idx];
+            instantiated = state.instantiated[buf_idx][dom_idx];
+            if (!state.instances[buf_idx][dom_idx].valid) {
+                stale_bytes += buffers_[buf_idx].len;
+            }
+        }
+        if (!instantiated) {
+            continue;
+        }
+        uint64_t finish = std::max(state.stream_avail[stream_idx], preds_finish) + task.cost;
+        if (bytes_per_cost_unit_ != 0) {
+            finish += stale_bytes / bytes_per_cost_unit_ + (stale_bytes % bytes_per_cost_unit_ != 0);
+        }
+        if (best < 0 || finish < best_finish ||
+                (finish == best_finish && stale_bytes < best_stale_bytes)) {
+            best = stream_idx;
+            best_finish = finish;
+            best_stale_bytes = stale_bytes;
+        }
+    }
+    if (best < 0) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "The buffers of task "
+                                   << task_idx
+                                   << " (\""
+                                   << task.func_name
+                                   << "\") are not all instantiated in the logical domain of any of the streams"
+                                  );
+    }
+    state.stream_avail[best] = best_finish;
+    state.task_finish[task_idx] = best_finish;
+    return (uint32_t) best;
+}
+
+void hStreams_Dag::submitTask(ExecState &state, uint32_t task_idx, uint32_t stream_idx)
+{
+    Task &task = tasks_[task_idx];
+    HSTR_LOG_STR stream = streams_[stream_idx];
+    uint32_t dom_idx = stream_domains_[stream_idx];
+
+    // Gather the actions of the other streams the transfers and the task
+    // have to wait for, and where the stale data are to be copied from
+    std::vector<HSTR_EVENT> events;
+    std::vector<void *> addresses;
+    std::vector<uint32_t> xfer_sources(task.buffers.size(), 0);
+    for (uint32_t idx = 0; idx < task.buffers.size(); ++idx) {
+        uint32_t buf_idx = task.buffers[idx];
+        std::vector<Instance> &instances = state.instances[buf_idx];
+        Instance &inst = instances[dom_idx];
+        addresses.push_back(buffers_[buf_idx].start);
+        if (!inst.valid) {
+            // Prefer the source domain, as the transfers from it don't
+            // occupy any of the sink domains' DMA engines
+            uint32_t src_idx = 0;
+            while (!instances[src_idx].valid) {
+                ++src_idx;
+            }
+            xfer_sources[idx] = src_idx;
+            // The transfer reads the up to date data, and overwrites the ones
+            // possibly still being read
+            state.addWait(stream_idx, instances[src_idx].ready, events);
+            for (uint32_t user = 0; user < inst.users.size(); ++user) {
+                state.addWait(stream_idx, inst.users[user], events);
+            }
+        } else {
+            state.addWait(stream_idx, inst.ready, events);
+            if (task.buffer_access[idx] & HSTR_ACCESS_WRITE) {
+                for (uint32_t user = 0; user < inst.users.size(); ++user) {
+                    state.addWait(stream_idx, inst.users[user], events);
+                }
+            }
+        }
+    }
+
+    // The marker is ordered before the transfers and the task by the stream
+    // itself, as it counts as writing the buffers
+    if (!events.empty()) {
+        detail::EventStreamWait_impl_throw(stream, (uint32_t) events.size(), &events[0],
+                                           (int32_t) addresses.size(), &addresses[0], NULL);
+        ++state.num_waits;
+        state.num_waited_events += events.size();
+    }
+
+    for (uint32_t idx = 0; idx < task.buffers.size(); ++idx) {
+        uint32_t buf_idx = task.buffers[idx];
+        Buffer &buf = buffers_[buf_idx];
+        std::vector<Instance> &instances = state.instances[buf_idx];
+        Instance &inst = instances[dom_idx];
+        if (inst.valid) {
+            continue;
+        }
+        uint32_t src_idx = xfer_sources[idx];
+        HSTR_EVENT xfer_event;
+        if (src_idx == 0) {
+            detail::EnqueueData1D_impl_throw(stream, buf.start, buf.start, buf.len,
+                                             HSTR_SRC_TO_SINK, &xfer_event);
+        } else {
+            detail::EnqueueDataXDomain1D_impl_throw(stream, buf.start, buf.start, buf.len,
+                                                    domains_[dom_idx], domains_[src_idx], &xfer_event);
+        }
+        ++state.num_transfers;
+        uint64_t action = state.addAction(xfer_event, stream_idx);
+        instances[src_idx].users.push_back(action);
+        inst.valid = true;
+        inst.ready = action;
+        inst.users.assign(1, action);
+    }
+
+    HSTR_EVENT task_event;
+    detail::EnqueueComputeEx_impl_throw(stream, task.func_name.c_str(),
+                                        task.num_scalar_args, (uint32_t) task.heap_arg_access.size(),
+                                        task.args.empty() ? NULL : &task.args[0],
+                                        task.heap_arg_access.empty() ? NULL : &task.heap_arg_access[0],
+                                        NULL, &task_event, NULL, 0);
+    uint64_t action = state.addAction(task_event, stream_idx);
+
+    for (uint32_t idx = 0; idx < task.buffers.size(); ++idx) {
+        uint32_t buf_idx = task.buffers[idx];
+        std::vector<Instance> &instances = state.instances[buf_idx];
+        if (task.buffer_access[idx] & HSTR_ACCESS_WRITE) {
+            // The other domains' data are stale now, though they may still be
+            // being read
+            for (uint32_t other = 0; other < instances.size(); ++other) {
+                instances[other].valid = false;
+            }
+            instances[dom_idx].valid = true;
+            instances[dom_idx].ready = action;
+            instances[dom_idx].users.assign(1, action);
+            state.written[buf_idx] = true;
+        } else {
+            instances[dom_idx].users.push_back(action);
+        }
+    }
+}
+
+void hStreams_Dag::writeBack(ExecState &state, uint32_t buf_idx)
+{
+    std::vector<Instance> &instances = state.instances[buf_idx];
+    if (!state.written[buf_idx] || instances[0].valid) {
+        return;
+    }
+    uint32_t dom_idx = 1;
+    while (!instances[dom_idx].valid) {
+        ++dom_idx;
+    }
+    // The data have been made up to date by an action of a stream in the
+    // domain, which then needn't wait for it
+    uint32_t stream_idx = state.actions[instances[dom_idx].ready].stream;
+    HSTR_LOG_STR stream = streams_[stream_idx];
+    Buffer &buf = buffers_[buf_idx];
+
+    std::vector<HSTR_EVENT> events;
+    for (uint32_t user = 0; user < instances[0].users.size(); ++user) {
+        state.addWait(stream_idx, instances[0].users[user], events);
+    }
+    if (!events.empty()) {
+        detail::EventStreamWait_impl_throw(stream, (uint32_t) events.size(), &events[0],
+                                           1, &buf.start, NULL);
+        ++state.num_waits;
+        state.num_waited_events += events.size();
+    }
+
+    HSTR_EVENT xfer_event;
+    detail::EnqueueData1D_impl_throw(stream, buf.start, buf.start, buf.len,
+                                     HSTR_SINK_TO_SRC, &xfer_event);
+    ++state.num_transfers;
+    uint64_t action = state.addAction(xfer_event, stream_idx);
+    instances[0].valid = true;
+    instances[0].ready = action;
+    instances[0].users.assign(1, action);
+}
+
+void hStreams_Dag::waitForAll(ExecState &state)
+{
+    std::vector<HSTR_EVENT> events;
+    events.reserve(state.actions.size());
+    for (uint64_t idx = 0; idx < state.actions.size(); ++idx) {
+        events.push_back(state.actions[idx].event);
+    }
+    for (uint64_t done = 0; done < events.size(); done += max_events_per_wait) {
+        uint32_t num_events = (uint32_t) std::min<uint64_t>(max_events_per_wait, events.size() - done);
+        detail::EventWait_impl_throw(num_events, &events[done], true, -1, NULL, NULL);
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+
+#include "hStreams_Graph.h"
+#include "hStreams_PhysStream.h"
+
+hStreams_GraphNode::hStreams_GraphNode(Type node_type)
+    : type(node_type), num_scalar_args(0), ret_val(NULL), ret_val_size(0),
+      input_dep_type(NONE), output_dep_type(NONE)
+{
+}
+
+hStreams_Graph::hStreams_Graph(HSTR_LOG_STR log_stream_id, uint64_t log_stream_serial)
+    : log_stream_id_(log_stream_id), log_stream_serial_(log_stream_serial)
+{
+}
+
+HSTR_LOG_STR hStreams_Graph::getLogStreamID() const
+{
+    return log_stream_id_;
+}
+
+uint64_t hStreams_Graph::getLogStreamSerial() const
+{
+    return log_stream_serial_;
+}
+
+void hStreams_Graph::addCompute(
+    std::vector<uint64_t> const &marshalled_args, uint32_t num_scalar_args,
+    hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+    HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+    uint32_t num_buffer_args,
+    void *ret_val, uint16_t ret_val_size)
+{
+    hStreams_GraphNode node(hStreams_GraphNode::COMPUTE);
+    node.marshalled_args = marshalled_args;
+    node.num_scalar_args = num_scalar_args;
+    node.buffers.assign(buffer_args, buffer_args + num_buffer_args);
+    node.offsets.assign(buffer_offsets, buffer_offsets + num_buffer_args);
+    if (buffer_access != NULL) {
+        node.access.assign(buffer_access, buffer_access + num_buffer_args);
+    }
+    if (buffer_lengths != NULL) {
+        node.lengths.assign(buffer_lengths, buffer_lengths + num_buffer_args);
+    }
+    node.ret_val = ret_val;
+    node.ret_val_size = ret_val_size;
+
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    nodes_.push_back(node);
+}
+
+void hStreams_Graph::addTransfer(std::vector<hStreams_PhysXferRegion> const &regions)
+{
+    hStreams_GraphNode node(hStreams_GraphNode::TRANSFER);
+    node.regions = regions;
+    hStreams_PhysXferRegion::getBuffers(regions, node.buffers);
+
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    nodes_.push_back(node);
+}
+
+void hStreams_Graph::addEventWait(
+    DEP_TYPE input_dep_type,
+    std::vector<hStreams_PhysBuffer *> const &input_bufs,
+    HSTR_EVENT const *events,
+    uint32_t num_events,
+    DEP_TYPE output_dep_type,
+    std::vector<hStreams_PhysBuffer *> const &output_bufs)
+{
+    hStreams_GraphNode node(hStreams_GraphNode::EVENT_WAIT);
+    node.input_dep_type = input_dep_type;
+    node.buffers = input_bufs;
+    node.events.assign(events, events + num_events);
+    node.output_dep_type = output_dep_type;
+    node.output_buffers = output_bufs;
+
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    nodes_.push_back(node);
+}
+
+HSTR_RESULT hStreams_Graph::setScalarArg(uint64_t node_idx, uint32_t arg_idx, uint64_t value)
+{
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    if (node_idx >= nodes_.size()) {
+        return HSTR_RESULT_OUT_OF_RANGE;
+    }
+    hStreams_GraphNode &node = nodes_[node_idx];
+    if (node.type != hStreams_GraphNode::COMPUTE) {
+        return HSTR_RESULT_INCONSISTENT_ARGS;
+    }
+    if (arg_idx >= node.num_scalar_args) {
+        return HSTR_RESULT_OUT_OF_RANGE;
+    }
+    // Past the numbers of scalar and heap arguments
+    node.marshalled_args[2 + arg_idx] = value;
+    return HSTR_RESULT_SUCCESS;
+}
+
+HSTR_RESULT hStreams_Graph::launch(hStreams_PhysStream &phys_stream, HSTR_STREAM_PRIORITY priority,
+                                   HSTR_EVENT *ret_event)
+{
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    return phys_stream.enqueueGraph(nodes_, priority, ret_event);
+}
@@ -0,0 +1,251 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#include "hStreams_HostCallbacks.h"
+#include "hStreams_HostEvent.h"
+#include "hStreams_COIWrapper_types.h"
+#include "hStreams_exceptions.h"
+#include "hStreams_locks.h"
+#include "hStreams_Logger.h"
+#include "hStreams_threading.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+// Either an application's callback, or a notification: a function of the
+// library, called without a completion event to signal
+struct Callback {
+    HSTR_EVENT dep;
+    HSTR_HOST_CALLBACK callback;
+    HSTR_LOG_STR log_stream_id;
+    void *user_data;
+    HSTR_EVENT completion;
+    void (*notify)(void *);
+};
+
+// hStreams_HostEvent::wait() takes at most that many events, one of which
+// is the wake-up event
+const uint32_t max_deps_per_wait = 0xFFFE;
+
+// How long the callbacks submitted while others are pending may wait to be
+// picked up, if none of the pending ones completes meanwhile
+const int32_t max_submission_delay_ms = 1;
+
+// A thread, started with the first callback submitted, running the
+// callbacks once their dependencies have completed
+class CallbackThread
+{
+public:
+    explicit CallbackThread(bool batch_submissions)
+        : batch_submissions_(batch_submissions), wakeup_armed_(false), stopping_(false) {}
+
+    void submit(Callback const &cb)
+    {
+        hStreams_Scope_Locker_Unlocker _autolock(lock_);
+        if (!thread_) {
+            thread_.reset(new hStreams_Thread(&CallbackThread::mainLoop, this));
+        }
+        submitted_.push_back(cb);
+        wakeUpLocked();
+    }
+
+    void shutdown()
+    {
+        {
+            hStreams_Scope_Locker_Unlocker _autolock(lock_);
+            if (!thread_) {
+                return;
+            }
+            stopping_ = true;
+            wakeUpLocked();
+        }
+        thread_->join();
+
+        hStreams_Scope_Locker_Unlocker _autolock(lock_);
+        thread_.reset();
+        stopping_ = false;
+    }
+private:
+    void wakeUpLocked()
+    {
+        if (wakeup_armed_) {
+            wakeup_armed_ = false;
+            hStreams_HostEvent::signal(wakeup_);
+        }
+    }
+
+    static worker_return_type mainLoop(void *self)
+    {
+        ((CallbackThread *) self)->run();
+#ifndef _WIN32
+        pthread_exit(NULL);
+#else
+        return 0;
+#endif // _WIN32
+    }
+
+    void run()
+    {
+        std::vector<Callback> pending;
+        std::vector<HSTR_EVENT> events;
+        std::vector<uint32_t> signaled;
+        std::vector<bool> ready;
+        bool timed_out = false;
+        for (;;) {
+            bool stop;
+            int32_t timeout;
+            {
+                hStreams_Scope_Locker_Unlocker _autolock(lock_);
+                pending.insert(pending.end(), submitted_.begin(), submitted_.end());
+                submitted_.clear();
+                stop = stopping_;
+                // With batching, the submissions made while some callbacks are
+                // pending are rather picked up as those complete, or after a
+                // while if none does. Only then, or if nothing is pending, is
+                // the wake-up armed again.
+                if (!wakeup_armed_ && (!batch_submissions_ || pending.empty() || timed_out)) {
+                    wakeup_ = hStreams_HostEvent::create();
+                    wakeup_armed_ = true;
+                }
+                events.clear();
+                if (wakeup_armed_) {
+                    events.push_back(wakeup_);
+                }
+                timeout = wakeup_armed_ ? HSTR_TIME_INFINITE : max_submission_delay_ms;
+            }
+            if (stop && pending.empty()) {
+                break;
+            }
+
+            // Wait for the wake-up or for any of the callbacks' events. Those
+            // which are known to have completed are run without waiting.
+            uint32_t num_deps = (uint32_t) std::min<uint64_t>(pending.size(), max_deps_per_wait);
+            uint32_t first_dep = (uint32_t) events.size();
+            ready.assign(pending.size(), false);
+            bool any_ready = false;
+            for (uint32_t idx = 0; idx < num_deps; ++idx) {
+                if (hStreams_HostEvent::isCompleted(pending[idx].dep)) {
+                    ready[idx] = any_ready = true;
+                }
+                events.push_back(pending[idx].dep);
+            }
+            timed_out = false;
+            if (!any_ready) {
+                signaled.resize(events.size());
+                uint32_t num_signaled = 0;
+                HSTR_COIRESULT result = hStreams_HostEvent::wait((uint16_t) events.size(), &events[0],
+                                        timeout, false, &num_signaled, &signaled[0]);
+                if (result == HSTR_COI_SUCCESS) {
+                    for (uint32_t idx = 0; idx < num_signaled; ++idx) {
+                        if (signaled[idx] >= first_dep) {
+                            ready[signaled[idx] - first_dep] = true;
+                        }
+                    }
+                } else if (result == HSTR_COI_TIME_OUT_REACHED) {
+                    timed_out = true;
+                } else {
+                    // The dependencies are broken, so are the streams they come
+                    // from. Rather than stall them for good, run the callbacks.
+                    HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
+                            << "Couldn't wait for the dependencies of the host callbacks, "
+                            << "running them right away";
+                    std::fill(ready.begin(), ready.end(), true);
+                }
+            }
+
+            // Run what's ready, in the order of submission
+            std::vector<Callback>::iterator out = pending.begin();
+            for (uint64_t idx = 0; idx < pending.size(); ++idx) {
+                if (ready[idx]) {
+                    Callback &cb = pending[idx];
+                    if (cb.notify != NULL) {
+                        cb.notify(cb.user_data);
+                    } else {
+                        cb.callback(cb.log_stream_id, cb.user_data);
+                        hStreams_HostEvent::signal(cb.completion);
+                    }
+                } else {
+                    *out++ = pending[idx];
+                }
+            }
+            pending.erase(out, pending.end());
+        }
+    }
+
+    // Whether to batch the submissions, as each wake-up costs a wait for all
+    // the pending events, which goes through COI if any of them is a COI event
+    const bool batch_submissions_;
+    // Protects all of the below
+    hStreams_Lock lock_;
+    // The callbacks not yet picked up by the thread
+    std::vector<Callback> submitted_;
+    // Signaled to wake the thread up when a callback is submitted or the thread
+    // is to stop. Valid while wakeup_armed_ is set, a new one is created by the
+    // thread once it has been signaled and, with batching, it has to.
+    HSTR_EVENT wakeup_;
+    bool wakeup_armed_;
+    bool stopping_;
+    std::unique_ptr<hStreams_Thread> thread_;
+};
+
+// The application's callbacks
+CallbackThread callbacks_thread(false);
+// The notifications of COI events' completion. Kept apart from the above so
+// that they are never held up by the application's callbacks.
+CallbackThread notifications_thread(true);
+
+} // anonymous namespace
+
+void hStreams_HostCallbacks::submit(
+    HSTR_EVENT const &dep,
+    HSTR_HOST_CALLBACK callback,
+    HSTR_LOG_STR log_stream_id,
+    void *user_data,
+    HSTR_EVENT const &completion)
+{
+    Callback cb;
+    cb.dep = dep;
+    cb.callback = callback;
+    cb.log_stream_id = log_stream_id;
+    cb.user_data = user_data;
+    cb.completion = completion;
+    cb.notify = NULL;
+    callbacks_thread.submit(cb);
+}
+
+bool hStreams_HostCallbacks::notifyOnCompletion(HSTR_EVENT const &event, void (*notify)(void *), void *arg)
+{
+    if (hStreams_HostEvent::isHostEvent(event) || hStreams_HostEvent::isNullEvent(event)) {
+        return hStreams_HostEvent::notifyOnSignal(event, notify, arg);
+    }
+    Callback cb;
+    cb.dep = event;
+    cb.callback = NULL;
+    cb.log_stream_id = 0;
+    cb.user_data = arg;
+    cb.completion = event;
+    cb.notify = notify;
+    notifications_thread.submit(cb);
+    return true;
+}
+
+void hStreams_HostCallbacks::shutdown()
+{
+    callbacks_thread.shutdown();
+    notifications_thread.shutdown();
+}
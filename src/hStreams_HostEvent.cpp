@@ -0,0 +1,774 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#include "hStreams_HostEvent.h"
+#include "hStreams_COIWrapper.h"
+#include "hStreams_internal.h"
+#include "hStreams_helpers_source.h"
+#include "hStreams_exceptions.h"
+#include "hStreams_locks.h"
+#include "hStreams_Logger.h"
+#include "hStreams_WaitPolicy.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+#else
+#include <Windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#endif
+
+namespace
+{
+
+// "HSTREVNT", stored in opaque[1] of host events
+const uint64_t host_event_tag = 0x4853545245564E54ULL;
+
+// Layout of the state word of a slot
+const uint32_t state_signaled = 1;
+const uint32_t state_bridged = 2;
+const uint32_t state_waiters = 4;
+const uint32_t state_notify = 8;
+const uint32_t state_generation_shift = 4;
+const uint32_t state_generation_mask = (1U << (32 - state_generation_shift)) - 1;
+
+// The slot table grows in chunks which are never freed, so that a stale
+// handle can always be safely looked up
+const uint32_t slots_per_chunk_log2 = 12;
+const uint32_t slots_per_chunk = 1U << slots_per_chunk_log2;
+const uint32_t max_chunks = 1024;
+
+struct Notification {
+    void (*notify)(void *);
+    void *arg;
+};
+
+struct Slot {
+    std::atomic<uint32_t> state;
+    /// @brief Index + 1 of the next slot on the free list, 0 terminates the list
+    std::atomic<uint32_t> next_free;
+    /// @brief COI user event signaled along with this event, valid if state_bridged is set
+    HSTR_EVENT coi_event;
+    /// @brief Called when the event is signaled, valid if state_notify is set.
+    ///     Guarded by the notify lock of the slot; keeps its capacity when
+    ///     the slot is recycled.
+    std::vector<Notification> notifications;
+};
+
+HSTR_STATIC_ASSERT(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), futex_word_must_be_32_bit);
+
+std::atomic<Slot *> chunks[max_chunks];
+std::atomic<uint32_t> num_chunks(0);
+// Lower 32 bits: index + 1 of the first free slot; upper 32 bits: ABA tag
+std::atomic<uint64_t> free_head(0);
+// Serializes growing the slot table
+hStreams_Lock grow_lock;
+// Serializes bridging host events to COI user events
+hStreams_Lock bridge_lock;
+// Serialize adding notifications to the slots with running them, a slot
+// uses the lock of its index modulo num_notify_locks
+const uint32_t num_notify_locks = 64;
+hStreams_Lock notify_locks[num_notify_locks];
+
+// Sleeping wait-for-any waiters, woken up whenever any host event is signaled
+std::atomic<uint32_t> any_waiters(0);
+std::atomic<uint32_t> any_epoch(0);
+
+// Sleep until word != expected, a wake-up or the timeout (in us, -1 is infinite)
+void futexWait(std::atomic<uint32_t> &word, uint32_t expected, int64_t timeout_us)
+{
+#ifndef _WIN32
+    struct timespec ts;
+    struct timespec *pts = NULL;
+    if (timeout_us >= 0) {
+        ts.tv_sec = timeout_us / 1000000;
+        ts.tv_nsec = (timeout_us % 1000000) * 1000;
+        pts = &ts;
+    }
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE, expected, pts, NULL, 0);
+#else
+    DWORD timeout_ms = (timeout_us < 0) ? INFINITE : (DWORD)((timeout_us + 999) / 1000);
+    WaitOnAddress(&word, &expected, sizeof(expected), timeout_ms);
+#endif
+}
+
+void futexWakeAll(std::atomic<uint32_t> &word)
+{
+#ifndef _WIN32
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+    WakeByAddressAll(&word);
+#endif
+}
+
+class Deadline
+{
+public:
+    Deadline(int32_t timeout_ms)
+        : timeout_ms_(timeout_ms), start_(std::chrono::steady_clock::now()) {}
+
+    bool isPoll() const
+    {
+        return timeout_ms_ == 0;
+    }
+    // Remaining time in microseconds, -1 if infinite
+    int64_t remainingUs() const
+    {
+        if (timeout_ms_ < 0) {
+            return -1;
+        }
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now() - start_).count();
+        int64_t remaining = (int64_t)timeout_ms_ * 1000 - elapsed;
+        return remaining > 0 ? remaining : 0;
+    }
+    // Remaining time in nanoseconds, as accepted by hStreams_WaitPolicy, -1 if infinite
+    int64_t remainingNs() const
+    {
+        int64_t remaining = remainingUs();
+        return remaining < 0 ? -1 : remaining * 1000;
+    }
+    // Remaining time in milliseconds, as accepted by COIEventWait
+    int32_t remainingMs() const
+    {
+        int64_t remaining = remainingUs();
+        return remaining < 0 ? -1 : (int32_t)(remaining / 1000);
+    }
+private:
+    int32_t timeout_ms_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+Slot *lookupSlot(uint32_t index)
+{
+    uint32_t chunk = index >> slots_per_chunk_log2;
+    if (chunk >= num_chunks.load(std::memory_order_acquire)) {
+        return NULL;
+    }
+    return chunks[chunk].load(std::memory_order_acquire) + (index & (slots_per_chunk - 1));
+}
+
+// Push a chain of slots first..last (already linked through next_free) on the free list
+void pushFree(uint32_t first, Slot *last)
+{
+    uint64_t head = free_head.load(std::memory_order_relaxed);
+    uint64_t new_head;
+    do {
+        last->next_free.store((uint32_t)head, std::memory_order_relaxed);
+        new_head = (((head >> 32) + 1) << 32) | (uint64_t)(first + 1);
+    } while (!free_head.compare_exchange_weak(head, new_head,
+             std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool popFree(uint32_t &out_index)
+{
+    uint64_t head = free_head.load(std::memory_order_acquire);
+    while ((uint32_t)head != 0) {
+        uint32_t index = (uint32_t)head - 1;
+        uint32_t next = lookupSlot(index)->next_free.load(std::memory_order_relaxed);
+        uint64_t new_head = (((head >> 32) + 1) << 32) | (uint64_t)next;
+        if (free_head.compare_exchange_weak(head, new_head,
+                                            std::memory_order_acquire, std::memory_order_acquire)) {
+            out_index = index;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t allocSlot()
+{
+    uint32_t index;
+    if (popFree(index)) {
+        return index;
+    }
+
+    hStreams_Scope_Locker_Unlocker _autolock(grow_lock);
+    // Somebody might have grown the table in the meantime
+    if (popFree(index)) {
+        return index;
+    }
+    uint32_t chunk = num_chunks.load(std::memory_order_relaxed);
+    if (chunk >= max_chunks) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_MEMORY, StringBuilder()
+                                   << "Too many host events in flight, the limit is "
+                                   << (uint64_t)max_chunks * slots_per_chunk);
+    }
+    Slot *slots = new Slot[slots_per_chunk];
+    uint32_t base = chunk << slots_per_chunk_log2;
+    for (uint32_t i = 0; i < slots_per_chunk; ++i) {
+        slots[i].state.store(1U << state_generation_shift, std::memory_order_relaxed);
+        slots[i].next_free.store(base + i + 2, std::memory_order_relaxed);
+    }
+    chunks[chunk].store(slots, std::memory_order_release);
+    num_chunks.store(chunk + 1, std::memory_order_release);
+
+    // Keep the first slot, put the rest on the free list
+    pushFree(base + 1, &slots[slots_per_chunk - 1]);
+    return base;
+}
+
+hStreams_Lock &notifyLock(uint32_t index)
+{
+    return notify_locks[index % num_notify_locks];
+}
+
+bool isCompletedState(uint32_t state, uint32_t generation)
+{
+    return (state >> state_generation_shift) != generation || (state & state_signaled);
+}
+
+// A host event resolved to its slot; slot == NULL denotes the placeholder event
+struct Entry {
+    Slot *slot;
+    uint32_t generation;
+
+    bool isCompleted() const
+    {
+        return slot == NULL ||
+               isCompletedState(slot->state.load(std::memory_order_seq_cst), generation);
+    }
+};
+
+// An array living on the stack when it's small and on the heap otherwise.
+// Saves the waiters from allocating memory on each call: the dependencies of
+// a single action normally fit on the stack. Waits on more than inline_size
+// events, e.g. an out-of-order worker waiting for the dependencies of more
+// than that many actions at once, allocate.
+template <typename T>
+class ScratchArray
+{
+public:
+    explicit ScratchArray(uint32_t size) : data_(inline_)
+    {
+        if (size > inline_size) {
+            heap_.resize(size);
+            data_ = &heap_[0];
+        }
+    }
+    T &operator[](uint32_t idx)
+    {
+        return data_[idx];
+    }
+    T *get()
+    {
+        return data_;
+    }
+private:
+    static const uint32_t inline_size = 128;
+    T inline_[inline_size];
+    std::vector<T> heap_;
+    T *data_;
+
+    // copy-ctor and assignment prohibited
+    ScratchArray(ScratchArray const &other);
+    ScratchArray &operator=(ScratchArray const &other);
+};
+
+bool resolve(HSTR_EVENT const &event, Entry &out_entry)
+{
+    if (hStreams_HostEvent::isNullEvent(event)) {
+        out_entry.slot = NULL;
+        out_entry.generation = 0;
+        return true;
+    }
+    out_entry.slot = lookupSlot((uint32_t)event.opaque[0]);
+    out_entry.generation = (uint32_t)(event.opaque[0] >> 32);
+    return out_entry.slot != NULL;
+}
+
+bool waitOne(Entry const &entry, Deadline const &deadline, HSTR_WAIT_PHASE &out_phase)
+{
+    out_phase = HSTR_WAIT_PHASE_IMMEDIATE;
+    if (entry.isCompleted()) {
+        return true;
+    }
+    if (deadline.isPoll()) {
+        return false;
+    }
+    out_phase = hStreams_WaitPolicy::spinThenYield(
+                    std::bind(&Entry::isCompleted, &entry), deadline.remainingNs());
+    if (out_phase != HSTR_WAIT_PHASE_PARK) {
+        return true;
+    }
+    std::atomic<uint32_t> &state = entry.slot->state;
+    while (true) {
+        uint32_t s = state.load(std::memory_order_seq_cst);
+        if (isCompletedState(s, entry.generation)) {
+            return true;
+        }
+        int64_t remaining = deadline.remainingUs();
+        if (remaining == 0) {
+            return false;
+        }
+        if (!(s & state_waiters)) {
+            if (!state.compare_exchange_weak(s, s | state_waiters)) {
+                continue;
+            }
+            s |= state_waiters;
+        }
+        futexWait(state, s, remaining);
+    }
+}
+
+uint32_t collectCompleted(Entry const *entries, uint32_t num_entries, uint32_t *out_signaled_indices)
+{
+    uint32_t num_signaled = 0;
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        if (entries[i].isCompleted()) {
+            if (out_signaled_indices) {
+                out_signaled_indices[num_signaled] = i;
+            }
+            ++num_signaled;
+        }
+    }
+    return num_signaled;
+}
+
+bool anyCompleted(Entry const *entries, uint32_t num_entries)
+{
+    return collectCompleted(entries, num_entries, NULL) != 0;
+}
+
+void recordPhase(hStreams_WaitStats *stats, HSTR_WAIT_PHASE phase)
+{
+    if (stats) {
+        stats->record(phase);
+    }
+}
+
+HSTR_COIRESULT waitAllNative(Entry const *entries, uint32_t num_entries, Deadline const &deadline,
+                             uint32_t *out_num_signaled, uint32_t *out_signaled_indices,
+                             hStreams_WaitStats *stats)
+{
+    // The phase reported for a wait on several events is the "worst" one
+    HSTR_WAIT_PHASE worst_phase = HSTR_WAIT_PHASE_IMMEDIATE;
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        HSTR_WAIT_PHASE phase;
+        if (!waitOne(entries[i], deadline, phase)) {
+            if (out_num_signaled) {
+                *out_num_signaled = collectCompleted(entries, num_entries, out_signaled_indices);
+            }
+            return HSTR_COI_TIME_OUT_REACHED;
+        }
+        if (phase > worst_phase) {
+            worst_phase = phase;
+        }
+    }
+    recordPhase(stats, worst_phase);
+    if (out_num_signaled) {
+        *out_num_signaled = collectCompleted(entries, num_entries, out_signaled_indices);
+    }
+    return HSTR_COI_SUCCESS;
+}
+
+HSTR_COIRESULT waitAnyNative(Entry const *entries, uint32_t num_entries, Deadline const &deadline,
+                             uint32_t *out_num_signaled, uint32_t *out_signaled_indices,
+                             hStreams_WaitStats *stats)
+{
+    HSTR_WAIT_PHASE phase = HSTR_WAIT_PHASE_IMMEDIATE;
+    uint32_t num_signaled = collectCompleted(entries, num_entries, out_signaled_indices);
+    if (num_signaled == 0 && !deadline.isPoll()) {
+        phase = hStreams_WaitPolicy::spinThenYield(
+                    std::bind(&anyCompleted, entries, num_entries), deadline.remainingNs());
+        num_signaled = collectCompleted(entries, num_entries, out_signaled_indices);
+        if (num_signaled == 0) {
+            any_waiters.fetch_add(1);
+            while (true) {
+                uint32_t epoch = any_epoch.load();
+                num_signaled = collectCompleted(entries, num_entries, out_signaled_indices);
+                if (num_signaled != 0) {
+                    break;
+                }
+                int64_t remaining = deadline.remainingUs();
+                if (remaining == 0) {
+                    break;
+                }
+                futexWait(any_epoch, epoch, remaining);
+            }
+            any_waiters.fetch_sub(1);
+        }
+    }
+    if (num_signaled) {
+        recordPhase(stats, phase);
+    }
+    if (out_num_signaled) {
+        *out_num_signaled = num_signaled;
+    }
+    return num_signaled ? HSTR_COI_SUCCESS : HSTR_COI_TIME_OUT_REACHED;
+}
+
+// Get a COI event which will be signaled no earlier than the host event.
+// Returns false if the host event has already completed.
+bool bridge(Entry const &entry, HSTR_EVENT &out_coi_event, HSTR_COIRESULT &out_result)
+{
+    out_result = HSTR_COI_SUCCESS;
+    if (entry.isCompleted()) {
+        return false;
+    }
+
+    hStreams_Scope_Locker_Unlocker _autolock(bridge_lock);
+    std::atomic<uint32_t> &state = entry.slot->state;
+    uint32_t s = state.load(std::memory_order_seq_cst);
+    if (isCompletedState(s, entry.generation)) {
+        return false;
+    }
+    if (s & state_bridged) {
+        // Only bridged under bridge_lock, coi_event is stable. Even if the
+        // host event is being signaled right now, the COI event is fine to use.
+        out_coi_event = entry.slot->coi_event;
+        return true;
+    }
+
+    HSTR_EVENT coi_event;
+    out_result = hStreams_COIWrapper::COIEventRegisterUserEvent(&coi_event);
+    if (out_result != HSTR_COI_SUCCESS) {
+        return false;
+    }
+    entry.slot->coi_event = coi_event;
+    while (!state.compare_exchange_weak(s, s | state_bridged)) {
+        if (isCompletedState(s, entry.generation)) {
+            // Signaled in the meantime, the signaler didn't see the COI event
+            out_result = hStreams_COIWrapper::COIEventSignalUserEvent(coi_event);
+            break;
+        }
+    }
+    out_coi_event = coi_event;
+    return true;
+}
+
+bool hasCOIWaitAvailable()
+{
+    return hStreams_COIWrapper::COIEventWait != NULL;
+}
+
+// Orders the events by their handles, so that the duplicates end up side by side
+class EventLess
+{
+public:
+    bool operator()(HSTR_EVENT const &a, HSTR_EVENT const &b) const
+    {
+        return a.opaque[0] < b.opaque[0] || (a.opaque[0] == b.opaque[0] && a.opaque[1] < b.opaque[1]);
+    }
+};
+
+class EventEqual
+{
+public:
+    bool operator()(HSTR_EVENT const &a, HSTR_EVENT const &b) const
+    {
+        return a.opaque[0] == b.opaque[0] && a.opaque[1] == b.opaque[1];
+    }
+};
+
+class EventCompleted
+{
+public:
+    bool operator()(HSTR_EVENT const &event) const
+    {
+        return hStreams_HostEvent::isCompleted(event);
+    }
+};
+
+} // anonymous namespace
+
+HSTR_EVENT hStreams_HostEvent::create()
+{
+    uint32_t index = allocSlot();
+    uint32_t state = lookupSlot(index)->state.load(std::memory_order_relaxed);
+
+    HSTR_EVENT event;
+    event.opaque[0] = (uint64_t)index | ((uint64_t)(state >> state_generation_shift) << 32);
+    event.opaque[1] = host_event_tag;
+    return event;
+}
+
+void hStreams_HostEvent::signal(HSTR_EVENT const &event)
+{
+    Entry entry;
+    if (!isHostEvent(event) || !resolve(event, entry)) {
+        HSTR_ERROR(HSTR_INFO_TYPE_SYNC) << "Attempted to signal an event which is not a host event";
+        return;
+    }
+    std::atomic<uint32_t> &state = entry.slot->state;
+    uint32_t s = state.load(std::memory_order_relaxed);
+    do {
+        if (isCompletedState(s, entry.generation)) {
+            HSTR_ERROR(HSTR_INFO_TYPE_SYNC) << "Attempted to signal a host event more than once";
+            return;
+        }
+    } while (!state.compare_exchange_weak(s, s | state_signaled));
+
+    if (s & state_bridged) {
+        HSTR_COIRESULT result = hStreams_COIWrapper::COIEventSignalUserEvent(entry.slot->coi_event);
+        if (result != HSTR_COI_SUCCESS) {
+            HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
+                    << "Error while signaling the COI event bridged to a host event: "
+                    << hStreams_COIWrapper::COIResultGetName(result);
+        }
+    }
+    if (s & state_waiters) {
+        futexWakeAll(state);
+    }
+    if (any_waiters.load() != 0) {
+        any_epoch.fetch_add(1);
+        futexWakeAll(any_epoch);
+    }
+    if (s & state_notify) {
+        // Nobody adds notifications to a signaled event, they're all here
+        hStreams_Scope_Locker_Unlocker _autolock(notifyLock((uint32_t)event.opaque[0]));
+        std::vector<Notification> &notifications = entry.slot->notifications;
+        for (size_t idx = 0; idx < notifications.size(); ++idx) {
+            notifications[idx].notify(notifications[idx].arg);
+        }
+        notifications.clear();
+    }
+
+    // Recycle the slot. Holders of the old handle see the generation change,
+    // which means "completed".
+    state.store(((entry.generation + 1) & state_generation_mask) << state_generation_shift);
+    pushFree((uint32_t)event.opaque[0], entry.slot);
+}
+
+bool hStreams_HostEvent::notifyOnSignal(HSTR_EVENT const &event, void (*notify)(void *), void *arg)
+{
+    Entry entry;
+    if (!isHostEvent(event) && !isNullEvent(event)) {
+        HSTR_ERROR(HSTR_INFO_TYPE_SYNC) << "Attempted to be notified of a COI event as of a host event";
+        return false;
+    }
+    if (!resolve(event, entry) || entry.isCompleted()) {
+        return false;
+    }
+
+    hStreams_Scope_Locker_Unlocker _autolock(notifyLock((uint32_t)event.opaque[0]));
+    std::atomic<uint32_t> &state = entry.slot->state;
+    uint32_t s = state.load(std::memory_order_seq_cst);
+    do {
+        if (isCompletedState(s, entry.generation)) {
+            return false;
+        }
+    } while (!(s & state_notify) && !state.compare_exchange_weak(s, s | state_notify));
+    // The signaler sees state_notify and runs the notifications only after
+    // getting the lock, by then this one is in place
+    Notification notification = { notify, arg };
+    entry.slot->notifications.push_back(notification);
+    return true;
+}
+
+bool hStreams_HostEvent::isHostEvent(HSTR_EVENT const &event)
+{
+    return event.opaque[1] == host_event_tag;
+}
+
+bool hStreams_HostEvent::isNullEvent(HSTR_EVENT const &event)
+{
+    return event.opaque[0] == (uint64_t) - 1 && event.opaque[1] == (uint64_t) - 1;
+}
+
+bool hStreams_HostEvent::isCompleted(HSTR_EVENT const &event)
+{
+    if (!isHostEvent(event) && !isNullEvent(event)) {
+        return false;
+    }
+    Entry entry;
+    return resolve(event, entry) && entry.isCompleted();
+}
+
+uint64_t hStreams_HostEvent::prune(std::vector<HSTR_EVENT> &events)
+{
+    const uint64_t num_before = events.size();
+    std::vector<HSTR_EVENT>::iterator end = std::remove_if(events.begin(), events.end(), EventCompleted());
+    if (end - events.begin() > 1) {
+        std::sort(events.begin(), end, EventLess());
+        end = std::unique(events.begin(), end, EventEqual());
+    }
+    events.erase(end, events.end());
+    return num_before - events.size();
+}
+
+HSTR_COIRESULT hStreams_HostEvent::wait(
+    uint16_t num_events,
+    const HSTR_EVENT *events,
+    int32_t timeout_ms,
+    uint8_t wait_for_all,
+    uint32_t *out_num_signaled,
+    uint32_t *out_signaled_indices,
+    hStreams_WaitStats *stats)
+{
+    if (events == NULL) {
+        return HSTR_COI_INVALID_POINTER;
+    }
+    if (num_events == 0 || timeout_ms < -1) {
+        return HSTR_COI_OUT_OF_RANGE;
+    }
+    if (!wait_for_all && num_events != 1 &&
+            (out_num_signaled == NULL || out_signaled_indices == NULL)) {
+        return HSTR_COI_ARGUMENT_MISMATCH;
+    }
+
+    Deadline deadline(timeout_ms);
+
+    // Split the events into the host ones (and placeholders) and the COI ones
+    ScratchArray<Entry> host_entries(num_events);
+    ScratchArray<uint32_t> host_indices(num_events);
+    ScratchArray<HSTR_EVENT> coi_events(num_events);
+    ScratchArray<uint32_t> coi_indices(num_events);
+    uint32_t num_host = 0, num_coi = 0;
+    for (uint32_t i = 0; i < num_events; ++i) {
+        Entry entry;
+        if (isHostEvent(events[i]) || isNullEvent(events[i])) {
+            if (!resolve(events[i], entry)) {
+                return HSTR_COI_INVALID_HANDLE;
+            }
+            host_entries[num_host] = entry;
+            host_indices[num_host++] = i;
+        } else {
+            coi_events[num_coi] = events[i];
+            coi_indices[num_coi++] = i;
+        }
+    }
+
+    if (num_coi == 0) {
+        return wait_for_all
+               ? waitAllNative(host_entries.get(), num_host, deadline, out_num_signaled, out_signaled_indices, stats)
+               : waitAnyNative(host_entries.get(), num_host, deadline, out_num_signaled, out_signaled_indices, stats);
+    }
+    if (!hasCOIWaitAvailable()) {
+        // Only host events can exist without COI
+        return HSTR_COI_INVALID_HANDLE;
+    }
+    if (num_host == 0) {
+        return hStreams_COIWrapper::COIEventWait(num_events, events, timeout_ms, wait_for_all,
+                out_num_signaled, out_signaled_indices);
+    }
+
+    ScratchArray<uint32_t> host_signaled(num_host);
+    ScratchArray<uint32_t> coi_signaled(num_coi);
+    uint32_t num_host_signaled = 0, num_coi_signaled = 0;
+
+    if (wait_for_all) {
+        // Wait natively for the host events first, then let COI wait for the rest
+        HSTR_COIRESULT result = waitAllNative(host_entries.get(), num_host, deadline,
+                                              &num_host_signaled, host_signaled.get(), NULL);
+        if (result == HSTR_COI_SUCCESS) {
+            result = hStreams_COIWrapper::COIEventWait((uint16_t) num_coi, coi_events.get(),
+                     deadline.remainingMs(), true, &num_coi_signaled, coi_signaled.get());
+        } else if (out_num_signaled) {
+            // Timed out, but the caller wants to know what completed
+            if (hStreams_COIWrapper::COIEventWait((uint16_t) num_coi, coi_events.get(),
+                                                  0, true, &num_coi_signaled, coi_signaled.get()) == HSTR_COI_SUCCESS) {
+                num_coi_signaled = num_coi;
+                for (uint32_t i = 0; i < num_coi_signaled; ++i) {
+                    coi_signaled[i] = i;
+                }
+            }
+        }
+        if (out_num_signaled) {
+            uint32_t num_signaled = 0;
+            for (uint32_t i = 0; i < num_host_signaled; ++i) {
+                out_signaled_indices[num_signaled++] = host_indices[host_signaled[i]];
+            }
+            for (uint32_t i = 0; i < num_coi_signaled; ++i) {
+                out_signaled_indices[num_signaled++] = coi_indices[coi_signaled[i]];
+            }
+            *out_num_signaled = num_signaled;
+        }
+        return result;
+    }
+
+    // Wait for any: if a host event has already completed, we're done.
+    // Otherwise let COI wait on all of them, with the host events bridged.
+    num_host_signaled = collectCompleted(host_entries.get(), num_host, host_signaled.get());
+    if (num_host_signaled == 0) {
+        ScratchArray<HSTR_EVENT> bridged(num_events);
+        std::copy(events, events + num_events, bridged.get());
+        for (uint32_t i = 0; i < num_host; ++i) {
+            HSTR_COIRESULT result;
+            if (!bridge(host_entries[i], bridged[host_indices[i]], result)) {
+                if (result != HSTR_COI_SUCCESS) {
+                    return result;
+                }
+                host_signaled[num_host_signaled++] = i;
+            }
+        }
+        if (num_host_signaled == 0) {
+            return hStreams_COIWrapper::COIEventWait(num_events, bridged.get(), timeout_ms, false,
+                    out_num_signaled, out_signaled_indices);
+        }
+    }
+    if (out_num_signaled) {
+        for (uint32_t i = 0; i < num_host_signaled; ++i) {
+            out_signaled_indices[i] = host_indices[host_signaled[i]];
+        }
+        *out_num_signaled = num_host_signaled;
+    }
+    return HSTR_COI_SUCCESS;
+}
+
+HSTR_COIRESULT hStreams_HostEvent::waitAll(
+    uint64_t num_events,
+    const HSTR_EVENT *events,
+    int32_t timeout_ms)
+{
+    const uint64_t max_chunk = 0xFFFF;
+    Deadline deadline(timeout_ms);
+    for (uint64_t first = 0; first < num_events; first += max_chunk) {
+        uint16_t num_chunk = (uint16_t) std::min(num_events - first, max_chunk);
+        HSTR_COIRESULT result = wait(num_chunk, events + first, deadline.remainingMs(),
+                                     true, NULL, NULL);
+        if (result != HSTR_COI_SUCCESS) {
+            return result;
+        }
+    }
+    return HSTR_COI_SUCCESS;
+}
+
+HSTR_COIRESULT hStreams_HostEvent::translateForCOI(std::vector<HSTR_EVENT> &events)
+{
+    std::vector<HSTR_EVENT>::iterator out = events.begin();
+    for (std::vector<HSTR_EVENT>::iterator it = events.begin(); it != events.end(); ++it) {
+        if (isNullEvent(*it)) {
+            continue;
+        }
+        if (isHostEvent(*it)) {
+            Entry entry;
+            if (!resolve(*it, entry)) {
+                return HSTR_COI_INVALID_HANDLE;
+            }
+            HSTR_COIRESULT result;
+            HSTR_EVENT coi_event;
+            if (!bridge(entry, coi_event, result)) {
+                if (result != HSTR_COI_SUCCESS) {
+                    return result;
+                }
+                continue;
+            }
+            *out++ = coi_event;
+        } else {
+            *out++ = *it;
+        }
+    }
+    events.erase(out, events.end());
+    return HSTR_COI_SUCCESS;
+}
@@ -0,0 +1,254 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#include "hStreams_HostNuma.h"
+#include "hStreams_internal.h"
+#include "hStreams_Logger.h"
+#include "hStreams_threading.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace
+{
+const uint32_t max_cpus = sizeof(HSTR_CPU_MASK) * 8;
+// Don't start a thread for touching less than this
+const uint64_t min_touch_bytes = 2 * 1024 * 1024;
+
+#ifndef _WIN32
+// From <linux/mempolicy.h>, which isn't there on all the build hosts
+const int mpol_preferred = 1;
+const unsigned mpol_mf_move = 1 << 1;
+
+// Parses a list such as "0-3,8,10-11" into the table
+void readCPUList(const char *path, int32_t node, std::vector<int32_t> &cpu_nodes)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return;
+    }
+    char line[4096];
+    if (fgets(line, sizeof(line), file) != NULL) {
+        char *pos = line;
+        while (*pos >= '0' && *pos <= '9') {
+            unsigned long first = strtoul(pos, &pos, 10);
+            unsigned long last = first;
+            if (*pos == '-') {
+                last = strtoul(pos + 1, &pos, 10);
+            }
+            for (unsigned long cpu = first; cpu <= last && cpu < max_cpus; ++cpu) {
+                cpu_nodes[cpu] = node;
+            }
+            if (*pos == ',') {
+                ++pos;
+            }
+        }
+    }
+    fclose(file);
+}
+#endif // _WIN32
+
+std::vector<int32_t> readTopology()
+{
+    std::vector<int32_t> cpu_nodes(max_cpus, -1);
+#ifndef _WIN32
+    const char *const nodes_dir = "/sys/devices/system/node";
+    DIR *dir = opendir(nodes_dir);
+    if (dir == NULL) {
+        HSTR_DEBUG1(HSTR_INFO_TYPE_MEM)
+                << "Could not read the NUMA topology from " << nodes_dir
+                << ", host-side buffers won't be placed";
+        return cpu_nodes;
+    }
+    while (struct dirent *entry = readdir(dir)) {
+        if (strncmp(entry->d_name, "node", 4) != 0 || entry->d_name[4] < '0' || entry->d_name[4] > '9') {
+            continue;
+        }
+        int32_t node = atoi(entry->d_name + 4);
+        char path[PATH_MAX];
+        int len = snprintf(path, sizeof(path), "%s/%s/cpulist", nodes_dir, entry->d_name);
+        if (len < 0 || (size_t) len >= sizeof(path)) {
+            continue;
+        }
+        readCPUList(path, node, cpu_nodes);
+    }
+    closedir(dir);
+#else
+    // FIXME: More than 64 threads on Windows aren't support by that function.
+    for (uint32_t cpu = 0; cpu < 64; ++cpu) {
+        UCHAR node;
+        if (GetNumaProcessorNode((UCHAR) cpu, &node) && node != 0xFF) {
+            cpu_nodes[cpu] = node;
+        }
+    }
+#endif // _WIN32
+    return cpu_nodes;
+}
+
+std::vector<int32_t> const &cpuNodes()
+{
+    static const std::vector<int32_t> cpu_nodes = readTopology();
+    return cpu_nodes;
+}
+
+bool bindToNode(void *mem, uint64_t len, int32_t node)
+{
+#ifndef _WIN32
+    const uint64_t bits = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> node_mask(node / bits + 1, 0);
+    node_mask[node / bits] |= 1UL << (node % bits);
+    // The kernel only looks at maxnode - 1 bits
+    long ret = syscall(SYS_mbind, mem, len, mpol_preferred, &node_mask[0],
+                       node_mask.size() * bits + 1, mpol_mf_move);
+    if (ret != 0) {
+        HSTR_DEBUG1(HSTR_INFO_TYPE_MEM)
+                << "Could not bind " << len << " bytes at " << mem << " to NUMA node "
+                << node << ", mbind failed with errno " << errno;
+        return false;
+    }
+    return true;
+#else
+    // There's no binding of already allocated memory, first touch has to do
+    return false;
+#endif // _WIN32
+}
+
+/// @brief A range of pages first touched by a thread pinned to \c cpu_
+struct TouchRange {
+    char *begin_;
+    uint64_t len_;
+    uint32_t cpu_;
+    std::unique_ptr<hStreams_Thread> thread_;
+};
+
+void touchPages(char *begin, uint64_t len)
+{
+    for (uint64_t pos = 0; pos < len; pos += hStreams_HostNuma::page_size) {
+        ((volatile char *) begin)[pos] = 0;
+    }
+}
+
+worker_return_type touchMain(void *ptr)
+{
+    TouchRange *range = (TouchRange *) ptr;
+    hStreams_HostNuma::pinCurrentThread(range->cpu_, "page placement");
+    touchPages(range->begin_, range->len_);
+#ifndef _WIN32
+    pthread_exit(NULL);
+#else
+    return 0;
+#endif // _WIN32
+}
+} // anonymous namespace
+
+int32_t hStreams_HostNuma::nodeOfCPUs(hStreams_CPUMask const &cpu_mask)
+{
+    std::vector<int32_t> const &cpu_nodes = cpuNodes();
+    int32_t node = -1;
+    for (uint32_t cpu = 0; cpu < max_cpus; ++cpu) {
+        if (!HSTR_CPU_MASK_ISSET(cpu, cpu_mask.mask)) {
+            continue;
+        }
+        if (cpu_nodes[cpu] == -1 || (node != -1 && cpu_nodes[cpu] != node)) {
+            return -1;
+        }
+        node = cpu_nodes[cpu];
+    }
+    return node;
+}
+
+int32_t hStreams_HostNuma::placeNear(void *mem, uint64_t len, hStreams_CPUMask const &cpu_mask)
+{
+    std::vector<uint32_t> cpus;
+    for (uint32_t cpu = 0; cpu < max_cpus; ++cpu) {
+        if (HSTR_CPU_MASK_ISSET(cpu, cpu_mask.mask)) {
+            cpus.push_back(cpu);
+        }
+    }
+    int32_t node = nodeOfCPUs(cpu_mask);
+    if (cpus.empty() || (node == -1 && cpuNodes()[cpus[0]] == -1)) {
+        return -1;
+    }
+    bool bound = node != -1 && bindToNode(mem, len, node);
+
+    uint64_t num_pages = len / page_size;
+    uint64_t num_threads = std::min<uint64_t>(cpus.size(), std::max<uint64_t>(len / min_touch_bytes, 1));
+    if (bound && num_threads == 1) {
+        // The pages will land on the node whoever touches them first
+        return node;
+    }
+
+    std::vector<std::unique_ptr<TouchRange> > ranges;
+    for (uint64_t idx = 0; idx < num_threads; ++idx) {
+        uint64_t first_page = num_pages * idx / num_threads;
+        uint64_t end_page = num_pages * (idx + 1) / num_threads;
+        std::unique_ptr<TouchRange> range(new TouchRange());
+        range->begin_ = (char *) mem + first_page * page_size;
+        range->len_ = (end_page - first_page) * page_size;
+        // Spread the threads over the whole mask, so that they cover all of its nodes
+        range->cpu_ = cpus[idx * cpus.size() / num_threads];
+        try {
+            range->thread_.reset(new hStreams_Thread(touchMain, range.get()));
+        } catch (...) {
+            // Touched from here, maybe on a different node
+            HSTR_DEBUG1(HSTR_INFO_TYPE_MEM)
+                    << "Could not start a page placement thread, touching the pages from the calling one";
+            touchPages(range->begin_, range->len_);
+        }
+        ranges.push_back(std::move(range));
+    }
+    for (uint64_t idx = 0; idx < ranges.size(); ++idx) {
+        if (ranges[idx]->thread_) {
+            ranges[idx]->thread_->join();
+        }
+    }
+    return node;
+}
+
+void hStreams_HostNuma::pinCurrentThread(uint32_t cpu, const char *thread_desc)
+{
+#ifndef _WIN32
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    int pret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+    if (pret != 0) {
+        HSTR_WARN(HSTR_INFO_TYPE_MISC)
+                << "Could not pin a " << thread_desc << " thread to CPU " << cpu
+                << ", pthread_setaffinity_np returned " << pret;
+    }
+#else
+    // FIXME: More than 64 threads on Windows aren't support by that function.
+    if (cpu >= sizeof(DWORD_PTR) * 8) {
+        return;
+    }
+    if (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) == 0) {
+        HSTR_WARN(HSTR_INFO_TYPE_MISC)
+                << "Could not pin a " << thread_desc << " thread to CPU " << cpu
+                << ", GetLastError returned " << StringBuilder::hex(GetLastError());
+    }
+#endif // _WIN32
+}
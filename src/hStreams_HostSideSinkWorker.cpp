@@ -14,13 +14,18 @@
 
 #include <memory>
 #include <functional>
+#include <algorithm>
+#include <deque>
 #include "hStreams_internal.h"
 #include "hStreams_helpers_source.h"
 #include "hStreams_exceptions.h"
 #include "hStreams_HostSideSinkWorker.h"
 #include "hStreams_sink.h"
 #include "hStreams_Logger.h"
-#include "hStreams_COIWrapper.h"
+#include "hStreams_HostEvent.h"
+#include "hStreams_internal_vars_source.h"
+
+#include <string.h>
 
 
 
@@ -64,11 +69,55 @@ ComputePayload::ComputePayload(std::vector<uint64_t> &args,
     args_(args), input_deps_(input_deps),
     ret_val_(ret_val), ret_val_size_(ret_val_size),
     ret_event_(ret_event)
+{
+    args_.reserve(reserved_entries);
+    input_deps_.reserve(reserved_entries);
+}
+
+void ComputePayload::assign(std::vector<uint64_t> const &args,
+                            std::vector<HSTR_EVENT> const &input_deps,
+                            void *ret_val, uint16_t ret_val_size,
+                            HSTR_EVENT ret_event)
+{
+    args_.assign(args.begin(), args.end());
+    input_deps_.assign(input_deps.begin(), input_deps.end());
+    ret_val_ = ret_val;
+    ret_val_size_ = ret_val_size;
+    ret_event_ = ret_event;
+}
+
+TransferPayload::TransferPayload(TransferRegion const *regions, uint32_t num_regions,
+                                 std::vector<HSTR_EVENT> &input_deps,
+                                 HSTR_EVENT ret_event) :
+    regions_(regions, regions + num_regions),
+    input_deps_(input_deps), ret_event_(ret_event)
+{
+    regions_.reserve(ComputePayload::reserved_entries);
+    input_deps_.reserve(ComputePayload::reserved_entries);
+}
+
+void TransferPayload::assign(TransferRegion const *regions, uint32_t num_regions,
+                             std::vector<HSTR_EVENT> const &input_deps,
+                             HSTR_EVENT ret_event)
+{
+    regions_.assign(regions, regions + num_regions);
+    input_deps_.assign(input_deps.begin(), input_deps.end());
+    ret_event_ = ret_event;
+}
+
+Action::Action() :
+    action_type_(STOP), priority_(HSTR_STREAM_PRIORITY_NORMAL)
 {
 }
 
 Action::Action(ACTION_TYPE action_type, std::unique_ptr<ComputePayload> payload) :
-    action_type_(action_type), payload_(std::move(payload))
+    action_type_(action_type), priority_(HSTR_STREAM_PRIORITY_NORMAL), payload_(std::move(payload))
+{
+}
+
+Action::Action(ACTION_TYPE action_type, std::unique_ptr<TransferPayload> payload) :
+    action_type_(action_type), priority_(HSTR_STREAM_PRIORITY_NORMAL),
+    transfer_payload_(std::move(payload))
 {
 }
 
@@ -76,34 +125,149 @@ Action::~Action()
 {
 }
 
+void Action::setCompute(std::vector<uint64_t> &args,
+                        std::vector<HSTR_EVENT> &input_deps,
+                        void *ret_val, uint16_t ret_val_size,
+                        HSTR_EVENT ret_event)
+{
+    action_type_ = COMPUTE;
+    if (payload_.get() == NULL) {
+        payload_.reset(new ComputePayload(args, input_deps, ret_val, ret_val_size, ret_event));
+    } else {
+        payload_->assign(args, input_deps, ret_val, ret_val_size, ret_event);
+    }
+}
+
+void Action::setTransfer(ACTION_TYPE action_type,
+                         TransferRegion const *regions, uint32_t num_regions,
+                         std::vector<HSTR_EVENT> &input_deps,
+                         HSTR_EVENT ret_event)
+{
+    action_type_ = action_type;
+    if (transfer_payload_.get() == NULL) {
+        transfer_payload_.reset(new TransferPayload(regions, num_regions, input_deps, ret_event));
+    } else {
+        transfer_payload_->assign(regions, num_regions, input_deps, ret_event);
+    }
+}
+
 std::unique_ptr<ComputePayload> &Action::getComputePayload()
 {
     return payload_;
 }
 
+std::unique_ptr<TransferPayload> &Action::getTransferPayload()
+{
+    return transfer_payload_;
+}
+
 ACTION_TYPE Action::getActionType()
 {
     return action_type_;
 }
 
-hStreams_SPSCQueue::hStreams_SPSCQueue()
+HSTR_STREAM_PRIORITY Action::getPriority()
+{
+    return priority_;
+}
+
+void Action::setPriority(HSTR_STREAM_PRIORITY priority)
+{
+    priority_ = priority;
+}
+
+hStreams_SPSCQueue::hStreams_SPSCQueue() : wakeup_armed_(false)
 {
 }
 
 hStreams_SPSCQueue::~hStreams_SPSCQueue()
 {
+    // Hand the event back to the pool
+    if (wakeup_armed_.load()) {
+        hStreams_HostEvent::signal(wakeup_);
+    }
 }
 
-void hStreams_SPSCQueue::add(std::unique_ptr<Action> action)
+hStreams_WaitStats const &hStreams_SPSCQueue::getPopStats() const
 {
-    hStreams_Scope_Locker_Unlocker autolock(mutex_);
-    queue_.push(std::move(action));
-    cond_var_.signal();
+    return pop_stats_;
 }
 
-std::unique_ptr<Action> hStreams_SPSCQueue::popFront()
+HSTR_EVENT hStreams_SPSCQueue::armWakeup()
+{
+    HSTR_EVENT wakeup;
+    {
+        hStreams_Scope_Locker_Unlocker autolock(wakeup_lock_);
+        if (!wakeup_armed_.load(std::memory_order_relaxed)) {
+            wakeup_ = hStreams_HostEvent::create();
+            wakeup_armed_.store(true, std::memory_order_relaxed);
+        }
+        wakeup = wakeup_;
+    }
+    // Pairs with the fence preceding signalWakeup(): either the producer
+    // sees the event armed, or the consumer sees the action once it looks
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return wakeup;
+}
+
+void hStreams_SPSCQueue::signalWakeup()
+{
+    if (!wakeup_armed_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    hStreams_Scope_Locker_Unlocker autolock(wakeup_lock_);
+    if (wakeup_armed_.load(std::memory_order_relaxed)) {
+        wakeup_armed_.store(false, std::memory_order_relaxed);
+        hStreams_HostEvent::signal(wakeup_);
+    }
+}
+
+hStreams_SPSCQueue *hStreams_SPSCQueue::create()
+{
+    HSTR_HOST_QUEUE_TYPE queue_type = HSTR_HOST_QUEUE_RING;
+
+    const char *const env_value = getenv(host_queue_env_name);
+    if (env_value != NULL && env_value[0] != '\0') {
+        if (strcmp(env_value, "locked") == 0) {
+            queue_type = HSTR_HOST_QUEUE_LOCKED;
+        } else if (strcmp(env_value, "ring") != 0) {
+            HSTR_WARN(HSTR_INFO_TYPE_MISC)
+                    << "Unrecognized value of " << host_queue_env_name << ": \"" << env_value
+                    << "\", valid values are \"ring\" and \"locked\". Using \"ring\".";
+        }
+    }
+
+    if (queue_type == HSTR_HOST_QUEUE_LOCKED) {
+        HSTR_DEBUG1(HSTR_INFO_TYPE_MISC) << "Using the locked queue for a host-side stream";
+        return new hStreams_LockedSPSCQueue();
+    }
+    HSTR_DEBUG1(HSTR_INFO_TYPE_MISC) << "Using the lock-free ring queue for a host-side stream";
+    return new hStreams_RingSPSCQueue();
+}
+
+hStreams_LockedSPSCQueue::hStreams_LockedSPSCQueue()
+{
+}
+
+hStreams_LockedSPSCQueue::~hStreams_LockedSPSCQueue()
+{
+}
+
+void hStreams_LockedSPSCQueue::add(std::unique_ptr<Action> action)
+{
+    {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        queue_.push(std::move(action));
+        cond_var_.signal();
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    signalWakeup();
+}
+
+std::unique_ptr<Action> hStreams_LockedSPSCQueue::popFront()
 {
     hStreams_Scope_Locker_Unlocker autolock(mutex_);
+    pop_stats_.record(queue_.empty() ? HSTR_WAIT_PHASE_PARK : HSTR_WAIT_PHASE_IMMEDIATE);
     cond_var_.wait(mutex_, std::bind(&queue_t::empty, &queue_));
     //Else just grab action element
     std::unique_ptr<Action> action = std::move(queue_.front());
@@ -111,13 +275,249 @@ std::unique_ptr<Action> hStreams_SPSCQueue::popFront()
     return std::move(action);
 }
 
-hStreams_HostSideSinkWorker::hStreams_HostSideSinkWorker(hStreams_CPUMask const &cpu_mask) :
-    queue_(new hStreams_SPSCQueue()),
+void hStreams_LockedSPSCQueue::popAll(std::vector<std::unique_ptr<Action> > &out_actions)
+{
+    queue_t pending;
+    {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        pop_stats_.record(queue_.empty() ? HSTR_WAIT_PHASE_PARK : HSTR_WAIT_PHASE_IMMEDIATE);
+        cond_var_.wait(mutex_, std::bind(&queue_t::empty, &queue_));
+        pending.swap(queue_);
+    }
+    out_actions.reserve(out_actions.size() + pending.size());
+    while (!pending.empty()) {
+        out_actions.push_back(std::move(pending.front()));
+        pending.pop();
+    }
+}
+
+void hStreams_LockedSPSCQueue::tryPopAll(std::vector<std::unique_ptr<Action> > &out_actions)
+{
+    queue_t pending;
+    {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        pending.swap(queue_);
+    }
+    out_actions.reserve(out_actions.size() + pending.size());
+    while (!pending.empty()) {
+        out_actions.push_back(std::move(pending.front()));
+        pending.pop();
+    }
+}
+
+hStreams_RingSPSCQueue::hStreams_RingSPSCQueue() :
+    tail_(0), cached_head_(0),
+    head_(0), cached_tail_(0),
+    consumer_sleeping_(false), overflow_size_(0), overflow_head_(0)
+{
+}
+
+hStreams_RingSPSCQueue::~hStreams_RingSPSCQueue()
+{
+    // Actions still sitting in the ring or in the overflow are owned by the queue
+    Action *action;
+    while ((action = popRing()) != NULL) {
+        delete action;
+    }
+    for (size_t idx = overflow_head_; idx < overflow_.size(); ++idx) {
+        delete overflow_[idx];
+    }
+}
+
+bool hStreams_RingSPSCQueue::pushRing(Action *action)
+{
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == ring_capacity) {
+        // Looks full from the producer's point of view, check what the consumer is up to
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (tail - cached_head_ == ring_capacity) {
+            return false;
+        }
+    }
+    slots_[tail & (ring_capacity - 1)] = action;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+Action *hStreams_RingSPSCQueue::popRing()
+{
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+        // Looks empty from the consumer's point of view, check what the producer is up to
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head == cached_tail_) {
+            return NULL;
+        }
+    }
+    Action *action = slots_[head & (ring_capacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return action;
+}
+
+Action *hStreams_RingSPSCQueue::popOverflow_locked()
+{
+    if (overflow_head_ == overflow_.size()) {
+        return NULL;
+    }
+    Action *action = overflow_[overflow_head_++];
+    if (overflow_head_ == overflow_.size()) {
+        // Keeps the capacity for the next spill
+        overflow_.clear();
+        overflow_head_ = 0;
+    }
+    overflow_size_.store(overflow_.size() - overflow_head_, std::memory_order_release);
+    return action;
+}
+
+void hStreams_RingSPSCQueue::drainRing(std::vector<std::unique_ptr<Action> > &out_actions)
+{
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    // Reserve up front so that nothing throws while the slots are being taken over
+    out_actions.reserve(out_actions.size() + (cached_tail_ - head));
+    for (; head != cached_tail_; ++head) {
+        out_actions.push_back(std::unique_ptr<Action>(slots_[head & (ring_capacity - 1)]));
+    }
+    // A single store hands the whole segment back to the producer
+    head_.store(head, std::memory_order_release);
+}
+
+void hStreams_RingSPSCQueue::drainAll_locked(std::vector<std::unique_ptr<Action> > &out_actions)
+{
+    // With the overflow non-empty, the producer can't push into the ring
+    // behind our back, so whatever is in the ring is older than the overflow
+    drainRing(out_actions);
+    if (overflow_head_ != overflow_.size()) {
+        out_actions.reserve(out_actions.size() + (overflow_.size() - overflow_head_));
+        for (size_t idx = overflow_head_; idx < overflow_.size(); ++idx) {
+            out_actions.push_back(std::unique_ptr<Action>(overflow_[idx]));
+        }
+        overflow_.clear();
+        overflow_head_ = 0;
+        overflow_size_.store(0, std::memory_order_release);
+    }
+}
+
+bool hStreams_RingSPSCQueue::nothingToDrain_locked(std::vector<std::unique_ptr<Action> > *out_actions,
+        size_t num_before)
+{
+    drainAll_locked(*out_actions);
+    return out_actions->size() == num_before;
+}
+
+bool hStreams_RingSPSCQueue::nothingToPop_locked(Action **out_action)
+{
+    // Spilled actions are always younger than the ones in the ring
+    *out_action = popRing();
+    if (*out_action == NULL) {
+        *out_action = popOverflow_locked();
+    }
+    return *out_action == NULL;
+}
+
+bool hStreams_RingSPSCQueue::hasPending() const
+{
+    return head_.load(std::memory_order_relaxed) != tail_.load(std::memory_order_acquire) ||
+           overflow_size_.load(std::memory_order_acquire) != 0;
+}
+
+void hStreams_RingSPSCQueue::wakeConsumer()
+{
+    // Pairs with the fence in popFront(): either we see the consumer going
+    // to sleep, or the consumer sees our action before going to sleep.
+    // Likewise with the one in armWakeup().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_sleeping_.load(std::memory_order_relaxed)) {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        cond_var_.signal();
+    }
+    signalWakeup();
+}
+
+void hStreams_RingSPSCQueue::add(std::unique_ptr<Action> action)
+{
+    // overflow_size_ is only ever decreased by the consumer, so if it reads
+    // zero here, nothing has spilled over and the ring may be used.
+    if (overflow_size_.load(std::memory_order_acquire) == 0 && pushRing(action.get())) {
+        action.release();
+    } else {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        if (overflow_head_ == overflow_.size() && pushRing(action.get())) {
+            action.release();
+        } else {
+            overflow_.push_back(action.get());
+            action.release();
+            overflow_size_.store(overflow_.size() - overflow_head_, std::memory_order_release);
+        }
+    }
+    wakeConsumer();
+}
+
+std::unique_ptr<Action> hStreams_RingSPSCQueue::popFront()
+{
+    // The producer only signals the consumer once it's asleep, so polling
+    // the queue for a while costs the producer nothing
+    HSTR_WAIT_PHASE phase = hStreams_WaitPolicy::spinThenYield(
+                                std::bind(&hStreams_RingSPSCQueue::hasPending, this));
+
+    Action *action = popRing();
+    if (action == NULL && overflow_size_.load(std::memory_order_acquire) != 0) {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        action = popOverflow_locked();
+    }
+    if (action == NULL) {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        consumer_sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cond_var_.wait(mutex_, std::bind(&hStreams_RingSPSCQueue::nothingToPop_locked, this, &action));
+        consumer_sleeping_.store(false, std::memory_order_relaxed);
+        phase = HSTR_WAIT_PHASE_PARK;
+    }
+    pop_stats_.record(phase);
+    return std::unique_ptr<Action>(action);
+}
+
+void hStreams_RingSPSCQueue::popAll(std::vector<std::unique_ptr<Action> > &out_actions)
+{
+    HSTR_WAIT_PHASE phase = hStreams_WaitPolicy::spinThenYield(
+                                std::bind(&hStreams_RingSPSCQueue::hasPending, this));
+
+    const size_t num_before = out_actions.size();
+    drainRing(out_actions);
+    if (overflow_size_.load(std::memory_order_acquire) != 0) {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        drainAll_locked(out_actions);
+    }
+    if (out_actions.size() == num_before) {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        consumer_sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cond_var_.wait(mutex_, std::bind(&hStreams_RingSPSCQueue::nothingToDrain_locked, this,
+                                         &out_actions, num_before));
+        consumer_sleeping_.store(false, std::memory_order_relaxed);
+        phase = HSTR_WAIT_PHASE_PARK;
+    }
+    pop_stats_.record(phase);
+}
+
+void hStreams_RingSPSCQueue::tryPopAll(std::vector<std::unique_ptr<Action> > &out_actions)
+{
+    drainRing(out_actions);
+    if (overflow_size_.load(std::memory_order_acquire) != 0) {
+        hStreams_Scope_Locker_Unlocker autolock(mutex_);
+        drainAll_locked(out_actions);
+    }
+}
+
+hStreams_HostSideSinkWorker::hStreams_HostSideSinkWorker(hStreams_CPUMask const &cpu_mask, bool out_of_order) :
+    queue_(hStreams_SPSCQueue::create()),
     thread_(new hStreams_Thread(&hStreams_HostSideSinkWorker::workerMainLoop, this)),
     cpu_mask_(cpu_mask),
-    worker_status_(HSTR_RESULT_SUCCESS)
+    worker_status_(HSTR_RESULT_SUCCESS),
+    out_of_order_(out_of_order),
+    poll_num_signaled_(0),
+    xfer_engine_(new hStreams_HostXferEngine(cpu_mask))
 {
-
 }
 
 hStreams_HostSideSinkWorker::~hStreams_HostSideSinkWorker()
@@ -133,9 +533,19 @@ hStreams_HostSideSinkWorker::~hStreams_HostSideSinkWorker()
         }
 
         thread_->join();
+
+        HSTR_DEBUG1(HSTR_INFO_TYPE_SYNC)
+                << "Host stream worker waits for actions (" << queue_->getPopStats()
+                << "), for input dependencies (" << deps_wait_stats_ << ")";
     } catch (...) {
         hStreams_handle_exception();
     }
+    for (std::vector<Action *>::iterator it = free_actions_.begin(); it != free_actions_.end(); ++it) {
+        delete *it;
+    }
+    for (std::vector<Action *>::iterator it = recycled_actions_.begin(); it != recycled_actions_.end(); ++it) {
+        delete *it;
+    }
 }
 
 HSTR_RESULT hStreams_HostSideSinkWorker::putAction(std::unique_ptr<Action> action)
@@ -150,6 +560,38 @@ HSTR_RESULT hStreams_HostSideSinkWorker::putAction(std::unique_ptr<Action> actio
     return HSTR_RESULT_SUCCESS;
 }
 
+std::unique_ptr<Action> hStreams_HostSideSinkWorker::acquireAction()
+{
+    if (free_actions_.empty()) {
+        // Take over everything the worker has handed back since the last time.
+        // The two vectors keep swapping, give the worker's one the larger
+        // capacity so that it doesn't grow while the backlog is no deeper.
+        hStreams_Scope_Locker_Unlocker autolock(recycled_lock_);
+        free_actions_.swap(recycled_actions_);
+        recycled_actions_.reserve(free_actions_.capacity());
+    }
+    if (free_actions_.empty()) {
+        return std::unique_ptr<Action>(new Action());
+    }
+    std::unique_ptr<Action> action(free_actions_.back());
+    free_actions_.pop_back();
+    return std::move(action);
+}
+
+void hStreams_HostSideSinkWorker::recycleActions(std::vector<std::unique_ptr<Action> > &actions)
+{
+    {
+        hStreams_Scope_Locker_Unlocker autolock(recycled_lock_);
+        for (uint32_t i = 0; i < actions.size(); ++i) {
+            if (actions[i].get() != NULL && recycled_actions_.size() < max_recycled_actions) {
+                recycled_actions_.push_back(actions[i].release());
+            }
+        }
+    }
+    // Frees whatever didn't fit
+    actions.clear();
+}
+
 namespace
 {
 void set_affinity(hStreams_CPUMask const &cpu_mask)
@@ -213,57 +655,373 @@ void set_affinity(hStreams_CPUMask const &cpu_mask)
             cpu_mask.mask[15]);
     }
 }
+
+bool waitForInputDeps(std::vector<HSTR_EVENT> &input_deps, hStreams_WaitStats &stats)
+{
+    if (input_deps.empty()) {
+        stats.record(HSTR_WAIT_PHASE_IMMEDIATE);
+        return true;
+    }
+    HSTR_COIRESULT result = hStreams_HostEvent::wait((uint16_t) input_deps.size(),
+                            &input_deps[0], -1, true, NULL, NULL, &stats);
+    if (result != HSTR_COI_SUCCESS) {
+        HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
+                << "Error while waiting on the input dependencies of an action: "
+                << hStreams_COIWrapper::COIResultGetName(result);
+
+        return false;
+    }
+    return true;
 }
 
-worker_return_type hStreams_HostSideSinkWorker::workerMainLoop(void *ptr)
+std::vector<HSTR_EVENT> *inputDepsOf(Action &action)
 {
-    hStreams_HostSideSinkWorker *worker = (hStreams_HostSideSinkWorker *) ptr;
-    try {
-        worker->worker_status_ = HSTR_RESULT_SUCCESS;
-        set_affinity(worker->cpu_mask_);
+    switch (action.getActionType()) {
+    case COMPUTE:
+        return &action.getComputePayload()->input_deps_;
+    case TRANSFER:
+    case MARKER:
+        return &action.getTransferPayload()->input_deps_;
+    default:
+        return NULL;
+    }
+}
+}
+
+bool hStreams_HostSideSinkWorker::executeAction(Action &action, bool deps_resolved)
+{
+    if (action.getActionType() == STOP) {
+        return false;
+    }
+
+    //Wait for all input_deps
+    if (deps_resolved) {
+        deps_wait_stats_.record(HSTR_WAIT_PHASE_IMMEDIATE);
+    } else if (!waitForInputDeps(*inputDepsOf(action), deps_wait_stats_)) {
+        // skip the action
+        return true;
+    }
+
+    if (action.getActionType() == COMPUTE) {
+        std::unique_ptr<ComputePayload> &payload = action.getComputePayload();
+
+        // Compute
+        // Historically, we never handled any errors from the thunk
+        hStreamsThunk(1, NULL, NULL, &(payload->args_[0]),
+                      (uint16_t)(payload->args_.size()) * sizeof(uint64_t),
+                      payload->ret_val_, payload->ret_val_size_);
+
+        //Signal ret event
+        hStreams_HostEvent::signal(payload->ret_event_);
+
+    } else if (action.getActionType() == TRANSFER || action.getActionType() == MARKER) {
+        std::unique_ptr<TransferPayload> &payload = action.getTransferPayload();
+
+        // A marker has no regions
+        if (!payload->regions_.empty()) {
+            xfer_engine_->copy(&payload->regions_[0], payload->regions_.size());
+        }
+
+        hStreams_HostEvent::signal(payload->ret_event_);
+    }
+    return true;
+}
+
+void hStreams_HostSideSinkWorker::pollInputDeps(std::vector<std::unique_ptr<Action> > &actions,
+        std::vector<bool> &out_resolved)
+{
+    out_resolved.assign(actions.size(), true);
+    poll_events_.clear();
+    poll_owners_.clear();
+    poll_pending_.assign(actions.size(), 0);
+    poll_num_signaled_ = 0;
+
+    for (uint32_t i = 0; i < actions.size(); ++i) {
+        if (actions[i].get() == NULL) {
+            continue;
+        }
+        std::vector<HSTR_EVENT> *input_deps = inputDepsOf(*actions[i]);
+        if (input_deps != NULL) {
+            for (std::vector<HSTR_EVENT>::const_iterator it = input_deps->begin(); it != input_deps->end(); ++it) {
+                poll_events_.push_back(*it);
+                poll_owners_.push_back(i);
+                ++poll_pending_[i];
+            }
+            out_resolved[i] = (poll_pending_[i] == 0);
+        }
+    }
+    // A single wait takes at most 0xFFFF events, the actions which are left
+    // unresolved will simply wait for their dependencies on their own.
+    if (poll_events_.empty() || poll_events_.size() > 0xFFFF) {
+        return;
+    }
+
+    poll_signaled_.resize(poll_events_.size());
+    uint32_t num_signaled = 0;
+    HSTR_COIRESULT result = hStreams_HostEvent::wait((uint16_t) poll_events_.size(), &poll_events_[0],
+                            0, true, &num_signaled, &poll_signaled_[0]);
+    if (result != HSTR_COI_SUCCESS && result != HSTR_COI_TIME_OUT_REACHED) {
+        // Let each action find out on its own what's wrong
+        return;
+    }
+    for (uint32_t i = 0; i < num_signaled; ++i) {
+        uint32_t owner = poll_owners_[poll_signaled_[i]];
+        if (--poll_pending_[owner] == 0) {
+            out_resolved[owner] = true;
+        }
+    }
+    poll_num_signaled_ = num_signaled;
+}
+
+bool hStreams_HostSideSinkWorker::waitForPolledInputDeps(HSTR_EVENT const &wakeup)
+{
+    // One of the events waited for is the wake-up
+    if (poll_events_.size() >= 0xFFFF) {
+        return false;
+    }
+    poll_is_signaled_.assign(poll_events_.size(), false);
+    for (uint32_t i = 0; i < poll_num_signaled_; ++i) {
+        poll_is_signaled_[poll_signaled_[i]] = true;
+    }
+    poll_unsignaled_.clear();
+    for (uint32_t i = 0; i < poll_events_.size(); ++i) {
+        if (!poll_is_signaled_[i]) {
+            poll_unsignaled_.push_back(poll_events_[i]);
+        }
+    }
+    if (poll_unsignaled_.empty()) {
+        return true;
+    }
+    poll_unsignaled_.push_back(wakeup);
+
+    uint32_t num_signaled = 0;
+    poll_signaled_.resize(poll_unsignaled_.size());
+    HSTR_COIRESULT result = hStreams_HostEvent::wait((uint16_t) poll_unsignaled_.size(), &poll_unsignaled_[0],
+                            HSTR_TIME_INFINITE, false, &num_signaled, &poll_signaled_[0]);
+    return result == HSTR_COI_SUCCESS;
+}
+
+bool hStreams_HostSideSinkWorker::executeInOrder(std::vector<std::unique_ptr<Action> > &actions)
+{
+    for (uint64_t i = 0; i < actions.size(); ++i) {
+        if (!executeAction(*actions[i], false)) {
+            return false;
+        }
+    }
+    recycleActions(actions);
+    return true;
+}
+
+void hStreams_HostSideSinkWorker::runSingle()
+{
+    std::vector<std::unique_ptr<Action> > done;
+    while (true, true) {
+        std::unique_ptr<Action> action(queue_->popFront());
+
+        if (action.get() == NULL) {
+            HSTR_ERROR(HSTR_INFO_TYPE_MISC) << "Host stream worker received an empty action.";
+
+            continue;
+        }
+        if (action->getPriority() != HSTR_STREAM_PRIORITY_NORMAL) {
+            std::vector<std::unique_ptr<Action> > pending;
+            pending.push_back(std::move(action));
+            runPrioritized(pending);
+            if (!executeInOrder(pending)) {
+                return;
+            }
+            continue;
+        }
 
-        while (true, true) {
-            std::unique_ptr<Action> action(worker->queue_->popFront());
+        if (!executeAction(*action, false)) {
+            return;
+        }
+        done.push_back(std::move(action));
+        recycleActions(done);
+    }
+}
 
-            if (action.get() == NULL) {
+void hStreams_HostSideSinkWorker::runOutOfOrder()
+{
+    // The actions not executed yet, oldest first
+    std::vector<std::unique_ptr<Action> > pending;
+    std::vector<std::unique_ptr<Action> > done;
+    std::vector<bool> resolved;
+    while (true, true) {
+        // Only block on the queue if there's nothing else to do
+        uint64_t num_before = pending.size();
+        if (pending.empty()) {
+            queue_->popAll(pending);
+        } else {
+            queue_->tryPopAll(pending);
+        }
+        for (uint64_t i = num_before; i < pending.size(); ++i) {
+            if (pending[i].get() == NULL) {
                 HSTR_ERROR(HSTR_INFO_TYPE_MISC) << "Host stream worker received an empty action.";
+            }
+        }
+        pollInputDeps(pending, resolved);
 
+        // Only the ready actions of the highest priority are executed this
+        // time around, so that the ones enqueued meanwhile are looked at
+        // before going on with the lower priorities
+        HSTR_STREAM_PRIORITY top_priority = HSTR_STREAM_PRIORITY_LOW;
+        for (uint64_t i = 0; i < pending.size(); ++i) {
+            if (pending[i].get() != NULL && resolved[i] && pending[i]->getActionType() != STOP) {
+                top_priority = std::max(top_priority, pending[i]->getPriority());
+            }
+        }
+
+        // Execute whatever is ready, in the order of enqueueing, and compact the rest
+        uint64_t num_kept = 0;
+        for (uint64_t i = 0; i < pending.size(); ++i) {
+            if (pending[i].get() == NULL) {
                 continue;
             }
+            if (pending[i]->getActionType() == STOP) {
+                // Nothing is enqueued after a STOP, it's only acted upon
+                // once all the actions before it have been executed
+                if (num_kept == 0) {
+                    return;
+                }
+                pending[num_kept++] = std::move(pending[i]);
+            } else if (resolved[i] && pending[i]->getPriority() == top_priority) {
+                executeAction(*pending[i], true);
+                done.push_back(std::move(pending[i]));
+            } else {
+                pending[num_kept++] = std::move(pending[i]);
+            }
+        }
+        bool executed_any = !done.empty();
+        pending.resize(num_kept);
+        recycleActions(done);
 
-            if (action->getActionType() == COMPUTE) {
-                std::unique_ptr<ComputePayload> &payload = action->getComputePayload();
+        if (!executed_any && !pending.empty() && pending[0]->getActionType() != STOP) {
+            // Sleep until a dependency completes or an action is enqueued.
+            // Should the dependencies turn out impossible to wait for, fall
+            // back to executing the oldest action as an in-order stream would.
+            HSTR_EVENT wakeup = queue_->armWakeup();
+            uint64_t num_popped = pending.size();
+            queue_->tryPopAll(pending);
+            if (pending.size() == num_popped && !waitForPolledInputDeps(wakeup)) {
+                executeAction(*pending[0], false);
+                done.push_back(std::move(pending[0]));
+                pending.erase(pending.begin());
+                recycleActions(done);
+            }
+        }
+    }
+}
 
-                //Wait for all input_deps
-                HSTR_COIRESULT result = hStreams_COIWrapper::COIEventWait((int16_t) payload->input_deps_.size(),
-                                        &payload->input_deps_[0], -1, true, NULL, NULL);
-                if (result != HSTR_COI_SUCCESS) {
-                    HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
-                            << "Error while waiting on the input dependencies of an action: "
-                            << hStreams_COIWrapper::COIResultGetName(result);
+void hStreams_HostSideSinkWorker::runPrioritized(std::vector<std::unique_ptr<Action> > &pending)
+{
+    // The actions not executed yet, a FIFO per priority, each numbered in
+    // the order of enqueueing so that the oldest of all can be told
+    typedef std::deque<std::pair<uint64_t, std::unique_ptr<Action> > > lane_t;
+    lane_t lanes[HSTR_STREAM_PRIORITY_SIZE];
+    uint64_t next_seq = 0;
+    std::unique_ptr<Action> stop_action;
+    // The oldest action of each of the non-empty lanes, highest priority first
+    std::vector<std::unique_ptr<Action> > heads;
+    std::vector<uint32_t> head_lanes;
+    std::vector<std::unique_ptr<Action> > done;
+    std::vector<bool> resolved;
+    while (true, true) {
+        for (uint64_t i = 0; i < pending.size(); ++i) {
+            if (pending[i].get() == NULL) {
+                HSTR_ERROR(HSTR_INFO_TYPE_MISC) << "Host stream worker received an empty action.";
 
-                    // skip the action
-                    continue;
-                }
+                continue;
+            }
+            if (pending[i]->getActionType() == STOP) {
+                // Nothing is enqueued after a STOP, it's only acted upon
+                // once all the actions before it have been executed
+                stop_action = std::move(pending[i]);
+                continue;
+            }
+            HSTR_STREAM_PRIORITY priority = pending[i]->getPriority();
+            lanes[priority].push_back(std::make_pair(next_seq++, std::move(pending[i])));
+        }
+        pending.clear();
 
-                // Compute
-                // Historically, we never handled any errors from the thunk
-                hStreamsThunk(1, NULL, NULL, &(payload->args_[0]),
-                              (uint16_t)(payload->args_.size()) * sizeof(uint64_t),
-                              payload->ret_val_, payload->ret_val_size_);
-
-                //Signal ret event
-                result = hStreams_COIWrapper::COIEventSignalUserEvent(payload->ret_event_);
-                if (result != HSTR_COI_SUCCESS) {
-                    HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
-                            << "Error while signaling the output event of an action: "
-                            << hStreams_COIWrapper::COIResultGetName(result);
-                }
+        bool prioritized = false;
+        for (uint32_t lane = 0; lane < HSTR_STREAM_PRIORITY_SIZE && !prioritized; ++lane) {
+            prioritized = lane != HSTR_STREAM_PRIORITY_NORMAL && !lanes[lane].empty();
+        }
+        if (!prioritized) {
+            // Only the FIFO order is left to follow, hand the rest back
+            lane_t &normal = lanes[HSTR_STREAM_PRIORITY_NORMAL];
+            for (lane_t::iterator it = normal.begin(); it != normal.end(); ++it) {
+                pending.push_back(std::move(it->second));
+            }
+            if (stop_action) {
+                pending.push_back(std::move(stop_action));
+            }
+            return;
+        }
 
-            } else if (action->getActionType() == STOP) {
-                break;
+        heads.clear();
+        head_lanes.clear();
+        for (int32_t lane = HSTR_STREAM_PRIORITY_SIZE - 1; lane >= 0; --lane) {
+            if (!lanes[lane].empty()) {
+                heads.push_back(std::move(lanes[lane].front().second));
+                head_lanes.push_back(lane);
             }
         }
+        pollInputDeps(heads, resolved);
+
+        int32_t chosen = -1;
+        for (uint32_t i = 0; i < heads.size() && chosen < 0; ++i) {
+            if (resolved[i]) {
+                chosen = i;
+            }
+        }
+        if (chosen < 0) {
+            // Sleep until a dependency completes or an action is enqueued
+            HSTR_EVENT wakeup = queue_->armWakeup();
+            queue_->tryPopAll(pending);
+            if (pending.empty() && !waitForPolledInputDeps(wakeup)) {
+                // Should the dependencies turn out impossible to wait for, fall
+                // back to executing the oldest action as the FIFO order would,
+                // as it can't depend on anything still pending here
+                uint64_t oldest_seq = (uint64_t) - 1;
+                for (uint32_t i = 0; i < heads.size(); ++i) {
+                    if (lanes[head_lanes[i]].front().first < oldest_seq) {
+                        oldest_seq = lanes[head_lanes[i]].front().first;
+                        chosen = i;
+                    }
+                }
+            }
+        }
+        for (uint32_t i = 0; i < heads.size(); ++i) {
+            lane_t &lane = lanes[head_lanes[i]];
+            if ((int32_t) i == chosen) {
+                executeAction(*heads[i], resolved[i]);
+                done.push_back(std::move(heads[i]));
+                lane.pop_front();
+            } else {
+                lane.front().second = std::move(heads[i]);
+            }
+        }
+        recycleActions(done);
+
+        // Whatever has been enqueued meanwhile may take precedence
+        queue_->tryPopAll(pending);
+    }
+}
+
+worker_return_type hStreams_HostSideSinkWorker::workerMainLoop(void *ptr)
+{
+    hStreams_HostSideSinkWorker *worker = (hStreams_HostSideSinkWorker *) ptr;
+    try {
+        worker->worker_status_ = HSTR_RESULT_SUCCESS;
+        set_affinity(worker->cpu_mask_);
+
+        if (worker->out_of_order_) {
+            worker->runOutOfOrder();
+        } else {
+            worker->runSingle();
+        }
     } catch (...) {
         worker->worker_status_ = hStreams_handle_exception();
     }
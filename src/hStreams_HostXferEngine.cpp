@@ -0,0 +1,299 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#include "hStreams_HostXferEngine.h"
+#include "hStreams_HostNuma.h"
+#include "hStreams_helpers_source.h"
+#include "hStreams_internal.h"
+#include "hStreams_internal_vars_source.h"
+#include "hStreams_Logger.h"
+#include "hStreams_WaitPolicy.h"
+
+#include <functional>
+#include <immintrin.h>
+#include <string.h>
+
+namespace
+{
+// Above the size of the last-level cache share of a core, writing the
+// destination through the caches mostly evicts data which is still needed
+const uint64_t default_nt_bytes = 4 * 1024 * 1024;
+// The non-temporal loop moves this many bytes per iteration
+const uint64_t nt_block_bytes = 64;
+
+/// Copy with stores bypassing the caches; the caller issues the fence
+void copyNonTemporal(char *dst, const char *src, uint64_t len)
+{
+    uint64_t head = (16 - ((uintptr_t) dst & 15)) & 15;
+    if (len < head + nt_block_bytes) {
+        memcpy(dst, src, len);
+        return;
+    }
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    len -= head;
+
+    uint64_t body = len & ~(nt_block_bytes - 1);
+    for (uint64_t pos = 0; pos < body; pos += nt_block_bytes) {
+        __m128i r0 = _mm_loadu_si128((const __m128i *)(src + pos));
+        __m128i r1 = _mm_loadu_si128((const __m128i *)(src + pos + 16));
+        __m128i r2 = _mm_loadu_si128((const __m128i *)(src + pos + 32));
+        __m128i r3 = _mm_loadu_si128((const __m128i *)(src + pos + 48));
+        _mm_stream_si128((__m128i *)(dst + pos), r0);
+        _mm_stream_si128((__m128i *)(dst + pos + 16), r1);
+        _mm_stream_si128((__m128i *)(dst + pos + 32), r2);
+        _mm_stream_si128((__m128i *)(dst + pos + 48), r3);
+    }
+    memcpy(dst + body, src + body, len - body);
+}
+
+void copyBlock(char *dst, const char *src, uint64_t len, bool non_temporal)
+{
+    if (non_temporal) {
+        copyNonTemporal(dst, src, len);
+    } else {
+        memcpy(dst, src, len);
+    }
+}
+} // anonymous namespace
+
+hStreams_HostXferEngine::hStreams_HostXferEngine(hStreams_CPUMask const &cpu_mask)
+    : max_threads_(1),
+      nt_bytes_(hStreams_GetEnvNumber(host_xfer_nt_bytes_env_name, default_nt_bytes)),
+      helpers_started_(false),
+      regions_(NULL),
+      num_regions_(0),
+      total_bytes_(0),
+      num_parts_(0),
+      non_temporal_(false),
+      job_seq_(0),
+      stopping_(false),
+      parts_left_(0)
+{
+    for (uint32_t cpu = 0; cpu < sizeof(HSTR_CPU_MASK) * 8; ++cpu) {
+        if (HSTR_CPU_MASK_ISSET(cpu, cpu_mask.mask)) {
+            cpus_.push_back(cpu);
+        }
+    }
+    uint64_t num_cpus = std::max<uint64_t>(cpus_.size(), 1);
+    uint64_t max_threads = hStreams_GetEnvNumber(host_xfer_threads_env_name, num_cpus);
+    if (max_threads == 0) {
+        HSTR_WARN(HSTR_INFO_TYPE_MISC)
+                << host_xfer_threads_env_name << " must be at least 1. Using " << num_cpus << ".";
+        max_threads = num_cpus;
+    }
+    max_threads_ = (uint32_t) std::min(max_threads, num_cpus);
+}
+
+hStreams_HostXferEngine::~hStreams_HostXferEngine()
+{
+    if (helpers_.empty()) {
+        return;
+    }
+    // This is destructor, we need to handle the exception gracefully
+    try {
+        {
+            hStreams_Scope_Locker_Unlocker autolock(lock_);
+            stopping_.store(true, std::memory_order_relaxed);
+            job_seq_.fetch_add(1, std::memory_order_release);
+            for (uint32_t i = 0; i < helpers_.size(); ++i) {
+                helpers_[i]->cond_var_.signal();
+            }
+        }
+        for (uint32_t i = 0; i < helpers_.size(); ++i) {
+            helpers_[i]->thread_->join();
+        }
+    } catch (...) {
+        hStreams_handle_exception();
+    }
+}
+
+void hStreams_HostXferEngine::startHelpers()
+{
+    helpers_started_ = true;
+    for (uint32_t part = 1; part < max_threads_; ++part) {
+        std::unique_ptr<Helper> helper(new Helper());
+        helper->engine_ = this;
+        helper->part_ = part;
+        helper->cpu_ = cpus_[part];
+        helper->seen_seq_ = job_seq_.load(std::memory_order_relaxed);
+        try {
+            helper->thread_.reset(new hStreams_Thread(&hStreams_HostXferEngine::helperMainLoop, helper.get()));
+        } catch (...) {
+            HSTR_WARN(HSTR_INFO_TYPE_MISC)
+                    << "Could not start a host transfer thread, copies will use "
+                    << helpers_.size() + 1 << " threads";
+            break;
+        }
+        helpers_.push_back(std::move(helper));
+    }
+    HSTR_DEBUG1(HSTR_INFO_TYPE_MISC)
+            << "Host transfers use " << helpers_.size() + 1 << " threads, non-temporal stores from "
+            << nt_bytes_ << " bytes on";
+}
+
+void hStreams_HostXferEngine::copy(TransferRegion const *regions, uint64_t num_regions)
+{
+    uint64_t total_bytes = 0;
+    for (uint64_t idx = 0; idx < num_regions; ++idx) {
+        total_bytes += regions[idx].shape_.totalBytes();
+    }
+    if (total_bytes == 0) {
+        return;
+    }
+
+    regions_ = regions;
+    num_regions_ = num_regions;
+    total_bytes_ = total_bytes;
+    non_temporal_ = nt_bytes_ != 0 && total_bytes >= nt_bytes_;
+
+    uint64_t wanted_parts = total_bytes / min_part_bytes;
+    if (wanted_parts > 1 && max_threads_ > 1 && !helpers_started_) {
+        startHelpers();
+    }
+    num_parts_ = (uint32_t) std::max<uint64_t>(std::min<uint64_t>(wanted_parts, helpers_.size() + 1), 1);
+    if (num_parts_ == 1) {
+        copyPart(0, total_bytes);
+        return;
+    }
+
+    // Each of the helpers checks in, including the ones without a part of
+    // their own, so that none of them looks at the job once it's over
+    parts_left_.store((uint32_t) helpers_.size(), std::memory_order_relaxed);
+    {
+        hStreams_Scope_Locker_Unlocker autolock(lock_);
+        job_seq_.fetch_add(1, std::memory_order_release);
+        for (uint32_t i = 0; i < helpers_.size(); ++i) {
+            helpers_[i]->cond_var_.signal();
+        }
+    }
+
+    uint64_t begin, end;
+    partBounds(0, begin, end);
+    copyPart(begin, end);
+
+    if (hStreams_WaitPolicy::spinThenYield(std::bind(&hStreams_HostXferEngine::allPartsDone, this))
+            == HSTR_WAIT_PHASE_PARK) {
+        hStreams_Scope_Locker_Unlocker autolock(lock_);
+        done_cond_var_.wait(lock_, std::bind(&hStreams_HostXferEngine::partsPending_locked, this));
+    }
+}
+
+void hStreams_HostXferEngine::partBounds(uint32_t part, uint64_t &begin, uint64_t &end) const
+{
+    // Parts start on cache line boundaries of the copied bytes, the last one
+    // takes whatever is left
+    uint64_t part_bytes = (total_bytes_ / num_parts_) & ~(uint64_t)(HSTR_CACHE_LINE_SIZE - 1);
+    begin = part * part_bytes;
+    end = (part + 1 == num_parts_) ? total_bytes_ : begin + part_bytes;
+}
+
+void hStreams_HostXferEngine::copyPart(uint64_t begin, uint64_t end) const
+{
+    uint64_t region_begin = 0;
+    for (uint64_t idx = 0; idx < num_regions_ && region_begin < end; ++idx) {
+        TransferRegion const &region = regions_[idx];
+        hStreams_XferShape const &shape = region.shape_;
+        uint64_t region_end = region_begin + shape.totalBytes();
+        if (region_end <= begin) {
+            region_begin = region_end;
+            continue;
+        }
+        uint64_t first = std::max(begin, region_begin) - region_begin;
+        uint64_t last = std::min(end, region_end) - region_begin;
+        if (shape.isContiguous()) {
+            copyBlock((char *) region.dst_ + first, (const char *) region.src_ + first,
+                      last - first, non_temporal_);
+        } else {
+            // Parts may start and end in the middle of a row
+            for (uint64_t pos = first; pos < last;) {
+                uint64_t row = pos / shape.width;
+                uint64_t col = pos % shape.width;
+                uint64_t len = std::min(shape.width - col, last - pos);
+                copyBlock((char *) region.dst_ + shape.dstRowOffset(row) + col,
+                          (const char *) region.src_ + shape.srcRowOffset(row) + col,
+                          len, non_temporal_);
+                pos += len;
+            }
+        }
+        region_begin = region_end;
+    }
+    if (non_temporal_) {
+        // The streaming stores have to be visible before the completion is
+        _mm_sfence();
+    }
+}
+
+void hStreams_HostXferEngine::runHelperPart(Helper &helper)
+{
+    if (helper.part_ < num_parts_) {
+        uint64_t begin, end;
+        partBounds(helper.part_, begin, end);
+        copyPart(begin, end);
+    }
+    if (parts_left_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        hStreams_Scope_Locker_Unlocker autolock(lock_);
+        done_cond_var_.signal();
+    }
+}
+
+bool hStreams_HostXferEngine::hasNewJob(Helper *helper) const
+{
+    return job_seq_.load(std::memory_order_acquire) != helper->seen_seq_;
+}
+
+bool hStreams_HostXferEngine::noNewJob_locked(Helper *helper) const
+{
+    return !hasNewJob(helper);
+}
+
+bool hStreams_HostXferEngine::partsPending_locked() const
+{
+    return !allPartsDone();
+}
+
+bool hStreams_HostXferEngine::allPartsDone() const
+{
+    return parts_left_.load(std::memory_order_acquire) == 0;
+}
+
+worker_return_type hStreams_HostXferEngine::helperMainLoop(void *ptr)
+{
+    Helper *helper = (Helper *) ptr;
+    hStreams_HostXferEngine *engine = helper->engine_;
+    try {
+        hStreams_HostNuma::pinCurrentThread(helper->cpu_, "host transfer");
+        for (;;) {
+            if (hStreams_WaitPolicy::spinThenYield(std::bind(&hStreams_HostXferEngine::hasNewJob, engine, helper))
+                    == HSTR_WAIT_PHASE_PARK) {
+                hStreams_Scope_Locker_Unlocker autolock(engine->lock_);
+                helper->cond_var_.wait(engine->lock_, std::bind(&hStreams_HostXferEngine::noNewJob_locked,
+                                       engine, helper));
+            }
+            helper->seen_seq_ = engine->job_seq_.load(std::memory_order_acquire);
+            if (engine->stopping_.load(std::memory_order_relaxed)) {
+                break;
+            }
+            engine->runHelperPart(*helper);
+        }
+    } catch (...) {
+        hStreams_handle_exception();
+    }
+#ifndef _WIN32
+    pthread_exit(NULL);
+#else
+    return 0;
+#endif // _WIN32
+}
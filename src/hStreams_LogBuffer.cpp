@@ -224,39 +224,53 @@ HSTR_RESULT hStreams_LogBuffer::attachExistingLogDomain(const hStreams_LogDomain
     if (phys_buffers_.end() != it) {
         return HSTR_RESULT_ALREADY_FOUND;
     }
+    hStreams_PhysDomain &phys_dom = log_dom.getPhysDomain();
+
     // First check whether the buffer's an aliasing one. If yes, search for
     // another physbuffer in the logdomain's physdomain and attach to that.
-    if (isPropertyFlagSet(HSTR_BUF_PROP_ALIASED)) {
+    // On the host, that's the source instance, which is always attached first.
+    if (isPropertyFlagSet(HSTR_BUF_PROP_ALIASED) ||
+            (isPropertyFlagSet(HSTR_BUF_PROP_HOST_ALIASED) && phys_dom.id() == HSTR_SRC_PHYS_DOMAIN)) {
         if (tryAttachToAliasingBuffer(log_dom)) {
             return HSTR_RESULT_SUCCESS;
         }
     }
 
-    hStreams_PhysDomain &phys_dom = log_dom.getPhysDomain();
-
     HSTR_COIBUFFER coi_buf;
     hStreams_PhysBuffer *new_buffer;
     if (log_dom.id() == HSTR_SRC_LOG_DOMAIN) {
-        CHECK_HSTR_RESULT(createSourceCOIBUFFER(*this, start_, len_, phys_dom.getCOIProcess(), &coi_buf));
-        new_buffer = new hStreams_PhysBuffer(*this, coi_buf, start_, 0); // source log domain with offset 0
+        if (hstr_proc.hostOnly) {
+            // No COI process to associate the buffer with, nor a need to
+            coi_buf = NULL;
+        } else {
+            CHECK_HSTR_RESULT(createSourceCOIBUFFER(*this, start_, len_, phys_dom.getCOIProcess(), &coi_buf));
+        }
+        new_buffer = new hStreams_PhysBuffer(*this, coi_buf, start_, 0, true); // source log domain with offset 0
     } else if (phys_dom.id() == HSTR_SRC_PHYS_DOMAIN) {
         void *mem = NULL;
         uint64_t compensated_len = len_ + offset_;
+        int32_t numa_node;
 
-        mem = hStreams_MemAlignedAllocator::alloc(compensated_len);
+        // Closest to the CPUs the domain's streams run on, which mostly
+        // access the buffer, whoever allocates it
+        mem = hStreams_MemAlignedAllocator::allocNear(compensated_len, log_dom.getCPUMask(), numa_node);
 
         if (mem == NULL) {
             return HSTR_RESULT_OUT_OF_MEMORY;
         }
 
-        CHECK_HSTR_RESULT(createHostSideCOIBUFFER(mem, compensated_len, phys_dom.getCOIProcess(), &coi_buf));
+        if (hstr_proc.hostOnly) {
+            coi_buf = NULL;
+        } else {
+            CHECK_HSTR_RESULT(createHostSideCOIBUFFER(mem, compensated_len, phys_dom.getCOIProcess(), &coi_buf));
+        }
 
         std::unique_ptr<void, void(*)(void *)> data_ptr(mem, hStreams_MemAlignedAllocator::dealloc);
-        new_buffer = new hStreams_PhysBufferHost(*this, coi_buf, std::move(data_ptr), offset_);
+        new_buffer = new hStreams_PhysBufferHost(*this, coi_buf, std::move(data_ptr), offset_, numa_node);
     } else {
         uint64_t sink_addr;
         CHECK_HSTR_RESULT(createSinkCOIBUFFER(len_ + offset_, phys_dom.getCOIProcess(), &sink_addr, &coi_buf));
-        new_buffer = new hStreams_PhysBuffer(*this, coi_buf, sink_addr, offset_);
+        new_buffer = new hStreams_PhysBuffer(*this, coi_buf, sink_addr, offset_, false);
     }
     phys_buffers_[&log_dom] = new_buffer;
     return HSTR_RESULT_SUCCESS;
@@ -14,6 +14,8 @@
 
 #include "hStreams_LogBufferCollection.h"
 #include "hStreams_LogBuffer.h"
+#include "hStreams_internal.h"
+#include <atomic>
 #include <utility>
 #include <algorithm>
 #include <iostream>
@@ -41,131 +43,99 @@ hStreams_LogBufferCollection::iterator hStreams_LogBufferCollection::end()
 void hStreams_LogBufferCollection::addToCollection(hStreams_LogBuffer *new_buf)
 {
     container_.insert(std::make_pair(new_buf->getStart(), new_buf));
+    published_.publish(container_);
 }
 
 void hStreams_LogBufferCollection::delFromCollection(hStreams_LogBuffer &buf)
 {
     container_.erase(buf.getStart());
+    published_.publish(container_);
 }
 
-// Check whether addr falls within left-closed, right-open range [start, start+len)
-static bool addr_in_ropen_range(void *start, uint64_t len, void *addr)
+namespace
+{
+// Generation of the next lookup table to be built. Starts from 1 so that the
+// zero-initialized hints below don't match any table.
+std::atomic<uint64_t> next_lookup_table_generation(1);
+
+// The table generation and the index of the buffer last found by this thread
+HSTR_THREAD_LOCAL uint64_t hint_generation;
+HSTR_THREAD_LOCAL uint64_t hint_index;
+}
+
+hStreams_LogBufferCollection::LookupTable::LookupTable()
+    : generation_(next_lookup_table_generation++)
+{
+}
+
+hStreams_LogBufferCollection::LookupTable::LookupTable(Container const &buffers)
+    : generation_(next_lookup_table_generation++)
+{
+    starts_.reserve(buffers.size());
+    ends_.reserve(buffers.size());
+    buffers_.reserve(buffers.size());
+    fences_.reserve((buffers.size() + block_size - 1) / block_size);
+    // The map is already sorted by the start address
+    for (Container::const_iterator it = buffers.begin(); it != buffers.end(); ++it) {
+        if (starts_.size() % block_size == 0) {
+            fences_.push_back((uint64_t) it->first);
+        }
+        starts_.push_back((uint64_t) it->first);
+        ends_.push_back((uint64_t) it->first + it->second->getLen());
+        buffers_.push_back(it->second);
+    }
+}
+
+uint64_t hStreams_LogBufferCollection::LookupTable::countStartsNotAbove(uint64_t addr) const
 {
-    return (addr >= start) && (addr < (void *)((uint64_t)start + len));
+    // The first block whose fence is above addr, and all the ones after it,
+    // start above addr; so only the block before it needs to be scanned
+    uint64_t block = std::upper_bound(fences_.begin(), fences_.end(), addr) - fences_.begin();
+    if (block == 0) {
+        return 0;
+    }
+    uint64_t idx = (block - 1) * block_size + 1;
+    uint64_t block_end = std::min(block * block_size, (uint64_t) starts_.size());
+    while (idx < block_end && starts_[idx] <= addr) {
+        ++idx;
+    }
+    return idx;
 }
 
 hStreams_LogBuffer *hStreams_LogBufferCollection::lookupLogBuffer(void *addr, uint64_t len, HSTR_OVERLAP_TYPE *overlap)
 {
-    if (0 == len || container_.empty()) {
+    LookupTable const &table = published_.get();
+    if (0 == len || 0 == table.size()) {
         *overlap = HSTR_NO_OVERLAP;
         return NULL;
     }
-    // A brief explanation of this logic as it is dense.  We only need to consider lower_bound
-    // or its immediate predecessor because of the following:
-    //
-    // map::lower_bound returns the iterator that is immediately less than
-    // or, exactly matches the specified address.  If no node exists that is less than
-    // or equal to the address, map::lower_bound return map::end.
-    //
-    // A. if map::lower_bound() provides an iterator, such that it->first == in_Address, we have
-    // obviously found the map entry.
-    //
-    // B. Sometimes, however an in_Address value is specified that does not exactly match the
-    // key value (it->first) but resides within the memory range of a node in the map.  When this
-    // occurs, map::lower_bound will return the node that comes immediately after this node.
-    //
-    // C. if there are no nodes in the tree that are less than or equal to address,
-    // map::lower_bound, returns map::end.
-    //
-    // D. if the given address precedes all of the nodes in the map, map::lower_bound returns
-    // begin().
-    //
-    // An example is good here:
-    //
-    // Suppose there are only two nodes in the map:
-    //
-    // Entry    |               |
-    // Number:  | Address (key) | length
-    // ---------+---------------+----------
-    // 1 begin()|    0x1000     | 0x1000
-    // 2        |    0x3000     | 0x1000
-    // end()    |     NA        |   NA
-    // ---------+---------------+----------
-    //
-    // Let entry number end() correspond to map::end.
-    //
-    // And, suppose we query the following address values with map::lower_bound.
-    // map::lower_bound returns the following entry numbers in the map due to the specified
-    // reason A, B, C or D:
-    //
-    // Address: | Entry Number: | Reason:
-    // ---------+---------------+----------
-    // 0x1000  |      1        |   A
-    // 0x3000  |      2        |   A
-    // 0x2000  |      2        |   B
-    // 0x3010  |     end()     |   B
-    // 0x4010  |     end()     |   C
-    // 0x10    |      1        |   D
-
-    void *right_end = (void *)((uint64_t)addr + len - 1);
-
-    Container::iterator itlow = container_.lower_bound(addr);
-    if (container_.end() == itlow) {
-        // Check whether the last element in the container overlaps the queried range
-        Container::iterator prev = itlow;
-        --prev;
-        if (addr_in_ropen_range(prev->second->getStart(), prev->second->getLen(), addr)) {
-            if (addr_in_ropen_range(prev->second->getStart(), prev->second->getLen(), right_end)) {
-                *overlap = HSTR_EXACT_OVERLAP;
-                return prev->second;
-            } else {
-                *overlap = HSTR_PARTIAL_OVERLAP;
-                return NULL;
-            }
-        } else {
-            *overlap = HSTR_NO_OVERLAP;
-            return NULL;
-        }
+    uint64_t left_end = (uint64_t) addr;
+    uint64_t right_end = left_end + len - 1;
+
+    // Fast path: the queried range lies within the buffer this thread found last
+    if (hint_generation == table.generation()
+            && table.start(hint_index) <= left_end && right_end < table.end(hint_index)) {
+        *overlap = HSTR_EXACT_OVERLAP;
+        return table.buffer(hint_index);
     }
 
-
-    // we've found a buffer whose start address is _not lower_ than addr
-    // First, special case when the start addresses are equal:
-    if (addr == itlow->second->getStart()) {
-        // Need to check the right end of the queried range, whether it fits in the one we found
-        // Note that the right end does not count into the buffer, so we use -1
-        if (addr_in_ropen_range(itlow->second->getStart(), itlow->second->getLen(), right_end)) {
+    // The buffers don't overlap each other, so only the last one starting at
+    // or below addr may contain addr. The next one may only overlap the
+    // queried range partially.
+    uint64_t count = table.countStartsNotAbove(left_end);
+    if (count > 0 && left_end < table.end(count - 1)) {
+        if (right_end < table.end(count - 1)) {
+            hint_generation = table.generation();
+            hint_index = count - 1;
             *overlap = HSTR_EXACT_OVERLAP;
-            return itlow->second;
-        } else {
-            *overlap = HSTR_PARTIAL_OVERLAP;
-            return NULL;
+            return table.buffer(count - 1);
         }
-    }
-
-    // By now, we know that itlow points to a buffer whose start address is higher
-    // than the queried start address. Need to check whether the upper end of the queried range
-    // falls inside that "next" buffer.
-    if (addr_in_ropen_range(itlow->second->getStart(), itlow->second->getLen(), right_end)) {
         *overlap = HSTR_PARTIAL_OVERLAP;
         return NULL;
     }
-
-    // Unless we're at the beginning of the container, we also have to check
-    // whether the previous range in the container overlaps this buffer
-    // (similar to what has been done for end() special case above and whethre
-    // the previous one fully contains the requested range or not
-    if (container_.begin() != itlow) {
-        --itlow;
-        if (addr_in_ropen_range(itlow->second->getStart(), itlow->second->getLen(), addr)) {
-            if (addr_in_ropen_range(itlow->second->getStart(), itlow->second->getLen(), right_end)) {
-                *overlap = HSTR_EXACT_OVERLAP;
-                return itlow->second;
-            } else {
-                *overlap = HSTR_PARTIAL_OVERLAP;
-                return NULL;
-            }
-        }
+    if (count < table.size() && table.start(count) <= right_end) {
+        *overlap = HSTR_PARTIAL_OVERLAP;
+        return NULL;
     }
 
     // By here, the queried range does not overlap any range already present in the container
@@ -198,15 +168,18 @@ public:
 
 void hStreams_LogBufferCollection::destroyAllBuffers()
 {
-    std::for_each(container_.begin(), container_.end(), DeleteLogBufferFunctor());
-    container_.clear();
+    Container doomed;
+    doomed.swap(container_);
+    published_.publish(container_);
+    std::for_each(doomed.begin(), doomed.end(), DeleteLogBufferFunctor());
 }
 
 void hStreams_LogBufferCollection::getAllPhysBuffersForLogDomain(hStreams_LogDomain &log_dom, std::vector<hStreams_PhysBuffer *> &phys_buffers)
 {
     phys_buffers.clear();
-    for (Container::iterator it = container_.begin(); it != container_.end(); ++it) {
-        hStreams_PhysBuffer *phys_buf = it->second->getPhysBufferForLogDomain(log_dom);
+    LookupTable const &table = published_.get();
+    for (uint64_t idx = 0; idx < table.size(); ++idx) {
+        hStreams_PhysBuffer *phys_buf = table.buffer(idx)->getPhysBufferForLogDomain(log_dom);
         if (NULL != phys_buf) {
             phys_buffers.push_back(phys_buf);
         }
@@ -38,37 +38,40 @@ hStreams_LogDomainCollection::iterator hStreams_LogDomainCollection::end()
 void hStreams_LogDomainCollection::addToCollection(hStreams_LogDomain *log_dom)
 {
     container_.push_back(log_dom);
+    published_.publish(container_);
 }
 
 void hStreams_LogDomainCollection::delFromCollection(hStreams_LogDomain &log_dom)
 {
-    Container::iterator it = getIteratorByID(log_dom.id());
+    Container::const_iterator it = getIteratorByID(container_, log_dom.id());
     if (it == container_.end()) {
         // in DEBUG, log the issue/fail hard?
         return;
     }
-    container_.erase(it);
+    container_.erase(container_.begin() + (it - container_.begin()));
+    published_.publish(container_);
 }
 
 hStreams_LogDomain *hStreams_LogDomainCollection::lookupByLogDomainID(HSTR_LOG_DOM id)
 {
-    Container::iterator it = getIteratorByID(id);
-    if (it == container_.end()) {
+    Container const &domains = published_.get();
+    Container::const_iterator it = getIteratorByID(domains, id);
+    if (it == domains.end()) {
         return NULL;
     }
     return *it;
 }
 
-hStreams_LogDomainCollection::Container::iterator
-hStreams_LogDomainCollection::getIteratorByID(HSTR_LOG_DOM id)
+hStreams_LogDomainCollection::Container::const_iterator
+hStreams_LogDomainCollection::getIteratorByID(Container const &container, HSTR_LOG_DOM id)
 {
-    hStreams_LogDomainCollection::Container::iterator ret;
-    for (ret = container_.begin(); ret != container_.end(); ++ret) {
+    hStreams_LogDomainCollection::Container::const_iterator ret;
+    for (ret = container.begin(); ret != container.end(); ++ret) {
         if ((*ret)->id() == id) {
             return ret;
         }
     }
-    return container_.end();
+    return container.end();
 }
 
 class DeleteLogDomainFunctor
@@ -82,6 +85,8 @@ public:
 
 void hStreams_LogDomainCollection::destroyAllDomains()
 {
-    std::for_each(container_.begin(), container_.end(), DeleteLogDomainFunctor());
-    container_.clear();
+    Container doomed;
+    doomed.swap(container_);
+    published_.publish(container_);
+    std::for_each(doomed.begin(), doomed.end(), DeleteLogDomainFunctor());
 }
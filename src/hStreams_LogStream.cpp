@@ -13,6 +13,12 @@
  */
 
 #include "hStreams_LogStream.h"
+#include "hStreams_Graph.h"
+
+namespace
+{
+std::atomic<uint64_t> next_serial(1);
+}
 
 HSTR_LOG_STR hStreams_LogStream::id() const
 {
@@ -35,13 +41,16 @@ hStreams_PhysStream &hStreams_LogStream::getPhysStream()
 }
 
 hStreams_LogStream::hStreams_LogStream(HSTR_LOG_STR id, hStreams_CPUMask const &my_cpu_mask, hStreams_LogDomain &log_dom, hStreams_PhysStream &phys_stream)
-    : id_(id), cpu_mask_(my_cpu_mask), log_dom_(&log_dom), phys_stream_(&phys_stream)
+    : id_(id), cpu_mask_(my_cpu_mask), log_dom_(&log_dom), phys_stream_(&phys_stream),
+      serial_(next_serial++), capture_(NULL), priority_(HSTR_STREAM_PRIORITY_NORMAL)
 {
     phys_stream_->attach();
 }
 
 hStreams_LogStream::~hStreams_LogStream()
 {
+    // An unfinished capture can't be launched anyway
+    delete capture_.load();
     phys_stream_->detach();
 }
 
@@ -49,3 +58,34 @@ void hStreams_LogStream::getAllEvents(std::vector<HSTR_EVENT> &events)
 {
     phys_stream_->getAllEvents(events);
 }
+
+uint64_t hStreams_LogStream::serial() const
+{
+    return serial_;
+}
+
+bool hStreams_LogStream::beginCapture(hStreams_Graph *graph)
+{
+    hStreams_Graph *expected = NULL;
+    return capture_.compare_exchange_strong(expected, graph);
+}
+
+hStreams_Graph *hStreams_LogStream::endCapture()
+{
+    return capture_.exchange(NULL);
+}
+
+hStreams_Graph *hStreams_LogStream::getCapture()
+{
+    return capture_.load();
+}
+
+HSTR_STREAM_PRIORITY hStreams_LogStream::getPriority() const
+{
+    return priority_.load();
+}
+
+void hStreams_LogStream::setPriority(HSTR_STREAM_PRIORITY priority)
+{
+    priority_.store(priority);
+}
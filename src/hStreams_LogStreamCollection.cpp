@@ -30,37 +30,35 @@ hStreams_LogStreamCollection::~hStreams_LogStreamCollection()
 void hStreams_LogStreamCollection::addToCollection(hStreams_LogStream *log_dom)
 {
     container_.push_back(log_dom);
+    published_.publish(container_);
 }
 
 void hStreams_LogStreamCollection::delFromCollection(hStreams_LogStream &log_dom)
 {
-    Container::iterator it = getIteratorByID(log_dom.id());
+    Container::const_iterator it = getIteratorByID(container_, log_dom.id());
     if (it == container_.end()) {
         // in DEBUG, log the issue/fail hard?
         return;
     }
-    container_.erase(it);
+    container_.erase(container_.begin() + (it - container_.begin()));
+    published_.publish(container_);
 }
 
 hStreams_LogStream *hStreams_LogStreamCollection::lookupByLogStreamID(HSTR_LOG_STR id)
 {
-    Container::iterator it = getIteratorByID(id);
-    if (it == container_.end()) {
-        return NULL;
-    }
-    return *it;
+    return published_.get().lookup(id);
 }
 
-hStreams_LogStreamCollection::Container::iterator
-hStreams_LogStreamCollection::getIteratorByID(HSTR_LOG_STR id)
+hStreams_LogStreamCollection::Container::const_iterator
+hStreams_LogStreamCollection::getIteratorByID(Container const &container, HSTR_LOG_STR id)
 {
-    hStreams_LogStreamCollection::Container::iterator ret;
-    for (ret = container_.begin(); ret != container_.end(); ++ret) {
+    hStreams_LogStreamCollection::Container::const_iterator ret;
+    for (ret = container.begin(); ret != container.end(); ++ret) {
         if ((*ret)->id() == id) {
             return ret;
         }
     }
-    return container_.end();
+    return container.end();
 }
 
 class BelongsToLogDomainFunctor
@@ -83,20 +81,92 @@ void hStreams_LogStreamCollection::delFromCollectionByLogDomain(hStreams_LogDoma
             container_.end(),
             BelongsToLogDomainFunctor(log_dom)),
         container_.end());
+    published_.publish(container_);
 }
 
 void hStreams_LogStreamCollection::getEventsFromAllStreams(std::vector<HSTR_EVENT> &events)
 {
     events.clear();
-    events.reserve(container_.size());
+    Container const &streams = published_.get().streams();
+    events.reserve(streams.size());
 
     std::vector<HSTR_EVENT> tmp_event_vector;
-    for (Container::iterator it = container_.begin(); it != container_.end(); ++it) {
+    for (Container::const_iterator it = streams.begin(); it != streams.end(); ++it) {
         (*it)->getAllEvents(tmp_event_vector);
         events.insert(events.end(), tmp_event_vector.begin(), tmp_event_vector.end());
     }
 }
 
+hStreams_LogStreamCollection::LookupTable::LookupTable()
+{
+}
+
+hStreams_LogStreamCollection::LookupTable::LookupTable(Container const &streams)
+    : streams_(streams)
+{
+    // IDs below this limit go into the dense table. It is proportional to the
+    // number of streams so that the table's memory footprint is as well.
+    const HSTR_LOG_STR dense_limit = 16 + 2 * (HSTR_LOG_STR) streams.size();
+
+    HSTR_LOG_STR max_dense_id = 0;
+    uint64_t num_hashed = 0;
+    for (Container::const_iterator it = streams.begin(); it != streams.end(); ++it) {
+        if ((*it)->id() < dense_limit) {
+            max_dense_id = std::max(max_dense_id, (*it)->id());
+        } else {
+            ++num_hashed;
+        }
+    }
+    if (num_hashed < streams.size()) {
+        dense_.assign(max_dense_id + 1, NULL);
+    }
+    if (num_hashed > 0) {
+        uint64_t num_slots = 2;
+        while (num_slots < 2 * num_hashed) {
+            num_slots *= 2;
+        }
+        hashed_.assign(num_slots, NULL);
+    }
+
+    for (Container::const_iterator it = streams.begin(); it != streams.end(); ++it) {
+        HSTR_LOG_STR id = (*it)->id();
+        if (id < dense_limit) {
+            dense_[id] = *it;
+            continue;
+        }
+        uint64_t slot = hashSlot(id, hashed_.size());
+        while (hashed_[slot] != NULL) {
+            slot = (slot + 1) & (hashed_.size() - 1);
+        }
+        hashed_[slot] = *it;
+    }
+}
+
+hStreams_LogStream *hStreams_LogStreamCollection::LookupTable::lookup(HSTR_LOG_STR id) const
+{
+    if (id < dense_.size()) {
+        return dense_[id];
+    }
+    if (hashed_.empty()) {
+        return NULL;
+    }
+    // The table is at most half full, so the probing ends on an empty slot
+    for (uint64_t slot = hashSlot(id, hashed_.size()); hashed_[slot] != NULL;
+            slot = (slot + 1) & (hashed_.size() - 1)) {
+        if (hashed_[slot]->id() == id) {
+            return hashed_[slot];
+        }
+    }
+    return NULL;
+}
+
+uint64_t hStreams_LogStreamCollection::LookupTable::hashSlot(HSTR_LOG_STR id, uint64_t num_slots)
+{
+    // Fibonacci hashing: spreads IDs which differ only in their high bits, or
+    // by a constant stride, over the whole table
+    return (id * 0x9E3779B97F4A7C15ULL >> 32) & (num_slots - 1);
+}
+
 class DeleteLogStreamFunctor
 {
 public:
@@ -108,6 +178,8 @@ public:
 
 void hStreams_LogStreamCollection::destroyAllStreams()
 {
-    std::for_each(container_.begin(), container_.end(), DeleteLogStreamFunctor());
-    container_.clear();
+    Container doomed;
+    doomed.swap(container_);
+    published_.publish(container_);
+    std::for_each(doomed.begin(), doomed.end(), DeleteLogStreamFunctor());
 }
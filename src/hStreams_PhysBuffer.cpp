@@ -15,10 +15,13 @@
 #include "hStreams_PhysBuffer.h"
 #include "hStreams_internal.h"
 #include "hStreams_internal_vars_source.h"
+#include "hStreams_exceptions.h"
 #include "hStreams_Logger.h"
 #include "hStreams_LogBuffer.h"
+#include "hStreams_HostCallbacks.h"
+#include "hStreams_HostEvent.h"
 
-#include <algorithm>
+#include <functional>
 
 uint64_t hStreams_PhysBuffer::getPadding() const
 {
@@ -30,31 +33,33 @@ uint64_t hStreams_PhysBuffer::translateToSinkAddress(uint64_t host_offset) const
     return sink_start_addr_ + padding_ + host_offset;
 }
 
-hStreams_PhysBuffer::hStreams_PhysBuffer(const hStreams_LogBuffer &log_buf, HSTR_COIBUFFER coi_buf, uint64_t sink_start_addr, uint64_t padding)
-    : log_buf_(&log_buf), coi_buf_(coi_buf), padding_(padding), sink_start_addr_(sink_start_addr), action_cleanup_counter_(0)
+hStreams_PhysBuffer::hStreams_PhysBuffer(const hStreams_LogBuffer &log_buf, HSTR_COIBUFFER coi_buf, uint64_t sink_start_addr, uint64_t padding,
+        bool in_host_memory)
+    : submitted_seq_(0), retired_seq_(0),
+      log_buf_(&log_buf), coi_buf_(coi_buf), padding_(padding), sink_start_addr_(sink_start_addr),
+      in_host_memory_(in_host_memory)
 {
 
 }
 
-hStreams_PhysBuffer::hStreams_PhysBuffer(const hStreams_LogBuffer &log_buf, HSTR_COIBUFFER coi_buf, void *sink_start_addr, uint64_t padding)
-    : log_buf_(&log_buf), coi_buf_(coi_buf), padding_(padding), sink_start_addr_((uint64_t)sink_start_addr), action_cleanup_counter_(0)
+hStreams_PhysBuffer::hStreams_PhysBuffer(const hStreams_LogBuffer &log_buf, HSTR_COIBUFFER coi_buf, void *sink_start_addr, uint64_t padding,
+        bool in_host_memory)
+    : submitted_seq_(0), retired_seq_(0),
+      log_buf_(&log_buf), coi_buf_(coi_buf), padding_(padding), sink_start_addr_((uint64_t)sink_start_addr),
+      in_host_memory_(in_host_memory)
 {
 
 }
 
 hStreams_PhysBuffer::~hStreams_PhysBuffer()
 {
-    HSTR_COIRESULT coi_res;
-    if (!pending_actions_.empty()) {
-        coi_res = hStreams_COIWrapper::COIEventWait((uint16_t) pending_actions_.size(), &pending_actions_[0], -1, true, NULL, NULL);
-        if (HSTR_COI_SUCCESS != coi_res) {
-            HSTR_WARN(HSTR_INFO_TYPE_SYNC)
-                    << "Couldn't perform wait for pending actions while destroying buffer: "
-                    << hStreams_COIWrapper::COIResultGetName(coi_res);
-        }
-    }
+    waitForPendingActions();
 
-    coi_res = hStreams_COIWrapper::COIBufferDestroy(coi_buf_);
+    if (coi_buf_ == NULL) {
+        // Host-only buffer, not backed by COI
+        return;
+    }
+    HSTR_COIRESULT coi_res = hStreams_COIWrapper::COIBufferDestroy(coi_buf_);
     if (HSTR_COI_SUCCESS != coi_res) {
         HSTR_WARN(HSTR_INFO_TYPE_MEM)
                 << "Couldn't destroy buffer [" << log_buf_->getStart() << "]: "
@@ -73,76 +78,87 @@ HSTR_COIBUFFER hStreams_PhysBuffer::getCOIhandle() const
     return coi_buf_;
 }
 
-class hStreams_PhysBuffer::isActionCompleted_functor_
+bool hStreams_PhysBuffer::isInHostMemory() const
 {
-public:
-    isActionCompleted_functor_(uint32_t &index, uint32_t num_completed_actions, uint32_t *completed_actions) :
-        index_(index), num_completed_actions_(num_completed_actions), completed_actions_(completed_actions) {}
+    return in_host_memory_;
+}
 
-    bool operator()(const HSTR_EVENT &event)
-    {
-        for (uint32_t i = 0; i < num_completed_actions_; ++i) {
-            if (index_ == completed_actions_[i]) {
-                index_++;
-                return true;
-            }
-        }
+int32_t hStreams_PhysBuffer::getNumaNode() const
+{
+    return -1;
+}
 
-        index_++;
-        return false;
+void hStreams_PhysBuffer::waitForPendingActions()
+{
+    hStreams_Scope_Locker_Unlocker autolock(lock_);
+    if (hasPendingActions()) {
+        HSTR_DEBUG1(HSTR_INFO_TYPE_SYNC)
+                << "Destroying buffer [" << log_buf_->getStart() << "]: actions submitted: "
+                << submitted_seq_ << ", retired: " << retired_seq_;
     }
-private:
-    uint32_t &index_;
-    uint32_t num_completed_actions_;
-    uint32_t *completed_actions_;
-};
-
-void hStreams_PhysBuffer::removeCompletedActions()
-{
-    // Poll COI which actions are completed (no waiting is done here, timeout is 0)
-    HSTR_COIRESULT coi_res;
-    uint32_t num_completed_actions = 0;
-    uint32_t *completed_actions = new uint32_t[pending_actions_.size()];
-
-    coi_res = hStreams_COIWrapper::COIEventWait((uint16_t) pending_actions_.size(), &pending_actions_[0],
-              0, true, &num_completed_actions, &completed_actions[0]);
-
-    if (HSTR_COI_SUCCESS == coi_res) {
-        // All actions in pending_actions_ are completed
-        pending_actions_.clear();
-    } else if (HSTR_COI_TIME_OUT_REACHED == coi_res) {
-        // Remove completed actions
-        // TODO: Better solution would be keeping the index only in the functor object and use this object
-        // with std::reference_wrapper, but this is not currently work with build system.
-        uint32_t index = 0;
-        isActionCompleted_functor_ is_completed(index, num_completed_actions, completed_actions);
-
-        pending_actions_.erase(
-            remove_if(pending_actions_.begin(), pending_actions_.end(), is_completed), pending_actions_.end());
-    } else {
-        HSTR_WARN(HSTR_INFO_TYPE_SYNC)
-                << "Couldn't perform poll for pending actions while looking for done actions: "
-                << hStreams_COIWrapper::COIResultGetName(coi_res);
+    // Called from the destructors, failures have to be handled gracefully
+    try {
+        retired_cond_.wait(lock_, std::bind(&hStreams_PhysBuffer::hasPendingActions, this));
+    } catch (...) {
+        hStreams_handle_exception();
     }
+}
 
-    delete[] completed_actions;
+bool hStreams_PhysBuffer::hasPendingActions() const
+{
+    return retired_seq_ != submitted_seq_;
 }
 
-void hStreams_PhysBuffer::addPendingAction(HSTR_EVENT action)
+void hStreams_PhysBuffer::retireAction()
 {
     hStreams_Scope_Locker_Unlocker autolock(lock_);
-
-    //Lazy pending actions clean up
-    if (++action_cleanup_counter_ >= fixed_buffer_actions_cleanup_value) {
-        action_cleanup_counter_ = 0;
-        removeCompletedActions();
+    ++retired_seq_;
+    if (retired_seq_ == submitted_seq_) {
+        retired_cond_.signal();
     }
+}
 
-    pending_actions_.push_back(action);
+void hStreams_PhysBuffer::actionCompleted(void *buf)
+{
+    ((hStreams_PhysBuffer *) buf)->retireAction();
+}
+
+void hStreams_PhysBuffer::addPendingAction(HSTR_EVENT action)
+{
+    {
+        hStreams_Scope_Locker_Unlocker autolock(lock_);
+        ++submitted_seq_;
+    }
+    bool notified;
+    try {
+        notified = hStreams_HostCallbacks::notifyOnCompletion(action, &hStreams_PhysBuffer::actionCompleted, this);
+    } catch (...) {
+        // No way to learn when the action completes but to wait for it
+        HSTR_WARN(HSTR_INFO_TYPE_SYNC)
+                << "Couldn't have the completion of an action on buffer ["
+                << log_buf_->getStart() << "] notified, waiting for it";
+        HSTR_COIRESULT coi_res = hStreams_HostEvent::wait(1, &action, -1, true, NULL, NULL);
+        if (HSTR_COI_SUCCESS != coi_res) {
+            HSTR_WARN(HSTR_INFO_TYPE_SYNC)
+                    << "Couldn't perform wait for an action on buffer ["
+                    << log_buf_->getStart() << "]: "
+                    << hStreams_COIWrapper::COIResultGetName(coi_res);
+        }
+        notified = false;
+    }
+    if (!notified) {
+        // Already completed
+        retireAction();
+    }
 }
 
 bool operator==(hStreams_PhysBuffer const &pb1, hStreams_PhysBuffer const &pb2)
 {
+    if (pb1.getCOIhandle() == NULL || pb2.getCOIhandle() == NULL) {
+        // Host-only buffers are the same if they are backed by the same memory
+        return pb1.getCOIhandle() == pb2.getCOIhandle() &&
+               pb1.translateToSinkAddress(0) == pb2.translateToSinkAddress(0);
+    }
     return pb1.getCOIhandle() == pb2.getCOIhandle();
 }
 
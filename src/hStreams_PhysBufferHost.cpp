@@ -16,12 +16,21 @@
 
 #include "hStreams_PhysBufferHost.h"
 
-hStreams_PhysBufferHost::hStreams_PhysBufferHost(hStreams_LogBuffer const &log_buf, HSTR_COIBUFFER coi_buf, std::unique_ptr<void, void(*)(void *)> data_ptr, uint64_t padding)
-    : hStreams_PhysBuffer(log_buf, coi_buf, (uint64_t)data_ptr.get(), padding), data_ptr_(std::move(data_ptr))
+hStreams_PhysBufferHost::hStreams_PhysBufferHost(hStreams_LogBuffer const &log_buf, HSTR_COIBUFFER coi_buf, std::unique_ptr<void, void(*)(void *)> data_ptr, uint64_t padding,
+        int32_t numa_node)
+    : hStreams_PhysBuffer(log_buf, coi_buf, (uint64_t)data_ptr.get(), padding, true), data_ptr_(std::move(data_ptr)),
+      numa_node_(numa_node)
 {
 }
 
 hStreams_PhysBufferHost::~hStreams_PhysBufferHost()
 {
+    // data_ptr_ goes away before the base class gets to wait
+    waitForPendingActions();
+}
+
+int32_t hStreams_PhysBufferHost::getNumaNode() const
+{
+    return numa_node_;
 }
 
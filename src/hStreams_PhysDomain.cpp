@@ -117,15 +117,16 @@ void hStreams_PhysDomain::getLogDomainIDs(HSTR_LOG_DOM *ptr, uint32_t num, uint3
     *num_present = (uint32_t) log_domains_.size();
 }
 
-uint64_t hStreams_PhysDomain::getSinkAddress(std::string const &func_name)
+bool hStreams_PhysDomain::getSinkAddress(std::string const &func_name, uint64_t *sink_addr)
 {
     hStreams_RW_Scope_Locker_Unlocker cache_lock(sink_functions_addresses_lock_,
             hStreams_RW_Lock::HSTR_RW_LOCK_READ);
     SinkFuncAddressesContainer::const_iterator it = sink_functions_addresses_.find(func_name);
     if (it == sink_functions_addresses_.end()) {
-        return 0;
+        return false;
     }
-    return it->second;
+    *sink_addr = it->second;
+    return true;
 }
 
 void hStreams_PhysDomain::setSinkAddress(std::string const &func_name, uint64_t sink_addr)
@@ -137,8 +138,8 @@ void hStreams_PhysDomain::setSinkAddress(std::string const &func_name, uint64_t
 
 uint64_t hStreams_PhysDomain::fetchSinkFunctionAddress(std::string const &func_name)
 {
-    uint64_t ret = getSinkAddress(func_name);
-    if (0 != ret) {
+    uint64_t ret = 0;
+    if (getSinkAddress(func_name, &ret)) {
         return ret;
     }
     // Return NULL for hStreams functions using MKL when is disabled
@@ -151,17 +152,37 @@ uint64_t hStreams_PhysDomain::fetchSinkFunctionAddress(std::string const &func_n
             return 0;
         }
     }
-    // NOTE this will repeat unsuccessful lookups
+    // Unsuccessful lookups are cached as well, so that a bad name costs
+    // a sink-side lookup only once
     ret = impl_fetchSinkFunctionAddress(func_name);
-    if (0 != ret) {
-        setSinkAddress(func_name, ret);
-    }
+    setSinkAddress(func_name, ret);
     return ret;
 }
 
-hStreams_PhysStream *hStreams_PhysDomain::createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask)
+uint64_t hStreams_PhysDomain::fetchSinkFunctionAddress(HSTR_FUNC_HANDLE func_handle)
+{
+    hStreams_RW_Scope_Locker_Unlocker cache_lock(sink_functions_addresses_lock_,
+            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    if (func_handle >= sink_addresses_by_handle_.size()) {
+        return 0;
+    }
+    return sink_addresses_by_handle_[func_handle];
+}
+
+void hStreams_PhysDomain::bindFunctionHandle(HSTR_FUNC_HANDLE func_handle, uint64_t sink_addr)
+{
+    hStreams_RW_Scope_Locker_Unlocker cache_lock(sink_functions_addresses_lock_,
+            hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
+    if (func_handle >= sink_addresses_by_handle_.size()) {
+        sink_addresses_by_handle_.resize(func_handle + 1, 0);
+    }
+    sink_addresses_by_handle_[func_handle] = sink_addr;
+}
+
+hStreams_PhysStream *hStreams_PhysDomain::createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask,
+        bool out_of_order)
 {
-    hStreams_PhysStream *new_stream = impl_createNewPhysStream(log_dom, cpu_mask);
+    hStreams_PhysStream *new_stream = impl_createNewPhysStream(log_dom, cpu_mask, out_of_order);
     if (NULL != new_stream) {
         modifyOversubscriptionArray(cpu_mask, 1);
     }
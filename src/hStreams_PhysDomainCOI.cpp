@@ -52,6 +52,7 @@ hStreams_PhysDomainCOI::hStreams_PhysDomainCOI(
     std::vector<HSTR_COILIBRARY> const &sink_libs,
     HSTR_COIFUNCTION thunk_func,
     HSTR_COIFUNCTION fetch_addr_func,
+    HSTR_COIFUNCTION marker_func,
     HSTR_COIPIPELINE helper_pipeline
 )
     :
@@ -67,6 +68,7 @@ hStreams_PhysDomainCOI::hStreams_PhysDomainCOI(
     sink_libs_(sink_libs),
     thunk_func_(thunk_func),
     fetch_addr_func_(fetch_addr_func),
+    marker_func_(marker_func),
     helper_pipeline_(helper_pipeline)
 {
 }
@@ -98,7 +100,8 @@ hStreams_PhysDomainCOI::~hStreams_PhysDomainCOI()
     }
 }
 
-hStreams_PhysStream *hStreams_PhysDomainCOI::impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask)
+hStreams_PhysStream *hStreams_PhysDomainCOI::impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask,
+        bool out_of_order)
 {
     HSTR_COIPIPELINE coi_pipeline;
     HSTR_CPU_MASK pipeline_mask;
@@ -116,7 +119,8 @@ hStreams_PhysStream *hStreams_PhysDomainCOI::impl_createNewPhysStream(hStreams_L
         return NULL;
     }
 
-    hStreams_PhysStream *phys_stream = new hStreams_PhysStreamCOI(log_dom, cpu_mask, coi_pipeline, thunk_func_);
+    hStreams_PhysStream *phys_stream = new hStreams_PhysStreamCOI(log_dom, cpu_mask, out_of_order, coi_pipeline,
+            thunk_func_, marker_func_);
 
     if (!phys_stream) {
         HSTR_ERROR(HSTR_INFO_TYPE_MISC) << "Internal error while creating the physical stream.";
@@ -48,6 +48,11 @@ hStreams_PhysDomain *hStreams_PhysDomainCollection::lookupByPhysDomainID(HSTR_PH
     return *it;
 }
 
+void hStreams_PhysDomainCollection::getAllPhysDomains(std::vector<hStreams_PhysDomain *> &phys_doms) const
+{
+    phys_doms.assign(container_.begin(), container_.end());
+}
+
 hStreams_PhysDomainCollection::Container::iterator
 hStreams_PhysDomainCollection::getIteratorByID(HSTR_PHYS_DOM id)
 {
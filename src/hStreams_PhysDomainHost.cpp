@@ -146,9 +146,10 @@ HSTR_COIPROCESS hStreams_PhysDomainHost::impl_getCOIProcess() const
     return coi_proc_;
 }
 
-hStreams_PhysStream *hStreams_PhysDomainHost::impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask)
+hStreams_PhysStream *hStreams_PhysDomainHost::impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask,
+        bool out_of_order)
 {
-    return new hStreams_PhysStreamHost(log_dom, cpu_mask);
+    return new hStreams_PhysStreamHost(log_dom, cpu_mask, out_of_order);
 }
 
 uint64_t hStreams_PhysDomainHost::impl_fetchSinkFunctionAddress(std::string const &func_name)
@@ -17,17 +17,48 @@
 #include "hStreams_PhysDomain.h"
 #include "hStreams_LogBuffer.h"
 #include "hStreams_PhysBuffer.h"
+#include "hStreams_HostEvent.h"
+#include "hStreams_HostCallbacks.h"
+#include "hStreams_Graph.h"
 #include "hStreams_helpers_source.h"
 #include "hStreams_internal_vars_source.h"
 #include "hStreams_Logger.h"
+#include "hStreams_common.h" // for HSTR_MAX_FUNC_NAME_SIZE, HSTR_ARGS_IMPLEMENTED
 
 #include <vector>
+#include <algorithm>
 
-hStreams_PhysStream::hStreams_PhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask)
-    : log_dom_(&log_dom), cpu_mask_(cpu_mask)
+namespace
 {
-    lastAction_.opaque[0] = (uint64_t) - 1;
-    lastAction_.opaque[1] = (uint64_t) - 1;
+// How many buffer-less computes of an out-of-order stream to record before
+// looking for the completed ones
+const uint64_t min_unordered_actions_cleanup_size = 64;
+// How many of them may stay pending before they are folded into a marker
+const uint64_t max_unordered_actions = 1024;
+// How many readers of a buffer to record before looking for the completed ones
+const uint64_t min_readers_cleanup_size = 64;
+// How many of them may stay pending before they are folded into a marker
+const uint64_t max_readers = 1024;
+}
+
+hStreams_PhysStream::hStreams_PhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask,
+        bool out_of_order)
+    : log_dom_(&log_dom), cpu_mask_(cpu_mask), out_of_order_(out_of_order),
+      unorderedActionsCleanupSize_(min_unordered_actions_cleanup_size),
+      enqueue_priority_(HSTR_STREAM_PRIORITY_NORMAL),
+      num_deps_submitted_(0), num_deps_pruned_(0)
+{
+    lastBarrier_.opaque[0] = (uint64_t) - 1;
+    lastBarrier_.opaque[1] = (uint64_t) - 1;
+    for (uint32_t prio = 0; prio < HSTR_STREAM_PRIORITY_SIZE; ++prio) {
+        lastAction_[prio] = lastBarrier_;
+    }
+
+    func_name_scratch_.reserve(HSTR_MAX_FUNC_NAME_SIZE);
+    // Two for scalar/heap args number, one for sink-side function address
+    marshalled_args_scratch_.reserve(2 + HSTR_ARGS_IMPLEMENTED + 1);
+    // The last actions in the stream
+    input_deps_scratch_.reserve(HSTR_STREAM_PRIORITY_SIZE + HSTR_ARGS_IMPLEMENTED);
 }
 
 hStreams_PhysStream::~hStreams_PhysStream()
@@ -36,13 +67,16 @@ hStreams_PhysStream::~hStreams_PhysStream()
     std::vector<hStreams_PhysBuffer *> dummy_buffers;
     getInputDeps(IS_BARRIER, dummy_buffers, pending_actions);
     if (!pending_actions.empty()) {
-        HSTR_COIRESULT coi_res = hStreams_COIWrapper::COIEventWait((uint16_t) pending_actions.size(), &pending_actions[0], -1, true, NULL, NULL);
+        HSTR_COIRESULT coi_res = hStreams_HostEvent::waitAll(pending_actions.size(), &pending_actions[0], -1);
         if (HSTR_COI_SUCCESS != coi_res) {
             HSTR_WARN(HSTR_INFO_TYPE_SYNC)
                     << "Couldn't perform wait for pending actions while destroying stream: "
                     << hStreams_COIWrapper::COIResultGetName(coi_res);
         }
     }
+    HSTR_DEBUG1(HSTR_INFO_TYPE_SYNC)
+            << "Stream dependencies submitted: " << num_deps_submitted_
+            << ", pruned: " << num_deps_pruned_;
     log_dom_->getPhysDomain().processPhysStreamDestroy(*this);
 }
 
@@ -51,11 +85,118 @@ hStreams_CPUMask hStreams_PhysStream::getCPUMask() const
     return cpu_mask_;
 }
 
+bool hStreams_PhysStream::isOutOfOrder() const
+{
+    return out_of_order_;
+}
+
+HSTR_STREAM_PRIORITY hStreams_PhysStream::enqueuePriority() const
+{
+    return enqueue_priority_;
+}
+
+void hStreams_PhysStream::getDepStats(uint64_t &out_num_submitted, uint64_t &out_num_pruned)
+{
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    out_num_submitted = num_deps_submitted_;
+    out_num_pruned = num_deps_pruned_;
+}
+
+void hStreams_PhysStream::pruneInputDeps(std::vector<HSTR_EVENT> &deps)
+{
+    // E.g. the last action is often also the last writer of the buffers,
+    // and the completed actions cost COI as much as the pending ones
+    num_deps_pruned_ += hStreams_HostEvent::prune(deps);
+    num_deps_submitted_ += deps.size();
+}
+
+void hStreams_PhysStream::addUnorderedAction(HSTR_EVENT completion)
+{
+    if (unorderedActions_.size() >= unorderedActionsCleanupSize_) {
+        // Poll which actions are completed (no waiting is done here, timeout is 0)
+        uint16_t num_polled = (uint16_t) std::min<uint64_t>(unorderedActions_.size(), 0xFFFF);
+        uint32_t num_completed = 0;
+        completed_actions_scratch_.resize(num_polled);
+        HSTR_COIRESULT coi_res = hStreams_HostEvent::wait(num_polled, &unorderedActions_[0], 0, true,
+                                 &num_completed, &completed_actions_scratch_[0]);
+        if (coi_res == HSTR_COI_SUCCESS) {
+            // All the polled actions are completed
+            unorderedActions_.erase(unorderedActions_.begin(), unorderedActions_.begin() + num_polled);
+        } else if (coi_res == HSTR_COI_TIME_OUT_REACHED) {
+            // Turn the completed ones into placeholders and compact the rest
+            for (uint32_t i = 0; i < num_completed; ++i) {
+                unorderedActions_[completed_actions_scratch_[i]].opaque[0] = (uint64_t) - 1;
+                unorderedActions_[completed_actions_scratch_[i]].opaque[1] = (uint64_t) - 1;
+            }
+            uint64_t num_kept = 0;
+            for (uint64_t idx = 0; idx < unorderedActions_.size(); ++idx) {
+                if (!hStreams_HostEvent::isNullEvent(unorderedActions_[idx])) {
+                    unorderedActions_[num_kept++] = unorderedActions_[idx];
+                }
+            }
+            unorderedActions_.resize(num_kept);
+        } else {
+            HSTR_WARN(HSTR_INFO_TYPE_SYNC)
+                    << "Couldn't poll the actions of an out-of-order stream: "
+                    << hStreams_COIWrapper::COIResultGetName(coi_res);
+        }
+        if (unorderedActions_.size() >= max_unordered_actions) {
+            // Too many are still pending, let a marker stand in for them so
+            // that the barriers and the synchronizations have fewer to wait for
+            fold_deps_scratch_.assign(unorderedActions_.begin(), unorderedActions_.end());
+            HSTR_EVENT marker;
+            HSTR_RESULT hret = impl_enqueueMarker(fold_deps_scratch_, &marker);
+            if (hret == HSTR_RESULT_SUCCESS) {
+                unorderedActions_.clear();
+                unorderedActions_.push_back(marker);
+            } else {
+                HSTR_WARN(HSTR_INFO_TYPE_SYNC)
+                        << "Couldn't fold the actions of an out-of-order stream into a marker: "
+                        << hStreams_ResultGetName(hret);
+            }
+        }
+        // Don't poll again before the vector has doubled
+        unorderedActionsCleanupSize_ = std::max<uint64_t>(min_unordered_actions_cleanup_size,
+                                       2 * unorderedActions_.size());
+    }
+    unorderedActions_.push_back(completion);
+}
+
+namespace
+{
+bool sameEvent(HSTR_EVENT const &lhs, HSTR_EVENT const &rhs)
+{
+    return lhs.opaque[0] == rhs.opaque[0] && lhs.opaque[1] == rhs.opaque[1];
+}
+}
+
+void hStreams_PhysStream::getLastActions(std::vector<HSTR_EVENT> &deps) const
+{
+    // The priorities without an action since the last barrier still have the
+    // barrier as their last action. It needn't be waited for if any of the
+    // others has had an action since, as that action waits for the barrier.
+    uint64_t num_before = deps.size();
+    for (uint32_t prio = 0; prio < HSTR_STREAM_PRIORITY_SIZE; ++prio) {
+        HSTR_EVENT const &last = lastAction_[prio];
+        bool seen = sameEvent(last, lastBarrier_);
+        for (uint64_t idx = num_before; idx < deps.size() && !seen; ++idx) {
+            seen = sameEvent(last, deps[idx]);
+        }
+        if (!seen) {
+            deps.push_back(last);
+        }
+    }
+    if (deps.size() == num_before) {
+        deps.push_back(lastBarrier_);
+    }
+}
+
 void hStreams_PhysStream::getAllEvents(std::vector<HSTR_EVENT> &events)
 {
-    events.clear();
-    std::vector<hStreams_PhysBuffer *> dummy_bufs;
-    getInputDeps(IS_BARRIER, dummy_bufs, events);
+    // Only the snapshot is taken under the lock, the caller waits without it
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    getInputDeps(IS_BARRIER, NULL, NULL, NULL, NULL, 0, events);
+    pruneInputDeps(events);
 }
 
 void hStreams_PhysStream::getInputDeps(
@@ -63,35 +204,77 @@ void hStreams_PhysStream::getInputDeps(
     std::vector<hStreams_PhysBuffer *> &buffers,
     std::vector<HSTR_EVENT> &deps)
 {
+    getInputDeps(dep_type, buffers.empty() ? NULL : &buffers[0], NULL, NULL, NULL,
+                 (uint32_t) buffers.size(), deps);
+}
+
+namespace
+{
+// The part of the idx-th of the buffers which is accessed
+void getAccessedRange(uint64_t const *offsets, uint64_t const *lengths, uint32_t idx,
+                      uint64_t &begin, uint64_t &end)
+{
+    if (lengths == NULL) {
+        begin = 0;
+        end = (uint64_t) - 1;
+    } else {
+        begin = offsets[idx];
+        end = offsets[idx] + lengths[idx];
+    }
+}
+}
+
+void hStreams_PhysStream::getInputDeps(
+    DEP_TYPE dep_type,
+    hStreams_PhysBuffer *const *buffers,
+    HSTR_ACCESS_MODE const *access,
+    uint64_t const *offsets,
+    uint64_t const *lengths,
+    uint32_t num_buffers,
+    std::vector<HSTR_EVENT> &deps)
+{
 
     deps.clear(); // don't depend on caller to clear this
 
-    if (hStreams_GetOptions_dep_policy() == HSTR_DEP_POLICY_CONSERVATIVE) {
-        // dep_type is a don't care
-        deps.push_back(lastAction_);
-    } else if (hStreams_GetOptions_dep_policy() == HSTR_DEP_POLICY_BUFFERS) {
-        // FIXME perf: this can be commented out unless and until computes are
-        // OOO [prove this first]
-        if (dep_type != IS_XFER) {
-            deps.push_back(lastAction_);
+    // Reading an option takes a lock, so only do it once
+    HSTR_DEP_POLICY dep_policy = hStreams_GetOptions_dep_policy();
+    if (dep_policy == HSTR_DEP_POLICY_CONSERVATIVE) {
+        // dep_type is a don't care, and neither are the priorities
+        getLastActions(deps);
+    } else if (dep_policy == HSTR_DEP_POLICY_BUFFERS || dep_policy == HSTR_DEP_POLICY_ACCESS_MODES) {
+        bool access_modes = dep_policy == HSTR_DEP_POLICY_ACCESS_MODES;
+        // With the access modes, and in an out-of-order stream, computes are
+        // ordered by the buffers they access only, so that e.g. the ones
+        // sharing a read-only input don't have to wait for each other. They
+        // still wait for the barriers.
+        if (dep_type == IS_BARRIER) {
+            getLastActions(deps);
+        } else if (dep_type == IS_COMPUTE && !access_modes && !out_of_order_) {
+            deps.push_back(lastAction_[enqueue_priority_]);
+        } else if (dep_type == IS_COMPUTE) {
+            deps.push_back(lastBarrier_);
         }
 
         if (dep_type == IS_BARRIER) {
-            // If barrier, get completion event for every buffer used thus far in the stream
-            deps.reserve(deps.size() + pendingBufUpdates_.size());
-            std::map<hStreams_PhysBuffer *, HSTR_EVENT>::iterator bufupd_it;
+            // If barrier, get completion events for every buffer used thus far in the stream
+            std::map<hStreams_PhysBuffer *, BufferDeps>::iterator bufupd_it;
             for (bufupd_it = pendingBufUpdates_.begin(); bufupd_it != pendingBufUpdates_.end(); ++bufupd_it) {
-                deps.push_back(bufupd_it->second);
+                bufupd_it->second.getAllDeps(deps);
             }
+            // and for the computes which don't show up in any of the buffers
+            deps.insert(deps.end(), unorderedActions_.begin(), unorderedActions_.end());
         } else {
-            // Walk over input buffers, grab a completion event for each (if it exists)
-            // Let's optimistically assume that each input buffer has been already used in this stream
-            deps.reserve(deps.size() + buffers.size());
-            std::vector<hStreams_PhysBuffer *>::iterator it;
-            for (it = buffers.begin(); it != buffers.end(); ++it) {
-                std::map<hStreams_PhysBuffer *, HSTR_EVENT>::iterator bufupd_it = pendingBufUpdates_.find(*it);
+            // Walk over input buffers, grab the completion events of the
+            // overlapping actions for each (if they exist)
+            for (uint32_t idx = 0; idx < num_buffers; ++idx) {
+                std::map<hStreams_PhysBuffer *, BufferDeps>::iterator bufupd_it = pendingBufUpdates_.find(buffers[idx]);
                 if (bufupd_it != pendingBufUpdates_.end()) {
-                    deps.push_back(bufupd_it->second);
+                    uint64_t begin, end;
+                    getAccessedRange(offsets, lengths, idx, begin, end);
+                    // Reads wait for the last writes, writes for the reads since then as well.
+                    // Reads are only recorded with the access modes.
+                    bool write = !access_modes || access == NULL || (access[idx] & HSTR_ACCESS_WRITE);
+                    bufupd_it->second.getDeps(begin, end, write, deps);
                 }
             }
         }
@@ -103,103 +286,355 @@ void hStreams_PhysStream::setOutputDeps(
     std::vector<hStreams_PhysBuffer *> &buffers,
     HSTR_EVENT completion)
 {
-    // Current implementation conservatively treats RAW, WAW, WAR the same,
-    // and even if the dest is the host, treats the read as creating a dep
+    setOutputDeps(dep_type, buffers.empty() ? NULL : &buffers[0], NULL, NULL, NULL,
+                  (uint32_t) buffers.size(), completion);
+}
+
+void hStreams_PhysStream::setOutputDeps(
+    DEP_TYPE dep_type,
+    hStreams_PhysBuffer *const *buffers,
+    HSTR_ACCESS_MODE const *access,
+    uint64_t const *offsets,
+    uint64_t const *lengths,
+    uint32_t num_buffers,
+    HSTR_EVENT completion)
+{
+    // With HSTR_DEP_POLICY_BUFFERS, the computes are conservatively taken
+    // as writing all of their buffers, which treats RAW, WAW and WAR the same.
+    // Even if the dest of a transfer is the host, the write creates a dep
     // in the hStream.  To check whether all xfers out of a stream are
     // done, one can do a StreamSync.
 
-    if (hStreams_GetOptions_dep_policy() == HSTR_DEP_POLICY_CONSERVATIVE) {
-        // dep_type is a don't care
-        lastAction_ = completion;
-    } else if (hStreams_GetOptions_dep_policy() == HSTR_DEP_POLICY_BUFFERS) {
-        //  FIXME perf: this can be commented out unless and until computes are
-        //  OOO [prove this first]
-        if (dep_type != IS_XFER) {
-            lastAction_ = completion;
+    HSTR_DEP_POLICY dep_policy = hStreams_GetOptions_dep_policy();
+    if (dep_policy == HSTR_DEP_POLICY_CONSERVATIVE) {
+        // dep_type is a don't care, the priorities aren't told apart
+        std::fill(lastAction_, lastAction_ + HSTR_STREAM_PRIORITY_SIZE, completion);
+    } else if (dep_policy == HSTR_DEP_POLICY_BUFFERS || dep_policy == HSTR_DEP_POLICY_ACCESS_MODES) {
+        bool access_modes = dep_policy == HSTR_DEP_POLICY_ACCESS_MODES;
+        // The computes of an out-of-order stream may complete in any order,
+        // so the ones without buffers are remembered separately
+        if (dep_type == IS_BARRIER) {
+            std::fill(lastAction_, lastAction_ + HSTR_STREAM_PRIORITY_SIZE, completion);
+            lastBarrier_ = completion;
+            unorderedActions_.clear();
+        } else if (dep_type == IS_COMPUTE && !out_of_order_) {
+            lastAction_[enqueue_priority_] = completion;
+        } else if (dep_type == IS_COMPUTE && num_buffers == 0) {
+            addUnorderedAction(completion);
         }
 
         // NOTE if dep_type == IS_BARRIER, caller is responsible for providing all the possible
         //      physical buffers that can be used in this stream; a physical stream doesn't go
-        //      and grab the list of all buffers.
-        std::vector<hStreams_PhysBuffer *>::iterator it;
-        for (it = buffers.begin(); it != buffers.end(); ++it) {
-            pendingBufUpdates_[*it] = completion;
+        //      and grab the list of all buffers. A barrier has waited for everything,
+        //      so it's like a write to each of the buffers.
+        for (uint32_t idx = 0; idx < num_buffers; ++idx) {
+            bool read_only = dep_type != IS_BARRIER && access != NULL && access[idx] == HSTR_ACCESS_READ;
+            if (read_only && !access_modes) {
+                if (dep_type == IS_XFER) {
+                    // The reads aren't recorded
+                    continue;
+                }
+                // Computes write all of their buffers
+                read_only = false;
+            }
+            uint64_t begin, end;
+            getAccessedRange(offsets, lengths, idx, begin, end);
+            BufferDeps &buf_deps = pendingBufUpdates_[buffers[idx]];
+            if (read_only) {
+                buf_deps.addReader(begin, end, completion);
+                if (buf_deps.numReaders() >= max_readers) {
+                    foldReaders(buf_deps);
+                }
+            } else {
+                buf_deps.addWriter(begin, end, completion);
+            }
         }
     }
 }
 
-HSTR_RESULT hStreams_PhysStream::enqueueFunction(
-    std::string func_name,
-    std::vector<uint64_t> &scalar_args,
-    std::vector<hStreams_PhysBuffer *> &buffer_args,
-    std::vector<uint64_t> &buffer_offsets,
-    void *ret_val, uint16_t ret_val_size, HSTR_EVENT *ret_event
-)
+namespace
 {
-    if (buffer_args.size() != buffer_offsets.size()) {
-        HSTR_ERROR(HSTR_INFO_TYPE_MISC)
-                << "Internal error. buffer_args.size() != buffer_offsets.size() ["
-                << buffer_args.size() << " != " << buffer_offsets.size() << "]";
-
-        return HSTR_RESULT_INTERNAL_ERROR;
+// Compare a range with an offset, for finding the first range ending after the offset
+template <typename Range>
+class EndsNotAfter
+{
+public:
+    bool operator()(Range const &range, uint64_t offset) const
+    {
+        return range.end <= offset;
     }
+};
 
-    HSTR_EVENT completion;
+// Compare a range with an offset, for finding the first range beginning at or after the offset
+template <typename Range>
+class BeginsBefore
+{
+public:
+    bool operator()(Range const &range, uint64_t offset) const
     {
-        // Synchronize the enqueues to the physical stream
-        hStreams_Scope_Locker_Unlocker _autolock(lock_);
+        return range.begin < offset;
+    }
+};
+}
 
-        hStreams_PhysDomain &phys_dom = log_dom_->getPhysDomain();
-        uint64_t sink_addr = phys_dom.fetchSinkFunctionAddress(func_name);
-        if (!sink_addr) {
-            HSTR_ERROR(HSTR_INFO_TYPE_MISC)
-                    << "A sink-compiled version of called function "
-                    << func_name << " not found on logical domain " << log_dom_->id()
-                    << ", physical domain " << phys_dom.id();
+hStreams_PhysStream::BufferDeps::BufferDeps()
+    : readersCleanupSize_(min_readers_cleanup_size)
+{
+}
 
-            return HSTR_RESULT_BAD_NAME;
+void hStreams_PhysStream::BufferDeps::getDeps(uint64_t begin, uint64_t end, bool write,
+        std::vector<HSTR_EVENT> &deps) const
+{
+    if (begin >= end) {
+        return;
+    }
+    // The writers are sorted and don't overlap, so their ends are sorted as well
+    for (std::vector<Range>::const_iterator it = std::lower_bound(writers_.begin(), writers_.end(),
+            begin, EndsNotAfter<Range>()); it != writers_.end() && it->begin < end; ++it) {
+        deps.push_back(it->event);
+    }
+    if (write) {
+        for (std::vector<Range>::const_iterator it = readers_.begin(); it != readers_.end(); ++it) {
+            if (it->begin < end && begin < it->end) {
+                deps.push_back(it->event);
+            }
         }
+    }
+}
+
+void hStreams_PhysStream::BufferDeps::getAllDeps(std::vector<HSTR_EVENT> &deps) const
+{
+    for (std::vector<Range>::const_iterator it = writers_.begin(); it != writers_.end(); ++it) {
+        deps.push_back(it->event);
+    }
+    for (std::vector<Range>::const_iterator it = readers_.begin(); it != readers_.end(); ++it) {
+        deps.push_back(it->event);
+    }
+}
 
-        // Here we marshall the arguments to the form used by the thunks
-        // This involves translating the addresses to sink-side addresses
-        std::vector<uint64_t> marshalled_args;
-        // Two for scalar/heap args number
-        // One for sink-side function address
-        marshalled_args.reserve(2 + scalar_args.size() + buffer_args.size() + 1);
-        marshalled_args.push_back(scalar_args.size());
-        marshalled_args.push_back(buffer_args.size());
+void hStreams_PhysStream::BufferDeps::addWriter(uint64_t begin, uint64_t end, HSTR_EVENT event)
+{
+    if (begin >= end) {
+        return;
+    }
+
+    Range writer = {begin, end, event};
+    if (writers_.empty() || (begin <= writers_.front().begin && writers_.back().end <= end)) {
+        // The common case of an action accessing the whole buffer
+        writers_.assign(1, writer);
+    } else {
+        // The writers overlapping the new one are [first, last). Only the parts
+        // of the first and the last one sticking out of the new range stay.
+        std::vector<Range>::iterator first = std::lower_bound(writers_.begin(), writers_.end(),
+                                             begin, EndsNotAfter<Range>());
+        std::vector<Range>::iterator last = std::lower_bound(first, writers_.end(),
+                                            end, BeginsBefore<Range>());
+        Range pieces[3];
+        uint32_t num_pieces = 0;
+        if (first != last && first->begin < begin) {
+            Range left = {first->begin, begin, first->event};
+            pieces[num_pieces++] = left;
+        }
+        pieces[num_pieces++] = writer;
+        if (first != last && (last - 1)->end > end) {
+            Range right = {end, (last - 1)->end, (last - 1)->event};
+            pieces[num_pieces++] = right;
+        }
 
-        // scalar args go untouched
-        marshalled_args.insert(marshalled_args.end(), scalar_args.begin(), scalar_args.end());
+        // Replace the overlapping writers with the pieces, in place
+        uint64_t pos = first - writers_.begin();
+        uint64_t num_overlapping = last - first;
+        uint64_t num_copied = std::min<uint64_t>(num_pieces, num_overlapping);
+        std::copy(pieces, pieces + num_copied, first);
+        if (num_overlapping > num_pieces) {
+            writers_.erase(writers_.begin() + pos + num_pieces, writers_.begin() + pos + num_overlapping);
+        } else if (num_pieces > num_copied) {
+            writers_.insert(writers_.begin() + pos + num_copied, pieces + num_copied, pieces + num_pieces);
+        }
+    }
 
-        for (uint32_t idx = 0; idx < buffer_args.size(); ++idx) {
-            marshalled_args.push_back(buffer_args[idx]->translateToSinkAddress(buffer_offsets[idx]));
+    // Likewise, the readers are superseded where they overlap the new writer.
+    // A reader sticking out of both sides is split, the right part going to
+    // the end of the vector, past the ones being compacted.
+    uint64_t num_readers = readers_.size();
+    uint64_t num_kept = 0;
+    for (uint64_t idx = 0; idx < num_readers; ++idx) {
+        Range reader = readers_[idx];
+        if (reader.end <= begin || end <= reader.begin) {
+            readers_[num_kept++] = reader;
+            continue;
+        }
+        if (reader.begin < begin) {
+            Range left = {reader.begin, begin, reader.event};
+            readers_[num_kept++] = left;
+        }
+        if (end < reader.end) {
+            Range right = {end, reader.end, reader.event};
+            if (reader.begin < begin) {
+                readers_.push_back(right);
+            } else {
+                readers_[num_kept++] = right;
+            }
         }
+    }
+    readers_.erase(readers_.begin() + num_kept, readers_.begin() + num_readers);
+}
+
+void hStreams_PhysStream::BufferDeps::addReader(uint64_t begin, uint64_t end, HSTR_EVENT event)
+{
+    if (begin >= end) {
+        return;
+    }
+    if (readers_.size() >= readersCleanupSize_) {
+        dropCompletedReaders();
+        // Don't poll again before the vector has doubled
+        readersCleanupSize_ = std::max<uint64_t>(min_readers_cleanup_size, 2 * readers_.size());
+    }
+    Range reader = {begin, end, event};
+    readers_.push_back(reader);
+}
 
-        marshalled_args.push_back(sink_addr);
+uint64_t hStreams_PhysStream::BufferDeps::numReaders() const
+{
+    return readers_.size();
+}
 
-        std::vector<HSTR_EVENT> input_deps;
-        getInputDeps(IS_COMPUTE, buffer_args, input_deps);
+void hStreams_PhysStream::BufferDeps::getReaderDeps(std::vector<HSTR_EVENT> &deps) const
+{
+    for (std::vector<Range>::const_iterator it = readers_.begin(); it != readers_.end(); ++it) {
+        deps.push_back(it->event);
+    }
+}
 
-        // NULL event handle semantics are different in streams and in COI. Streams
-        // have FIFO ordering; NULL completion event in EnqueueCompute/EnqueueData
-        // means that the user doesn't care about the completion event, but that
-        // doesn't mean the call should be synchronous (as is the semantic in COI).
-        //
-        // This logic is implemented here.
-        HSTR_RESULT hret = impl_enqueueFunction(marshalled_args, input_deps,
-                                                ret_val, ret_val_size, &completion);
+void hStreams_PhysStream::BufferDeps::foldReaders(HSTR_EVENT stand_in)
+{
+    if (readers_.empty()) {
+        return;
+    }
+    Range folded = readers_.front();
+    for (std::vector<Range>::const_iterator it = readers_.begin(); it != readers_.end(); ++it) {
+        folded.begin = std::min(folded.begin, it->begin);
+        folded.end = std::max(folded.end, it->end);
+    }
+    folded.event = stand_in;
+    readers_.assign(1, folded);
+}
+
+void hStreams_PhysStream::foldReaders(BufferDeps &buf_deps)
+{
+    fold_deps_scratch_.clear();
+    buf_deps.getReaderDeps(fold_deps_scratch_);
+    HSTR_EVENT marker;
+    HSTR_RESULT hret = impl_enqueueMarker(fold_deps_scratch_, &marker);
+    if (hret == HSTR_RESULT_SUCCESS) {
+        buf_deps.foldReaders(marker);
+    } else {
+        HSTR_WARN(HSTR_INFO_TYPE_SYNC)
+                << "Couldn't fold the readers of a buffer into a marker: "
+                << hStreams_ResultGetName(hret);
+    }
+}
+
+void hStreams_PhysStream::BufferDeps::dropCompletedReaders()
+{
+    // Poll which readers are completed (no waiting is done here, timeout is 0)
+    uint16_t num_polled = (uint16_t) std::min<uint64_t>(readers_.size(), 0xFFFF);
+    poll_events_scratch_.resize(num_polled);
+    for (uint32_t idx = 0; idx < num_polled; ++idx) {
+        poll_events_scratch_[idx] = readers_[idx].event;
+    }
+    uint32_t num_completed = 0;
+    completed_readers_scratch_.resize(num_polled);
+    HSTR_COIRESULT coi_res = hStreams_HostEvent::wait(num_polled, &poll_events_scratch_[0], 0, true,
+                             &num_completed, &completed_readers_scratch_[0]);
+    if (coi_res == HSTR_COI_SUCCESS) {
+        // All the polled readers are completed
+        readers_.erase(readers_.begin(), readers_.begin() + num_polled);
+    } else if (coi_res == HSTR_COI_TIME_OUT_REACHED) {
+        // Turn the completed ones into placeholders and compact the rest
+        for (uint32_t i = 0; i < num_completed; ++i) {
+            readers_[completed_readers_scratch_[i]].event.opaque[0] = (uint64_t) - 1;
+            readers_[completed_readers_scratch_[i]].event.opaque[1] = (uint64_t) - 1;
+        }
+        uint64_t num_kept = 0;
+        for (uint64_t idx = 0; idx < readers_.size(); ++idx) {
+            if (!hStreams_HostEvent::isNullEvent(readers_[idx].event)) {
+                readers_[num_kept++] = readers_[idx];
+            }
+        }
+        readers_.resize(num_kept);
+    } else {
+        HSTR_WARN(HSTR_INFO_TYPE_SYNC)
+                << "Couldn't poll the readers of a buffer: "
+                << hStreams_COIWrapper::COIResultGetName(coi_res);
+    }
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueFunction(
+    const char *func_name,
+    uint64_t const *scalar_args, uint32_t num_scalar_args,
+    hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+    HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+    uint32_t num_buffer_args,
+    void *ret_val, uint16_t ret_val_size, HSTR_STREAM_PRIORITY priority,
+    HSTR_EVENT *ret_event
+)
+{
+    return enqueueFunctionImpl(func_name, 0, scalar_args, num_scalar_args,
+                               buffer_args, buffer_offsets, buffer_access, buffer_lengths,
+                               num_buffer_args,
+                               ret_val, ret_val_size, priority, ret_event);
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueFunctionByHandle(
+    HSTR_FUNC_HANDLE func_handle,
+    uint64_t const *scalar_args, uint32_t num_scalar_args,
+    hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+    HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+    uint32_t num_buffer_args,
+    void *ret_val, uint16_t ret_val_size, HSTR_STREAM_PRIORITY priority,
+    HSTR_EVENT *ret_event
+)
+{
+    return enqueueFunctionImpl(NULL, func_handle, scalar_args, num_scalar_args,
+                               buffer_args, buffer_offsets, buffer_access, buffer_lengths,
+                               num_buffer_args,
+                               ret_val, ret_val_size, priority, ret_event);
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueFunctionImpl(
+    const char *func_name, HSTR_FUNC_HANDLE func_handle,
+    uint64_t const *scalar_args, uint32_t num_scalar_args,
+    hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+    HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+    uint32_t num_buffer_args,
+    void *ret_val, uint16_t ret_val_size, HSTR_STREAM_PRIORITY priority,
+    HSTR_EVENT *ret_event
+)
+{
+    HSTR_EVENT completion;
+    {
+        // Synchronize the enqueues to the physical stream
+        hStreams_Scope_Locker_Unlocker _autolock(lock_);
+        enqueue_priority_ = priority;
+
+        std::vector<uint64_t> &marshalled_args = marshalled_args_scratch_;
+        HSTR_RESULT hret = marshalFunctionLocked(func_name, func_handle, scalar_args, num_scalar_args,
+                           buffer_args, buffer_offsets, num_buffer_args, marshalled_args);
         if (HSTR_RESULT_SUCCESS != hret) {
             return hret;
         }
 
-        setOutputDeps(IS_COMPUTE, buffer_args, completion);
-
+        hret = enqueueComputeLocked(marshalled_args, buffer_args, buffer_offsets, buffer_access,
+                                    buffer_lengths, num_buffer_args, ret_val, ret_val_size, completion);
+        if (HSTR_RESULT_SUCCESS != hret) {
+            return hret;
+        }
     } // end of critical section protecting enqueues to the stream
 
     // Go over each buffer and notify it that there's an action involving it
-    for (std::vector<hStreams_PhysBuffer *>::iterator it = buffer_args.begin(); it != buffer_args.end(); ++it) {
-        (*it)->addPendingAction(completion);
+    for (uint32_t idx = 0; idx < num_buffer_args; ++idx) {
+        buffer_args[idx]->addPendingAction(completion);
     }
 
     // If caller wants to wait for completion, copy back the handle.
@@ -210,81 +645,129 @@ HSTR_RESULT hStreams_PhysStream::enqueueFunction(
     return HSTR_RESULT_SUCCESS;
 }
 
+HSTR_RESULT hStreams_PhysStream::marshalFunction(
+    const char *func_name, HSTR_FUNC_HANDLE func_handle,
+    uint64_t const *scalar_args, uint32_t num_scalar_args,
+    hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+    uint32_t num_buffer_args,
+    std::vector<uint64_t> &marshalled_args
+)
+{
+    // The function names and handles are cached under the stream's lock
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    return marshalFunctionLocked(func_name, func_handle, scalar_args, num_scalar_args,
+                                 buffer_args, buffer_offsets, num_buffer_args, marshalled_args);
+}
+
+HSTR_RESULT hStreams_PhysStream::marshalFunctionLocked(
+    const char *func_name, HSTR_FUNC_HANDLE func_handle,
+    uint64_t const *scalar_args, uint32_t num_scalar_args,
+    hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+    uint32_t num_buffer_args,
+    std::vector<uint64_t> &marshalled_args
+)
+{
+    hStreams_PhysDomain &phys_dom = log_dom_->getPhysDomain();
+    uint64_t sink_addr = 0;
+    if (func_name != NULL) {
+        // assign() reuses the memory reserved in the constructor
+        func_name_scratch_.assign(func_name);
+        sink_addr = phys_dom.fetchSinkFunctionAddress(func_name_scratch_);
+    } else if (func_handle < sink_addresses_by_handle_.size()
+               && sink_addresses_by_handle_[func_handle] != 0) {
+        sink_addr = sink_addresses_by_handle_[func_handle];
+    } else {
+        sink_addr = phys_dom.fetchSinkFunctionAddress(func_handle);
+        if (sink_addr) {
+            if (func_handle >= sink_addresses_by_handle_.size()) {
+                sink_addresses_by_handle_.resize(func_handle + 1, 0);
+            }
+            sink_addresses_by_handle_[func_handle] = sink_addr;
+        }
+    }
+    if (!sink_addr) {
+        if (func_name != NULL) {
+            HSTR_ERROR(HSTR_INFO_TYPE_MISC)
+                    << "A sink-compiled version of called function "
+                    << func_name << " not found on logical domain " << log_dom_->id()
+                    << ", physical domain " << phys_dom.id();
+        } else {
+            HSTR_ERROR(HSTR_INFO_TYPE_MISC)
+                    << "Function handle " << func_handle
+                    << " doesn't refer to a function present on logical domain "
+                    << log_dom_->id() << ", physical domain " << phys_dom.id();
+        }
+
+        return HSTR_RESULT_BAD_NAME;
+    }
+
+    // Here we marshall the arguments to the form used by the thunks
+    // This involves translating the addresses to sink-side addresses
+    marshalled_args.clear();
+    marshalled_args.push_back(num_scalar_args);
+    marshalled_args.push_back(num_buffer_args);
+
+    // scalar args go untouched
+    marshalled_args.insert(marshalled_args.end(), scalar_args, scalar_args + num_scalar_args);
+
+    for (uint32_t idx = 0; idx < num_buffer_args; ++idx) {
+        marshalled_args.push_back(buffer_args[idx]->translateToSinkAddress(buffer_offsets[idx]));
+    }
+
+    marshalled_args.push_back(sink_addr);
+    return HSTR_RESULT_SUCCESS;
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueComputeLocked(
+    std::vector<uint64_t> &marshalled_args,
+    hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+    HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+    uint32_t num_buffer_args,
+    void *ret_val, uint16_t ret_val_size, HSTR_EVENT &completion
+)
+{
+    std::vector<HSTR_EVENT> &input_deps = input_deps_scratch_;
+    getInputDeps(IS_COMPUTE, buffer_args, buffer_access, buffer_offsets, buffer_lengths,
+                 num_buffer_args, input_deps);
+    pruneInputDeps(input_deps);
+
+    // NULL event handle semantics are different in streams and in COI. Streams
+    // have FIFO ordering; NULL completion event in EnqueueCompute/EnqueueData
+    // means that the user doesn't care about the completion event, but that
+    // doesn't mean the call should be synchronous (as is the semantic in COI).
+    //
+    // This logic is implemented here.
+    HSTR_RESULT hret = impl_enqueueFunction(marshalled_args, input_deps,
+                                            ret_val, ret_val_size, &completion);
+    if (HSTR_RESULT_SUCCESS != hret) {
+        return hret;
+    }
+
+    setOutputDeps(IS_COMPUTE, buffer_args, buffer_access, buffer_offsets, buffer_lengths,
+                  num_buffer_args, completion);
+    return HSTR_RESULT_SUCCESS;
+}
+
 HSTR_RESULT hStreams_PhysStream::enqueueTransfer(
     hStreams_PhysBuffer &dst_buf,
     hStreams_PhysBuffer &src_buf,
     uint64_t dst_offset,
     uint64_t src_offset,
-    uint64_t length,
+    hStreams_XferShape const &shape,
+    HSTR_STREAM_PRIORITY priority,
     HSTR_EVENT *ret_event
 )
 {
-
-    std::vector<hStreams_PhysBuffer *> in_dep_bufs;
-    in_dep_bufs.push_back(&dst_buf);
-    in_dep_bufs.push_back(&src_buf);
-    std::vector<HSTR_EVENT> in_deps;
     HSTR_EVENT completion;
-
     {
         // Synchronize the enqueues to the physical stream
         hStreams_Scope_Locker_Unlocker _autolock(lock_);
-        getInputDeps(IS_XFER, in_dep_bufs, in_deps);
-
-        if (dst_offset == src_offset &&
-                dst_buf == src_buf &&
-                dst_buf.getLogBuffer().isPropertyFlagSet(HSTR_BUF_PROP_ALIASED)) {
-            // Do not perform transfer, only resolve dependences
-            HSTR_COIRESULT coires = hStreams_COIWrapper::COIBufferWrite(
-                                        hstr_proc.dummy_buf,                    // in_DestBuffer
-                                        0,                                      // in_Offset
-                                        &hstr_proc.dummy_data,                  // in_pSourceData. Cannot be NULL
-                                        1,                                      // in_Length
-                                        HSTR_COI_COPY_USE_CPU,                       // in_Type
-                                        (int32_t) in_deps.size(),               // total number of dependencies
-                                        (in_deps.size()) ? &in_deps[0] : NULL,  // in_pDependencies
-                                        &completion);                           // out_pCompletion
-
-            if (coires != HSTR_COI_SUCCESS) {
-                HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
-                        << "Couldn't properly enforce dependencies of an optimized-away transfer "
-                        << "within an aliased buffer. :"
-                        << hStreams_COIWrapper::COIResultGetName(coires)
-                        << ". Source buffer: " << src_buf.getLogBuffer().getStart()
-                        << " Destination buffer: " << dst_buf.getLogBuffer().getStart();
-
-
-                return HSTR_RESULT_REMOTE_ERROR;
-            }
-        } else {
-            // Perform transfer
-            HSTR_COIRESULT coires = hStreams_COIWrapper::COIBufferCopy(dst_buf.getCOIhandle(), src_buf.getCOIhandle(),
-                                    dst_offset + dst_buf.getPadding(),
-                                    src_offset + src_buf.getPadding(),
-                                    length,
-                                    HSTR_COI_COPY_UNSPECIFIED,
-                                    (int32_t) in_deps.size(),
-                                    (in_deps.size()) ? &in_deps[0] : NULL,
-                                    &completion);
-
-            if (coires != HSTR_COI_SUCCESS) {
-                HSTR_ERROR(HSTR_INFO_TYPE_MISC)
-                        << "A problem encountered while copying data between buffers: "
-                        << hStreams_COIWrapper::COIResultGetName(coires);
-            }
-
-
-            if (coires == HSTR_COI_MEMORY_OVERLAP) {
-                return HSTR_RESULT_OVERLAPPING_RESOURCES;
-            } else if (coires != HSTR_COI_SUCCESS) {
-                // FIXME handle the cases more appropriately
-                return HSTR_RESULT_REMOTE_ERROR;
-            }
-
-            // Only update the output dependencies wrt the destination buffer
-            std::vector<hStreams_PhysBuffer *> out_dep_bufs;
-            out_dep_bufs.push_back(&dst_buf);
-            setOutputDeps(IS_XFER, out_dep_bufs, completion);
+        enqueue_priority_ = priority;
+        hStreams_PhysXferRegion region = {&dst_buf, &src_buf, dst_offset, src_offset, shape};
+        regions_scratch_.assign(1, region);
+        HSTR_RESULT hret = enqueueTransferLocked(regions_scratch_, completion);
+        if (hret != HSTR_RESULT_SUCCESS) {
+            return hret;
         }
     } // End of critical section protecting enqueues to the stream
 
@@ -300,3 +783,369 @@ HSTR_RESULT hStreams_PhysStream::enqueueTransfer(
 
     return HSTR_RESULT_SUCCESS;
 }
+
+HSTR_RESULT hStreams_PhysStream::enqueueTransferList(
+    std::vector<hStreams_PhysXferRegion> const &regions,
+    HSTR_STREAM_PRIORITY priority,
+    HSTR_EVENT *ret_event
+)
+{
+    HSTR_EVENT completion;
+    {
+        // Synchronize the enqueues to the physical stream
+        hStreams_Scope_Locker_Unlocker _autolock(lock_);
+        enqueue_priority_ = priority;
+        HSTR_RESULT hret = enqueueTransferLocked(regions, completion);
+        if (hret != HSTR_RESULT_SUCCESS) {
+            return hret;
+        }
+    } // End of critical section protecting enqueues to the stream
+
+    // Notify the buffers of the action, each one once however many of the
+    // regions it holds
+    std::vector<hStreams_PhysBuffer *> bufs;
+    hStreams_PhysXferRegion::getBuffers(regions, bufs);
+    for (uint64_t idx = 0; idx < bufs.size(); ++idx) {
+        bufs[idx]->addPendingAction(completion);
+    }
+
+    if (ret_event != NULL) {
+        *ret_event = completion;
+    }
+    return HSTR_RESULT_SUCCESS;
+}
+
+namespace
+{
+// A transfer within an aliased buffer onto itself moves nothing
+bool isSkippedRegion(hStreams_PhysXferRegion const &region)
+{
+    hStreams_LogBuffer const &log_buf = region.dst_buf->getLogBuffer();
+    return region.dst_offset == region.src_offset &&
+           region.shape.hasSamePitches() &&
+           *region.dst_buf == *region.src_buf &&
+           (log_buf.isPropertyFlagSet(HSTR_BUF_PROP_ALIASED) ||
+            log_buf.isPropertyFlagSet(HSTR_BUF_PROP_HOST_ALIASED));
+}
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueTransferLocked(
+    std::vector<hStreams_PhysXferRegion> const &regions,
+    HSTR_EVENT &completion
+)
+{
+    // The rows of a strided transfer are tracked as the whole range they
+    // span, each region as a write of the destination and a read of the source
+    uint32_t num_deps = (uint32_t)(2 * regions.size());
+    dep_bufs_scratch_.resize(num_deps);
+    dep_access_scratch_.resize(num_deps);
+    dep_offsets_scratch_.resize(num_deps);
+    dep_lengths_scratch_.resize(num_deps);
+    std::vector<hStreams_PhysXferRegion> &moved_regions = moved_regions_scratch_;
+    moved_regions.clear();
+    for (uint64_t idx = 0; idx < regions.size(); ++idx) {
+        hStreams_PhysXferRegion const &region = regions[idx];
+        dep_bufs_scratch_[2 * idx] = region.dst_buf;
+        dep_access_scratch_[2 * idx] = HSTR_ACCESS_WRITE;
+        dep_offsets_scratch_[2 * idx] = region.dst_offset;
+        dep_lengths_scratch_[2 * idx] = region.shape.dstExtent();
+        dep_bufs_scratch_[2 * idx + 1] = region.src_buf;
+        dep_access_scratch_[2 * idx + 1] = HSTR_ACCESS_READ;
+        dep_offsets_scratch_[2 * idx + 1] = region.src_offset;
+        dep_lengths_scratch_[2 * idx + 1] = region.shape.srcExtent();
+        if (!isSkippedRegion(region)) {
+            moved_regions.push_back(region);
+        }
+    }
+    std::vector<HSTR_EVENT> &in_deps = input_deps_scratch_;
+
+    getInputDeps(IS_XFER, &dep_bufs_scratch_[0], &dep_access_scratch_[0], &dep_offsets_scratch_[0],
+                 &dep_lengths_scratch_[0], num_deps, in_deps);
+    pruneInputDeps(in_deps);
+
+    HSTR_RESULT hret;
+    if (moved_regions.empty()) {
+        // Do not perform transfer, only resolve dependences
+        hret = impl_enqueueMarker(in_deps, &completion);
+        if (hret != HSTR_RESULT_SUCCESS) {
+            HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
+                    << "Couldn't properly enforce dependencies of an optimized-away transfer "
+                    << "within an aliased buffer. Source buffer: "
+                    << regions[0].src_buf->getLogBuffer().getStart()
+                    << " Destination buffer: " << regions[0].dst_buf->getLogBuffer().getStart();
+            return hret;
+        }
+    } else {
+        // Perform transfer
+        hret = impl_enqueueTransfer(moved_regions, in_deps, &completion);
+        if (hret != HSTR_RESULT_SUCCESS) {
+            return hret;
+        }
+    }
+
+    // The source buffer is only read, so later actions wait for the
+    // transfer wrt the destination buffer only, unless they write the source
+    setOutputDeps(IS_XFER, &dep_bufs_scratch_[0], &dep_access_scratch_[0], &dep_offsets_scratch_[0],
+                  &dep_lengths_scratch_[0], num_deps, completion);
+    return HSTR_RESULT_SUCCESS;
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueMarker(
+    std::vector<HSTR_EVENT> &input_deps,
+    HSTR_STREAM_PRIORITY priority,
+    HSTR_EVENT *completion
+)
+{
+    // Synchronize the enqueues to the physical stream
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    enqueue_priority_ = priority;
+    pruneInputDeps(input_deps);
+    return impl_enqueueMarker(input_deps, completion);
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueuePriorityChange(
+    HSTR_STREAM_PRIORITY from,
+    HSTR_STREAM_PRIORITY to
+)
+{
+    // Only HSTR_DEP_POLICY_BUFFERS chains the computes by priority: the
+    // conservative policy chains all of them together, the access modes
+    // order them by the buffers only
+    if (from == to || out_of_order_ || hStreams_GetOptions_dep_policy() != HSTR_DEP_POLICY_BUFFERS) {
+        return HSTR_RESULT_SUCCESS;
+    }
+
+    // Synchronize the enqueues to the physical stream
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    if (sameEvent(lastAction_[from], lastAction_[to])) {
+        return HSTR_RESULT_SUCCESS;
+    }
+    std::vector<HSTR_EVENT> &input_deps = input_deps_scratch_;
+    input_deps.clear();
+    input_deps.push_back(lastAction_[from]);
+    input_deps.push_back(lastAction_[to]);
+    pruneInputDeps(input_deps);
+    if (input_deps.size() < 2) {
+        // The last compute of either of them is all there's to wait for
+        if (!input_deps.empty()) {
+            lastAction_[to] = input_deps[0];
+        }
+        return HSTR_RESULT_SUCCESS;
+    }
+
+    enqueue_priority_ = to;
+    HSTR_EVENT completion;
+    HSTR_RESULT hret = impl_enqueueMarker(input_deps, &completion);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        return hret;
+    }
+    lastAction_[to] = completion;
+    return HSTR_RESULT_SUCCESS;
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueEventWait(
+    DEP_TYPE input_dep_type,
+    std::vector<hStreams_PhysBuffer *> &input_bufs,
+    HSTR_EVENT const *events,
+    uint32_t num_events,
+    DEP_TYPE output_dep_type,
+    std::vector<hStreams_PhysBuffer *> &output_bufs,
+    HSTR_STREAM_PRIORITY priority,
+    HSTR_EVENT *completion
+)
+{
+    // Synchronize the enqueues to the physical stream
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    enqueue_priority_ = priority;
+    return enqueueEventWaitLocked(input_dep_type, input_bufs, events, num_events,
+                                  output_dep_type, output_bufs, *completion);
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueEventWaitLocked(
+    DEP_TYPE input_dep_type,
+    std::vector<hStreams_PhysBuffer *> &input_bufs,
+    HSTR_EVENT const *events,
+    uint32_t num_events,
+    DEP_TYPE output_dep_type,
+    std::vector<hStreams_PhysBuffer *> &output_bufs,
+    HSTR_EVENT &completion
+)
+{
+    std::vector<HSTR_EVENT> &input_deps = input_deps_scratch_;
+    getInputDeps(input_dep_type, input_bufs, input_deps);
+    input_deps.insert(input_deps.end(), events, events + num_events);
+    pruneInputDeps(input_deps);
+
+    HSTR_RESULT hret = impl_enqueueMarker(input_deps, &completion);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        return hret;
+    }
+    if (output_dep_type != NONE) {
+        setOutputDeps(output_dep_type, output_bufs, completion);
+    }
+    return HSTR_RESULT_SUCCESS;
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueHostCallback(
+    std::vector<hStreams_PhysBuffer *> &bufs,
+    HSTR_HOST_CALLBACK callback,
+    HSTR_LOG_STR log_stream_id,
+    void *user_data,
+    HSTR_STREAM_PRIORITY priority,
+    HSTR_EVENT *completion
+)
+{
+    // Synchronize the enqueues to the physical stream
+    hStreams_Scope_Locker_Unlocker _autolock(lock_);
+    enqueue_priority_ = priority;
+
+    std::vector<HSTR_EVENT> &input_deps = input_deps_scratch_;
+    getInputDeps(IS_BARRIER, bufs, input_deps);
+    pruneInputDeps(input_deps);
+
+    // Nothing to wait for is told by the "no action" placeholder
+    HSTR_EVENT dep;
+    dep.opaque[0] = (uint64_t) - 1;
+    dep.opaque[1] = (uint64_t) - 1;
+    if (input_deps.size() == 1) {
+        dep = input_deps[0];
+    } else if (input_deps.size() > 1) {
+        HSTR_RESULT hret = impl_enqueueMarker(input_deps, &dep);
+        if (hret != HSTR_RESULT_SUCCESS) {
+            return hret;
+        }
+    }
+
+    HSTR_EVENT callback_done = hStreams_HostEvent::create();
+    hStreams_HostCallbacks::submit(dep, callback, log_stream_id, user_data, callback_done);
+    setOutputDeps(IS_BARRIER, bufs, callback_done);
+    *completion = callback_done;
+    return HSTR_RESULT_SUCCESS;
+}
+
+HSTR_RESULT hStreams_PhysStream::enqueueGraph(
+    std::vector<hStreams_GraphNode> &nodes,
+    HSTR_STREAM_PRIORITY priority,
+    HSTR_EVENT *ret_event
+)
+{
+    std::vector<HSTR_EVENT> completions;
+    completions.reserve(nodes.size());
+    HSTR_RESULT hret = HSTR_RESULT_SUCCESS;
+    {
+        // The whole graph is enqueued atomically with respect to the other
+        // enqueues to the stream
+        hStreams_Scope_Locker_Unlocker _autolock(lock_);
+        enqueue_priority_ = priority;
+
+        for (uint64_t idx = 0; idx < nodes.size() && hret == HSTR_RESULT_SUCCESS; ++idx) {
+            hStreams_GraphNode &node = nodes[idx];
+            HSTR_EVENT completion;
+            switch (node.type) {
+            case hStreams_GraphNode::COMPUTE:
+                hret = enqueueComputeLocked(node.marshalled_args,
+                                            node.buffers.empty() ? NULL : &node.buffers[0],
+                                            node.offsets.empty() ? NULL : &node.offsets[0],
+                                            node.access.empty() ? NULL : &node.access[0],
+                                            node.lengths.empty() ? NULL : &node.lengths[0],
+                                            (uint32_t) node.buffers.size(),
+                                            node.ret_val, node.ret_val_size, completion);
+                break;
+            case hStreams_GraphNode::TRANSFER:
+                hret = enqueueTransferLocked(node.regions, completion);
+                break;
+            case hStreams_GraphNode::EVENT_WAIT:
+                hret = enqueueEventWaitLocked(node.input_dep_type, node.buffers,
+                                              node.events.empty() ? NULL : &node.events[0],
+                                              (uint32_t) node.events.size(),
+                                              node.output_dep_type, node.output_buffers, completion);
+                break;
+            }
+            if (hret == HSTR_RESULT_SUCCESS) {
+                completions.push_back(completion);
+            }
+        }
+
+        // One event for the whole launch, if asked for
+        if (hret == HSTR_RESULT_SUCCESS && ret_event != NULL) {
+            std::vector<HSTR_EVENT> &input_deps = input_deps_scratch_;
+            input_deps.assign(completions.begin(), completions.end());
+            pruneInputDeps(input_deps);
+            hret = impl_enqueueMarker(input_deps, ret_event);
+        }
+    } // end of critical section protecting enqueues to the stream
+
+    // Notify the buffers of the actions which have been enqueued. The ones
+    // waited for by the markers aren't, as in enqueueEventWait().
+    for (uint64_t idx = 0; idx < completions.size(); ++idx) {
+        hStreams_GraphNode &node = nodes[idx];
+        if (node.type != hStreams_GraphNode::EVENT_WAIT) {
+            for (uint64_t buf = 0; buf < node.buffers.size(); ++buf) {
+                node.buffers[buf]->addPendingAction(completions[idx]);
+            }
+        }
+    }
+    return hret;
+}
+
+HSTR_RESULT hStreams_PhysStream::impl_enqueueTransfer(
+    std::vector<hStreams_PhysXferRegion> const &regions,
+    std::vector<HSTR_EVENT> &input_deps,
+    HSTR_EVENT *completion
+)
+{
+    // Dependencies on actions in host streams have to be made visible to COI
+    HSTR_COIRESULT coires = hStreams_HostEvent::translateForCOI(input_deps);
+    if (coires != HSTR_COI_SUCCESS) {
+        HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
+                << "Couldn't pass the dependencies on host actions to COI: "
+                << hStreams_COIWrapper::COIResultGetName(coires);
+
+        return HSTR_RESULT_INTERNAL_ERROR;
+    }
+
+    // COI only copies contiguous ranges, so the rows of a strided transfer
+    // are copied one by one, all of them waiting for the same dependencies.
+    // Unless there's a single copy, a marker stands for the whole transfer.
+    bool single_copy = regions.size() == 1 && regions[0].shape.isContiguous();
+    std::vector<HSTR_EVENT> copy_completions;
+    for (uint64_t idx = 0; idx < regions.size() && coires == HSTR_COI_SUCCESS; ++idx) {
+        hStreams_PhysXferRegion const &region = regions[idx];
+        hStreams_XferShape const &shape = region.shape;
+        bool contiguous = shape.isContiguous();
+        uint64_t num_copies = contiguous ? 1 : shape.numRows();
+        uint64_t copy_length = contiguous ? shape.totalBytes() : shape.width;
+        for (uint64_t row = 0; row < num_copies && coires == HSTR_COI_SUCCESS; ++row) {
+            HSTR_EVENT copy_completion;
+            coires = hStreams_COIWrapper::COIBufferCopy(region.dst_buf->getCOIhandle(),
+                     region.src_buf->getCOIhandle(),
+                     region.dst_offset + shape.dstRowOffset(row) + region.dst_buf->getPadding(),
+                     region.src_offset + shape.srcRowOffset(row) + region.src_buf->getPadding(),
+                     copy_length,
+                     HSTR_COI_COPY_UNSPECIFIED,
+                     (int32_t) input_deps.size(),
+                     (input_deps.size()) ? &input_deps[0] : NULL,
+                     single_copy ? completion : &copy_completion);
+            if (!single_copy && coires == HSTR_COI_SUCCESS) {
+                copy_completions.push_back(copy_completion);
+            }
+        }
+    }
+
+    if (coires != HSTR_COI_SUCCESS) {
+        HSTR_ERROR(HSTR_INFO_TYPE_MISC)
+                << "A problem encountered while copying data between buffers: "
+                << hStreams_COIWrapper::COIResultGetName(coires);
+    }
+
+    if (coires == HSTR_COI_MEMORY_OVERLAP) {
+        return HSTR_RESULT_OVERLAPPING_RESOURCES;
+    } else if (coires != HSTR_COI_SUCCESS) {
+        // FIXME handle the cases more appropriately
+        return HSTR_RESULT_REMOTE_ERROR;
+    }
+    if (!single_copy) {
+        return impl_enqueueMarker(copy_completions, completion);
+    }
+    return HSTR_RESULT_SUCCESS;
+}
@@ -19,15 +19,19 @@
 #include "hStreams_PhysStreamCOI.h"
 #include "hStreams_common.h" // for HSTR_MAX_FUNC_NAME_SIZE
 #include "hStreams_internal.h"
+#include "hStreams_HostEvent.h"
 #include "hStreams_Logger.h"
 
 hStreams_PhysStreamCOI::hStreams_PhysStreamCOI(
     hStreams_LogDomain &log_dom,
     hStreams_CPUMask const &cpu_mask,
+    bool out_of_order,
     HSTR_COIPIPELINE coi_pipeline,
-    HSTR_COIFUNCTION thunk_func
+    HSTR_COIFUNCTION thunk_func,
+    HSTR_COIFUNCTION marker_func
 )
-    : hStreams_PhysStream(log_dom, cpu_mask), coi_pipeline_(coi_pipeline), thunk_func_(thunk_func)
+    : hStreams_PhysStream(log_dom, cpu_mask, out_of_order), coi_pipeline_(coi_pipeline), thunk_func_(thunk_func),
+      marker_func_(marker_func)
 {
 }
 
@@ -51,8 +55,18 @@ HSTR_RESULT hStreams_PhysStreamCOI::impl_enqueueFunction(
     void *ret_val, uint16_t ret_val_size, HSTR_EVENT *ret_event
 )
 {
+    // Dependencies on actions in host streams have to be made visible to COI
+    HSTR_COIRESULT coi_res = hStreams_HostEvent::translateForCOI(input_deps);
+    if (HSTR_COI_SUCCESS != coi_res) {
+        HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
+                << "Couldn't pass the dependencies on host actions to COI: "
+                << hStreams_COIWrapper::COIResultGetName(coi_res);
+
+        return HSTR_RESULT_INTERNAL_ERROR;
+    }
+
     HSTR_COI_ACCESS_FLAGS  *flags_ptr = NULL;
-    HSTR_COIRESULT coi_res = hStreams_COIWrapper::COIPipelineRunFunction(
+    coi_res = hStreams_COIWrapper::COIPipelineRunFunction(
                                  coi_pipeline_,
                                  thunk_func_,
                                  0, NULL,
@@ -74,4 +88,41 @@ HSTR_RESULT hStreams_PhysStreamCOI::impl_enqueueFunction(
     return HSTR_RESULT_SUCCESS;
 }
 
+HSTR_RESULT hStreams_PhysStreamCOI::impl_enqueueMarker(
+    std::vector<HSTR_EVENT> &input_deps,
+    HSTR_EVENT *completion
+)
+{
+    // Dependencies on actions in host streams have to be made visible to COI
+    HSTR_COIRESULT coi_res = hStreams_HostEvent::translateForCOI(input_deps);
+    if (HSTR_COI_SUCCESS != coi_res) {
+        HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
+                << "Couldn't pass the dependencies on host actions to COI: "
+                << hStreams_COIWrapper::COIResultGetName(coi_res);
 
+        return HSTR_RESULT_INTERNAL_ERROR;
+    }
+
+    // No buffers, no arguments and no return value, so that the run moves no
+    // data and only the stream's own pipeline gets ordered by it
+    coi_res = hStreams_COIWrapper::COIPipelineRunFunction(
+                  coi_pipeline_,
+                  marker_func_,
+                  0, NULL,
+                  NULL,
+                  (uint32_t)input_deps.size(),
+                  (input_deps.size()) ? &input_deps[0] : NULL,
+                  NULL, 0,
+                  NULL, 0,
+                  completion
+              );
+    if (HSTR_COI_SUCCESS != coi_res) {
+        HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
+                << "A problem occured while gathering the dependencies of a marker, "
+                << "COIPipelineRunFunction returned: "
+                << hStreams_COIWrapper::COIResultGetName(coi_res);
+
+        return HSTR_RESULT_REMOTE_ERROR;
+    }
+    return HSTR_RESULT_SUCCESS;
+}
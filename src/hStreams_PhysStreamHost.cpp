@@ -13,15 +13,17 @@
  */
 
 #include "hStreams_PhysStreamHost.h"
+#include "hStreams_LogBuffer.h"
 #include "hStreams_Logger.h"
 
 hStreams_PhysStreamHost::hStreams_PhysStreamHost(
     hStreams_LogDomain &log_dom,
-    hStreams_CPUMask const &cpu_mask
+    hStreams_CPUMask const &cpu_mask,
+    bool out_of_order
 )
     :
-    hStreams_PhysStream(log_dom, cpu_mask),
-    hostSinkWorker_(new hStreams_HostSideSinkWorker(cpu_mask))
+    hStreams_PhysStream(log_dom, cpu_mask, out_of_order),
+    hostSinkWorker_(new hStreams_HostSideSinkWorker(cpu_mask, out_of_order))
 {
 }
 
@@ -35,21 +37,83 @@ HSTR_RESULT hStreams_PhysStreamHost::impl_enqueueFunction(
     void *ret_val, uint16_t ret_val_size, HSTR_EVENT *ret_event
 )
 {
-    HSTR_EVENT an_event;
-    HSTR_COIRESULT result = hStreams_COIWrapper::COIEventRegisterUserEvent(&an_event);
-    if (result != HSTR_COI_SUCCESS) {
-        HSTR_ERROR(HSTR_INFO_TYPE_SYNC)
-                << "A problem encountered while registering event: "
-                << hStreams_COIWrapper::COIResultGetName(result);
-
-        return HSTR_RESULT_INTERNAL_ERROR;
-    }
+    HSTR_EVENT an_event = hStreams_HostEvent::create();
     *ret_event = an_event;
-    std::unique_ptr<ComputePayload> payload(new ComputePayload(args, input_deps,
-                                            ret_val, ret_val_size, an_event));
-
-    std::unique_ptr<Action> new_action(new Action(COMPUTE, std::move(payload)));
+    std::unique_ptr<Action> new_action(hostSinkWorker_->acquireAction());
+    new_action->setCompute(args, input_deps, ret_val, ret_val_size, an_event);
+    new_action->setPriority(enqueuePriority());
 
     return hostSinkWorker_->putAction(std::move(new_action));
 }
 
+HSTR_RESULT hStreams_PhysStreamHost::impl_enqueueTransfer(
+    std::vector<hStreams_PhysXferRegion> const &regions,
+    std::vector<HSTR_EVENT> &input_deps,
+    HSTR_EVENT *completion
+)
+{
+    std::vector<TransferRegion> &host_regions = host_regions_scratch_;
+    std::vector<hStreams_PhysXferRegion> &coi_regions = coi_regions_scratch_;
+    host_regions.clear();
+    coi_regions.clear();
+    for (uint64_t idx = 0; idx < regions.size(); ++idx) {
+        hStreams_PhysXferRegion const &region = regions[idx];
+        if (!region.dst_buf->isInHostMemory() || !region.src_buf->isInHostMemory()) {
+            coi_regions.push_back(region);
+            continue;
+        }
+
+        // Both buffers live in host memory, the worker copies them directly
+        // even if they are backed by COI buffers
+        uint64_t dst = region.dst_buf->translateToSinkAddress(region.dst_offset);
+        uint64_t src = region.src_buf->translateToSinkAddress(region.src_offset);
+        if (dst < src + region.shape.srcExtent() && src < dst + region.shape.dstExtent()) {
+            HSTR_ERROR(HSTR_INFO_TYPE_MISC)
+                    << "Source and destination ranges of a transfer overlap: "
+                    << region.src_buf->getLogBuffer().getStart() << "+" << region.src_offset << " and "
+                    << region.dst_buf->getLogBuffer().getStart() << "+" << region.dst_offset;
+
+            return HSTR_RESULT_OVERLAPPING_RESOURCES;
+        }
+        TransferRegion host_region = {(void *)dst, (const void *)src, region.shape};
+        host_regions.push_back(host_region);
+    }
+
+    if (host_regions.empty()) {
+        return hStreams_PhysStream::impl_enqueueTransfer(coi_regions, input_deps, completion);
+    }
+
+    HSTR_EVENT an_event = hStreams_HostEvent::create();
+    std::unique_ptr<Action> new_action(hostSinkWorker_->acquireAction());
+    new_action->setTransfer(TRANSFER, &host_regions[0], (uint32_t) host_regions.size(),
+                            input_deps, an_event);
+    new_action->setPriority(enqueuePriority());
+    HSTR_RESULT hret = hostSinkWorker_->putAction(std::move(new_action));
+    if (hret != HSTR_RESULT_SUCCESS || coi_regions.empty()) {
+        *completion = an_event;
+        return hret;
+    }
+
+    // Some of the regions are moved by COI, a marker waits for both parts
+    std::vector<HSTR_EVENT> parts(1, an_event);
+    parts.resize(2);
+    hret = hStreams_PhysStream::impl_enqueueTransfer(coi_regions, input_deps, &parts[1]);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        return hret;
+    }
+    return impl_enqueueMarker(parts, completion);
+}
+
+HSTR_RESULT hStreams_PhysStreamHost::impl_enqueueMarker(
+    std::vector<HSTR_EVENT> &input_deps,
+    HSTR_EVENT *completion
+)
+{
+    HSTR_EVENT an_event = hStreams_HostEvent::create();
+    *completion = an_event;
+    std::unique_ptr<Action> new_action(hostSinkWorker_->acquireAction());
+    new_action->setTransfer(MARKER, NULL, 0, input_deps, an_event);
+    new_action->setPriority(enqueuePriority());
+
+    return hostSinkWorker_->putAction(std::move(new_action));
+}
@@ -0,0 +1,146 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#include "hStreams_RCU.h"
+#include "hStreams_WaitPolicy.h"
+#include "hStreams_internal.h"
+#include "hStreams_locks.h"
+
+// Readers count themselves in one of two sets of counters, picked by the
+// parity of the grace period. A writer flips the parity so that new readers
+// go to the other set and waits for the old set to drain; doing that twice
+// covers the readers which picked the set just before a flip.
+//
+// Each thread gets a counter of its own, on its own cache line. Threads only
+// start sharing the counters when there's more of them than counters.
+namespace
+{
+const uint32_t num_reader_counters = 128;
+
+struct ReaderCounter {
+    std::atomic<uint64_t> count;
+    char pad[HSTR_CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+};
+HSTR_STATIC_ASSERT(sizeof(ReaderCounter) == HSTR_CACHE_LINE_SIZE, reader_counter_fills_a_cache_line);
+
+HSTR_ALIGN(64) ReaderCounter reader_counters[2][num_reader_counters];
+HSTR_ALIGN(64) std::atomic<uint32_t> grace_period(0);
+std::atomic<uint32_t> num_exclusive(0);
+std::atomic<uint32_t> next_reader_counter(0);
+// Serializes the flips of the grace period parity
+hStreams_Lock writers_lock;
+
+// 1 + index of the thread's counter, 0 if it hasn't got one yet
+HSTR_THREAD_LOCAL uint32_t my_counter_plus_one;
+// Depth of nesting of the thread's read-side critical sections
+HSTR_THREAD_LOCAL uint32_t my_nesting;
+// The parity the thread's outermost read-side critical section counted itself in
+HSTR_THREAD_LOCAL uint32_t my_parity;
+
+uint32_t myCounter()
+{
+    if (my_counter_plus_one == 0) {
+        my_counter_plus_one = 1 + next_reader_counter.fetch_add(1, std::memory_order_relaxed)
+                              % num_reader_counters;
+    }
+    return my_counter_plus_one - 1;
+}
+
+class NoExclusive
+{
+public:
+    bool operator()() const
+    {
+        return num_exclusive.load(std::memory_order_acquire) == 0;
+    }
+};
+
+class ReadersGone
+{
+    const uint32_t parity_;
+public:
+    ReadersGone(uint32_t parity) : parity_(parity) {}
+    bool operator()() const
+    {
+        for (uint32_t i = 0; i < num_reader_counters; ++i) {
+            if (reader_counters[parity_][i].count.load(std::memory_order_acquire) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+template <typename Ready>
+void waitUntil(Ready const &ready)
+{
+    if (hStreams_WaitPolicy::spinThenYield(ready) != HSTR_WAIT_PHASE_PARK) {
+        return;
+    }
+    while (!ready()) {
+        hStreams_SleepMS(1);
+    }
+}
+} // anonymous namespace
+
+void hStreams_RCU::readLock()
+{
+    if (my_nesting++ > 0) {
+        return;
+    }
+    const uint32_t counter = myCounter();
+    for (;;) {
+        const uint32_t parity = grace_period.load(std::memory_order_relaxed) & 1;
+        reader_counters[parity][counter].count.fetch_add(1, std::memory_order_relaxed);
+        // Pairs with the fence in synchronize(): either the writer sees our
+        // counter or we see what it had published before
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (num_exclusive.load(std::memory_order_relaxed) == 0) {
+            my_parity = parity;
+            return;
+        }
+        reader_counters[parity][counter].count.fetch_sub(1, std::memory_order_release);
+        waitUntil(NoExclusive());
+    }
+}
+
+void hStreams_RCU::readUnlock()
+{
+    if (--my_nesting > 0) {
+        return;
+    }
+    reader_counters[my_parity][myCounter()].count.fetch_sub(1, std::memory_order_release);
+}
+
+void hStreams_RCU::synchronize()
+{
+    hStreams_Scope_Locker_Unlocker lock(writers_lock);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (int flip = 0; flip < 2; ++flip) {
+        const uint32_t old_parity = grace_period.fetch_add(1, std::memory_order_seq_cst) & 1;
+        waitUntil(ReadersGone(old_parity));
+    }
+}
+
+void hStreams_RCU::exclusiveLock()
+{
+    num_exclusive.fetch_add(1, std::memory_order_seq_cst);
+    // Readers which didn't notice us yet are waited out like for any update
+    synchronize();
+}
+
+void hStreams_RCU::exclusiveUnlock()
+{
+    num_exclusive.fetch_sub(1, std::memory_order_release);
+}
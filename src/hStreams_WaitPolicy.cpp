@@ -0,0 +1,62 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#include "hStreams_WaitPolicy.h"
+#include "hStreams_helpers_source.h"
+#include "hStreams_internal_vars_source.h"
+#include "hStreams_Logger.h"
+
+namespace
+{
+// A thread handing work over to the host worker typically does so within a
+// few microseconds, so that much spinning pays off. On a single CPU the
+// thread we wait for can't make progress while we spin, so only yield there.
+const uint64_t default_spin_ns = 10000;
+const uint64_t default_yield_ns = 50000;
+// Anything longer than this is better spent asleep
+const uint64_t max_budget_ns = 1000000000;
+} // anonymous namespace
+
+std::atomic<uint64_t> hStreams_WaitPolicy::spin_ns_(0);
+std::atomic<uint64_t> hStreams_WaitPolicy::yield_ns_(0);
+
+hStreams_WaitStats::hStreams_WaitStats()
+{
+    for (uint32_t i = 0; i < HSTR_WAIT_PHASE_COUNT; ++i) {
+        hits_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, hStreams_WaitStats const &stats)
+{
+    return os << "immediate: " << stats.get(HSTR_WAIT_PHASE_IMMEDIATE)
+           << ", spin: " << stats.get(HSTR_WAIT_PHASE_SPIN)
+           << ", yield: " << stats.get(HSTR_WAIT_PHASE_YIELD)
+           << ", park: " << stats.get(HSTR_WAIT_PHASE_PARK);
+}
+
+void hStreams_WaitPolicy::readFromEnv()
+{
+    bool multi_cpu = std::thread::hardware_concurrency() > 1;
+    spin_ns_.store(hStreams_GetEnvNumber(host_spin_ns_env_name, multi_cpu ? default_spin_ns : 0,
+                                         max_budget_ns, "nanoseconds"),
+                   std::memory_order_relaxed);
+    yield_ns_.store(hStreams_GetEnvNumber(host_yield_ns_env_name, default_yield_ns,
+                                          max_budget_ns, "nanoseconds"),
+                    std::memory_order_relaxed);
+
+    HSTR_DEBUG1(HSTR_INFO_TYPE_SYNC)
+            << "Host waiters spin for " << spinNs() << " ns and yield for "
+            << yieldNs() << " ns before going to sleep";
+}
@@ -1220,3 +1220,88 @@ HSTR_EXPORT_IN_DEFAULT_VERSION(
         HSTR_RETURN(hStreams_handle_exception());
     }
 }
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_app_dag_create)(
+        uint32_t            in_NumLogStreams,
+        HSTR_LOG_STR       *in_pLogStreamIDs,
+        uint64_t            in_BytesPerCostUnit,
+        HSTR_DAG           *out_pDag)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_NumLogStreams);
+        HSTR_TRACE_API_ARG(in_pLogStreamIDs);
+        HSTR_TRACE_API_ARG(in_BytesPerCostUnit);
+        HSTR_TRACE_API_ARG(out_pDag);
+        detail::app_dag_create_impl_throw(in_NumLogStreams, in_pLogStreamIDs,
+                                          in_BytesPerCostUnit, out_pDag);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_app_dag_add_task)(
+        HSTR_DAG            in_Dag,
+        const char         *in_pFunctionName,
+        uint32_t            in_NumScalarArgs,
+        uint32_t            in_NumHeapArgs,
+        uint64_t           *in_pArgs,
+        HSTR_ACCESS_MODE   *in_pHeapArgAccess,
+        uint64_t            in_Cost,
+        uint32_t           *out_pTaskID)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_Dag);
+        HSTR_TRACE_API_ARG_STR(in_pFunctionName);
+        HSTR_TRACE_API_ARG(in_NumScalarArgs);
+        HSTR_TRACE_API_ARG(in_NumHeapArgs);
+        HSTR_TRACE_API_ARG(in_pArgs);
+        HSTR_TRACE_API_ARG(in_pHeapArgAccess);
+        HSTR_TRACE_API_ARG(in_Cost);
+        HSTR_TRACE_API_ARG(out_pTaskID);
+        detail::app_dag_add_task_impl_throw(in_Dag, in_pFunctionName, in_NumScalarArgs,
+                                            in_NumHeapArgs, in_pArgs, in_pHeapArgAccess,
+                                            in_Cost, out_pTaskID);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_app_dag_execute)(
+        HSTR_DAG            in_Dag,
+        HSTR_DAG_POLICY     in_Policy)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_Dag);
+        HSTR_TRACE_API_ARG(in_Policy);
+        detail::app_dag_execute_impl_throw(in_Dag, in_Policy);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_app_dag_destroy)(
+        HSTR_DAG            in_Dag)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_Dag);
+        detail::app_dag_destroy_impl_throw(in_Dag);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
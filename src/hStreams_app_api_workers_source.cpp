@@ -17,11 +17,14 @@
 #include "hStreams_exceptions.h"
 #include "hStreams_helpers_source.h"
 #include "hStreams_Logger.h"
+#include "hStreams_Dag.h"
 
 #include "hStreams_internal_vars_source.h"
 
+#include <memory>
 #include <vector>
 #include <numeric>
+#include <algorithm>
 
 void
 detail::app_init_domains_in_version_impl_throw(
@@ -371,8 +374,9 @@ detail::app_init_in_version_impl_throw(
                                   );
     }
 
-    HSTR_LOG_DOM num_phys_log_domains; // 1 logical domain on each physical domain
-    hStreams_COIWrapper::COIEngineGetCount(HSTR_ISA_MIC, &num_phys_log_domains);
+    // 1 logical domain on each physical domain. Use the count from hStreams_Init,
+    // COI might not be available at all.
+    HSTR_LOG_DOM num_phys_log_domains = hstr_proc.myNumPhysDomains;
     std::vector<uint32_t> places_per_domain(num_phys_log_domains, in_StreamsPerDomain);
 
     app_init_domains_in_version_impl_throw(
@@ -730,3 +734,202 @@ detail::app_zgemm_impl_throw(
         NULL,          // return value pointer
         0);            // return value size
 } // detail::app_zgemm_impl_throw
+
+namespace
+{
+hStreams_Dag *dag_from_handle_throw(HSTR_DAG in_Dag)
+{
+    hStreams_RW_Scope_Locker_Unlocker dags_scope_lock(globals::dags_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+
+    std::map<HSTR_DAG, hStreams_Dag *>::const_iterator it = globals::dags.find(in_Dag);
+    if (it == globals::dags.end()) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << in_Dag
+                                   << " is not a valid DAG"
+                                  );
+    }
+    return it->second;
+}
+
+// Append the IDs of the logical streams of a physical domain and of their
+// logical domains
+void
+get_phys_domain_streams(
+    HSTR_PHYS_DOM                in_PhysDomainID,
+    std::vector<HSTR_LOG_STR>   &streams,
+    std::vector<HSTR_LOG_DOM>   &stream_domains)
+{
+    uint32_t num_log_domains;
+    detail::GetNumLogDomains_impl_throw(in_PhysDomainID, &num_log_domains);
+    if (num_log_domains == 0) {
+        return;
+    }
+    std::vector<HSTR_LOG_DOM> log_domains(num_log_domains);
+    detail::GetLogDomainIDList_impl_throw(in_PhysDomainID, num_log_domains, &log_domains[0]);
+
+    for (uint32_t dom = 0; dom < num_log_domains; ++dom) {
+        uint32_t num_log_streams;
+        detail::GetNumLogStreams_impl_throw(log_domains[dom], &num_log_streams);
+        if (num_log_streams == 0) {
+            continue;
+        }
+        std::vector<HSTR_LOG_STR> log_streams(num_log_streams);
+        detail::GetLogStreamIDList_impl_throw(log_domains[dom], num_log_streams, &log_streams[0]);
+        streams.insert(streams.end(), log_streams.begin(), log_streams.end());
+        stream_domains.insert(stream_domains.end(), num_log_streams, log_domains[dom]);
+    }
+}
+} // anonymous namespace
+
+void
+detail::app_dag_create_impl_throw(
+    uint32_t            in_NumLogStreams,
+    HSTR_LOG_STR       *in_pLogStreamIDs,
+    uint64_t            in_BytesPerCostUnit,
+    HSTR_DAG           *out_pDag)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_NumLogStreams);
+    HSTR_TRACE_FUN_ARG(in_pLogStreamIDs);
+    HSTR_TRACE_FUN_ARG(in_BytesPerCostUnit);
+    HSTR_TRACE_FUN_ARG(out_pDag);
+    IsInitialized_impl_throw();
+
+    if (out_pDag == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "out_pDag cannot be NULL"
+                                  );
+    }
+    if ((in_NumLogStreams == 0) != (in_pLogStreamIDs == NULL)) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_INCONSISTENT_ARGS, StringBuilder()
+                                   << "in_pLogStreamIDs must be NULL if and only if in_NumLogStreams is 0"
+                                  );
+    }
+
+    // Find out the logical domains of all the streams
+    uint32_t num_phys_domains, num_active_phys_domains;
+    bool homogeneous;
+    GetNumPhysDomains_impl_throw(&num_phys_domains, &num_active_phys_domains, &homogeneous);
+    std::vector<HSTR_LOG_STR> all_streams;
+    std::vector<HSTR_LOG_DOM> all_stream_domains;
+    get_phys_domain_streams(HSTR_SRC_PHYS_DOMAIN, all_streams, all_stream_domains);
+    for (HSTR_PHYS_DOM phys_dom = 0; phys_dom < (HSTR_PHYS_DOM) num_active_phys_domains; ++phys_dom) {
+        get_phys_domain_streams(phys_dom, all_streams, all_stream_domains);
+    }
+
+    std::vector<HSTR_LOG_STR> streams;
+    std::vector<HSTR_LOG_DOM> stream_domains;
+    if (in_pLogStreamIDs == NULL) {
+        streams.swap(all_streams);
+        stream_domains.swap(all_stream_domains);
+    } else {
+        for (uint32_t idx = 0; idx < in_NumLogStreams; ++idx) {
+            std::vector<HSTR_LOG_STR>::iterator it = std::find(all_streams.begin(), all_streams.end(),
+                    in_pLogStreamIDs[idx]);
+            if (it == all_streams.end()) {
+                throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                           << "Logical stream with ID "
+                                           << in_pLogStreamIDs[idx]
+                                           << " doesn't exist"
+                                          );
+            }
+            streams.push_back(*it);
+            stream_domains.push_back(all_stream_domains[it - all_streams.begin()]);
+        }
+    }
+    if (streams.empty()) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "There are no logical streams to schedule the tasks onto"
+                                  );
+    }
+
+    std::unique_ptr<hStreams_Dag> dag(new hStreams_Dag(streams, stream_domains, in_BytesPerCostUnit));
+
+    hStreams_RW_Scope_Locker_Unlocker dags_scope_lock(globals::dags_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
+    HSTR_DAG handle = globals::next_dag_handle++;
+    globals::dags[handle] = dag.get();
+    dag.release();
+    *out_pDag = handle;
+} // detail::app_dag_create_impl_throw
+
+void
+detail::app_dag_add_task_impl_throw(
+    HSTR_DAG            in_Dag,
+    const char         *in_pFunctionName,
+    uint32_t            in_NumScalarArgs,
+    uint32_t            in_NumHeapArgs,
+    uint64_t           *in_pArgs,
+    HSTR_ACCESS_MODE   *in_pHeapArgAccess,
+    uint64_t            in_Cost,
+    uint32_t           *out_pTaskID)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_Dag);
+    HSTR_TRACE_FUN_ARG_STR(in_pFunctionName);
+    HSTR_TRACE_FUN_ARG(in_NumScalarArgs);
+    HSTR_TRACE_FUN_ARG(in_NumHeapArgs);
+    HSTR_TRACE_FUN_ARG(in_pArgs);
+    HSTR_TRACE_FUN_ARG(in_pHeapArgAccess);
+    HSTR_TRACE_FUN_ARG(in_Cost);
+    HSTR_TRACE_FUN_ARG(out_pTaskID);
+    IsInitialized_impl_throw();
+
+    hStreams_Dag *dag = dag_from_handle_throw(in_Dag);
+    if (in_pFunctionName == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "in_pFunctionName cannot be NULL"
+                                  );
+    }
+    if (in_NumScalarArgs + in_NumHeapArgs && !in_pArgs) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "in_pArgs cannot be NULL if in_NumScalarArgs != 0 && in_NumHeapArgs != 0 "
+                                  );
+    }
+
+    uint32_t task_id = dag->addTask(in_pFunctionName, in_NumScalarArgs, in_NumHeapArgs,
+                                    in_pArgs, in_pHeapArgAccess, in_Cost);
+    if (out_pTaskID != NULL) {
+        *out_pTaskID = task_id;
+    }
+} // detail::app_dag_add_task_impl_throw
+
+void
+detail::app_dag_execute_impl_throw(
+    HSTR_DAG            in_Dag,
+    HSTR_DAG_POLICY     in_Policy)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_Dag);
+    HSTR_TRACE_FUN_ARG(in_Policy);
+    IsInitialized_impl_throw();
+
+    dag_from_handle_throw(in_Dag)->execute(in_Policy);
+} // detail::app_dag_execute_impl_throw
+
+void
+detail::app_dag_destroy_impl_throw(
+    HSTR_DAG            in_Dag)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_Dag);
+    IsInitialized_impl_throw();
+
+    hStreams_Dag *dag;
+    {
+        hStreams_RW_Scope_Locker_Unlocker dags_scope_lock(globals::dags_lock,
+                hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
+
+        std::map<HSTR_DAG, hStreams_Dag *>::iterator it = globals::dags.find(in_Dag);
+        if (it == globals::dags.end()) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                       << in_Dag
+                                       << " is not a valid DAG"
+                                      );
+        }
+        dag = it->second;
+        globals::dags.erase(it);
+    }
+    delete dag;
+} // detail::app_dag_destroy_impl_throw
@@ -548,7 +548,7 @@ HSTR_EXPORT_IN_VERSION(
         HSTR_CORE_API_CALLCOUNTER();
 
         detail::StreamCreate_impl_throw(in_LogStreamID, in_LogDomainID,
-                                        in_CPUmask);
+                                        in_CPUmask, HSTR_STREAM_IN_ORDER);
         HSTR_RETURN(HSTR_RESULT_SUCCESS);
     } catch (...) {
         HSTR_RETURN(hStreams_handle_exception());
@@ -570,7 +570,31 @@ HSTR_EXPORT_IN_DEFAULT_VERSION(
         HSTR_CORE_API_CALLCOUNTER();
 
         detail::StreamCreate_impl_throw(in_LogStreamID, in_LogDomainID,
-                                        in_CPUmask);
+                                        in_CPUmask, HSTR_STREAM_IN_ORDER);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_StreamCreateEx)(
+        HSTR_LOG_STR        in_LogStreamID,
+        HSTR_LOG_DOM        in_LogDomainID,
+        const HSTR_CPU_MASK in_CPUmask,
+        HSTR_STREAM_FLAGS   in_Flags)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(in_LogDomainID);
+        HSTR_TRACE_API_ARG(in_CPUmask);
+        HSTR_TRACE_API_ARG(in_Flags);
+        HSTR_CORE_API_CALLCOUNTER();
+
+        detail::StreamCreate_impl_throw(in_LogStreamID, in_LogDomainID,
+                                        in_CPUmask, in_Flags);
         HSTR_RETURN(HSTR_RESULT_SUCCESS);
     } catch (...) {
         HSTR_RETURN(hStreams_handle_exception());
@@ -729,6 +753,62 @@ HSTR_EXPORT_IN_DEFAULT_VERSION(
     }
 }
 
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_GetLogStreamDepStats)(
+        HSTR_LOG_STR      in_LogStreamID,
+        uint64_t         *out_pNumSubmitted,
+        uint64_t         *out_pNumPruned)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(out_pNumSubmitted);
+        HSTR_TRACE_API_ARG(out_pNumPruned);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::GetLogStreamDepStats_impl_throw(in_LogStreamID, out_pNumSubmitted, out_pNumPruned);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_StreamSetPriority)(
+        HSTR_LOG_STR            in_LogStreamID,
+        HSTR_STREAM_PRIORITY    in_Priority)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(in_Priority);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::StreamSetPriority_impl_throw(in_LogStreamID, in_Priority);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_StreamGetPriority)(
+        HSTR_LOG_STR            in_LogStreamID,
+        HSTR_STREAM_PRIORITY   *out_pPriority)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(out_pPriority);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::StreamGetPriority_impl_throw(in_LogStreamID, out_pPriority);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
 HSTR_EXPORT_IN_VERSION(
     HSTR_RESULT,
     hStreams_EnqueueCompute,
@@ -845,6 +925,107 @@ HSTR_EXPORT_IN_DEFAULT_VERSION(
     }
 }
 
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_GetFunctionHandle)(
+        const char         *in_pFunctionName,
+        HSTR_FUNC_HANDLE   *out_pFunctionHandle)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG_STR(in_pFunctionName);
+        HSTR_TRACE_API_ARG(out_pFunctionHandle);
+        HSTR_CORE_API_CALLCOUNTER();
+
+        detail::GetFunctionHandle_impl_throw(in_pFunctionName, out_pFunctionHandle);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_EnqueueComputeByHandle)(
+        HSTR_LOG_STR        in_LogStreamID,
+        HSTR_FUNC_HANDLE    in_FunctionHandle,
+        uint32_t            in_numScalarArgs,
+        uint32_t            in_numHeapArgs,
+        uint64_t           *in_pArgs,
+        HSTR_EVENT         *out_pEvent,
+        void               *out_ReturnValue,
+        uint16_t            in_ReturnValueSize)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(in_FunctionHandle);
+        HSTR_TRACE_API_ARG(in_numScalarArgs);
+        HSTR_TRACE_API_ARG(in_numHeapArgs);
+        HSTR_TRACE_API_ARG(in_pArgs);
+        HSTR_TRACE_API_ARG(out_pEvent);
+        HSTR_TRACE_API_ARG(out_ReturnValue);
+        HSTR_TRACE_API_ARG(in_ReturnValueSize);
+        HSTR_CORE_API_CALLCOUNTER();
+
+        detail::EnqueueComputeByHandle_impl_throw(in_LogStreamID,
+                in_FunctionHandle,
+                in_numScalarArgs,
+                in_numHeapArgs,
+                in_pArgs,
+                out_pEvent,
+                out_ReturnValue,
+                in_ReturnValueSize);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_EnqueueComputeEx)(
+        HSTR_LOG_STR        in_LogStreamID,
+        const char         *in_pFunctionName,
+        uint32_t            in_numScalarArgs,
+        uint32_t            in_numHeapArgs,
+        uint64_t           *in_pArgs,
+        HSTR_ACCESS_MODE   *in_pHeapArgAccess,
+        uint64_t           *in_pHeapArgSizes,
+        HSTR_EVENT         *out_pEvent,
+        void               *out_ReturnValue,
+        uint16_t            in_ReturnValueSize)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG_STR(in_pFunctionName);
+        HSTR_TRACE_API_ARG(in_numScalarArgs);
+        HSTR_TRACE_API_ARG(in_numHeapArgs);
+        HSTR_TRACE_API_ARG(in_pArgs);
+        HSTR_TRACE_API_ARG(in_pHeapArgAccess);
+        HSTR_TRACE_API_ARG(in_pHeapArgSizes);
+        HSTR_TRACE_API_ARG(out_pEvent);
+        HSTR_TRACE_API_ARG(out_ReturnValue);
+        HSTR_TRACE_API_ARG(in_ReturnValueSize);
+        HSTR_CORE_API_CALLCOUNTER();
+
+        detail::EnqueueComputeEx_impl_throw(in_LogStreamID,
+                                            in_pFunctionName,
+                                            in_numScalarArgs,
+                                            in_numHeapArgs,
+                                            in_pArgs,
+                                            in_pHeapArgAccess,
+                                            in_pHeapArgSizes,
+                                            out_pEvent,
+                                            out_ReturnValue,
+                                            in_ReturnValueSize);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
 HSTR_EXPORT_IN_VERSION(
     HSTR_RESULT,
     hStreams_EnqueueData1D,
@@ -981,6 +1162,132 @@ HSTR_EXPORT_IN_DEFAULT_VERSION(
     }
 }
 
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_EnqueueData2D)(
+        HSTR_LOG_STR        in_LogStreamID,
+        void               *in_pWriteAddr,
+        uint64_t            in_WritePitch,
+        void               *in_pReadAddr,
+        uint64_t            in_ReadPitch,
+        uint64_t            in_Width,
+        uint64_t            in_Height,
+        HSTR_XFER_DIRECTION in_XferDirection,
+        HSTR_EVENT         *out_pEvent)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(in_pWriteAddr);
+        HSTR_TRACE_API_ARG(in_WritePitch);
+        HSTR_TRACE_API_ARG(in_pReadAddr);
+        HSTR_TRACE_API_ARG(in_ReadPitch);
+        HSTR_TRACE_API_ARG(in_Width);
+        HSTR_TRACE_API_ARG(in_Height);
+        HSTR_TRACE_API_ARG(in_XferDirection);
+        HSTR_TRACE_API_ARG(out_pEvent);
+        HSTR_CORE_API_CALLCOUNTER();
+
+        detail::EnqueueData2D_impl_throw(in_LogStreamID,
+                                         in_pWriteAddr,
+                                         in_WritePitch,
+                                         in_pReadAddr,
+                                         in_ReadPitch,
+                                         in_Width,
+                                         in_Height,
+                                         in_XferDirection,
+                                         out_pEvent);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_EnqueueData3D)(
+        HSTR_LOG_STR        in_LogStreamID,
+        void               *in_pWriteAddr,
+        uint64_t            in_WritePitch,
+        uint64_t            in_WriteSlicePitch,
+        void               *in_pReadAddr,
+        uint64_t            in_ReadPitch,
+        uint64_t            in_ReadSlicePitch,
+        uint64_t            in_Width,
+        uint64_t            in_Height,
+        uint64_t            in_Depth,
+        HSTR_XFER_DIRECTION in_XferDirection,
+        HSTR_EVENT         *out_pEvent)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(in_pWriteAddr);
+        HSTR_TRACE_API_ARG(in_WritePitch);
+        HSTR_TRACE_API_ARG(in_WriteSlicePitch);
+        HSTR_TRACE_API_ARG(in_pReadAddr);
+        HSTR_TRACE_API_ARG(in_ReadPitch);
+        HSTR_TRACE_API_ARG(in_ReadSlicePitch);
+        HSTR_TRACE_API_ARG(in_Width);
+        HSTR_TRACE_API_ARG(in_Height);
+        HSTR_TRACE_API_ARG(in_Depth);
+        HSTR_TRACE_API_ARG(in_XferDirection);
+        HSTR_TRACE_API_ARG(out_pEvent);
+        HSTR_CORE_API_CALLCOUNTER();
+
+        detail::EnqueueData3D_impl_throw(in_LogStreamID,
+                                         in_pWriteAddr,
+                                         in_WritePitch,
+                                         in_WriteSlicePitch,
+                                         in_pReadAddr,
+                                         in_ReadPitch,
+                                         in_ReadSlicePitch,
+                                         in_Width,
+                                         in_Height,
+                                         in_Depth,
+                                         in_XferDirection,
+                                         out_pEvent);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_EnqueueDataList)(
+        HSTR_LOG_STR        in_LogStreamID,
+        uint32_t            in_NumRegions,
+        void              **in_pWriteAddrs,
+        void              **in_pReadAddrs,
+        uint64_t           *in_pSizes,
+        HSTR_XFER_DIRECTION in_XferDirection,
+        HSTR_EVENT         *out_pEvent)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(in_NumRegions);
+        HSTR_TRACE_API_ARG(in_pWriteAddrs);
+        HSTR_TRACE_API_ARG(in_pReadAddrs);
+        HSTR_TRACE_API_ARG(in_pSizes);
+        HSTR_TRACE_API_ARG(in_XferDirection);
+        HSTR_TRACE_API_ARG(out_pEvent);
+        HSTR_CORE_API_CALLCOUNTER();
+
+        detail::EnqueueDataList_impl_throw(in_LogStreamID,
+                                           in_NumRegions,
+                                           in_pWriteAddrs,
+                                           in_pReadAddrs,
+                                           in_pSizes,
+                                           in_XferDirection,
+                                           out_pEvent);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
 
 HSTR_EXPORT_IN_VERSION(
     HSTR_RESULT,
@@ -1164,6 +1471,117 @@ HSTR_EXPORT_IN_DEFAULT_VERSION(
     }
 }
 
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_EnqueueHostCallback)(
+        HSTR_LOG_STR       in_LogStreamID,
+        HSTR_HOST_CALLBACK in_Callback,
+        void              *in_pUserData,
+        HSTR_EVENT        *out_pEvent)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(in_pUserData);
+        HSTR_TRACE_API_ARG(out_pEvent);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::EnqueueHostCallback_impl_throw(in_LogStreamID, in_Callback, in_pUserData, out_pEvent);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_GraphBeginCapture)(
+        HSTR_LOG_STR      in_LogStreamID)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::GraphBeginCapture_impl_throw(in_LogStreamID);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_GraphEndCapture)(
+        HSTR_LOG_STR      in_LogStreamID,
+        HSTR_GRAPH       *out_pGraph)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_LogStreamID);
+        HSTR_TRACE_API_ARG(out_pGraph);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::GraphEndCapture_impl_throw(in_LogStreamID, out_pGraph);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_GraphLaunch)(
+        HSTR_GRAPH        in_Graph,
+        HSTR_EVENT       *out_pEvent)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_Graph);
+        HSTR_TRACE_API_ARG(out_pEvent);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::GraphLaunch_impl_throw(in_Graph, out_pEvent);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_GraphSetScalarArg)(
+        HSTR_GRAPH        in_Graph,
+        uint32_t          in_ActionIndex,
+        uint32_t          in_ArgIndex,
+        uint64_t          in_Value)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_Graph);
+        HSTR_TRACE_API_ARG(in_ActionIndex);
+        HSTR_TRACE_API_ARG(in_ArgIndex);
+        HSTR_TRACE_API_ARG(in_Value);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::GraphSetScalarArg_impl_throw(in_Graph, in_ActionIndex, in_ArgIndex, in_Value);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_GraphDestroy)(
+        HSTR_GRAPH        in_Graph)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_Graph);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::GraphDestroy_impl_throw(in_Graph);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
 HSTR_EXPORT_IN_VERSION(
     HSTR_RESULT,
     hStreams_Alloc1D,
@@ -1514,6 +1932,29 @@ HSTR_EXPORT_IN_DEFAULT_VERSION(
     }
 }
 
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_GetBufferNumaNode)(
+        void                *in_Address,
+        HSTR_LOG_DOM         in_LogDomainID,
+        int32_t             *out_pNumaNode)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_Address);
+        HSTR_TRACE_API_ARG(in_LogDomainID);
+        HSTR_TRACE_API_ARG(out_pNumaNode);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::GetBufferNumaNode_impl_throw(
+            in_Address,
+            in_LogDomainID,
+            out_pNumaNode);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
 HSTR_EXPORT_IN_VERSION(
     HSTR_RESULT,
     hStreams_DeAlloc,
@@ -1649,6 +2090,22 @@ HSTR_EXPORT_IN_DEFAULT_VERSION(
     }
 }
 
+HSTR_EXPORT_IN_DEFAULT_VERSION(
+    HSTR_RESULT,
+    hStreams_Cfg_SetHostBufferAliasing)(
+        bool in_Enable)
+{
+    try {
+        HSTR_TRACE_API_ENTER();
+        HSTR_TRACE_API_ARG(in_Enable);
+        HSTR_CORE_API_CALLCOUNTER();
+        detail::Cfg_SetHostBufferAliasing(in_Enable);
+        HSTR_RETURN(HSTR_RESULT_SUCCESS);
+    } catch (...) {
+        HSTR_RETURN(hStreams_handle_exception());
+    }
+}
+
 HSTR_EXPORT_IN_VERSION(
     uint32_t,
     hStreams_GetVerbose,
@@ -24,6 +24,12 @@
 #include "hStreams_PhysDomainHost.h"
 #include "hStreams_PhysDomainCOI.h"
 #include "hStreams_LogBuffer.h"
+#include "hStreams_HostEvent.h"
+#include "hStreams_HostCallbacks.h"
+#include "hStreams_Graph.h"
+#include "hStreams_Dag.h"
+#include "hStreams_RCU.h"
+#include "hStreams_WaitPolicy.h"
 #include "hStreams_COIWrapper_types.h"
 
 namespace
@@ -112,14 +118,10 @@ detail::InitInVersion_impl_throw(const char *interface_version)
     hStreams_ClearLastError();
 
 
-    assert(0 == (((uint64_t)&hstr_proc.dummy_buf) & 63));
-    assert(0 == (((uint64_t)&hstr_proc.dummy_data) & 63));
-
-    uint32_t            active_domains_knc, num_phys_domains_knc,
-                        active_domains_x200, num_phys_domains_x200;
+    uint32_t            active_domains_knc = 0, num_phys_domains_knc = 0,
+                        active_domains_x200 = 0, num_phys_domains_x200 = 0;
     string              executableFileName;
     HSTR_RESULT         hsr;
-    HSTR_COIRESULT      result;
     HSTR_COIPROCESS     dummy_process_knc = NULL, dummy_process_x200 = NULL, dummy_process = NULL;
 
     if ((hsr = hStreams_FetchExecutableName(executableFileName)) != HSTR_RESULT_SUCCESS) {
@@ -134,13 +136,19 @@ detail::InitInVersion_impl_throw(const char *interface_version)
     // Set search paths for libraries from environment variables
     setSearchedPaths();
 
-    InitPhysicalDomains_impl_throw(HSTR_ISA_KNC, executableFileName,
-                                   "x100_card_startup", (void *)x100_card_startup, x100_card_startup_size,
-                                   active_domains_knc, dummy_process_knc, num_phys_domains_knc);
+    // How the host-side waiters balance latency against burning the CPU
+    hStreams_WaitPolicy::readFromEnv();
 
-    InitPhysicalDomains_impl_throw(HSTR_ISA_KNL, executableFileName,
-                                   "x200_card_startup", (void *)x200_card_startup, x200_card_startup_size,
-                                   active_domains_x200, dummy_process_x200, num_phys_domains_x200);
+    // Without COI (no MPSS installed) there can be no cards, the host is still usable
+    if (hStreams_COIWrapper::isAvailable()) {
+        InitPhysicalDomains_impl_throw(HSTR_ISA_KNC, executableFileName,
+                                       "x100_card_startup", (void *)x100_card_startup, x100_card_startup_size,
+                                       active_domains_knc, dummy_process_knc, num_phys_domains_knc);
+
+        InitPhysicalDomains_impl_throw(HSTR_ISA_KNL, executableFileName,
+                                       "x200_card_startup", (void *)x200_card_startup, x200_card_startup_size,
+                                       active_domains_x200, dummy_process_x200, num_phys_domains_x200);
+    }
 
     //This shouldn't happened, cannot have both card types in system.
     if (num_phys_domains_knc * num_phys_domains_x200 > 0) {
@@ -166,30 +174,16 @@ detail::InitInVersion_impl_throw(const char *interface_version)
     log_domains.addToCollection(source_log_dom);
 
 
-    if (active_domains_knc == 0 && active_domains_x200 == 0) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_DEVICE_NOT_INITIALIZED, StringBuilder()
-                                   << "No active MIC cards in the system. Use of hStreams is not permitted"
-                                  );
+    // Without active cards, the host domain's buffers, transfers and events
+    // don't go through COI at all
+    hstr_proc.hostOnly = (active_domains_knc == 0 && active_domains_x200 == 0);
+    if (hstr_proc.hostOnly) {
+        HSTR_LOG(HSTR_INFO_TYPE_MISC) << "No active MIC cards in the system, only the host will be used";
     }
 
     // Check that all physical domains have the same resources
     hstr_proc.homogeneous = phys_domains.isHomogenous();
 
-    // Create dummy buffer for EventStreamWait
-    result = hStreams_COIWrapper::COIBufferCreate(
-                 1,                             // Size: 1. Smallest performant size
-                 HSTR_COI_BUFFER_OPENCL,             // COI Buffer Type: OCL, non-thread specific
-                 0,                             // Flags: 0
-                 NULL,                          // not initialized
-                 1, &dummy_process, // Unused but required
-                 &hstr_proc.dummy_buf);        // Assign to pointer to COIBuffer
-    if (result != HSTR_COI_SUCCESS) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_DEVICE_NOT_INITIALIZED, StringBuilder()
-                                   << "A problem encountered while creating a helper buffer: "
-                                   << hStreams_COIWrapper::COIResultGetName(result)
-                                  );
-    }
-
     // Check envirables for 2M buffer usage.  DMA is faster if host and device
     //   use 2MB.
     // Host usage of 2MB requires either
@@ -246,6 +240,7 @@ void detail::InitPhysicalDomains_impl_throw(HSTR_ISA_TYPE isa_type, std::string
     uint32_t            i, first_valid_domainID = (uint32_t) - 1;
     const char         *thunk_name                  = "hStreamsThunk";
     const char         *fetchSinkFuncAddress_name   = "hStreams_fetchSinkFuncAddress";
+    const char         *marker_name                 = "hStreams_marker_sink";
     HSTR_COIRESULT      result;
 
     // May return HSTR_COI_DOES_NOT_EXIST if isa_type is not matched
@@ -352,6 +347,18 @@ void detail::InitPhysicalDomains_impl_throw(HSTR_ISA_TYPE isa_type, std::string
                                        << hStreams_COIWrapper::COIResultGetName(coi_res)
                                       );
         }
+
+        // Get the handle for the no-op run by the marker actions
+        HSTR_COIFUNCTION marker_func;
+        coi_res = hStreams_COIWrapper::COIProcessGetFunctionHandles(coi_process, 1, &marker_name, &marker_func);
+        if (coi_res != HSTR_COI_SUCCESS) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
+                                       << "Sink-side library does not contain a function named "
+                                       << marker_name
+                                       << ", COIProcessGetFunctionHandles returned "
+                                       << hStreams_COIWrapper::COIResultGetName(coi_res)
+                                      );
+        }
         // The helper pipeline will be first used to initialize the sink side
         // of things by calling hStreams_init_sink.
         // Later, it will be passed to the hStreams_PhysDomainCOI's constructor and
@@ -413,7 +420,7 @@ void detail::InitPhysicalDomains_impl_throw(HSTR_ISA_TYPE isa_type, std::string
         }
 
         hStreams_PhysDomain *phys_dom = new hStreams_PhysDomainCOI(active_domains, coi_process,
-                coi_eng_info, loaded_libs, thunk_func, fetch_addr_func, helper_coi_pipeline);
+                coi_eng_info, loaded_libs, thunk_func, fetch_addr_func, marker_func, helper_coi_pipeline);
 
         phys_domains.addToCollection(phys_dom);
 
@@ -474,21 +481,15 @@ void detail::Fini_impl_throw()
         hStreams_SleepMS(1);
     }
 
-    HSTR_COIRESULT result = hStreams_COIWrapper::COIBufferDestroy(hstr_proc.dummy_buf);
-    if (result != HSTR_COI_SUCCESS) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
-                                   << "A problem encountered while destroying the helper buffer, "
-                                   << "COIBufferDestroy() returned "
-                                   << hStreams_COIWrapper::COIResultGetName(result)
-                                  );
-    }
-
     log_buffers.destroyAllBuffers();
     log_streams.destroyAllStreams();
+    // Whatever the streams were waiting for has been run by now
+    hStreams_HostCallbacks::shutdown();
     log_domains.destroyAllDomains();
     phys_domains.destroyAllDomains();
 
     hstr_proc.myActivePhysDomains = 0;
+    hstr_proc.hostOnly = false;
     globals::target_library_search_path.clear();
     globals::host_library_search_path.clear();
     globals::tokenized_target_library_search_path.clear();
@@ -496,10 +497,24 @@ void detail::Fini_impl_throw()
     globals::app_init_next_log_str_ID       = globals::initial_values::app_init_next_log_str_ID;
     globals::interface_version              = globals::initial_values::interface_version;
     globals::mkl_interface                  = globals::initial_values::mkl_interface;
+    globals::host_buffer_aliasing           = globals::initial_values::host_buffer_aliasing;
     globals::next_log_dom_id                = globals::initial_values::next_log_dom_id;
     globals::options                        = globals::initial_values::options;
     globals::libraries_to_load.clear();
     globals::app_init_log_doms_IDs.clear();
+    globals::function_handles.clear();
+    // The graphs and the DAGs not destroyed by the application. Their handles
+    // stay invalid once the library is initialized again.
+    for (std::map<HSTR_GRAPH, hStreams_Graph *>::iterator it = globals::graphs.begin();
+            it != globals::graphs.end(); ++it) {
+        delete it->second;
+    }
+    globals::graphs.clear();
+    for (std::map<HSTR_DAG, hStreams_Dag *>::iterator it = globals::dags.begin();
+            it != globals::dags.end(); ++it) {
+        delete it->second;
+    }
+    globals::dags.clear();
 
     globals::hStreamsState = HSTR_STATE_UNINITIALIZED;
 } // void detail::Fini_impl_throw
@@ -733,6 +748,9 @@ detail::AddLogDomain_impl_throw(
             hStreams_RW_Lock::HSTR_RW_LOCK_READ);
     hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
             hStreams_RW_Lock::HSTR_RW_LOCK_WRITE); // So that nobody adds new buffers
+    // Attaching the buffers to the new domain changes them in place, so the
+    // enqueueing threads have to be kept out
+    hStreams_RCU_Exclusive_Scope tables_exclusive_scope;
 
     hStreams_PhysDomain *phys_dom = phys_domains.lookupByPhysDomainID(in_PhysDomainID);
     if (NULL == phys_dom) {
@@ -838,6 +856,8 @@ detail::RmLogDomains_impl_throw(
             hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
     hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
             hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    // The streams, and the instantiations of the buffers, are destroyed in place
+    hStreams_RCU_Exclusive_Scope tables_exclusive_scope;
 
     for (uint32_t log_dom_idx = 0; log_dom_idx < in_NumLogDomains; ++log_dom_idx) {
         hStreams_LogDomain *log_dom = log_domains.lookupByLogDomainID(in_pLogDomainIDs[log_dom_idx]);
@@ -986,12 +1006,14 @@ void
 detail::StreamCreate_impl_throw(
     HSTR_LOG_STR        in_LogStreamID,
     HSTR_LOG_DOM        in_LogDomainID,
-    const HSTR_CPU_MASK in_CPUmask)
+    const HSTR_CPU_MASK in_CPUmask,
+    HSTR_STREAM_FLAGS   in_Flags)
 {
     HSTR_TRACE_FUN_ENTER();
     HSTR_TRACE_FUN_ARG(in_LogStreamID);
     HSTR_TRACE_FUN_ARG(in_LogDomainID);
     HSTR_TRACE_FUN_ARG(in_CPUmask);
+    HSTR_TRACE_FUN_ARG(in_Flags);
     IsInitialized_impl_throw();
 
     if (0 == HSTR_CPU_MASK_COUNT(in_CPUmask)) {
@@ -999,6 +1021,12 @@ detail::StreamCreate_impl_throw(
                                    << "An empty CPU maks has been supplied to hStreams_StreamCreate."
                                   );
     }
+    if (in_Flags != HSTR_STREAM_IN_ORDER && in_Flags != HSTR_STREAM_OUT_OF_ORDER) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "Invalid stream flags: " << in_Flags
+                                  );
+    }
+    bool out_of_order = (in_Flags == HSTR_STREAM_OUT_OF_ORDER);
 
     hStreams_RW_Scope_Locker_Unlocker phys_domains_scope_lock(phys_domains_lock,
             hStreams_RW_Lock::HSTR_RW_LOCK_READ);
@@ -1044,11 +1072,17 @@ detail::StreamCreate_impl_throw(
     HSTR_OVERLAP_TYPE overlap;
     hStreams_LogStream *other_log_str = log_dom->lookupLogStreamByCPUMask(non_const_cpu_mask, &overlap);
     if (HSTR_EXACT_OVERLAP == overlap && NULL != other_log_str) {
+        if (other_log_str->getPhysStream().isOutOfOrder() != out_of_order) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_INCONSISTENT_ARGS, StringBuilder()
+                                       << "Logical stream " << other_log_str->id()
+                                       << " has the same CPU mask but has been created with different flags"
+                                      );
+        }
         // just attach to the logical stream's physical stream
         new_log_stream = new hStreams_LogStream(in_LogStreamID, non_const_cpu_mask, *log_dom, other_log_str->getPhysStream());
     } else {
         // Otherwise, we have to create a new stream
-        hStreams_PhysStream *new_phys_stream = log_dom->getPhysDomain().createNewPhysStream(*log_dom, non_const_cpu_mask);
+        hStreams_PhysStream *new_phys_stream = log_dom->getPhysDomain().createNewPhysStream(*log_dom, non_const_cpu_mask, out_of_order);
         if (!new_phys_stream) {
             throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_REMOTE_ERROR, StringBuilder()
                                        << "An error occured while trying to create a physical stream on the device"
@@ -1217,32 +1251,129 @@ detail::GetLogStreamDetails_impl_throw(
 } // detail::GetLogStreamDetails_impl_throw
 
 void
-detail::EnqueueCompute_impl_throw(
+detail::GetLogStreamDepStats_impl_throw(
+    HSTR_LOG_STR      in_LogStreamID,
+    uint64_t         *out_pNumSubmitted,
+    uint64_t         *out_pNumPruned)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(out_pNumSubmitted);
+    HSTR_TRACE_FUN_ARG(out_pNumPruned);
+    IsInitialized_impl_throw();
+
+    if (NULL == out_pNumSubmitted || NULL == out_pNumPruned) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "out_pNumSubmitted and out_pNumPruned must not be NULL"
+                                  );
+    }
+
+    hStreams_RCU_Read_Scope tables_read_scope;
+
+    hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
+    if (NULL == log_stream) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "Logical stream with ID "
+                                   << in_LogStreamID
+                                   << " doesn't exist"
+                                  );
+    }
+
+    log_stream->getPhysStream().getDepStats(*out_pNumSubmitted, *out_pNumPruned);
+} // detail::GetLogStreamDepStats_impl_throw
+
+void
+detail::StreamSetPriority_impl_throw(
+    HSTR_LOG_STR            in_LogStreamID,
+    HSTR_STREAM_PRIORITY    in_Priority)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(in_Priority);
+    IsInitialized_impl_throw();
+
+    if (in_Priority < HSTR_STREAM_PRIORITY_LOW || in_Priority >= HSTR_STREAM_PRIORITY_SIZE) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "Invalid stream priority: " << in_Priority
+                                  );
+    }
+
+    hStreams_RCU_Read_Scope tables_read_scope;
+
+    hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
+    if (NULL == log_stream) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "Logical stream with ID "
+                                   << in_LogStreamID
+                                   << " doesn't exist"
+                                  );
+    }
+
+    // The computes enqueued from now on mustn't overtake the ones enqueued
+    // so far with the former priority
+    HSTR_RESULT hret = log_stream->getPhysStream().enqueuePriorityChange(log_stream->getPriority(),
+                       in_Priority);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
+                                   << "A problem occured while ordering the actions of logical stream "
+                                   << in_LogStreamID << " across the priority change"
+                                  );
+    }
+    log_stream->setPriority(in_Priority);
+} // detail::StreamSetPriority_impl_throw
+
+void
+detail::StreamGetPriority_impl_throw(
+    HSTR_LOG_STR            in_LogStreamID,
+    HSTR_STREAM_PRIORITY   *out_pPriority)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(out_pPriority);
+    IsInitialized_impl_throw();
+
+    if (NULL == out_pPriority) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "out_pPriority must not be NULL"
+                                  );
+    }
+
+    hStreams_RCU_Read_Scope tables_read_scope;
+
+    hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
+    if (NULL == log_stream) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "Logical stream with ID "
+                                   << in_LogStreamID
+                                   << " doesn't exist"
+                                  );
+    }
+
+    *out_pPriority = log_stream->getPriority();
+} // detail::StreamGetPriority_impl_throw
+
+namespace
+{
+// The common part of EnqueueCompute, EnqueueComputeByHandle and
+// EnqueueComputeEx. The function is identified by in_pFunctionName if it's not
+// NULL, by in_FunctionHandle otherwise; the name, if any, is expected to have
+// been validated. in_pHeapArgAccess is NULL if all the heap arguments are
+// both read and written, in_pHeapArgSizes is NULL if the whole buffers of the
+// heap arguments may be accessed.
+void
+EnqueueCompute_worker_throw(
     HSTR_LOG_STR        in_LogStreamID,
     const char         *in_pFunctionName,
+    HSTR_FUNC_HANDLE    in_FunctionHandle,
     uint32_t            in_numScalarArgs,
     uint32_t            in_numHeapArgs,
     uint64_t           *in_pArgs,
+    HSTR_ACCESS_MODE const *in_pHeapArgAccess,
+    uint64_t const     *in_pHeapArgSizes,
     HSTR_EVENT         *out_pEvent,
     void               *out_ReturnValue,
     uint16_t            in_ReturnValueSize)
 {
-    HSTR_TRACE_FUN_ENTER();
-    HSTR_TRACE_FUN_ARG(in_LogStreamID);
-    HSTR_TRACE_FUN_ARG_STR(in_pFunctionName);
-    HSTR_TRACE_FUN_ARG(in_numScalarArgs);
-    HSTR_TRACE_FUN_ARG(in_numHeapArgs);
-    HSTR_TRACE_FUN_ARG(in_pArgs);
-    HSTR_TRACE_FUN_ARG(out_pEvent);
-    HSTR_TRACE_FUN_ARG(out_ReturnValue);
-    HSTR_TRACE_FUN_ARG(in_ReturnValueSize);
-    IsInitialized_impl_throw();
-
-    if (in_pFunctionName == NULL) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
-                                   << "Function name argument to hStreams_EnqueueCompute was NULL"
-                                  );
-    }
     if (in_ReturnValueSize > HSTR_RETURN_SIZE_LIMIT) {
         throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
                                    << "in_ReturnValueSize was larger than HSTR_RETURN_SIZE_LIMIT, "
@@ -1260,14 +1391,6 @@ detail::EnqueueCompute_impl_throw(
                                    << "in_ReturnValueSize must be 0 if out_ReturnValue is NULL and vice versa"
                                   );
     }
-    if (strlen(in_pFunctionName) > HSTR_MAX_FUNC_NAME_SIZE - 1) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
-                                   << "Sorry, "
-                                   << in_pFunctionName
-                                   << " exceeds max called function name size of "
-                                   << HSTR_MAX_FUNC_NAME_SIZE - 1
-                                  );
-    }
     uint64_t spt = HSTR_ARGS_SUPPORTED;
     if (spt > HSTR_ARGS_IMPLEMENTED) {
         spt = HSTR_ARGS_IMPLEMENTED;
@@ -1280,15 +1403,25 @@ detail::EnqueueCompute_impl_throw(
                                    << " arguments to streamed functions."
                                   );
     }
+    if (in_pHeapArgAccess != NULL) {
+        for (uint32_t i = 0; i < in_numHeapArgs; ++i) {
+            if (in_pHeapArgAccess[i] != HSTR_ACCESS_READ &&
+                    in_pHeapArgAccess[i] != HSTR_ACCESS_WRITE &&
+                    in_pHeapArgAccess[i] != HSTR_ACCESS_READ_WRITE) {
+                throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                           << "Invalid access mode of heap argument "
+                                           << i
+                                           << ": "
+                                           << in_pHeapArgAccess[i]
+                                          );
+            }
+        }
+    }
 
-    hStreams_RW_Scope_Locker_Unlocker phys_domains_scope_lock(phys_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_domains_scope_lock(log_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_streams_scope_lock(log_streams_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    // Instead of the global read-write locks, which every enqueueing thread
+    // would be writing to, pin the current versions of the streams, domains
+    // and buffers tables. The physical domains don't change after the init.
+    hStreams_RCU_Read_Scope tables_read_scope;
 
     hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
     if (NULL == log_stream) {
@@ -1298,16 +1431,21 @@ detail::EnqueueCompute_impl_throw(
                                    << " doesn't exist "
                                   );
     }
+    hStreams_Graph *capture = log_stream->getCapture();
+    if (capture != NULL && out_pEvent != NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_PERMITTED, StringBuilder()
+                                   << "The actions of logical stream (ID="
+                                   << in_LogStreamID
+                                   << ") are being captured, they have no events"
+                                  );
+    }
 
     hStreams_LogDomain &log_domain = log_stream->getLogDomain();
 
-    std::vector<uint64_t> scalar_args;
-    scalar_args.assign(in_pArgs, in_pArgs + in_numScalarArgs);
-
-    std::vector<uint64_t> buffer_offsets;
-    buffer_offsets.reserve(in_numHeapArgs);
-    std::vector<hStreams_PhysBuffer *> buffer_args;
-    buffer_args.reserve(in_numHeapArgs);
+    // The number of arguments has been checked against HSTR_ARGS_IMPLEMENTED
+    // above, so they fit on the stack, saving a trip to the heap
+    uint64_t buffer_offsets[HSTR_ARGS_IMPLEMENTED];
+    hStreams_PhysBuffer *buffer_args[HSTR_ARGS_IMPLEMENTED];
     for (uint64_t i = in_numScalarArgs; i < in_numScalarArgs + in_numHeapArgs; ++i) {
         uint64_t addr = in_pArgs[i];
 
@@ -1332,174 +1470,491 @@ detail::EnqueueCompute_impl_throw(
                                        << ")"
                                       );
         }
-        buffer_args.push_back(phys_buf);
+        buffer_args[i - in_numScalarArgs] = phys_buf;
         // NOTE Those are offsets into the source buffers.
         //      Physical buffers will compensate for eventual sink-side
         //      buffer padding themselves.
         uint64_t sink_offset = addr - (uint64_t)log_buf->getStart();
-        buffer_offsets.push_back(sink_offset);
+        buffer_offsets[i - in_numScalarArgs] = sink_offset;
+        if (in_pHeapArgSizes != NULL &&
+                in_pHeapArgSizes[i - in_numScalarArgs] > log_buf->getLen() - sink_offset) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                       << "The memory accessed from in_pArgs["
+                                       << i
+                                       << "] == "
+                                       << (void *)in_pArgs[i]
+                                       << " (size "
+                                       << in_pHeapArgSizes[i - in_numScalarArgs]
+                                       << ") doesn't fit in its buffer"
+                                      );
+        }
     }
 
     hStreams_PhysStream &phys_stream = log_stream->getPhysStream();
-    HSTR_RESULT hret = phys_stream.enqueueFunction(in_pFunctionName, scalar_args, buffer_args,
-                       buffer_offsets, out_ReturnValue, (int16_t) in_ReturnValueSize, out_pEvent);
+    HSTR_RESULT hret;
+    if (capture != NULL) {
+        // Resolve the function and the buffers now, so that the launches don't have to
+        std::vector<uint64_t> marshalled_args;
+        hret = phys_stream.marshalFunction(in_pFunctionName, in_FunctionHandle, in_pArgs, in_numScalarArgs,
+                                           buffer_args, buffer_offsets, in_numHeapArgs, marshalled_args);
+        if (hret == HSTR_RESULT_SUCCESS) {
+            capture->addCompute(marshalled_args, in_numScalarArgs,
+                                buffer_args, buffer_offsets, in_pHeapArgAccess, in_pHeapArgSizes,
+                                in_numHeapArgs, out_ReturnValue, in_ReturnValueSize);
+        }
+    } else if (in_pFunctionName != NULL) {
+        hret = phys_stream.enqueueFunction(in_pFunctionName, in_pArgs, in_numScalarArgs,
+                                           buffer_args, buffer_offsets, in_pHeapArgAccess, in_pHeapArgSizes,
+                                           in_numHeapArgs,
+                                           out_ReturnValue, (int16_t) in_ReturnValueSize,
+                                           log_stream->getPriority(), out_pEvent);
+    } else {
+        hret = phys_stream.enqueueFunctionByHandle(in_FunctionHandle, in_pArgs, in_numScalarArgs,
+                buffer_args, buffer_offsets, in_pHeapArgAccess, in_pHeapArgSizes, in_numHeapArgs,
+                out_ReturnValue, (int16_t) in_ReturnValueSize, log_stream->getPriority(), out_pEvent);
+    }
     if (hret != HSTR_RESULT_SUCCESS) {
+        if (in_pFunctionName != NULL) {
+            throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
+                                       << "An error occured while attempting to enqueue function \""
+                                       << in_pFunctionName
+                                       << "\" in logical stream (ID="
+                                       << in_LogStreamID
+                                       << ")"
+                                      );
+        }
         throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
-                                   << "An error occured while attempting to enqueue function \""
-                                   << in_pFunctionName
-                                   << "\" in logical stream (ID="
+                                   << "An error occured while attempting to enqueue function with handle "
+                                   << in_FunctionHandle
+                                   << " in logical stream (ID="
                                    << in_LogStreamID
                                    << ")"
                                   );
     }
-} // detail::EnqueueCompute_impl_throw
-
+} // EnqueueCompute_worker_throw
+} // anonymous namespace
 
-namespace
-{
-// This just expects the logical stream and the logical domains to have been
-// looked up and the appropriate locks to have been grabbed. It is the common
-// part for EnqueueData1D and EnqueueDataXDomain1D
 void
-EnqueueDataXDomain1D_worker_locked_throw(
-    hStreams_LogStream &in_LogStream,
-    void               *in_pWriteAddr,
-    void               *in_pReadAddr,
-    uint64_t            in_size,
-    hStreams_LogDomain &in_dstLogDomain,
-    hStreams_LogDomain &in_srcLogDomain,
-    HSTR_EVENT         *out_pEvent)
+detail::EnqueueCompute_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    const char         *in_pFunctionName,
+    uint32_t            in_numScalarArgs,
+    uint32_t            in_numHeapArgs,
+    uint64_t           *in_pArgs,
+    HSTR_EVENT         *out_pEvent,
+    void               *out_ReturnValue,
+    uint16_t            in_ReturnValueSize)
 {
     HSTR_TRACE_FUN_ENTER();
-    HSTR_TRACE_FUN_ARG(in_LogStream.id());
-    HSTR_TRACE_FUN_ARG(in_pWriteAddr);
-    HSTR_TRACE_FUN_ARG(in_pReadAddr);
-    HSTR_TRACE_FUN_ARG(in_size);
-    HSTR_TRACE_FUN_ARG(in_dstLogDomain.id());
-    HSTR_TRACE_FUN_ARG(in_srcLogDomain.id());
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG_STR(in_pFunctionName);
+    HSTR_TRACE_FUN_ARG(in_numScalarArgs);
+    HSTR_TRACE_FUN_ARG(in_numHeapArgs);
+    HSTR_TRACE_FUN_ARG(in_pArgs);
     HSTR_TRACE_FUN_ARG(out_pEvent);
+    HSTR_TRACE_FUN_ARG(out_ReturnValue);
+    HSTR_TRACE_FUN_ARG(in_ReturnValueSize);
+    IsInitialized_impl_throw();
 
-    if (in_pWriteAddr == NULL || in_pReadAddr == NULL) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
-                                   << "in_pWriteAddr or in_pReadAddr was NULL"
-                                  );
-    }
-    if (0 == in_size) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
-                                   << "in_size cannot be equal to 0"
+    if (in_pFunctionName == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
+                                   << "Function name argument to hStreams_EnqueueCompute was NULL"
                                   );
     }
-
-    if (in_LogStream.getLogDomain().id() != in_srcLogDomain.id() &&
-            in_LogStream.getLogDomain().id() != in_dstLogDomain.id()) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
-                                   << "The logical stream does not belong in any of the specified domains."
+    if (strlen(in_pFunctionName) > HSTR_MAX_FUNC_NAME_SIZE - 1) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
+                                   << "Sorry, "
+                                   << in_pFunctionName
+                                   << " exceeds max called function name size of "
+                                   << HSTR_MAX_FUNC_NAME_SIZE - 1
                                   );
     }
 
-    uint64_t src_u64 = (uint64_t)in_pReadAddr;
-    uint64_t dst_u64 = (uint64_t)in_pWriteAddr;
-
-    if (in_srcLogDomain.id() == in_dstLogDomain.id()) {
-        // Note for future: also for aliased buffers
-        // do arithmetic on a pointer to byte-sized type as the transfers are with that granularity
-        if (add_gt(src_u64, in_size, dst_u64) || add_gt(dst_u64, in_size, src_u64)) {
-            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
-                                       << "Overlapping transfers within the same logical domain are not permitted."
-                                      );
-        }
-    }
+    EnqueueCompute_worker_throw(in_LogStreamID, in_pFunctionName, 0,
+                                in_numScalarArgs, in_numHeapArgs, in_pArgs, NULL, NULL,
+                                out_pEvent, out_ReturnValue, in_ReturnValueSize);
+} // detail::EnqueueCompute_impl_throw
 
-    // implementation note: though we _could_ use lookupLogBuffer(start, size,
-    // overlap), the error codes exposed by the EnqueueData* APIs require that
-    // HSTR_RESULT_OUT_OF_RANGE be returned if "in_size extends past the end of
-    // an allocated buffer". So we have to do the checking by hand here :/
+void
+detail::EnqueueComputeEx_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    const char         *in_pFunctionName,
+    uint32_t            in_numScalarArgs,
+    uint32_t            in_numHeapArgs,
+    uint64_t           *in_pArgs,
+    HSTR_ACCESS_MODE   *in_pHeapArgAccess,
+    uint64_t           *in_pHeapArgSizes,
+    HSTR_EVENT         *out_pEvent,
+    void               *out_ReturnValue,
+    uint16_t            in_ReturnValueSize)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG_STR(in_pFunctionName);
+    HSTR_TRACE_FUN_ARG(in_numScalarArgs);
+    HSTR_TRACE_FUN_ARG(in_numHeapArgs);
+    HSTR_TRACE_FUN_ARG(in_pArgs);
+    HSTR_TRACE_FUN_ARG(in_pHeapArgAccess);
+    HSTR_TRACE_FUN_ARG(in_pHeapArgSizes);
+    HSTR_TRACE_FUN_ARG(out_pEvent);
+    HSTR_TRACE_FUN_ARG(out_ReturnValue);
+    HSTR_TRACE_FUN_ARG(in_ReturnValueSize);
+    IsInitialized_impl_throw();
 
-    hStreams_LogBuffer *dst_log_buf = log_buffers.lookupLogBuffer(in_pWriteAddr);
-    if (NULL == dst_log_buf) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
-                                   << "Did not find the destination buffer."
-                                  );
-    }
-    if (add_gt(dst_u64, in_size, dst_log_buf->getStartu64() + dst_log_buf->getLen())) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
-                                   << "Transfer range extends past the end of the destination buffer."
+    if (in_pFunctionName == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
+                                   << "Function name argument to hStreams_EnqueueComputeEx was NULL"
+                                  );
+    }
+    if (strlen(in_pFunctionName) > HSTR_MAX_FUNC_NAME_SIZE - 1) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
+                                   << "Sorry, "
+                                   << in_pFunctionName
+                                   << " exceeds max called function name size of "
+                                   << HSTR_MAX_FUNC_NAME_SIZE - 1
+                                  );
+    }
+    if (in_numHeapArgs && !in_pHeapArgAccess) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "in_pHeapArgAccess cannot be NULL if in_numHeapArgs != 0"
                                   );
     }
 
-    hStreams_PhysBuffer *dst_phys_buf = dst_log_buf->getPhysBufferForLogDomain(in_dstLogDomain);
-    if (NULL == dst_phys_buf) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
-                                   << "Did not find an instantiation of the destination buffer for logical domain #"
-                                   << in_dstLogDomain.id()
+    EnqueueCompute_worker_throw(in_LogStreamID, in_pFunctionName, 0,
+                                in_numScalarArgs, in_numHeapArgs, in_pArgs, in_pHeapArgAccess,
+                                in_pHeapArgSizes, out_pEvent, out_ReturnValue, in_ReturnValueSize);
+} // detail::EnqueueComputeEx_impl_throw
+
+void
+detail::GetFunctionHandle_impl_throw(
+    const char         *in_pFunctionName,
+    HSTR_FUNC_HANDLE   *out_pFunctionHandle)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG_STR(in_pFunctionName);
+    HSTR_TRACE_FUN_ARG(out_pFunctionHandle);
+    IsInitialized_impl_throw();
+
+    if (in_pFunctionName == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
+                                   << "Function name argument to hStreams_GetFunctionHandle was NULL"
+                                  );
+    }
+    if (out_pFunctionHandle == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "out_pFunctionHandle cannot be NULL"
+                                  );
+    }
+    if (strlen(in_pFunctionName) > HSTR_MAX_FUNC_NAME_SIZE - 1) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
+                                   << "Sorry, "
+                                   << in_pFunctionName
+                                   << " exceeds max called function name size of "
+                                   << HSTR_MAX_FUNC_NAME_SIZE - 1
                                   );
     }
 
-    hStreams_LogBuffer *src_log_buf = log_buffers.lookupLogBuffer(in_pReadAddr);
-    if (NULL == src_log_buf) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
-                                   << "Did not find the source buffer."
+    hStreams_RW_Scope_Locker_Unlocker phys_domains_scope_lock(phys_domains_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    hStreams_RW_Scope_Locker_Unlocker function_handles_scope_lock(globals::function_handles_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
+
+    std::string func_name(in_pFunctionName);
+    std::map<std::string, HSTR_FUNC_HANDLE>::const_iterator it = globals::function_handles.find(func_name);
+    if (it != globals::function_handles.end()) {
+        *out_pFunctionHandle = it->second;
+        return;
+    }
+
+    // Resolve the function in all the physical domains up front, so that
+    // enqueueing by the handle never has to look anything up by name
+    std::vector<hStreams_PhysDomain *> doms;
+    phys_domains.getAllPhysDomains(doms);
+    std::vector<uint64_t> sink_addrs(doms.size());
+    bool found = false;
+    for (uint32_t i = 0; i < doms.size(); ++i) {
+        sink_addrs[i] = doms[i]->fetchSinkFunctionAddress(func_name);
+        found = found || sink_addrs[i] != 0;
+    }
+    if (!found) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_BAD_NAME, StringBuilder()
+                                   << "A sink-compiled version of function "
+                                   << in_pFunctionName
+                                   << " not found on any physical domain"
                                   );
     }
-    if (add_gt(src_u64, in_size, src_log_buf->getStartu64() + src_log_buf->getLen())) {
+
+    // Handles start at 1, so that a zero-initialized one is never valid
+    HSTR_FUNC_HANDLE handle = globals::function_handles.size() + 1;
+    for (uint32_t i = 0; i < doms.size(); ++i) {
+        doms[i]->bindFunctionHandle(handle, sink_addrs[i]);
+    }
+    globals::function_handles[func_name] = handle;
+    *out_pFunctionHandle = handle;
+} // detail::GetFunctionHandle_impl_throw
+
+void
+detail::EnqueueComputeByHandle_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    HSTR_FUNC_HANDLE    in_FunctionHandle,
+    uint32_t            in_numScalarArgs,
+    uint32_t            in_numHeapArgs,
+    uint64_t           *in_pArgs,
+    HSTR_EVENT         *out_pEvent,
+    void               *out_ReturnValue,
+    uint16_t            in_ReturnValueSize)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(in_FunctionHandle);
+    HSTR_TRACE_FUN_ARG(in_numScalarArgs);
+    HSTR_TRACE_FUN_ARG(in_numHeapArgs);
+    HSTR_TRACE_FUN_ARG(in_pArgs);
+    HSTR_TRACE_FUN_ARG(out_pEvent);
+    HSTR_TRACE_FUN_ARG(out_ReturnValue);
+    HSTR_TRACE_FUN_ARG(in_ReturnValueSize);
+    IsInitialized_impl_throw();
+
+    EnqueueCompute_worker_throw(in_LogStreamID, NULL, in_FunctionHandle,
+                                in_numScalarArgs, in_numHeapArgs, in_pArgs, NULL, NULL,
+                                out_pEvent, out_ReturnValue, in_ReturnValueSize);
+} // detail::EnqueueComputeByHandle_impl_throw
+
+
+namespace
+{
+// Checks that the rows, and the slices, on one side of a transfer follow one
+// another without overlapping and that the range they span is addressable
+void
+checkXferLayout_throw(
+    char const *side,
+    uint64_t    width,
+    uint64_t    height,
+    uint64_t    depth,
+    uint64_t    pitch,
+    uint64_t    slice_pitch)
+{
+    if (height > 1 && pitch < width) {
         throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
-                                   << "Transfer range extends past the end of the source buffer."
+                                   << "The pitch of the " << side
+                                   << " (" << pitch << ") cannot be smaller than the width ("
+                                   << width << ")"
                                   );
     }
-
-    hStreams_PhysBuffer *src_phys_buf = src_log_buf->getPhysBufferForLogDomain(in_srcLogDomain);
-    if (NULL == src_phys_buf) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
-                                   << "Did not find an instantiation of the source buffer for logical domain #"
-                                   << in_srcLogDomain.id()
+    if (multiplication_overflow(height - 1, pitch) || addition_overflow((height - 1) * pitch, width)) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "The rows of the " << side << " span more than 2^64 bytes"
+                                  );
+    }
+    uint64_t slice_extent = (height - 1) * pitch + width;
+    if (depth > 1 && slice_pitch < slice_extent) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "The slice pitch of the " << side
+                                   << " (" << slice_pitch << ") cannot be smaller than the "
+                                   << slice_extent << " bytes spanned by a slice"
                                   );
     }
+    if (multiplication_overflow(depth - 1, slice_pitch) ||
+            addition_overflow((depth - 1) * slice_pitch, slice_extent)) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "The slices of the " << side << " span more than 2^64 bytes"
+                                  );
+    }
+}
 
-    hStreams_PhysStream &phys_stream = in_LogStream.getPhysStream();
+// The buffer the last region of a transfer was found in, so that the regions
+// of a list falling in the same buffer don't have to look it up again
+struct XferBufferHint {
+    hStreams_LogBuffer  *log_buf;
+    hStreams_PhysBuffer *phys_buf;
 
-    uint64_t dst_offset = (uint64_t)in_pWriteAddr - dst_log_buf->getStartu64();
-    uint64_t src_offset = (uint64_t)in_pReadAddr - src_log_buf->getStartu64();
+    XferBufferHint() : log_buf(NULL), phys_buf(NULL) {}
+};
 
-    HSTR_RESULT hret = phys_stream.enqueueTransfer(*dst_phys_buf, *src_phys_buf, dst_offset,
-                       src_offset, in_size, out_pEvent);
-    if (hret != HSTR_RESULT_SUCCESS) {
-        throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
-                                   << "An error occured while attempting to enqueue the transfer in logical stream (ID="
-                                   << in_LogStream.id()
-                                   << ")"
+// Look up the instantiation in in_LogDomain of the buffer [in_pAddr, in_pAddr
+// + in_extent) falls in, side being "source" or "destination"
+void
+lookupXferBuffer_throw(
+    char const         *side,
+    void               *in_pAddr,
+    uint64_t            in_extent,
+    hStreams_LogDomain &in_LogDomain,
+    XferBufferHint     &io_hint,
+    uint64_t           &out_offset)
+{
+    uint64_t addr_u64 = (uint64_t)in_pAddr;
+    hStreams_LogBuffer *log_buf = io_hint.log_buf;
+    if (log_buf == NULL || addr_u64 < log_buf->getStartu64() ||
+            addr_u64 >= log_buf->getStartu64() + log_buf->getLen()) {
+        // implementation note: though we _could_ use lookupLogBuffer(start, size,
+        // overlap), the error codes exposed by the EnqueueData* APIs require that
+        // HSTR_RESULT_OUT_OF_RANGE be returned if "in_size extends past the end of
+        // an allocated buffer". So we have to do the checking by hand here :/
+        log_buf = log_buffers.lookupLogBuffer(in_pAddr);
+        if (NULL == log_buf) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                       << "Did not find the " << side << " buffer."
+                                      );
+        }
+        io_hint.phys_buf = log_buf->getPhysBufferForLogDomain(in_LogDomain);
+        if (NULL == io_hint.phys_buf) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                       << "Did not find an instantiation of the " << side
+                                       << " buffer for logical domain #"
+                                       << in_LogDomain.id()
+                                      );
+        }
+        io_hint.log_buf = log_buf;
+    }
+    // For pitched transfers, it's the whole range spanned by the rows that
+    // has to fit in the buffer.
+    if (add_gt(addr_u64, in_extent, log_buf->getStartu64() + log_buf->getLen())) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "Transfer range extends past the end of the " << side << " buffer."
                                   );
     }
-} // EnqueueDataXDomain1D_worker_locked_throw
-} // anonymous namespace
+    out_offset = addr_u64 - log_buf->getStartu64();
+}
 
+// Validate a transfer between two logical domains and look up the physical
+// buffers it moves memory between
+void
+resolveXferRegion_throw(
+    void                     *in_pWriteAddr,
+    void                     *in_pReadAddr,
+    hStreams_XferShape const &in_shape,
+    hStreams_LogDomain       &in_dstLogDomain,
+    hStreams_LogDomain       &in_srcLogDomain,
+    XferBufferHint           &io_dstHint,
+    XferBufferHint           &io_srcHint,
+    hStreams_PhysXferRegion  &out_region)
+{
+    if (in_pWriteAddr == NULL || in_pReadAddr == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "in_pWriteAddr or in_pReadAddr was NULL"
+                                  );
+    }
+    if (0 == in_shape.width) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "The width of the transfer (in_size for 1D transfers) cannot be equal to 0"
+                                  );
+    }
+    if (0 == in_shape.height || 0 == in_shape.depth) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "in_Height and in_Depth cannot be equal to 0"
+                                  );
+    }
+    checkXferLayout_throw("destination", in_shape.width, in_shape.height, in_shape.depth,
+                          in_shape.dst_pitch, in_shape.dst_slice_pitch);
+    checkXferLayout_throw("source", in_shape.width, in_shape.height, in_shape.depth,
+                          in_shape.src_pitch, in_shape.src_slice_pitch);
+    uint64_t dst_extent = in_shape.dstExtent();
+    uint64_t src_extent = in_shape.srcExtent();
+
+    uint64_t src_u64 = (uint64_t)in_pReadAddr;
+    uint64_t dst_u64 = (uint64_t)in_pWriteAddr;
+
+    if (in_srcLogDomain.id() == in_dstLogDomain.id()) {
+        // Note for future: also for aliased buffers
+        // do arithmetic on a pointer to byte-sized type as the transfers are with that granularity
+        if (add_gt(src_u64, src_extent, dst_u64) || add_gt(dst_u64, dst_extent, src_u64)) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                       << "Overlapping transfers within the same logical domain are not permitted."
+                                      );
+        }
+    }
+
+    lookupXferBuffer_throw("destination", in_pWriteAddr, dst_extent, in_dstLogDomain,
+                           io_dstHint, out_region.dst_offset);
+    lookupXferBuffer_throw("source", in_pReadAddr, src_extent, in_srcLogDomain,
+                           io_srcHint, out_region.src_offset);
+    out_region.dst_buf = io_dstHint.phys_buf;
+    out_region.src_buf = io_srcHint.phys_buf;
+    out_region.shape = in_shape;
+}
 
 void
-detail::EnqueueData1D_impl_throw(
-    HSTR_LOG_STR        in_LogStreamID,
-    void               *in_pWriteAddr,
-    void               *in_pReadAddr,
-    uint64_t            in_size,
-    HSTR_XFER_DIRECTION in_XferDirection,
+checkXferLogStream_throw(
+    hStreams_LogStream &in_LogStream,
+    hStreams_LogDomain &in_dstLogDomain,
+    hStreams_LogDomain &in_srcLogDomain,
     HSTR_EVENT         *out_pEvent)
+{
+    if (in_LogStream.getLogDomain().id() != in_srcLogDomain.id() &&
+            in_LogStream.getLogDomain().id() != in_dstLogDomain.id()) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "The logical stream does not belong in any of the specified domains."
+                                  );
+    }
+    if (in_LogStream.getCapture() != NULL && out_pEvent != NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_PERMITTED, StringBuilder()
+                                   << "The actions of logical stream (ID="
+                                   << in_LogStream.id()
+                                   << ") are being captured, they have no events"
+                                  );
+    }
+}
+
+// This just expects the logical stream and the logical domains to have been
+// looked up and the appropriate locks to have been grabbed. It is the common
+// part for EnqueueData1D/2D/3D and EnqueueDataXDomain1D, a 1D transfer being
+// a single row of hStreams_XferShape::linear()
+void
+EnqueueDataXDomain_worker_locked_throw(
+    hStreams_LogStream       &in_LogStream,
+    void                     *in_pWriteAddr,
+    void                     *in_pReadAddr,
+    hStreams_XferShape const &in_shape,
+    hStreams_LogDomain       &in_dstLogDomain,
+    hStreams_LogDomain       &in_srcLogDomain,
+    HSTR_EVENT               *out_pEvent)
 {
     HSTR_TRACE_FUN_ENTER();
-    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(in_LogStream.id());
     HSTR_TRACE_FUN_ARG(in_pWriteAddr);
     HSTR_TRACE_FUN_ARG(in_pReadAddr);
-    HSTR_TRACE_FUN_ARG(in_size);
-    HSTR_TRACE_FUN_ARG(in_XferDirection);
+    HSTR_TRACE_FUN_ARG(in_shape.width);
+    HSTR_TRACE_FUN_ARG(in_shape.height);
+    HSTR_TRACE_FUN_ARG(in_shape.depth);
+    HSTR_TRACE_FUN_ARG(in_dstLogDomain.id());
+    HSTR_TRACE_FUN_ARG(in_srcLogDomain.id());
     HSTR_TRACE_FUN_ARG(out_pEvent);
-    IsInitialized_impl_throw();
 
-    hStreams_RW_Scope_Locker_Unlocker phys_domains_scope_lock(phys_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_domains_scope_lock(log_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_streams_scope_lock(log_streams_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    checkXferLogStream_throw(in_LogStream, in_dstLogDomain, in_srcLogDomain, out_pEvent);
+
+    XferBufferHint dst_hint, src_hint;
+    hStreams_PhysXferRegion region;
+    resolveXferRegion_throw(in_pWriteAddr, in_pReadAddr, in_shape, in_dstLogDomain, in_srcLogDomain,
+                            dst_hint, src_hint, region);
+
+    hStreams_Graph *capture = in_LogStream.getCapture();
+    if (capture != NULL) {
+        capture->addTransfer(std::vector<hStreams_PhysXferRegion>(1, region));
+        return;
+    }
+
+    HSTR_RESULT hret = in_LogStream.getPhysStream().enqueueTransfer(*region.dst_buf, *region.src_buf,
+                       region.dst_offset, region.src_offset, in_shape, in_LogStream.getPriority(), out_pEvent);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
+                                   << "An error occured while attempting to enqueue the transfer in logical stream (ID="
+                                   << in_LogStream.id()
+                                   << ")"
+                                  );
+    }
+} // EnqueueDataXDomain_worker_locked_throw
 
+// Look up the logical stream, and the logical domains between which to
+// transfer from the direction. The caller has to be in an RCU read-side
+// critical section.
+void
+lookupXferDirection_throw(
+    HSTR_LOG_STR         in_LogStreamID,
+    HSTR_XFER_DIRECTION  in_XferDirection,
+    hStreams_LogStream *&out_LogStream,
+    hStreams_LogDomain *&out_dstLogDomain,
+    hStreams_LogDomain *&out_srcLogDomain)
+{
     hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
     if (NULL == log_stream) {
         throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
@@ -1517,17 +1972,14 @@ detail::EnqueueData1D_impl_throw(
                                   );
     }
 
-    hStreams_LogDomain *xfer_src_log_domain;
-    hStreams_LogDomain *xfer_dst_log_domain;
-
     switch (in_XferDirection) {
     case HSTR_SRC_TO_SINK:
-        xfer_src_log_domain = src_log_domain;
-        xfer_dst_log_domain = &other_log_domain;
+        out_srcLogDomain = src_log_domain;
+        out_dstLogDomain = &other_log_domain;
         break;
     case HSTR_SINK_TO_SRC:
-        xfer_src_log_domain = &other_log_domain;
-        xfer_dst_log_domain = src_log_domain;
+        out_srcLogDomain = &other_log_domain;
+        out_dstLogDomain = src_log_domain;
         break;
     default:
         throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
@@ -1540,11 +1992,191 @@ detail::EnqueueData1D_impl_throw(
                                    << ")."
                                   );
     } // switch (in_XferDirection)
+    out_LogStream = log_stream;
+} // lookupXferDirection_throw
 
-    EnqueueDataXDomain1D_worker_locked_throw(*log_stream, in_pWriteAddr, in_pReadAddr,
-            in_size, *xfer_dst_log_domain, *xfer_src_log_domain, out_pEvent);
+// The common part of EnqueueData1D, EnqueueData2D and EnqueueData3D
+void
+EnqueueData_worker_throw(
+    HSTR_LOG_STR              in_LogStreamID,
+    void                     *in_pWriteAddr,
+    void                     *in_pReadAddr,
+    hStreams_XferShape const &in_shape,
+    HSTR_XFER_DIRECTION       in_XferDirection,
+    HSTR_EVENT               *out_pEvent)
+{
+    detail::IsInitialized_impl_throw();
+
+    // See EnqueueCompute_worker_throw
+    hStreams_RCU_Read_Scope tables_read_scope;
+
+    hStreams_LogStream *log_stream;
+    hStreams_LogDomain *xfer_dst_log_domain;
+    hStreams_LogDomain *xfer_src_log_domain;
+    lookupXferDirection_throw(in_LogStreamID, in_XferDirection, log_stream,
+                              xfer_dst_log_domain, xfer_src_log_domain);
+
+    EnqueueDataXDomain_worker_locked_throw(*log_stream, in_pWriteAddr, in_pReadAddr,
+                                           in_shape, *xfer_dst_log_domain, *xfer_src_log_domain, out_pEvent);
+} // EnqueueData_worker_throw
+} // anonymous namespace
+
+
+void
+detail::EnqueueData1D_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    void               *in_pWriteAddr,
+    void               *in_pReadAddr,
+    uint64_t            in_size,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(in_pWriteAddr);
+    HSTR_TRACE_FUN_ARG(in_pReadAddr);
+    HSTR_TRACE_FUN_ARG(in_size);
+    HSTR_TRACE_FUN_ARG(in_XferDirection);
+    HSTR_TRACE_FUN_ARG(out_pEvent);
+
+    EnqueueData_worker_throw(in_LogStreamID, in_pWriteAddr, in_pReadAddr,
+                             hStreams_XferShape::linear(in_size), in_XferDirection, out_pEvent);
 } // detail::EnqueueData1D_impl_throw
 
+void
+detail::EnqueueData2D_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    void               *in_pWriteAddr,
+    uint64_t            in_WritePitch,
+    void               *in_pReadAddr,
+    uint64_t            in_ReadPitch,
+    uint64_t            in_Width,
+    uint64_t            in_Height,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(in_pWriteAddr);
+    HSTR_TRACE_FUN_ARG(in_WritePitch);
+    HSTR_TRACE_FUN_ARG(in_pReadAddr);
+    HSTR_TRACE_FUN_ARG(in_ReadPitch);
+    HSTR_TRACE_FUN_ARG(in_Width);
+    HSTR_TRACE_FUN_ARG(in_Height);
+    HSTR_TRACE_FUN_ARG(in_XferDirection);
+    HSTR_TRACE_FUN_ARG(out_pEvent);
+
+    // The slice pitches don't matter for a single slice
+    hStreams_XferShape shape = {in_Width, in_Height, 1, in_WritePitch, 0, in_ReadPitch, 0};
+    EnqueueData_worker_throw(in_LogStreamID, in_pWriteAddr, in_pReadAddr,
+                             shape, in_XferDirection, out_pEvent);
+} // detail::EnqueueData2D_impl_throw
+
+void
+detail::EnqueueData3D_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    void               *in_pWriteAddr,
+    uint64_t            in_WritePitch,
+    uint64_t            in_WriteSlicePitch,
+    void               *in_pReadAddr,
+    uint64_t            in_ReadPitch,
+    uint64_t            in_ReadSlicePitch,
+    uint64_t            in_Width,
+    uint64_t            in_Height,
+    uint64_t            in_Depth,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(in_pWriteAddr);
+    HSTR_TRACE_FUN_ARG(in_WritePitch);
+    HSTR_TRACE_FUN_ARG(in_WriteSlicePitch);
+    HSTR_TRACE_FUN_ARG(in_pReadAddr);
+    HSTR_TRACE_FUN_ARG(in_ReadPitch);
+    HSTR_TRACE_FUN_ARG(in_ReadSlicePitch);
+    HSTR_TRACE_FUN_ARG(in_Width);
+    HSTR_TRACE_FUN_ARG(in_Height);
+    HSTR_TRACE_FUN_ARG(in_Depth);
+    HSTR_TRACE_FUN_ARG(in_XferDirection);
+    HSTR_TRACE_FUN_ARG(out_pEvent);
+
+    hStreams_XferShape shape = {in_Width, in_Height, in_Depth,
+                                in_WritePitch, in_WriteSlicePitch, in_ReadPitch, in_ReadSlicePitch
+                               };
+    EnqueueData_worker_throw(in_LogStreamID, in_pWriteAddr, in_pReadAddr,
+                             shape, in_XferDirection, out_pEvent);
+} // detail::EnqueueData3D_impl_throw
+
+void
+detail::EnqueueDataList_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    uint32_t            in_NumRegions,
+    void              **in_pWriteAddrs,
+    void              **in_pReadAddrs,
+    uint64_t           *in_pSizes,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(in_NumRegions);
+    HSTR_TRACE_FUN_ARG(in_pWriteAddrs);
+    HSTR_TRACE_FUN_ARG(in_pReadAddrs);
+    HSTR_TRACE_FUN_ARG(in_pSizes);
+    HSTR_TRACE_FUN_ARG(in_XferDirection);
+    HSTR_TRACE_FUN_ARG(out_pEvent);
+    IsInitialized_impl_throw();
+
+    if (in_NumRegions == 0) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_OUT_OF_RANGE, StringBuilder()
+                                   << "in_NumRegions cannot be equal to 0"
+                                  );
+    }
+    if (in_pWriteAddrs == NULL || in_pReadAddrs == NULL || in_pSizes == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "in_pWriteAddrs, in_pReadAddrs or in_pSizes was NULL"
+                                  );
+    }
+
+    // See EnqueueCompute_worker_throw
+    hStreams_RCU_Read_Scope tables_read_scope;
+
+    hStreams_LogStream *log_stream;
+    hStreams_LogDomain *xfer_dst_log_domain;
+    hStreams_LogDomain *xfer_src_log_domain;
+    lookupXferDirection_throw(in_LogStreamID, in_XferDirection, log_stream,
+                              xfer_dst_log_domain, xfer_src_log_domain);
+    checkXferLogStream_throw(*log_stream, *xfer_dst_log_domain, *xfer_src_log_domain, out_pEvent);
+
+    // The regions typically come from a few buffers only, so the one each
+    // side of the previous region was found in is tried first
+    XferBufferHint dst_hint, src_hint;
+    std::vector<hStreams_PhysXferRegion> regions(in_NumRegions);
+    for (uint32_t idx = 0; idx < in_NumRegions; ++idx) {
+        resolveXferRegion_throw(in_pWriteAddrs[idx], in_pReadAddrs[idx],
+                                hStreams_XferShape::linear(in_pSizes[idx]),
+                                *xfer_dst_log_domain, *xfer_src_log_domain,
+                                dst_hint, src_hint, regions[idx]);
+    }
+
+    hStreams_Graph *capture = log_stream->getCapture();
+    if (capture != NULL) {
+        capture->addTransfer(regions);
+        return;
+    }
+
+    HSTR_RESULT hret = log_stream->getPhysStream().enqueueTransferList(regions, log_stream->getPriority(),
+                       out_pEvent);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
+                                   << "An error occured while attempting to enqueue the transfers in logical stream (ID="
+                                   << log_stream->id()
+                                   << ")"
+                                  );
+    }
+} // detail::EnqueueDataList_impl_throw
+
 void
 detail::EnqueueDataXDomain1D_impl_throw(
     HSTR_LOG_STR        in_LogStreamID,
@@ -1565,14 +2197,8 @@ detail::EnqueueDataXDomain1D_impl_throw(
     HSTR_TRACE_FUN_ARG(out_pEvent);
     IsInitialized_impl_throw();
 
-    hStreams_RW_Scope_Locker_Unlocker phys_domains_scope_lock(phys_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_domains_scope_lock(log_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_streams_scope_lock(log_streams_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    // See EnqueueCompute_worker_throw
+    hStreams_RCU_Read_Scope tables_read_scope;
 
     hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
     if (NULL == log_stream) {
@@ -1600,108 +2226,30 @@ detail::EnqueueDataXDomain1D_impl_throw(
                                    << ") doesn't exist"
                                   );
     }
-    EnqueueDataXDomain1D_worker_locked_throw(*log_stream, in_pWriteAddr, in_pReadAddr, in_size,
-            *xfer_dst_log_domain, *xfer_src_log_domain, out_pEvent);
+    EnqueueDataXDomain_worker_locked_throw(*log_stream, in_pWriteAddr, in_pReadAddr,
+                                           hStreams_XferShape::linear(in_size),
+                                           *xfer_dst_log_domain, *xfer_src_log_domain, out_pEvent);
 } // detail::EnqueueDataXDomain1D_impl_throw
 
-void
-detail::StreamSynchronize_impl_throw(HSTR_LOG_STR in_LogStreamID)
-{
-    HSTR_TRACE_FUN_ENTER();
-    HSTR_TRACE_FUN_ARG(in_LogStreamID);
-    IsInitialized_impl_throw();
-
-    hStreams_RW_Scope_Locker_Unlocker phys_domains_scope_lock(phys_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_domains_scope_lock(log_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    // grabbing the streams lock for writing ensures that nobody commits any
-    // actions to any streams. This a temporary solution; Alternatively, one could
-    // create a lock for each logical stream and acquire that here (or even provide a
-    // "synchronize" method) in the logical stream (preferred), but I don't have a clear
-    // idea on how to handle thread synchronize, where we basically have to gather all the
-    // events from all the streams
-    //
-    // One can relax that after EventStreamWait functionality is implemented inside the hStreams_PhysStream class, internally synchronized.
-    // That would allow more concurrency.
-    hStreams_RW_Scope_Locker_Unlocker log_streams_scope_lock(log_streams_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
-    hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-
-    hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
-    if (NULL == log_stream) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
-                                   << "Logical stream with ID "
-                                   << in_LogStreamID
-                                   << " doesn't exist"
-                                  );
-    }
-
-    std::vector<HSTR_EVENT> the_events;
-    log_stream->getAllEvents(the_events);
-
-    if (the_events.empty()) {
-        // nothing to do
-        return;
-    }
-
-    int32_t timeout = (int32_t)hStreams_GetOptions_time_out_ms_val();
-    HSTR_COIRESULT result = hStreams_COIWrapper::COIEventWait((int16_t) the_events.size(),
-                            &the_events[0], timeout, true, NULL, NULL);
-
-    if (result == HSTR_COI_SUCCESS) {
-        return;
-    } else if (result == HSTR_COI_PROCESS_DIED) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_REMOTE_ERROR, StringBuilder()
-                                   << "Sink-side process died."
-                                  );
-    } else if (result == HSTR_COI_EVENT_CANCELED) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_EVENT_CANCELED, StringBuilder()
-                                   << "At least one of the events has been cancelled."
-                                  );
-    } else if (result == HSTR_COI_TIME_OUT_REACHED) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_TIME_OUT_REACHED, StringBuilder()
-                                   << "Timeout value of "
-                                   << timeout
-                                   << " was not large enough, you might wish to adjust the value of "
-                                   << "time_out_ms_val in HSTR_OPTIONS"
-                                  );
-    } else {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_INTERNAL_ERROR, StringBuilder()
-                                   << "Internal error, COI returned an unexpected value: "
-                                   << hStreams_COIWrapper::COIResultGetName(result)
-                                  );
-    }
-} // detail::StreamSynchronize_impl_throw(HSTR_LOG_STR in_LogStreamID)
-
-void
-detail::ThreadSynchronize_impl_throw()
-{
-    HSTR_TRACE_FUN_ENTER();
-    IsInitialized_impl_throw();
-
-    hStreams_RW_Scope_Locker_Unlocker phys_domains_scope_lock(phys_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_domains_scope_lock(log_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    // See StreamSynchronize_impl_throw for detailed explanation about the write lock
-    hStreams_RW_Scope_Locker_Unlocker log_streams_scope_lock(log_streams_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
-    hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-
-    std::vector<HSTR_EVENT> all_the_events;
-    log_streams.getEventsFromAllStreams(all_the_events);
-
-    if (all_the_events.empty()) {
-        // nothing to be done
+namespace
+{
+// Wait for a snapshot of the events of one or more streams. The snapshot has
+// to have been taken beforehand, under the appropriate locks; the wait itself
+// needs none, so other threads can keep enqueueing to and synchronizing with
+// any of the streams meanwhile.
+void
+WaitForStreamEvents_throw(std::vector<HSTR_EVENT> &events)
+{
+    // Logical streams sharing a physical stream report the same events
+    hStreams_HostEvent::prune(events);
+    if (events.empty()) {
+        // nothing to do
         return;
     }
 
     int32_t timeout = (int32_t)hStreams_GetOptions_time_out_ms_val();
-    HSTR_COIRESULT result = hStreams_COIWrapper::COIEventWait((int16_t) all_the_events.size(),
-                            &all_the_events[0], timeout, true, NULL, NULL);
+    HSTR_COIRESULT result = hStreams_HostEvent::waitAll(events.size(), &events[0], timeout);
+
     if (result == HSTR_COI_SUCCESS) {
         return;
     } else if (result == HSTR_COI_PROCESS_DIED) {
@@ -1720,11 +2268,56 @@ detail::ThreadSynchronize_impl_throw()
                                    << "time_out_ms_val in HSTR_OPTIONS"
                                   );
     } else {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_INTERNAL_ERROR, StringBuilder()
                                    << "Internal error, COI returned an unexpected value: "
                                    << hStreams_COIWrapper::COIResultGetName(result)
                                   );
     }
+} // WaitForStreamEvents_throw
+} // anonymous namespace
+
+void
+detail::StreamSynchronize_impl_throw(HSTR_LOG_STR in_LogStreamID)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    IsInitialized_impl_throw();
+
+    std::vector<HSTR_EVENT> the_events;
+    {
+        // The stream takes the snapshot of its events under its own lock,
+        // synchronized with the enqueues. Nothing is held during the wait.
+        hStreams_RCU_Read_Scope tables_read_scope;
+
+        hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
+        if (NULL == log_stream) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                       << "Logical stream with ID "
+                                       << in_LogStreamID
+                                       << " doesn't exist"
+                                      );
+        }
+        log_stream->getAllEvents(the_events);
+    }
+
+    WaitForStreamEvents_throw(the_events);
+} // detail::StreamSynchronize_impl_throw(HSTR_LOG_STR in_LogStreamID)
+
+void
+detail::ThreadSynchronize_impl_throw()
+{
+    HSTR_TRACE_FUN_ENTER();
+    IsInitialized_impl_throw();
+
+    std::vector<HSTR_EVENT> all_the_events;
+    {
+        // See StreamSynchronize_impl_throw. Each stream is snapshotted on its
+        // own, so actions enqueued concurrently may or may not be waited for.
+        hStreams_RCU_Read_Scope tables_read_scope;
+        log_streams.getEventsFromAllStreams(all_the_events);
+    }
+
+    WaitForStreamEvents_throw(all_the_events);
 } // detail::ThreadSynchronize_impl_throw()
 
 void
@@ -1750,8 +2343,8 @@ detail::EventWait_impl_throw(
         return;
     }
 
-    // Do a COIEventWait on it
-    HSTR_COIRESULT result = hStreams_COIWrapper::COIEventWait(
+    // Host events are waited on natively, the others through COIEventWait
+    HSTR_COIRESULT result = hStreams_HostEvent::wait(
                                 (uint16_t)in_NumEvents,
                                 in_pEvents,
                                 in_TimeOutMilliSeconds,
@@ -1815,14 +2408,8 @@ detail::EventStreamWait_impl_throw(
                                   );
     }
 
-    hStreams_RW_Scope_Locker_Unlocker phys_domains_scope_lock(phys_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_domains_scope_lock(log_domains_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_streams_scope_lock(log_streams_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
-    hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
-            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    // See EnqueueCompute_worker_throw
+    hStreams_RCU_Read_Scope tables_read_scope;
 
     hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
     if (NULL == log_stream) {
@@ -1832,6 +2419,14 @@ detail::EventStreamWait_impl_throw(
                                    << " doesn't exist."
                                   );
     }
+    hStreams_Graph *capture = log_stream->getCapture();
+    if (capture != NULL && out_pEvent != NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_PERMITTED, StringBuilder()
+                                   << "The actions of logical stream (ID="
+                                   << in_LogStreamID
+                                   << ") are being captured, they have no events"
+                                  );
+    }
 
     hStreams_PhysStream &phys_stream = log_stream->getPhysStream();
     hStreams_LogDomain &log_domain = log_stream->getLogDomain();
@@ -1881,69 +2476,47 @@ detail::EventStreamWait_impl_throw(
             << "Input dependency type in hStreams_EventStreamWait: "
             << (dep_type == IS_BARRIER) ? "barrier" : "transfer";
 
-    std::vector<HSTR_EVENT> events;
-    phys_stream.getInputDeps(dep_type, phys_buffers, events);
-    if (in_NumEvents > 0) {
-        events.insert(events.end(), in_pEvents, in_pEvents + in_NumEvents);
-    }
-
-    HSTR_EVENT completion;
-    // Create an action, COIBufferWrite, that manages the dependences Perform a
-    // COIBufferWrite is cheaper than COIPipelineRunFunction, and has the
-    // desired semantics COIBufferRead would be ok too.  Make sure it's the
-    // best-performing direction - from host?  Make the Buffer referenced here
-    // be a global dummy, of size 1 (not allowed to be 0) Let the input
-    // dependences be the Events, plus the valid pending COIEvents for each of
-    // the intersecting buffers Let the output dependence of that action be the
-    // completion event, allocated above
-    // XXX Does using the same dummy_buf for all streams across all domains not
-    // introduce some weird dependency between unrelated streams?
-    HSTR_COIRESULT result = hStreams_COIWrapper::COIBufferWrite(
-                                hstr_proc.dummy_buf,                    // in_DestBuffer
-                                0,                                      // in_Offset
-                                &hstr_proc.dummy_data,                  // in_pSourceData. Cannot be NULL
-                                1,                                      // in_Length
-                                HSTR_COI_COPY_USE_CPU,                  // in_Type
-                                (uint32_t) events.size(),               // total number of dependencies
-                                (events.empty()) ? NULL : &events[0],   // in_pDependencies
-                                &completion);                           // out_pCompletion
-
-    // Result checking
-    if (result != HSTR_COI_SUCCESS) {
-        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_REMOTE_ERROR, StringBuilder()
-                                   << "A problem occured while gathering the dependencies in "
-                                   << "hStreams_EventStreamWait. COIBufferWrite returned: "
-                                   << hStreams_COIWrapper::COIResultGetName(result)
-                                  );
-    }
-
-    // Iterate through addresses; there may be none
-    // Turn each address into a buffer index, else return HSTR_RESULT_NOT_FOUND
-    // The result, bufferArray is an array of intersecting buffer indices
-
-    // Update deps for that stream
-    // Call setOutputDeps
+    // Find out which buffers' later actions are to depend on the marker
+    DEP_TYPE output_dep_type;
     if (in_NumAddresses == HSTR_WAIT_CONTROL) {
         // Need to pass all the physical buffers instantiated for this logical domain
-        // to setOutputDeps; re-use the phys_buffers vector
+        // to setOutputDeps; re-use the phys_buffers vector, the input dependencies
+        // are a barrier anyway
         log_buffers.getAllPhysBuffersForLogDomain(log_domain, phys_buffers);
-        dep_type = IS_BARRIER;
+        output_dep_type = IS_BARRIER;
         HSTR_DEBUG1(HSTR_INFO_TYPE_SYNC)
                 << "Output dependency type in hStreams_EventStreamWait: barrier";
     } else if (in_NumAddresses == HSTR_WAIT_NONE) {
-        dep_type = NONE;
+        output_dep_type = NONE;
         HSTR_DEBUG1(HSTR_INFO_TYPE_SYNC)
                 << "Output dependency type in hStreams_EventStreamWait: none";
     } else {
-        dep_type = IS_XFER;
+        output_dep_type = IS_XFER;
         HSTR_DEBUG1(HSTR_INFO_TYPE_SYNC)
                 << "Output dependency type in hStreams_EventStreamWait: transfer";
     }
 
-    // Pass in the list of intersecting buffers, which is non-NULL if in_NumAddresses > 0
-    // Pass in the completion event from the dummy COIBufferWrite action
-    if (dep_type != NONE) {
-        phys_stream.setOutputDeps(dep_type, phys_buffers, completion);
+    if (capture != NULL) {
+        // With HSTR_WAIT_CONTROL, the buffers are the ones instantiated as of now
+        capture->addEventWait(dep_type, phys_buffers, in_pEvents, in_NumEvents,
+                              output_dep_type, phys_buffers);
+        return;
+    }
+
+    HSTR_EVENT completion;
+    // Create an action that manages the dependences. Let the input dependences
+    // be the Events, plus the valid pending events for each of the
+    // intersecting buffers. Let the output dependence of that action be the
+    // completion event. The stream does all of that under its own lock.
+    // The list of intersecting buffers is non-empty if in_NumAddresses > 0
+    HSTR_RESULT hret = phys_stream.enqueueEventWait(dep_type, phys_buffers,
+                       in_pEvents, in_NumEvents,
+                       output_dep_type, phys_buffers, log_stream->getPriority(), &completion);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
+                                   << "A problem occured while gathering the dependencies in "
+                                   << "hStreams_EventStreamWait."
+                                  );
     }
 
     //
@@ -1954,6 +2527,247 @@ detail::EventStreamWait_impl_throw(
     }
 } // detail::EventStreamWait_impl_throw(
 
+void
+detail::EnqueueHostCallback_impl_throw(
+    HSTR_LOG_STR       in_LogStreamID,
+    HSTR_HOST_CALLBACK in_Callback,
+    void              *in_pUserData,
+    HSTR_EVENT        *out_pEvent)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(in_pUserData);
+    HSTR_TRACE_FUN_ARG(out_pEvent);
+    IsInitialized_impl_throw();
+
+    if (in_Callback == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "The callback passed to hStreams_EnqueueHostCallback is NULL"
+                                  );
+    }
+
+    // See EnqueueCompute_worker_throw
+    hStreams_RCU_Read_Scope tables_read_scope;
+
+    hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
+    if (NULL == log_stream) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "Logical stream with ID "
+                                   << in_LogStreamID
+                                   << " doesn't exist."
+                                  );
+    }
+    if (log_stream->getCapture() != NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_PERMITTED, StringBuilder()
+                                   << "The actions of logical stream (ID="
+                                   << in_LogStreamID
+                                   << ") are being captured, host callbacks can't be"
+                                  );
+    }
+
+    // The callback is a barrier: it waits for all of the stream's actions,
+    // and all of the later ones wait for it
+    std::vector<hStreams_PhysBuffer *> phys_buffers;
+    log_buffers.getAllPhysBuffersForLogDomain(log_stream->getLogDomain(), phys_buffers);
+
+    HSTR_EVENT completion;
+    HSTR_RESULT hret = log_stream->getPhysStream().enqueueHostCallback(phys_buffers,
+                       in_Callback, in_LogStreamID, in_pUserData,
+                       log_stream->getPriority(), &completion);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
+                                   << "A problem occured while enqueueing a host callback"
+                                  );
+    }
+
+    if (out_pEvent != NULL) {
+        *out_pEvent = completion;
+    }
+} // detail::EnqueueHostCallback_impl_throw
+
+namespace
+{
+hStreams_Graph *graph_from_handle_throw(HSTR_GRAPH in_Graph)
+{
+    hStreams_RW_Scope_Locker_Unlocker graphs_scope_lock(globals::graphs_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+
+    std::map<HSTR_GRAPH, hStreams_Graph *>::const_iterator it = globals::graphs.find(in_Graph);
+    if (it == globals::graphs.end()) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << in_Graph
+                                   << " is not a valid graph"
+                                  );
+    }
+    return it->second;
+}
+} // anonymous namespace
+
+void
+detail::GraphBeginCapture_impl_throw(
+    HSTR_LOG_STR      in_LogStreamID)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    IsInitialized_impl_throw();
+
+    // See EnqueueCompute_worker_throw
+    hStreams_RCU_Read_Scope tables_read_scope;
+
+    hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
+    if (NULL == log_stream) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "Logical stream with ID "
+                                   << in_LogStreamID
+                                   << " doesn't exist"
+                                  );
+    }
+
+    hStreams_Graph *graph = new hStreams_Graph(in_LogStreamID, log_stream->serial());
+    if (!log_stream->beginCapture(graph)) {
+        delete graph;
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_PERMITTED, StringBuilder()
+                                   << "The actions of logical stream (ID="
+                                   << in_LogStreamID
+                                   << ") are already being captured"
+                                  );
+    }
+} // detail::GraphBeginCapture_impl_throw
+
+void
+detail::GraphEndCapture_impl_throw(
+    HSTR_LOG_STR      in_LogStreamID,
+    HSTR_GRAPH       *out_pGraph)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_LogStreamID);
+    HSTR_TRACE_FUN_ARG(out_pGraph);
+    IsInitialized_impl_throw();
+
+    if (out_pGraph == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "out_pGraph cannot be NULL"
+                                  );
+    }
+
+    hStreams_Graph *graph;
+    {
+        // See EnqueueCompute_worker_throw
+        hStreams_RCU_Read_Scope tables_read_scope;
+
+        hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(in_LogStreamID);
+        if (NULL == log_stream) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                       << "Logical stream with ID "
+                                       << in_LogStreamID
+                                       << " doesn't exist"
+                                      );
+        }
+        graph = log_stream->endCapture();
+    }
+    if (graph == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_PERMITTED, StringBuilder()
+                                   << "The actions of logical stream (ID="
+                                   << in_LogStreamID
+                                   << ") are not being captured"
+                                  );
+    }
+
+    hStreams_RW_Scope_Locker_Unlocker graphs_scope_lock(globals::graphs_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
+    HSTR_GRAPH handle = globals::next_graph_handle++;
+    globals::graphs[handle] = graph;
+    *out_pGraph = handle;
+} // detail::GraphEndCapture_impl_throw
+
+void
+detail::GraphLaunch_impl_throw(
+    HSTR_GRAPH        in_Graph,
+    HSTR_EVENT       *out_pEvent)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_Graph);
+    HSTR_TRACE_FUN_ARG(out_pEvent);
+    IsInitialized_impl_throw();
+
+    hStreams_Graph *graph = graph_from_handle_throw(in_Graph);
+
+    // See EnqueueCompute_worker_throw. The stream's physical stream is kept
+    // alive by the read scope as well.
+    hStreams_RCU_Read_Scope tables_read_scope;
+
+    hStreams_LogStream *log_stream = log_streams.lookupByLogStreamID(graph->getLogStreamID());
+    if (NULL == log_stream || log_stream->serial() != graph->getLogStreamSerial()) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "The logical stream (ID="
+                                   << graph->getLogStreamID()
+                                   << ") the graph has been captured from has been destroyed"
+                                  );
+    }
+
+    HSTR_RESULT hret = graph->launch(log_stream->getPhysStream(), log_stream->getPriority(), out_pEvent);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
+                                   << "An error occured while attempting to launch a graph in logical stream (ID="
+                                   << graph->getLogStreamID()
+                                   << ")"
+                                  );
+    }
+} // detail::GraphLaunch_impl_throw
+
+void
+detail::GraphSetScalarArg_impl_throw(
+    HSTR_GRAPH        in_Graph,
+    uint32_t          in_ActionIndex,
+    uint32_t          in_ArgIndex,
+    uint64_t          in_Value)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_Graph);
+    HSTR_TRACE_FUN_ARG(in_ActionIndex);
+    HSTR_TRACE_FUN_ARG(in_ArgIndex);
+    HSTR_TRACE_FUN_ARG(in_Value);
+    IsInitialized_impl_throw();
+
+    hStreams_Graph *graph = graph_from_handle_throw(in_Graph);
+    HSTR_RESULT hret = graph->setScalarArg(in_ActionIndex, in_ArgIndex, in_Value);
+    if (hret != HSTR_RESULT_SUCCESS) {
+        throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
+                                   << "Could not set scalar argument "
+                                   << in_ArgIndex
+                                   << " of action "
+                                   << in_ActionIndex
+                                   << " of the graph"
+                                  );
+    }
+} // detail::GraphSetScalarArg_impl_throw
+
+void
+detail::GraphDestroy_impl_throw(
+    HSTR_GRAPH        in_Graph)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_Graph);
+    IsInitialized_impl_throw();
+
+    hStreams_Graph *graph;
+    {
+        hStreams_RW_Scope_Locker_Unlocker graphs_scope_lock(globals::graphs_lock,
+                hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
+
+        std::map<HSTR_GRAPH, hStreams_Graph *>::iterator it = globals::graphs.find(in_Graph);
+        if (it == globals::graphs.end()) {
+            throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                       << in_Graph
+                                       << " is not a valid graph"
+                                      );
+        }
+        graph = it->second;
+        globals::graphs.erase(it);
+    }
+    delete graph;
+} // detail::GraphDestroy_impl_throw
+
 void
 detail::Alloc1DEx_impl_throw(
     void                    *in_BaseAddress,
@@ -2060,8 +2874,11 @@ detail::Alloc1DEx_impl_throw(
                                   );
     }
 
-    hStreams_LogBuffer *log_buf = new hStreams_LogBuffer(in_BaseAddress, in_Size,
-            *in_pBufferProps);
+    HSTR_BUFFER_PROPS buffer_props = *in_pBufferProps;
+    if (globals::host_buffer_aliasing) {
+        buffer_props.flags |= HSTR_BUF_PROP_HOST_ALIASED;
+    }
+    hStreams_LogBuffer *log_buf = new hStreams_LogBuffer(in_BaseAddress, in_Size, buffer_props);
 
     // Attach all selected logical domains
     if (in_NumLogDomains == -1) {
@@ -2075,11 +2892,13 @@ detail::Alloc1DEx_impl_throw(
         }
     } else {
         // Buffer will always be created for HSTR_SRC_LOG_DOMAIN, and it can't be in in_pLogDomainIDs
-        // so it is added manually here
-        hStreams_LogDomain *src_log_dom = log_domains.lookupByLogDomainID(HSTR_SRC_LOG_DOMAIN);
-        log_domains_set.insert(src_log_dom);
+        // so it is added manually here. It goes first, as the aliased instances
+        // on the host attach to it.
+        std::vector<hStreams_LogDomain *> attached_log_doms(1,
+                log_domains.lookupByLogDomainID(HSTR_SRC_LOG_DOMAIN));
+        attached_log_doms.insert(attached_log_doms.end(), log_domains_set.begin(), log_domains_set.end());
         HSTR_RESULT hret = log_buf->attachLogDomainFromRange(
-                               log_domains_set.begin(), log_domains_set.end());
+                               attached_log_doms.begin(), attached_log_doms.end());
         if (hret != HSTR_RESULT_SUCCESS) {
             throw HSTR_EXCEPTION_MACRO(hret, StringBuilder()
                                        << "An error was encountered while instantiating buffer "
@@ -2131,6 +2950,8 @@ detail::AddBufferLogDomains_impl_throw(
             hStreams_RW_Lock::HSTR_RW_LOCK_READ);
     hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
             hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
+    // The instantiations of the buffer are changed in place
+    hStreams_RCU_Exclusive_Scope tables_exclusive_scope;
 
     std::unordered_set<hStreams_LogDomain *> log_domains_set;
     hStreams_LogBuffer *log_buf = log_buffers.lookupLogBuffer(in_Address);
@@ -2226,6 +3047,8 @@ detail::RmBufferLogDomains_impl_throw(
             hStreams_RW_Lock::HSTR_RW_LOCK_READ);
     hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
             hStreams_RW_Lock::HSTR_RW_LOCK_WRITE);
+    // The instantiations of the buffer are changed in place
+    hStreams_RCU_Exclusive_Scope tables_exclusive_scope;
 
     std::unordered_set<hStreams_LogDomain *> log_domains_set;
     hStreams_LogBuffer *log_buf = log_buffers.lookupLogBuffer(in_Address);
@@ -2398,6 +3221,59 @@ detail::GetBufferProps_impl_throw(
     *out_BufferProps = log_buf->getProperties();
 } // detail::GetBufferProps_impl_throw
 
+void
+detail::GetBufferNumaNode_impl_throw(
+    void                *in_Address,
+    HSTR_LOG_DOM         in_LogDomainID,
+    int32_t             *out_pNumaNode)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_Address);
+    HSTR_TRACE_FUN_ARG(in_LogDomainID);
+    HSTR_TRACE_FUN_ARG(out_pNumaNode);
+    IsInitialized_impl_throw();
+
+    if (in_Address == NULL || out_pNumaNode == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NULL_PTR, StringBuilder()
+                                   << "Either the buffer address or output pointer operand "
+                                   << "was NULL in hStreams_GetBufferNumaNode"
+                                  );
+    }
+    hStreams_RW_Scope_Locker_Unlocker phys_domains_scope_lock(phys_domains_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    hStreams_RW_Scope_Locker_Unlocker log_domains_scope_lock(log_domains_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    hStreams_RW_Scope_Locker_Unlocker log_streams_scope_lock(log_streams_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+    hStreams_RW_Scope_Locker_Unlocker log_buffers_scope_lock(log_buffers_lock,
+            hStreams_RW_Lock::HSTR_RW_LOCK_READ);
+
+    hStreams_LogBuffer *log_buf = log_buffers.lookupLogBuffer(in_Address);
+    if (log_buf == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "Did not find a logical buffer containing the address "
+                                   << in_Address
+                                  );
+    }
+    hStreams_LogDomain *log_dom = log_domains.lookupByLogDomainID(in_LogDomainID);
+    if (log_dom == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_DOMAIN_OUT_OF_RANGE, StringBuilder()
+                                   << "Did not find a logical domain with ID "
+                                   << in_LogDomainID
+                                  );
+    }
+    hStreams_PhysBuffer *phys_buf = log_buf->getPhysBufferForLogDomain(*log_dom);
+    if (phys_buf == NULL) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_FOUND, StringBuilder()
+                                   << "Did not find an instantiation of the logical buffer "
+                                   << log_buf->getStart()
+                                   << " for logical domain #"
+                                   << in_LogDomainID
+                                  );
+    }
+    *out_pNumaNode = phys_buf->getNumaNode();
+} // detail::GetBufferNumaNode_impl_throw
+
 void
 detail::DeAlloc_impl_throw(void *in_Address)
 {
@@ -2486,6 +3362,20 @@ detail::Cfg_SetMKLInterface(HSTR_MKL_INTERFACE in_MKLInterface)
     globals::mkl_interface = in_MKLInterface;
 } // detail::Cfg_SetMKLInterface(HSTR_MKL_INTERFACE in_MKLInterface)
 
+void
+detail::Cfg_SetHostBufferAliasing(bool in_Enable)
+{
+    HSTR_TRACE_FUN_ENTER();
+    HSTR_TRACE_FUN_ARG(in_Enable);
+    if (IsInitialized_impl_nothrow() == HSTR_RESULT_SUCCESS) {
+        throw HSTR_EXCEPTION_MACRO(HSTR_RESULT_NOT_PERMITTED, StringBuilder()
+                                   << "hStreams_Cfg_SetHostBufferAliasing() cannot "
+                                   << "be called if the library has been already initialized."
+                                  );
+    }
+    globals::host_buffer_aliasing = in_Enable;
+} // detail::Cfg_SetHostBufferAliasing(bool in_Enable)
+
 void
 detail::GetCurrentOptions_impl_throw(HSTR_OPTIONS *pCurrentOptions, uint64_t buffSize)
 {
@@ -15,10 +15,14 @@
 #include "hStreams_helpers_source.h"
 
 #include "hStreams_internal_vars_source.h"
+#include "hStreams_HostNuma.h"
 #include "hStreams_PhysBuffer.h"
 #include "hStreams_PhysDomain.h"
 #include "hStreams_PhysStream.h"
 #include "hStreams_exceptions.h"
+#include "hStreams_Logger.h"
+
+#include <stdlib.h>
 
 hStreams_CPUMask::hStreams_CPUMask()
 {
@@ -62,6 +66,12 @@ bool operator!=(hStreams_CPUMask const &m1, hStreams_CPUMask const &m2)
     return !(m1 == m2);
 }
 
+namespace
+{
+// Below this, allocations come from pages shared with other ones and aren't placed
+const uint64_t min_numa_placed_bytes = 64 * 1024;
+} // anonymous namespace
+
 void *hStreams_MemAlignedAllocator::alloc(uint64_t len)
 {
     //TODO: Align to 64 or maybe something else ?
@@ -75,6 +85,30 @@ void *hStreams_MemAlignedAllocator::alloc(uint64_t len)
 #endif
 }
 
+void *hStreams_MemAlignedAllocator::allocNear(uint64_t len, hStreams_CPUMask const &cpu_mask, int32_t &numa_node)
+{
+    numa_node = -1;
+    if (len < min_numa_placed_bytes) {
+        return alloc(len);
+    }
+    // Whole pages, so that the placement doesn't affect other allocations
+    uint64_t page_size = hStreams_HostNuma::page_size;
+    uint64_t placed_len = (len + page_size - 1) & ~(page_size - 1);
+#ifndef _WIN32
+    void *mem;
+    if (posix_memalign(&mem, page_size, placed_len)) {
+        return NULL;
+    }
+#else
+    void *mem = _aligned_malloc(placed_len, page_size);
+    if (mem == NULL) {
+        return NULL;
+    }
+#endif
+    numa_node = hStreams_HostNuma::placeNear(mem, placed_len, cpu_mask);
+    return mem;
+}
+
 void hStreams_MemAlignedAllocator::dealloc(void *data_ptr)
 {
 #ifndef _WIN32
@@ -84,6 +118,30 @@ void hStreams_MemAlignedAllocator::dealloc(void *data_ptr)
 #endif
 }
 
+uint64_t hStreams_GetEnvNumber(const char *env_name, uint64_t default_value,
+                               uint64_t max_value, const char *unit)
+{
+    const char *const env_value = getenv(env_name);
+    if (env_value == NULL || env_value[0] == '\0') {
+        return default_value;
+    }
+    char *end;
+    unsigned long long value = strtoull(env_value, &end, 10);
+    if (*end != '\0' || env_value[0] == '-') {
+        HSTR_WARN(HSTR_INFO_TYPE_MISC)
+                << "Unrecognized value of " << env_name << ": \"" << env_value
+                << "\", expected a number" << (unit ? " of " : "") << (unit ? unit : "")
+                << ". Using " << default_value << ".";
+        return default_value;
+    }
+    if (value > max_value) {
+        HSTR_WARN(HSTR_INFO_TYPE_MISC)
+                << env_name << " is limited to " << max_value << (unit ? " " : "") << (unit ? unit : "");
+        return max_value;
+    }
+    return value;
+}
+
 HSTR_RESULT
 hStreams_helper_func_19parm(
     hStreams_PhysStream &in_phStr,
@@ -109,34 +167,31 @@ hStreams_helper_func_19parm(
     uint64_t          in_parameter18)
 {
     HSTR_EVENT completion_event;
-    std::vector<uint64_t> scalar_args;
-    std::vector<hStreams_PhysBuffer *> buffer_args;
-    std::vector<uint64_t> buffer_offsets;
-
-    scalar_args.reserve(19);
-    scalar_args.push_back(in_parameter0);
-    scalar_args.push_back(in_parameter1);
-    scalar_args.push_back(in_parameter2);
-    scalar_args.push_back(in_parameter3);
-    scalar_args.push_back(in_parameter4);
-    scalar_args.push_back(in_parameter5);
-    scalar_args.push_back(in_parameter6);
-    scalar_args.push_back(in_parameter7);
-    scalar_args.push_back(in_parameter8);
-    scalar_args.push_back(in_parameter9);
-    scalar_args.push_back(in_parameter10);
-    scalar_args.push_back(in_parameter11);
-    scalar_args.push_back(in_parameter12);
-    scalar_args.push_back(in_parameter13);
-    scalar_args.push_back(in_parameter14);
-    scalar_args.push_back(in_parameter15);
-    scalar_args.push_back(in_parameter16);
-    scalar_args.push_back(in_parameter17);
-    scalar_args.push_back(in_parameter18);
+    uint64_t scalar_args[] = {
+        in_parameter0,
+        in_parameter1,
+        in_parameter2,
+        in_parameter3,
+        in_parameter4,
+        in_parameter5,
+        in_parameter6,
+        in_parameter7,
+        in_parameter8,
+        in_parameter9,
+        in_parameter10,
+        in_parameter11,
+        in_parameter12,
+        in_parameter13,
+        in_parameter14,
+        in_parameter15,
+        in_parameter16,
+        in_parameter17,
+        in_parameter18
+    };
 
     CHECK_HSTR_RESULT(
-        in_phStr.enqueueFunction(in_pFuncName, scalar_args, buffer_args, buffer_offsets,
-                                 NULL, 0, &completion_event)
+        in_phStr.enqueueFunction(in_pFuncName, scalar_args, 19, NULL, NULL, NULL, NULL, 0,
+                                 NULL, 0, HSTR_STREAM_PRIORITY_NORMAL, &completion_event)
     );
 
     // No waits on the data, so this can be truly async
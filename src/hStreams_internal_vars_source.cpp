@@ -29,6 +29,7 @@ namespace initial_values
 const HSTR_LOG_STR app_init_next_log_str_ID = 0;
 const HSTR_LOG_DOM next_log_dom_id = 1;
 const HSTR_MKL_INTERFACE mkl_interface = HSTR_MKL_LP64;
+const bool host_buffer_aliasing = false;
 const char *interface_version = "[unknown]";
 hStreams_Atomic_HSTR_STATE hStreamsState = HSTR_STATE_UNINITIALIZED;
 
@@ -76,11 +77,23 @@ HSTR_ALIGN(64) volatile int64_t next_log_dom_id = initial_values::next_log_dom_i
 #pragma warning( pop )
 #endif
 
+bool host_buffer_aliasing = initial_values::host_buffer_aliasing;
+
 std::string target_library_search_path;
 std::string host_library_search_path;
 
 std::vector<std::string> tokenized_target_library_search_path;
 std::vector<std::string> tokenized_host_library_search_path;
+
+std::map<std::string, HSTR_FUNC_HANDLE> function_handles;
+hStreams_RW_Lock function_handles_lock;
+
+std::map<HSTR_GRAPH, hStreams_Graph *> graphs;
+HSTR_GRAPH next_graph_handle = 1;
+hStreams_RW_Lock graphs_lock;
+std::map<HSTR_DAG, hStreams_Dag *> dags;
+HSTR_DAG next_dag_handle = 1;
+hStreams_RW_Lock dags_lock;
 } // namespace globals
 
 
@@ -112,5 +125,8 @@ HSTR_ALIGN(64) volatile int64_t huge_page_usage_threshold = -1;
 const char *host_sink_ld_library_path_env_name = "HOST_SINK_LD_LIBRARY_PATH";
 const char *sink_ld_library_path_env_name = "SINK_LD_LIBRARY_PATH";
 const char *mic_ld_library_path_env_name = "MIC_LD_LIBRARY_PATH";
-
-const uint32_t fixed_buffer_actions_cleanup_value = 100;
+const char *host_queue_env_name = "HSTR_HOST_QUEUE";
+const char *host_spin_ns_env_name = "HSTR_HOST_SPIN_NS";
+const char *host_yield_ns_env_name = "HSTR_HOST_YIELD_NS";
+const char *host_xfer_threads_env_name = "HSTR_HOST_XFER_THREADS";
+const char *host_xfer_nt_bytes_env_name = "HSTR_HOST_XFER_NT_BYTES";
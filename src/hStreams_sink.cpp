@@ -418,5 +418,21 @@ void hStreams_fetchSinkFuncAddress(
         memcpy(in_pReturnValue, &target_func19, sizeof(void *));
     }
 }
+
+// A no-op, run in a stream's pipeline to make a marker action: its completion
+// event gets signaled once all of the action's dependencies have been met.
+// These arguments conform to the COIPipelineRunFunction template,
+//  since this function is invoked directly from COI's thunk
+HSTREAMS_EXPORT
+void hStreams_marker_sink(
+    uint32_t         in_BufferCount,
+    void           **in_ppBufferPointers,
+    uint64_t        *in_pBufferLengths,
+    void            *in_pMiscData,
+    uint16_t         in_MiscDataLength,
+    void            *in_pReturnValue,
+    uint16_t         in_ReturnValueLength)
+{
+}
 #endif
 
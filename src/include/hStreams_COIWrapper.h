@@ -55,9 +55,19 @@ private:
 
     typedef const char *(*COIResultGetName_handler_t)(HSTR_COIRESULT);
 
+    /// @brief Whether the COI library has been loaded
+    static bool available_;
+
 public:
+    /// @brief Load the COI library, if present.
+    /// @note It is not an error for the COI library to be missing: in that case
+    ///     only the host can be used and all the COI handles but
+    ///     \c COIResultGetName are left NULL, see isAvailable().
     hStreams_COIWrapper();
 
+    /// @brief Whether the COI library has been found and loaded
+    static bool isAvailable();
+
     //COI function handlers
     static COIEngineGetInfo_handler_t                               COIEngineGetInfo;
     static COIEngineGetCount_handler_t                              COIEngineGetCount;
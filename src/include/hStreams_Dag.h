@@ -0,0 +1,162 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+
+#ifndef HSTREAMS_DAG_H
+#define HSTREAMS_DAG_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "hStreams_types.h"
+
+/// @brief A set of tasks with the dependencies between them inferred from the
+///     buffers they access, scheduled onto a set of logical streams
+///
+/// The tasks are added in an order in which executing them one by one would
+/// give the intended results. Task B depends on an earlier task A if they
+/// access the same buffer and at least one of them writes it; only the edges
+/// not implied by the others through that buffer are recorded, i.e. a task
+/// depends on the last writer of a buffer and, if it writes the buffer, on
+/// the readers since.
+///
+/// \c execute() submits the tasks once all of their predecessors have been
+/// submitted, picking the next one from the ready ones according to a
+/// \c HSTR_DAG_POLICY. Each task goes to the stream where it is estimated to
+/// finish first. The estimates count the tasks' costs, as declared by the
+/// user, and the transfers needed to bring the task's buffers to the stream's
+/// logical domain, if asked to. Then:
+/// \arg The stale instantiations of the task's buffers are refreshed with a
+///     transfer from an up-to-date one, the source domain's if it is.
+/// \arg The predecessors running in other streams are waited for through a
+///     single \c hStreams_EventStreamWait() per task, scoped to the task's
+///     buffers. The ordering within a stream is left to the stream's own
+///     tracking of the buffers' dependencies.
+///
+/// The dependencies are tracked per buffer: the data of the instantiation of
+/// a buffer in one logical domain are either all up to date, or all stale.
+class hStreams_Dag
+{
+public:
+    /// @param streams The logical streams to schedule the tasks onto
+    /// @param stream_domains The logical domain of each of the streams
+    /// @param bytes_per_cost_unit How many bytes a transfer moves in the time
+    ///     it takes to execute a task of cost 1, 0 if the transfers are not
+    ///     to be taken into account when picking a stream
+    hStreams_Dag(std::vector<HSTR_LOG_STR> const &streams,
+                 std::vector<HSTR_LOG_DOM> const &stream_domains,
+                 uint64_t bytes_per_cost_unit);
+
+    /// @brief Add a task, inferring its dependencies on the ones added before
+    /// @return The index of the task
+    ///
+    /// The arguments are as taken by \c hStreams_EnqueueComputeEx(), with the
+    /// heap arguments being source-side proxy addresses; \c heap_arg_access is
+    /// NULL if the task both reads and writes all of them. A cost of 0 is
+    /// taken as 1.
+    ///
+    /// @note Throws \c HSTR_RESULT_NOT_FOUND if a heap argument is not within
+    ///     an allocated buffer.
+    uint32_t addTask(const char *func_name,
+                     uint32_t num_scalar_args, uint32_t num_heap_args,
+                     uint64_t const *args, HSTR_ACCESS_MODE const *heap_arg_access,
+                     uint64_t cost);
+
+    /// @brief Submit all of the tasks and wait for them to complete
+    ///
+    /// All the buffers' instantiations in the source logical domain are taken
+    /// to be up to date to begin with, and the other ones stale. Once the
+    /// tasks have completed, the source domain's instantiations of the
+    /// buffers written by them are brought up to date, so that the results
+    /// can be read directly by the source.
+    ///
+    /// @note Throws \c HSTR_RESULT_NOT_FOUND if a task's buffers are not all
+    ///     instantiated in the logical domain of any of the streams, or
+    ///     anything the enqueueing functions throw. Once a task has been
+    ///     submitted, the tasks submitted before it are waited for before
+    ///     throwing.
+    void execute(HSTR_DAG_POLICY policy);
+
+    /// @brief The number of tasks added
+    uint32_t numTasks() const;
+
+private:
+    struct Task {
+        std::string func_name;
+        uint32_t num_scalar_args;
+        /// @brief The scalar arguments, then the heap arguments
+        std::vector<uint64_t> args;
+        std::vector<HSTR_ACCESS_MODE> heap_arg_access;
+        /// @brief The buffers accessed, each once, with how they're accessed
+        std::vector<uint32_t> buffers;
+        std::vector<HSTR_ACCESS_MODE> buffer_access;
+        uint64_t cost;
+        std::vector<uint32_t> preds;
+        std::vector<uint32_t> succs;
+        /// @brief The cost of the costliest chain of tasks starting with this one
+        uint64_t bottom_level;
+    };
+
+    struct Buffer {
+        void *start;
+        uint64_t len;
+        /// @brief For inferring the edges while adding the tasks, -1 if none
+        int64_t last_writer;
+        /// @brief The tasks which have read the buffer since the last writer
+        std::vector<uint32_t> readers;
+    };
+
+    /// @brief An action enqueued by \c execute()
+    struct Action {
+        HSTR_EVENT event;
+        uint32_t stream;
+    };
+
+    /// @brief The state of a buffer's instantiation in a logical domain,
+    ///     during \c execute()
+    struct Instance {
+        bool valid;
+        /// @brief The action which has made the data up to date, -1 if none
+        int64_t ready;
+        /// @brief The actions which have accessed the data since then,
+        ///     or, if not valid, since the data have been up to date
+        std::vector<uint64_t> users;
+    };
+
+    class ExecState;
+
+    uint32_t pickStream(ExecState &state, uint32_t task_idx);
+    void submitTask(ExecState &state, uint32_t task_idx, uint32_t stream_idx);
+    void writeBack(ExecState &state, uint32_t buf_idx);
+    void waitForAll(ExecState &state);
+
+    std::vector<HSTR_LOG_STR> streams_;
+    /// @brief The logical domains involved, the source one first
+    std::vector<HSTR_LOG_DOM> domains_;
+    /// @brief The index into \c domains_ of each stream's logical domain
+    std::vector<uint32_t> stream_domains_;
+    uint64_t bytes_per_cost_unit_;
+
+    std::vector<Task> tasks_;
+    std::vector<Buffer> buffers_;
+    /// @brief The index into \c buffers_ by the buffers' start addresses
+    std::map<void *, uint32_t> buffer_indices_;
+
+    // copy and assignment prohibited
+    hStreams_Dag(hStreams_Dag const &other);
+    hStreams_Dag &operator=(hStreams_Dag const &other);
+};
+
+#endif /* HSTREAMS_DAG_H */
@@ -0,0 +1,134 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+
+#ifndef HSTREAMS_GRAPH_H
+#define HSTREAMS_GRAPH_H
+
+#include <vector>
+
+#include "hStreams_types.h"
+#include "hStreams_internal.h"
+#include "hStreams_locks.h"
+#include "hStreams_XferShape.h"
+
+class hStreams_PhysStream;
+class hStreams_PhysBuffer;
+
+/// @brief An action captured into a graph, with everything it takes to
+///     enqueue it looked up and validated beforehand
+struct hStreams_GraphNode {
+    enum Type {
+        COMPUTE,
+        TRANSFER,
+        EVENT_WAIT
+    };
+    Type type;
+    /// @brief COMPUTE: the arguments as taken by the thunk, the sink-side
+    ///     address of the function last
+    std::vector<uint64_t> marshalled_args;
+    /// @brief COMPUTE: the number of scalar arguments, which come first in
+    ///     \c marshalled_args after the numbers of arguments
+    uint32_t num_scalar_args;
+    /// @brief COMPUTE: the buffers of the heap arguments; TRANSFER: the
+    ///     buffers of the regions, each one once; EVENT_WAIT: the buffers
+    ///     whose actions to wait for
+    std::vector<hStreams_PhysBuffer *> buffers;
+    /// @brief COMPUTE: the offsets of the heap arguments into their buffers
+    std::vector<uint64_t> offsets;
+    /// @brief COMPUTE: the lengths accessed, empty if the whole buffers are
+    std::vector<uint64_t> lengths;
+    /// @brief COMPUTE: the access modes of the heap arguments, empty if they
+    ///     are both read and written
+    std::vector<HSTR_ACCESS_MODE> access;
+    /// @brief COMPUTE: where to write the return value to
+    void *ret_val;
+    uint16_t ret_val_size;
+    /// @brief TRANSFER: the blocks of memory to move
+    std::vector<hStreams_PhysXferRegion> regions;
+    /// @brief EVENT_WAIT: as in \c hStreams_PhysStream::enqueueEventWait()
+    DEP_TYPE input_dep_type;
+    DEP_TYPE output_dep_type;
+    std::vector<hStreams_PhysBuffer *> output_buffers;
+    std::vector<HSTR_EVENT> events;
+
+    explicit hStreams_GraphNode(Type node_type);
+};
+
+/// @brief A sequence of actions captured from a logical stream by
+///     \c hStreams_GraphBeginCapture() and \c hStreams_GraphEndCapture()
+///
+/// The graph doesn't keep the stream alive. It remembers the stream by its ID
+/// and serial number (see \c hStreams_LogStream::serial()) instead, so that
+/// launching it after the stream has been destroyed is detected, even if a
+/// stream with the same ID has been created since. Neither does it keep the
+/// buffers alive, just as CUDA graphs don't.
+class hStreams_Graph
+{
+    const HSTR_LOG_STR log_stream_id_;
+    const uint64_t log_stream_serial_;
+    /// @brief Serializes the capture, the patching and the launches
+    hStreams_Lock lock_;
+    std::vector<hStreams_GraphNode> nodes_;
+public:
+    /// @param log_stream_id The ID of the logical stream being captured
+    /// @param log_stream_serial The serial number of that stream
+    hStreams_Graph(HSTR_LOG_STR log_stream_id, uint64_t log_stream_serial);
+
+    HSTR_LOG_STR getLogStreamID() const;
+    uint64_t getLogStreamSerial() const;
+
+    /// @brief Record a compute action
+    /// @param marshalled_args As returned by \c hStreams_PhysStream::marshalFunction()
+    /// @note The other arguments are as taken by
+    ///     \c hStreams_PhysStream::enqueueFunction(), and are copied.
+    void addCompute(
+        std::vector<uint64_t> const &marshalled_args, uint32_t num_scalar_args,
+        hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+        HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+        uint32_t num_buffer_args,
+        void *ret_val, uint16_t ret_val_size);
+
+    /// @brief Record a transfer of one or more regions, as enqueued by
+    ///     \c hStreams_PhysStream::enqueueTransferList()
+    void addTransfer(std::vector<hStreams_PhysXferRegion> const &regions);
+
+    /// @brief Record a marker, as enqueued by \c hStreams_PhysStream::enqueueEventWait()
+    void addEventWait(
+        DEP_TYPE input_dep_type,
+        std::vector<hStreams_PhysBuffer *> const &input_bufs,
+        HSTR_EVENT const *events,
+        uint32_t num_events,
+        DEP_TYPE output_dep_type,
+        std::vector<hStreams_PhysBuffer *> const &output_bufs);
+
+    /// @brief Change a scalar argument of a compute for the later launches
+    /// @return \c HSTR_RESULT_OUT_OF_RANGE if there's no such action or no
+    ///     such argument, \c HSTR_RESULT_INCONSISTENT_ARGS if the action is
+    ///     not a compute
+    HSTR_RESULT setScalarArg(uint64_t node_idx, uint32_t arg_idx, uint64_t value);
+
+    /// @brief Enqueue the actions in a physical stream, with the priority of
+    ///     the logical stream launched in
+    /// @note The caller is responsible for \c phys_stream being the physical
+    ///     stream of the logical stream captured, and for keeping it alive.
+    HSTR_RESULT launch(hStreams_PhysStream &phys_stream, HSTR_STREAM_PRIORITY priority,
+                       HSTR_EVENT *ret_event);
+private:
+    // copy and assignment prohibited
+    hStreams_Graph(hStreams_Graph const &other);
+    hStreams_Graph &operator=(hStreams_Graph const &other);
+};
+
+#endif /* HSTREAMS_GRAPH_H */
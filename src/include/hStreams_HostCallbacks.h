@@ -0,0 +1,72 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#ifndef HSTREAMS_HOSTCALLBACKS_H
+#define HSTREAMS_HOSTCALLBACKS_H
+
+#include "hStreams_types.h"
+
+/// @brief The thread running the host callbacks enqueued by
+///     \c hStreams_EnqueueHostCallback()
+///
+/// A single thread, started with the first callback, waits for the events the
+/// pending callbacks depend on all at once, runs each callback as soon as its
+/// event has completed and then signals the callback's completion event. The
+/// callbacks whose events complete together are run in the order in which
+/// they were submitted. As the stream's later actions wait for the completion
+/// event, the callbacks of a single stream are run in order.
+///
+/// The callbacks are free to enqueue actions into any stream, including
+/// their own, but must not wait for actions which depend on a callback still
+/// to be run, as that would deadlock the thread.
+class hStreams_HostCallbacks
+{
+public:
+    /// @brief Have \c callback run once \c dep has completed, then signal \c completion
+    /// @param[in] dep A host or COI event, or the "no action" placeholder for a
+    ///     callback which can be run immediately
+    /// @param[in] completion A host event created for the callback by
+    ///     \c hStreams_HostEvent::create()
+    /// @throws hStreams_exception if the thread can't be started
+    static void submit(
+        HSTR_EVENT const &dep,
+        HSTR_HOST_CALLBACK callback,
+        HSTR_LOG_STR log_stream_id,
+        void *user_data,
+        HSTR_EVENT const &completion);
+
+    /// @brief Have \c notify(arg) called once \c event has completed
+    /// @return false, without calling \c notify, if the event is already
+    ///     known to have completed
+    ///
+    /// Host events call the notification themselves when they are signaled,
+    /// see \c hStreams_HostEvent::notifyOnSignal(). The completion of COI
+    /// events is waited for by a second thread, kept apart from the one
+    /// running the callbacks. Either way the notification must be short and
+    /// mustn't block.
+    /// @throws hStreams_exception if the thread can't be started
+    static bool notifyOnCompletion(HSTR_EVENT const &event, void (*notify)(void *), void *arg);
+
+    /// @brief Run the callbacks and notifications still pending, then stop
+    ///     the threads
+    ///
+    /// Called when finalizing the library, once no more callbacks can be
+    /// enqueued and all the buffers are gone. The threads are started again
+    /// by the next \c submit() or \c notifyOnCompletion().
+    static void shutdown();
+private:
+    hStreams_HostCallbacks();
+};
+
+#endif /* HSTREAMS_HOSTCALLBACKS_H */
@@ -0,0 +1,120 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#ifndef HSTREAMS_HOSTEVENT_H
+#define HSTREAMS_HOSTEVENT_H
+
+#include <vector>
+
+#include "hStreams_types.h"
+#include "hStreams_COIWrapper_types.h"
+#include "hStreams_WaitPolicy.h"
+
+/// @brief In-library completion events for actions executed in the source
+///     physical domain
+///
+/// A host event is a 32-bit atomic state word (a generation counter plus
+/// "signaled", "bridged", "has waiters" and "has notifications" flags) in a slot of a process-wide,
+/// never-shrinking table. Waiters poll it as long as \c hStreams_WaitPolicy
+/// allows and then sleep on it (futex on Linux, \c WaitOnAddress on
+/// Windows), so neither signalling nor waiting goes through COI.
+///
+/// The \c HSTR_EVENT handle of a host event carries a tag in \c opaque[1] and
+/// the slot index and generation in \c opaque[0]. A slot is recycled as soon
+/// as its event is signaled; handles of earlier generations are then simply
+/// reported as completed.
+///
+/// Host events may be mixed freely with COI events: \c wait() waits natively
+/// for the host subset and hands the rest to \c COIEventWait, while
+/// \c translateForCOI() replaces host events in dependency lists passed to COI
+/// by COI user events which are signaled together with the host event
+/// ("bridging").
+///
+/// @note The all-ones \c HSTR_EVENT, used by the physical streams as the
+///     "no action yet" placeholder, is treated as an already completed event.
+class hStreams_HostEvent
+{
+public:
+    /// @brief Create a new, not yet signaled host event
+    static HSTR_EVENT create();
+
+    /// @brief Mark the host event as completed and wake up all its waiters
+    /// @note Each host event must be signaled exactly once.
+    static void signal(HSTR_EVENT const &event);
+
+    /// @brief Have \c notify(arg) called by the thread which signals the host event
+    /// @return false, without calling \c notify, if the event has already
+    ///     completed or is the placeholder
+    ///
+    /// The notifications of an event are called in the order in which they
+    /// were added, after its waiters have been woken up. They are called with
+    /// an internal lock held, so they must be short and mustn't signal host
+    /// events or add notifications themselves.
+    static bool notifyOnSignal(HSTR_EVENT const &event, void (*notify)(void *), void *arg);
+
+    /// @brief Whether the event has been created by \c create()
+    static bool isHostEvent(HSTR_EVENT const &event);
+
+    /// @brief Whether the event is the "no action" placeholder
+    static bool isNullEvent(HSTR_EVENT const &event);
+
+    /// @brief Whether the event is known to have completed, without waiting
+    ///
+    /// True for the placeholder and for the host events which have been
+    /// signaled. COI events are never reported as completed, as finding that
+    /// out would take a call to COI.
+    static bool isCompleted(HSTR_EVENT const &event);
+
+    /// @brief Drop the duplicates and the events known to have completed from
+    ///     a list of events about to be waited for or passed as dependencies
+    /// @return The number of events dropped
+    ///
+    /// The order of the remaining events is not preserved.
+    static uint64_t prune(std::vector<HSTR_EVENT> &events);
+
+    /// @brief A drop-in replacement for \c COIEventWait which accepts host events
+    ///
+    /// Arguments and return values follow \c COIEventWait. If no COI event
+    /// is involved, COI is not called at all and the waiting follows
+    /// \c hStreams_WaitPolicy; successful waits of that kind are then counted
+    /// in \c stats, if given.
+    static HSTR_COIRESULT wait(
+        uint16_t num_events,
+        const HSTR_EVENT *events,
+        int32_t timeout_ms,
+        uint8_t wait_for_all,
+        uint32_t *out_num_signaled,
+        uint32_t *out_signaled_indices,
+        hStreams_WaitStats *stats = NULL);
+
+    /// @brief Wait for all of an arbitrarily long list of events
+    ///
+    /// Same as \c wait() with \c wait_for_all set, but the events are waited
+    /// for in chunks of at most 0xFFFF, the most \c COIEventWait accepts in
+    /// one call. The timeout applies to the whole list.
+    static HSTR_COIRESULT waitAll(
+        uint64_t num_events,
+        const HSTR_EVENT *events,
+        int32_t timeout_ms);
+
+    /// @brief Prepare a list of dependencies for a COI call
+    ///
+    /// Completed host events and placeholders are removed, host events which
+    /// are still pending are replaced with COI user events bridged to them.
+    static HSTR_COIRESULT translateForCOI(std::vector<HSTR_EVENT> &events);
+private:
+    hStreams_HostEvent();
+};
+
+#endif /* HSTREAMS_HOSTEVENT_H */
@@ -0,0 +1,58 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#ifndef HSTREAMS_HOSTNUMA_H
+#define HSTREAMS_HOSTNUMA_H
+
+#include "hStreams_types.h"
+#include "hStreams_helpers_source.h"
+
+/// @brief The NUMA topology of the host and the placement of memory on it
+///
+/// The topology is read once, on first use: from sysfs on Linux and from
+/// \c GetNumaProcessorNode() on Windows. Where it can't be read, all the CPUs
+/// are considered to be on an unknown node and nothing is ever placed.
+class hStreams_HostNuma
+{
+public:
+    /// @brief The node of the memory closest to all the CPUs of \c cpu_mask
+    /// @return -1 if the CPUs belong to more than one node, or the node of
+    ///     any of them is unknown
+    static int32_t nodeOfCPUs(hStreams_CPUMask const &cpu_mask);
+
+    /// @brief Put the pages of <tt>[mem, mem + len)</tt> in the memory
+    ///     closest to the CPUs of \c cpu_mask
+    ///
+    /// If the CPUs share a node, the memory is bound to that node, as a
+    /// preference. The pages are then first touched by threads pinned to the
+    /// CPUs of the mask, each touching a contiguous range of them, so that
+    /// the faulting is spread over the CPUs and, where the mask spans several
+    /// nodes, each range is placed next to the CPU touching it.
+    ///
+    /// @param mem Page-aligned start of the memory, which mustn't have been
+    ///     touched yet
+    /// @param len The length of the memory, a multiple of \c page_size
+    /// @return The node the memory has been placed on, -1 if it's spread over
+    ///     several of them or unknown
+    static int32_t placeNear(void *mem, uint64_t len, hStreams_CPUMask const &cpu_mask);
+
+    /// @brief Pin the calling thread to a single CPU, warning when it can't be done
+    /// @param thread_desc What the thread does, for the warning
+    static void pinCurrentThread(uint32_t cpu, const char *thread_desc);
+
+    /// @brief The granularity of the placement
+    static const uint64_t page_size = 4096;
+};
+
+#endif /* HSTREAMS_HOSTNUMA_H */
@@ -18,17 +18,28 @@
 #include <vector>
 #include <queue>
 #include <memory>
+#include <atomic>
 
 #include "hStreams_types.h"
+#include "hStreams_internal.h"
 #include "hStreams_locks.h"
 #include "hStreams_exceptions.h"
 #include "hStreams_threading.h"
+#include "hStreams_WaitPolicy.h"
+#include "hStreams_HostXferEngine.h"
 
 /// @brief Types of actions supported by the host-side streams worker
 enum ACTION_TYPE {
     /// @brief Perform a computation.
     /// @sa hStreams_EnqueueCompute
     COMPUTE,
+    /// @brief Copy memory between two host-side buffers.
+    /// @sa hStreams_EnqueueData1D, hStreams_EnqueueDataXDomain1D,
+    ///     hStreams_EnqueueData2D, hStreams_EnqueueData3D
+    TRANSFER,
+    /// @brief Only resolve the input dependencies and signal the completion event.
+    /// @sa hStreams_EventStreamWait
+    MARKER,
     /// @brief The host-side streams worker thread should exit
     STOP
 };
@@ -50,7 +61,7 @@ struct ComputePayload {
     uint16_t ret_val_size_;
     /// @brief Custom event to be signaled once the computation finishes
     ///
-    /// This event has to be registered through a call to \c COIEventRegisterUserEvent
+    /// This event has to be created through a call to \c hStreams_HostEvent::create()
     HSTR_EVENT ret_event_;
 
     /// @brief a helper constructor which will set up the internals of the struct.
@@ -59,21 +70,104 @@ struct ComputePayload {
                    void *ret_val,
                    uint16_t &ret_val_size,
                    HSTR_EVENT ret_event);
+
+    /// @brief Set up the internals of a recycled payload, reusing the memory of the vectors
+    void assign(std::vector<uint64_t> const &args,
+                std::vector<HSTR_EVENT> const &input_deps,
+                void *ret_val,
+                uint16_t ret_val_size,
+                HSTR_EVENT ret_event);
+
+    /// @brief The capacity the vectors of the payloads are created with
+    ///
+    /// Recycled payloads take the arguments and the dependencies of actions
+    /// with no more than that many of them without allocating memory,
+    /// whichever action they were created for.
+    static const size_t reserved_entries = 8;
+};
+
+/// @brief "Metadata" used by the \c TRANSFER and \c MARKER actions
+///
+/// A \c MARKER carries no memory to copy, i.e. no regions.
+struct TransferPayload {
+    /// @brief The blocks of memory to copy, in no particular order
+    std::vector<TransferRegion> regions_;
+    /// @brief A collection of the events this action should depend on before it can execute
+    std::vector<HSTR_EVENT> input_deps_;
+    /// @brief Event to be signaled once the copy finishes
+    ///
+    /// This event has to be created through a call to \c hStreams_HostEvent::create()
+    HSTR_EVENT ret_event_;
+
+    /// @brief a helper constructor which will set up the internals of the struct.
+    TransferPayload(TransferRegion const *regions,
+                    uint32_t num_regions,
+                    std::vector<HSTR_EVENT> &input_deps,
+                    HSTR_EVENT ret_event);
+
+    /// @brief Set up the internals of a recycled payload, reusing the memory of the vectors
+    void assign(TransferRegion const *regions,
+                uint32_t num_regions,
+                std::vector<HSTR_EVENT> const &input_deps,
+                HSTR_EVENT ret_event);
 };
 
 class Action
 {
     ACTION_TYPE action_type_;
+    HSTR_STREAM_PRIORITY priority_;
     std::unique_ptr<ComputePayload> payload_;
+    std::unique_ptr<TransferPayload> transfer_payload_;
 public:
 
+    /// @brief An action without a payload, to be set up through \c setCompute()
+    ///     or \c setTransfer()
+    Action();
     //Action object is taking ownership of payload object
     Action(ACTION_TYPE action_type, std::unique_ptr<ComputePayload> payload);
+    Action(ACTION_TYPE action_type, std::unique_ptr<TransferPayload> payload);
     ~Action();
 
+    /// @brief Turn the action into a \c COMPUTE one
+    ///
+    /// The payload of an action is kept when it's recycled (see
+    /// \c hStreams_HostSideSinkWorker::acquireAction()), so that it can be
+    /// filled in again without allocating memory.
+    void setCompute(std::vector<uint64_t> &args,
+                    std::vector<HSTR_EVENT> &input_deps,
+                    void *ret_val,
+                    uint16_t ret_val_size,
+                    HSTR_EVENT ret_event);
+    /// @brief Turn the action into a \c TRANSFER or \c MARKER one
+    /// @sa setCompute()
+    void setTransfer(ACTION_TYPE action_type,
+                     TransferRegion const *regions,
+                     uint32_t num_regions,
+                     std::vector<HSTR_EVENT> &input_deps,
+                     HSTR_EVENT ret_event);
+
     std::unique_ptr<ComputePayload> &getComputePayload();
+    std::unique_ptr<TransferPayload> &getTransferPayload();
 
     ACTION_TYPE getActionType();
+
+    /// @brief The priority of the logical stream the action was enqueued in,
+    ///     \c HSTR_STREAM_PRIORITY_NORMAL unless set
+    HSTR_STREAM_PRIORITY getPriority();
+    /// @note Kept when the action is recycled, so it has to be set each time
+    void setPriority(HSTR_STREAM_PRIORITY priority);
+};
+
+/// @brief Implementations of the queue feeding a host-side streams worker
+///
+/// The implementation is picked when the host-side physical stream is created,
+/// based on the value of the \c HSTR_HOST_QUEUE environment variable
+/// ("ring" or "locked"), see hStreams_SPSCQueue::create().
+enum HSTR_HOST_QUEUE_TYPE {
+    /// @brief Lock-free ring with an overflow path, see hStreams_RingSPSCQueue
+    HSTR_HOST_QUEUE_RING,
+    /// @brief Mutex- and condvar-protected \c std::queue, see hStreams_LockedSPSCQueue
+    HSTR_HOST_QUEUE_LOCKED
 };
 
 /// @brief A single consumer-single producer queue for the purpose of the host-side streams
@@ -81,11 +175,17 @@ public:
 /// Mimicking the behaviour of the queues in COI, this queue is an "infinite"
 /// one. Obviously, in practive there are no infinite queues, all queues are
 /// bounded by the resources of the operating system.
+///
+/// @note There must be at most one thread adding actions to the queue at any
+///     given time. For the host-side streams this is guaranteed by the
+///     physical stream, which only enqueues while holding its lock.
 class hStreams_SPSCQueue
 {
 public:
-    hStreams_SPSCQueue();
-    ~hStreams_SPSCQueue();
+    virtual ~hStreams_SPSCQueue();
+
+    /// @brief Create a queue of the type selected through the environment
+    static hStreams_SPSCQueue *create();
 
     /// @brief Push a new action onto the queue
     /// @param action The action to be pushed onto the queue
@@ -101,13 +201,64 @@ public:
     /// @endcode
     ///
     /// It might be helpful for the reader to understand the move semantics of C++11.
-    void add(std::unique_ptr<Action> action);
-    /// @brief Dequeue an element from the queue
+    virtual void add(std::unique_ptr<Action> action) = 0;
+    /// @brief Dequeue an element from the queue, blocking if the queue is empty
     /// @returns an action element
     ///
     /// @note The queue releases the ownership of the action object, the agent
     ///     dequeuing the action will now own it.
+    virtual std::unique_ptr<Action> popFront() = 0;
+    /// @brief Dequeue all the actions present in the queue, blocking if the queue is empty
+    /// @param out_actions The actions are appended to this vector, oldest first
+    ///
+    /// @note As with \c popFront(), the ownership of the actions passes to the caller.
+    virtual void popAll(std::vector<std::unique_ptr<Action> > &out_actions) = 0;
+    /// @brief As \c popAll(), but returning right away if the queue is empty
+    virtual void tryPopAll(std::vector<std::unique_ptr<Action> > &out_actions) = 0;
+    /// @brief How long the consumer had to wait in \c popFront()
+    hStreams_WaitStats const &getPopStats() const;
+    /// @brief Get a host event signaled once the next action is added, for the
+    ///     consumer to wait for along with other events
+    ///
+    /// The same event is returned until it's signaled. The actions added
+    /// before the call don't signal it, so the consumer has to look at the
+    /// queue once more, e.g. through \c tryPopAll(), before waiting for it.
+    HSTR_EVENT armWakeup();
+protected:
+    hStreams_SPSCQueue();
+
+    /// @brief Producer side: signal the event of \c armWakeup(), if armed
+    /// @note Must follow a sequentially consistent fence issued after the
+    ///     action has been made visible to the consumer
+    void signalWakeup();
+
+    hStreams_WaitStats pop_stats_;
+private:
+    // copy-ctor and assignment prohibited
+    hStreams_SPSCQueue(hStreams_SPSCQueue const &other);
+    hStreams_SPSCQueue &operator=(hStreams_SPSCQueue const &other);
+
+    /// @brief Guards wakeup_, and wakeup_armed_ being reset
+    hStreams_Lock wakeup_lock_;
+    /// @brief Valid while wakeup_armed_ is set
+    HSTR_EVENT wakeup_;
+    std::atomic<bool> wakeup_armed_;
+};
+
+/// @brief The original host-side streams queue: a \c std::queue guarded by a
+///     mutex, with the consumer sleeping on a conditional variable
+///
+/// The consumer goes to sleep right away, regardless of \c hStreams_WaitPolicy.
+class hStreams_LockedSPSCQueue : public hStreams_SPSCQueue
+{
+public:
+    hStreams_LockedSPSCQueue();
+    ~hStreams_LockedSPSCQueue();
+
+    void add(std::unique_ptr<Action> action);
     std::unique_ptr<Action> popFront();
+    void popAll(std::vector<std::unique_ptr<Action> > &out_actions);
+    void tryPopAll(std::vector<std::unique_ptr<Action> > &out_actions);
 private:
     /// @brief The underlying implementation of the queue.
     typedef std::queue<std::unique_ptr<Action> > queue_t;
@@ -117,17 +268,107 @@ private:
     hStreams_Lock mutex_;
     /// @brief For synchronising the pushes/pops
     hStreams_CondVar cond_var_;
-    // copy-ctor and assignment prohibited
-    hStreams_SPSCQueue(hStreams_SPSCQueue const &other);
-    hStreams_SPSCQueue &operator=(hStreams_SPSCQueue const &other);
 };
 
-// Implementation of a physical stream over COI, calls COIPipelineDestroy on
-// the pipeline it has been created with upon the object's destruction
+/// @brief A lock-free single producer-single consumer ring of actions
+///
+/// Pushes and pops which hit the ring touch only the producer's and the
+/// consumer's cache lines respectively; no mutex is taken unless the consumer
+/// has gone to sleep on an empty queue. Before going to sleep, the consumer
+/// polls the queue as long as \c hStreams_WaitPolicy allows.
+///
+/// To keep the "infinite" semantics of the queue, actions which don't fit in
+/// the ring spill over into a mutex-protected vector. Once anything has
+/// spilled over, subsequent actions are spilled over as well until the
+/// consumer drains the overflow, which keeps the FIFO order intact. The
+/// vector keeps its capacity once drained, so a backlog no deeper than an
+/// earlier one spills over without allocating memory.
+class hStreams_RingSPSCQueue : public hStreams_SPSCQueue
+{
+public:
+    hStreams_RingSPSCQueue();
+    ~hStreams_RingSPSCQueue();
+
+    void add(std::unique_ptr<Action> action);
+    std::unique_ptr<Action> popFront();
+    void popAll(std::vector<std::unique_ptr<Action> > &out_actions);
+    void tryPopAll(std::vector<std::unique_ptr<Action> > &out_actions);
+private:
+    /// @brief Number of slots in the ring, must be a power of 2
+    static const uint64_t ring_capacity = 1024;
+    HSTR_STATIC_ASSERT((ring_capacity & (ring_capacity - 1)) == 0, ring_capacity_must_be_a_power_of_2);
+
+    /// @brief Producer side: try to place an action in the ring
+    bool pushRing(Action *action);
+    /// @brief Consumer side: take the oldest action from the ring, NULL if empty
+    Action *popRing();
+    /// @brief Consumer side: take the oldest spilled action, mutex_ must be held
+    Action *popOverflow_locked();
+    /// @brief Consumer side: move everything in the ring to out_actions
+    void drainRing(std::vector<std::unique_ptr<Action> > &out_actions);
+    /// @brief Consumer side: move everything in the ring and overflow to out_actions, mutex_ must be held
+    void drainAll_locked(std::vector<std::unique_ptr<Action> > &out_actions);
+    /// @brief Consumer side: the predicate for sleeping in popAll()
+    bool nothingToDrain_locked(std::vector<std::unique_ptr<Action> > *out_actions, size_t num_before);
+    /// @brief Consumer side: the predicate for sleeping on the conditional variable
+    bool nothingToPop_locked(Action **out_action);
+    /// @brief Consumer side: whether there's anything to pop, without popping it
+    bool hasPending() const;
+    /// @brief Producer side: signal the consumer if it went to sleep, or
+    ///     armed the wake-up event
+    void wakeConsumer();
+
+    // Producer-owned cache line
+    std::atomic<uint64_t> tail_;
+    uint64_t cached_head_;
+    char producer_pad_[HSTR_CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+
+    // Consumer-owned cache line
+    std::atomic<uint64_t> head_;
+    uint64_t cached_tail_;
+    char consumer_pad_[HSTR_CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+
+    // Shared, but rarely written
+    std::atomic<bool> consumer_sleeping_;
+    std::atomic<uint64_t> overflow_size_;
+    char shared_pad_[HSTR_CACHE_LINE_SIZE];
+
+    Action *slots_[ring_capacity];
+
+    /// @brief Guards overflow_, overflow_head_ and the consumer going to sleep
+    hStreams_Lock mutex_;
+    hStreams_CondVar cond_var_;
+    /// @brief The spilled actions, owned by the queue, from overflow_head_ on
+    std::vector<Action *> overflow_;
+    size_t overflow_head_;
+};
+
+/// @brief The thread executing the actions of a host-side physical stream
+///
+/// The worker of an out-of-order stream keeps the actions whose input
+/// dependencies haven't completed yet aside and executes the ones enqueued
+/// after them whose dependencies have, so that e.g. a compute waiting for a
+/// transfer in another stream doesn't hold up the independent ones behind it.
+/// Of the actions which are ready, the ones of the highest priority go first.
+///
+/// The worker of an in-order stream keeps executing the actions in the FIFO
+/// order until one of a priority other than \c HSTR_STREAM_PRIORITY_NORMAL
+/// shows up. From then on, it keeps a FIFO per priority and, after each
+/// action, executes the oldest action of the highest priority whose input
+/// dependencies have completed. The actions of different priorities are then
+/// only ordered by their dependencies, see \c hStreams_PhysStream. Once only
+/// \c HSTR_STREAM_PRIORITY_NORMAL actions are left, it goes back to the FIFO
+/// order.
+///
+/// When none of the actions it holds is ready, either worker sleeps until one
+/// of their input dependencies completes or a new action is enqueued, see
+/// \c hStreams_SPSCQueue::armWakeup().
 class hStreams_HostSideSinkWorker
 {
 public:
-    hStreams_HostSideSinkWorker(hStreams_CPUMask const &cpu_mask);
+    /// @param out_of_order Whether to execute the actions in any order
+    ///     satisfying their input dependencies, rather than in the FIFO one
+    hStreams_HostSideSinkWorker(hStreams_CPUMask const &cpu_mask, bool out_of_order);
     ~hStreams_HostSideSinkWorker();
     /// @brief Push a new action onto the worker's queue
     /// @param action The action to be pushed onto the queue
@@ -135,11 +376,74 @@ public:
     ///
     /// It might be helpful for the reader to understand the move semantics of C++11.
     HSTR_RESULT putAction(std::unique_ptr<Action> action);
+    /// @brief Get an action to be set up and passed to \c putAction()
+    ///
+    /// Executed actions are handed back by the worker thread and reused here,
+    /// so in the steady state no memory is allocated for the actions and their
+    /// payloads. If there's nothing to reuse, a new action is created.
+    ///
+    /// @note Like \c putAction(), must be called by one thread at a time.
+    std::unique_ptr<Action> acquireAction();
     /// @brief The bootstrap routine for the host-sink worker thread to execute
     static worker_return_type workerMainLoop(void *);
 private:
+    /// @brief Execute a single action
+    /// @param deps_resolved Whether the action's input dependencies are known to have completed
+    /// @return false if the worker should stop
+    bool executeAction(Action &action, bool deps_resolved);
+    /// @brief Check the input dependencies of all the actions with a single poll
+    /// @param out_resolved For each action, whether its input dependencies have completed
+    void pollInputDeps(std::vector<std::unique_ptr<Action> > &actions, std::vector<bool> &out_resolved);
+    /// @brief Wait until one more of the input dependencies polled by the
+    ///     last \c pollInputDeps() completes, or \c wakeup is signaled
+    /// @param wakeup The event of \c hStreams_SPSCQueue::armWakeup()
+    /// @return false if the dependencies couldn't be waited for, e.g. if there
+    ///     were too many of them to be polled at all
+    bool waitForPolledInputDeps(HSTR_EVENT const &wakeup);
+    /// @brief Execute the actions one by one, in the order given, and recycle them
+    /// @return false if the worker should stop
+    bool executeInOrder(std::vector<std::unique_ptr<Action> > &actions);
+    /// @brief Pop and execute the actions one by one
+    void runSingle();
+    /// @brief Pop the actions and execute whichever have their input dependencies resolved
+    void runOutOfOrder();
+    /// @brief Pop the actions and execute them in the FIFO order of each of
+    ///     the priorities, the higher priorities first, for as long as any
+    ///     of them has a priority other than \c HSTR_STREAM_PRIORITY_NORMAL
+    /// @param pending The actions popped but not executed yet, oldest first.
+    ///     Upon return, the ones left, to be executed in order.
+    void runPrioritized(std::vector<std::unique_ptr<Action> > &pending);
+    /// @brief Hand the executed actions back to \c acquireAction(), emptying the vector
+    void recycleActions(std::vector<std::unique_ptr<Action> > &actions);
+
+    /// @brief How many executed actions are kept for reuse, the rest are freed
+    ///
+    /// The pool grows with the deepest backlog of the stream seen so far, so
+    /// no memory is allocated for actions as long as fewer than that many of
+    /// them are in flight. Beyond, actions are allocated and freed again.
+    static const size_t max_recycled_actions = 16384;
+
     hStreams_CPUMask cpu_mask_;
     HSTR_RESULT worker_status_;
+    /// @brief How long the worker had to wait for the input dependencies of actions
+    hStreams_WaitStats deps_wait_stats_;
+    const bool out_of_order_;
+    // Scratch space of pollInputDeps(), kept to avoid reallocating for each poll
+    std::vector<HSTR_EVENT> poll_events_;
+    std::vector<uint32_t> poll_owners_;
+    std::vector<uint32_t> poll_pending_;
+    std::vector<uint32_t> poll_signaled_;
+    // Scratch space of waitForPolledInputDeps()
+    uint32_t poll_num_signaled_;
+    std::vector<bool> poll_is_signaled_;
+    std::vector<HSTR_EVENT> poll_unsignaled_;
+    /// @brief Copies the regions of the \c TRANSFER actions
+    std::unique_ptr<hStreams_HostXferEngine> xfer_engine_;
+    /// @brief Actions ready for reuse, only touched by acquireAction()
+    std::vector<Action *> free_actions_;
+    /// @brief Actions handed back by the worker thread, guarded by recycled_lock_
+    std::vector<Action *> recycled_actions_;
+    hStreams_Lock recycled_lock_;
     hStreams_Lock lock_;
     std::unique_ptr<hStreams_SPSCQueue> queue_;
     std::unique_ptr<hStreams_Thread> thread_;
@@ -0,0 +1,127 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#ifndef HSTREAMS_HOSTXFERENGINE_H
+#define HSTREAMS_HOSTXFERENGINE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "hStreams_types.h"
+#include "hStreams_helpers_source.h"
+#include "hStreams_locks.h"
+#include "hStreams_threading.h"
+#include "hStreams_XferShape.h"
+
+/// @brief A block of memory copied by a \c TRANSFER action
+struct TransferRegion {
+    /// @brief Where to copy the first row of data to
+    void *dst_;
+    /// @brief Where to copy the first row of data from
+    const void *src_;
+    /// @brief The rows of bytes to copy
+    hStreams_XferShape shape_;
+};
+
+/// @brief Copies the regions of the \c TRANSFER actions of a host-side stream
+///
+/// Small copies are done with \c memcpy() by the calling thread, i.e. the
+/// host-side streams worker. The bytes of large ones are split into equal
+/// parts, one for the worker and one for each of the helper threads, which
+/// are pinned to the CPUs of the stream's CPU mask, one CPU each. Since the
+/// pages are usually first touched by the threads of the stream, this keeps
+/// the copies on the memory node of the stream's CPUs. Copies larger than a
+/// threshold are done with non-temporal stores, which don't evict the data
+/// the stream's computations work on from the caches.
+///
+/// The tunables are read from the environment when the engine is created:
+/// \c HSTR_HOST_XFER_THREADS limits the number of threads taking part in a
+/// copy (1 disables the helpers) and \c HSTR_HOST_XFER_NT_BYTES is the size
+/// from which on the non-temporal stores are used (0 disables them).
+///
+/// @note Must be used by one thread at a time. The helper threads are only
+///     created when the first large copy shows up.
+class hStreams_HostXferEngine
+{
+public:
+    explicit hStreams_HostXferEngine(hStreams_CPUMask const &cpu_mask);
+    ~hStreams_HostXferEngine();
+
+    /// @brief Copy all the regions, returning once all the bytes are in place
+    void copy(TransferRegion const *regions, uint64_t num_regions);
+private:
+    /// @brief A thread copying its part of the current job
+    struct Helper {
+        hStreams_HostXferEngine *engine_;
+        /// @brief Which part of a job this helper copies, the worker copies part 0
+        uint32_t part_;
+        /// @brief The only CPU the helper runs on
+        uint32_t cpu_;
+        /// @brief The sequence number of the last job seen by the helper
+        uint64_t seen_seq_;
+        /// @brief The helper sleeps on this one when there's no job, guarded by the engine's lock
+        hStreams_CondVar cond_var_;
+        std::unique_ptr<hStreams_Thread> thread_;
+    };
+
+    /// @brief Never split a copy into parts smaller than this
+    static const uint64_t min_part_bytes = 256 * 1024;
+
+    /// @brief Start the helper threads, as many as the CPU mask and the
+    ///     environment allow
+    void startHelpers();
+    /// @brief Copy bytes [begin, end) of the current job, counting the bytes
+    ///     of the regions one after another
+    void copyPart(uint64_t begin, uint64_t end) const;
+    /// @brief The bytes of the current job part \c part consists of
+    void partBounds(uint32_t part, uint64_t &begin, uint64_t &end) const;
+    /// @brief Copy the part of the current job assigned to the helper, if any
+    void runHelperPart(Helper &helper);
+    /// @brief Whether a job was posted since the helper last looked
+    bool hasNewJob(Helper *helper) const;
+    /// @brief The predicate for the helpers sleeping on their conditional variable
+    bool noNewJob_locked(Helper *helper) const;
+    /// @brief The predicate for the worker sleeping on \c done_cond_var_
+    bool partsPending_locked() const;
+    bool allPartsDone() const;
+    static worker_return_type helperMainLoop(void *ptr);
+
+    std::vector<uint32_t> cpus_;
+    uint32_t max_threads_;
+    uint64_t nt_bytes_;
+    bool helpers_started_;
+    std::vector<std::unique_ptr<Helper> > helpers_;
+
+    // The current job, written by the worker before job_seq_ is bumped
+    TransferRegion const *regions_;
+    uint64_t num_regions_;
+    uint64_t total_bytes_;
+    uint32_t num_parts_;
+    bool non_temporal_;
+
+    /// @brief Bumped for each job and once more to stop the helpers
+    std::atomic<uint64_t> job_seq_;
+    std::atomic<bool> stopping_;
+    /// @brief How many of the helpers' parts of the current job are yet to be copied
+    std::atomic<uint32_t> parts_left_;
+    hStreams_Lock lock_;
+    hStreams_CondVar done_cond_var_;
+
+    // copy-ctor and assignment prohibited
+    hStreams_HostXferEngine(hStreams_HostXferEngine const &other);
+    hStreams_HostXferEngine &operator=(hStreams_HostXferEngine const &other);
+};
+
+#endif /* HSTREAMS_HOSTXFERENGINE_H */
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "hStreams_types.h"
+#include "hStreams_RCU.h"
 
 class hStreams_LogBuffer;
 class hStreams_LogDomain;
@@ -32,6 +33,65 @@ class hStreams_LogBufferCollection
     ///
     /// @todo Could hide it using PIMPL but is it worth the added effort?
     Container container_;
+
+    /// @brief An immutable, flat index of the buffers' address ranges
+    ///
+    /// The start and end addresses are kept in sorted arrays, split into blocks
+    /// of \c block_size entries. The first start address of each block is
+    /// copied into a small array of fences, which is searched first; then only
+    /// a single block needs to be scanned. The search thus touches a couple of
+    /// contiguous cache lines instead of walking a tree node by node.
+    class LookupTable
+    {
+    public:
+        LookupTable();
+        explicit LookupTable(Container const &buffers);
+
+        /// @brief The number of buffers whose start address is not above \c addr,
+        ///     i.e. 1 + the index of the buffer which may contain \c addr
+        uint64_t countStartsNotAbove(uint64_t addr) const;
+
+        uint64_t size() const
+        {
+            return buffers_.size();
+        }
+        uint64_t start(uint64_t idx) const
+        {
+            return starts_[idx];
+        }
+        /// @brief The first address past the \c idx-th buffer
+        uint64_t end(uint64_t idx) const
+        {
+            return ends_[idx];
+        }
+        hStreams_LogBuffer *buffer(uint64_t idx) const
+        {
+            return buffers_[idx];
+        }
+        /// @brief Unique among all the tables ever built, so that the lookup
+        ///     hints of one table are never used with another
+        uint64_t generation() const
+        {
+            return generation_;
+        }
+    private:
+        static const uint64_t block_size = 16;
+
+        std::vector<uint64_t> starts_;
+        std::vector<uint64_t> ends_;
+        std::vector<hStreams_LogBuffer *> buffers_;
+        /// @brief starts_[i * block_size] for every block i
+        std::vector<uint64_t> fences_;
+        uint64_t generation_;
+    };
+
+    /// @brief The index used for lookups
+    ///
+    /// Rebuilt and republished after every change of \c container_, so that
+    /// the lookups can be done from within an \c hStreams_RCU_Read_Scope. A
+    /// buffer removed from the store may be deleted as soon as
+    /// \c delFromCollection() returns.
+    hStreams_RCU_Published<LookupTable> published_;
 public:
     /// @brief An iterator over entries in the store
     ///
@@ -119,6 +179,9 @@ public:
     ///      - PARTIAL_OVERLAP if [start,start+len) partially overlaps some other buffer;
     ///        Additionally, NULL is returned as the logical buffer pointer
     /// @return A pointer to the logical buffer, NULL if not found
+    /// @note Each thread remembers the last buffer it has found. Looking up the
+    ///     same buffer again, as happens e.g. when enqueueing consecutive
+    ///     actions on a tile, then doesn't need a search.
     hStreams_LogBuffer *lookupLogBuffer(void *addr, uint64_t len, HSTR_OVERLAP_TYPE *overlap);
     /// @brief Go over all buffers, calling detachLogDomain method on each
     void processDelLogDomain(hStreams_LogDomain &);
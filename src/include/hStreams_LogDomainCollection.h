@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "hStreams_LogDomain.h"
+#include "hStreams_RCU.h"
 
 /// @brief A class which acts as a store for logical domain objects.
 class hStreams_LogDomainCollection
@@ -27,6 +28,12 @@ class hStreams_LogDomainCollection
     ///
     /// @todo Could hide it using PIMPL but is it worth the added effort?
     Container container_;
+    /// @brief The copy of the container used for lookups
+    ///
+    /// Republished after every change of \c container_, so that the lookups
+    /// can be done from within an \c hStreams_RCU_Read_Scope. A domain removed
+    /// from the store may be deleted as soon as \c delFromCollection() returns.
+    hStreams_RCU_Published<Container> published_;
 public:
     /// @brief An iterator over entries in the store
     ///
@@ -109,8 +116,8 @@ public:
 private:
     /// @brief Helper lookup function, used internally
     /// @return iterator to the position in the container if \c id is valid,
-    ///    \c container_.end() otherwise
-    Container::iterator getIteratorByID(HSTR_LOG_DOM id);
+    ///    \c container.end() otherwise
+    static Container::const_iterator getIteratorByID(Container const &container, HSTR_LOG_DOM id);
 
     // copy/assignment construction disallowed
     hStreams_LogDomainCollection &operator=(hStreams_LogDomainCollection const &other);
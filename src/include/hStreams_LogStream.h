@@ -20,6 +20,9 @@
 #include "hStreams_PhysStream.h"
 
 #include <vector>
+#include <atomic>
+
+class hStreams_Graph;
 
 /// @brief A class which represents an individual logical stream
 ///
@@ -45,6 +48,13 @@ class hStreams_LogStream
     /// @note This entry is superfluous and the usage of it could well be replaced
     ///     by calls to \c phys_stream_->getCPUMask()
     const hStreams_CPUMask cpu_mask_;
+    /// @brief Unique among all the logical streams ever created, unlike the ID
+    const uint64_t serial_;
+    /// @brief The graph the actions are being captured into, NULL if they're
+    ///     being enqueued
+    std::atomic<hStreams_Graph *> capture_;
+    /// @brief The priority the actions are enqueued with
+    std::atomic<HSTR_STREAM_PRIORITY> priority_;
 public:
     /// @param[in] id ID of the logical stream.
     /// @param[in] cpu_mask CPU mask this logical stream shall occupy
@@ -68,6 +78,23 @@ public:
     hStreams_PhysStream &getPhysStream();
     /// @brief Get all the events used thus fat in this stream.
     void getAllEvents(std::vector<HSTR_EVENT> &events);
+    /// @brief Get the serial number of the stream, which tells it apart from
+    ///     the streams which have had the same ID before or after it
+    uint64_t serial() const;
+    /// @brief Start capturing the actions into a graph
+    /// @return false if a capture is already in progress, in which case the
+    ///     stream doesn't take the ownership of the graph
+    bool beginCapture(hStreams_Graph *graph);
+    /// @brief Stop capturing the actions
+    /// @return The graph captured into, NULL if there was no capture in progress
+    hStreams_Graph *endCapture();
+    /// @brief Get the graph the actions are being captured into, NULL if none
+    hStreams_Graph *getCapture();
+    /// @brief Get the priority the actions are enqueued with
+    HSTR_STREAM_PRIORITY getPriority() const;
+    /// @brief Set the priority of the actions enqueued from now on
+    /// @note \c priority is not validated
+    void setPriority(HSTR_STREAM_PRIORITY priority);
 private:
     // assingment prohibited
     hStreams_LogStream &operator=(hStreams_LogStream const &other);
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "hStreams_LogStream.h"
+#include "hStreams_RCU.h"
 
 class hStreams_LogDomain;
 
@@ -29,6 +30,40 @@ class hStreams_LogStreamCollection
     ///
     /// @todo Could hide it using PIMPL but is it worth the added effort?
     Container container_;
+
+    /// @brief An immutable index of the streams, built from a copy of the container
+    ///
+    /// IDs up to a few times the number of streams are looked up directly in a
+    /// dense table, others in an open-addressing hash table with linear probing,
+    /// so that lookups take constant time however many streams there are and
+    /// whatever IDs the user picked.
+    class LookupTable
+    {
+    public:
+        LookupTable();
+        explicit LookupTable(Container const &streams);
+        hStreams_LogStream *lookup(HSTR_LOG_STR id) const;
+        /// @brief All the streams, in a compact array
+        Container const &streams() const
+        {
+            return streams_;
+        }
+    private:
+        Container streams_;
+        /// @brief Indexed by the stream ID, NULL for unused IDs
+        Container dense_;
+        /// @brief The streams whose IDs don't fit in \c dense_; the size is a
+        ///     power of two, at least twice the number of such streams
+        Container hashed_;
+        static uint64_t hashSlot(HSTR_LOG_STR id, uint64_t num_slots);
+    };
+
+    /// @brief The index used for lookups
+    ///
+    /// Rebuilt and republished after every change of \c container_, so that
+    /// the lookups can be done from within an \c hStreams_RCU_Read_Scope. A
+    /// stream removed from the store may be deleted as soon as the removal returns.
+    hStreams_RCU_Published<LookupTable> published_;
 public:
     hStreams_LogStreamCollection();
     ~hStreams_LogStreamCollection();
@@ -51,13 +86,15 @@ public:
     /// @brief Remove all logical streams from a logical domain from the store
     void delFromCollectionByLogDomain(hStreams_LogDomain &);
     /// @brief Obtain all events ever used in any of the streams
+    /// @note The events of each stream are a snapshot taken under that stream's
+    ///     lock, see \c hStreams_PhysStream::getAllEvents().
     /// @sa hStreams_ThreadSynchronize()
     void getEventsFromAllStreams(std::vector<HSTR_EVENT> &events);
 private:
     /// @brief Helper lookup function, used internally
     /// @return iterator to the position in the container if \c id is valid,
-    ///    \c container_.end() otherwise
-    Container::iterator getIteratorByID(HSTR_LOG_STR id);
+    ///    \c container.end() otherwise
+    static Container::const_iterator getIteratorByID(Container const &container, HSTR_LOG_STR id);
 
     // copy/assignment construction disallowed
     hStreams_LogStreamCollection &operator=(hStreams_LogStreamCollection const &other);
@@ -23,8 +23,12 @@
 #include "hStreams_internal.h"
 #include "hStreams_helpers_common.h"
 
+// Checking the level before constructing the Logger makes a disabled message
+// nearly free. Constructing the streams isn't: among others, it bumps the
+// reference count of the global locale, which all the threads share.
 #define HSTR_GET_LOGGER(log_level, info_type, exit_code) \
-    Logger(__FILE__, __LINE__, __FUNCTION__, exit_code).get(log_level, info_type)
+    if (!Logger::shouldLog(log_level, info_type) && !(exit_code)) {} else \
+        Logger(__FILE__, __LINE__, __FUNCTION__, exit_code).get(log_level, info_type)
 
 #define HSTR_DEBUG1(info_type) \
     HSTR_GET_LOGGER(HSTR_LOG_LEVEL_DEBUG1, info_type, 0)
@@ -155,10 +159,10 @@ public:
     ~Logger();
     /// @brief Obtain a stream to which you can push, incrementally creating the message
     std::ostream &get(HSTR_LOG_LEVEL log_level, HSTR_INFO_TYPE info_type);
+    /// @brief whether for a given log_level and info_type, the message should be logged
+    static bool shouldLog(HSTR_LOG_LEVEL log_level, HSTR_INFO_TYPE info_type);
 
 private:
-    /// @brief whether for a given log_level and info_type, the message should be logged
-    bool shouldLog(HSTR_LOG_LEVEL log_level, HSTR_INFO_TYPE info_type);
 
     /// @brief get string representation for a given info type
     const char *getInfoTypeName(HSTR_INFO_TYPE info_type);
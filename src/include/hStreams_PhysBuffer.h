@@ -15,11 +15,10 @@
 #ifndef HSTREAMS_PHYSBUFFER_H
 #define HSTREAMS_PHYSBUFFER_H
 
-#include <vector>
-
 #include "hStreams_RefCountDestroyed.h"
 #include "hStreams_types.h"
 #include "hStreams_locks.h"
+#include "hStreams_threading.h"
 #include "hStreams_COIWrapper.h"
 
 // forward declaration
@@ -30,29 +29,39 @@ class hStreams_PhysBuffer : public hStreams_RefCountDestroyed
 {
     /// @brief A mutex to synchronize internal operations
     hStreams_Lock lock_;
-    /// @brief A vector of actions in which this buffer is involved.
-    /// Destruction of the buffer will wait on the completion of these actions.
-    std::vector<HSTR_EVENT> pending_actions_;
-    /// @brief A number of addPendingAction() calls from last removeDoneActions() call.
-    uint64_t action_cleanup_counter_;
+    /// @brief The number of actions in which this buffer is involved
+    uint64_t submitted_seq_;
+    /// @brief The number of those actions which have completed
+    ///
+    /// Advanced by the notification of each action's completion, in
+    /// whichever order they complete. Destruction of the buffer will wait
+    /// until it catches up with \c submitted_seq_.
+    uint64_t retired_seq_;
+    /// @brief Signaled when \c retired_seq_ catches up with \c submitted_seq_
+    hStreams_CondVar retired_cond_;
     /// @brief A logical buffer with contain this physical buffer
     const hStreams_LogBuffer *log_buf_;
-    /// @brief A handle to the COI buffer
+    /// @brief A handle to the COI buffer, NULL for host buffers when running host-only
     const HSTR_COIBUFFER coi_buf_;
     /// @brief Sink-side buffers are a bit larger to ensure the same offset into the cache
     ///     line.
     const uint64_t padding_;
     /// @brief The sink-side address of the buffer's beginning
     const uint64_t sink_start_addr_;
-    /// @brief This class is used in removeCompletedActions() as condition to remove action
-    class isActionCompleted_functor_;
+    /// @brief Whether the buffer lives in the memory of this process
+    const bool in_host_memory_;
 public:
     /// @param[in] HSTR_COIBUFFER a handle to a pre-created COI buffer
     /// @param[in] sink_start_addr a pre-looked-up sink-side address of the buffer's beginning
     /// @param[in] padding The amount of superfluous memory at the beginning of the buffer;
     ///     usually, the offset of the host side buffer into the cache line
-    hStreams_PhysBuffer(const hStreams_LogBuffer &log_buf, HSTR_COIBUFFER coi_buf, uint64_t sink_start_addr, uint64_t padding);
-    hStreams_PhysBuffer(const hStreams_LogBuffer &log_buf, HSTR_COIBUFFER coi_buf, void *sink_start_addr, uint64_t padding);
+    /// @param[in] in_host_memory Whether \c sink_start_addr is an address in
+    ///     the memory of this process, i.e. the buffer belongs to the source
+    ///     physical domain
+    hStreams_PhysBuffer(const hStreams_LogBuffer &log_buf, HSTR_COIBUFFER coi_buf, uint64_t sink_start_addr, uint64_t padding,
+                        bool in_host_memory);
+    hStreams_PhysBuffer(const hStreams_LogBuffer &log_buf, HSTR_COIBUFFER coi_buf, void *sink_start_addr, uint64_t padding,
+                        bool in_host_memory);
     /// @note While this _could_ be provided in LogBuffer only, this allows Enqueue* functions to
     ///     not care whether the buffer is on source or sink, which will be relevant for
     ///     aliased buffers on the host
@@ -61,16 +70,35 @@ public:
     ///     beginning in the source proxy memory address space.
     uint64_t translateToSinkAddress(uint64_t host_offset) const;
     /// @brief Register an action that concerns this buffer
-    /// Already-completed events are removed after a certain number of calls.
+    /// The action is retired by the notification of its completion, see
+    /// \c hStreams_HostCallbacks::notifyOnCompletion().
     void addPendingAction(HSTR_EVENT action);
-    /// @brief Remove completed actions from set of actions which concerns this buffer.
-    void removeCompletedActions();
     /// @brief Get a reference to parent log buffer
     const hStreams_LogBuffer &getLogBuffer() const;
     /// @brief Get a copy of COI buffer handle
     HSTR_COIBUFFER getCOIhandle() const;
+    /// @brief Whether the memory can be accessed directly through the
+    ///     addresses from \c translateToSinkAddress(), regardless of the
+    ///     buffer being backed by a COI buffer
+    bool isInHostMemory() const;
+    /// @brief The NUMA node of the host memory the buffer was placed on, -1
+    ///     if it's not known or the buffer wasn't placed by hStreams
+    virtual int32_t getNumaNode() const;
 protected:
     virtual ~hStreams_PhysBuffer();
+    /// @brief Wait until all the actions submitted have been retired
+    ///
+    /// Called by the destructor. The derived classes which own the memory of
+    /// the buffer have to call it before they free the memory.
+    void waitForPendingActions();
+private:
+    /// @brief Whether any of the actions submitted hasn't been retired yet,
+    ///     \c lock_ must be held
+    bool hasPendingActions() const;
+    /// @brief Count one more action as completed
+    void retireAction();
+    /// @brief The notification of an action's completion, \c buf is the buffer
+    static void actionCompleted(void *buf);
 };
 
 bool operator==(hStreams_PhysBuffer const &pb1, hStreams_PhysBuffer const &pb2);
@@ -24,6 +24,8 @@ class hStreams_PhysBufferHost : public hStreams_PhysBuffer
 {
     /// @brief The automatically-deleted data we allocated for the host-side buffer
     std::unique_ptr<void, void(*)(void *)> data_ptr_;
+    /// @brief The NUMA node the data was placed on, -1 if unknown
+    const int32_t numa_node_;
 public:
     /// @brief The constructor which sets up the internals
     ///
@@ -38,8 +40,13 @@ public:
     ///     that one can achieve the proper alignment through allocting more
     ///     memory and calculating proper offset. We might want
     ///     to it that way eventually.
-    hStreams_PhysBufferHost(hStreams_LogBuffer const &log_buf, HSTR_COIBUFFER coi_buf, std::unique_ptr<void, void(*)(void *)> data_ptr, uint64_t padding);
+    ///
+    /// @param numa_node The NUMA node the memory was placed on during its
+    ///     allocation, -1 if unknown
+    hStreams_PhysBufferHost(hStreams_LogBuffer const &log_buf, HSTR_COIBUFFER coi_buf, std::unique_ptr<void, void(*)(void *)> data_ptr, uint64_t padding,
+                            int32_t numa_node);
     ~hStreams_PhysBufferHost();
+    int32_t getNumaNode() const;
 };
 
 #endif /* HSTREAMS_PHYSBUFFERHOST_H */
@@ -49,9 +49,17 @@ class hStreams_PhysDomain
     typedef std::map<std::string, uint64_t> SinkFuncAddressesContainer;
     /// @brief A cache of sink-side function addresses, to avoid constant lookups
     ///     which might be costly
+    ///
+    /// Functions which couldn't be found are cached too, with an address of 0.
+    /// The sink-side libraries are only loaded at initialization, so a
+    /// function which isn't there now won't show up later.
     SinkFuncAddressesContainer sink_functions_addresses_;
+    /// @brief Sink-side addresses of the functions, indexed by their handles
+    ///
+    /// 0 for handles not bound to this domain and for functions not present here.
+    std::vector<uint64_t> sink_addresses_by_handle_;
     /// @brief A read-write mutex to internally synchronize access to the sink-side
-    ///     functions cache
+    ///     functions cache and to the handles
     hStreams_RW_Lock sink_functions_addresses_lock_;
     /// @brief An incrementally maintained oversubscription array.
     ///
@@ -114,12 +122,25 @@ public:
     ///
     /// Implementation of this method _may_ check whether this cpu
     /// mask is valid with respect to the _physical_ domain.
-    hStreams_PhysStream *createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask);
+    ///
+    /// @param out_of_order Whether the stream was created with \c HSTR_STREAM_OUT_OF_ORDER
+    hStreams_PhysStream *createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask,
+            bool out_of_order);
 
     /// @brief Internally cached function address lookup functionality
     /// @param[in] func_name The name of the function to be looked up
     /// @return Sink-side address of the function, 0 if not found or an error occured
     uint64_t fetchSinkFunctionAddress(std::string const &func_name);
+    /// @brief Look up the address of a function by its handle
+    /// @return Sink-side address of the function, 0 if the handle hasn't been bound
+    ///     or the function is not present in this domain
+    /// @sa hStreams_PhysDomain::bindFunctionHandle()
+    /// @note This function is internally synchronized
+    uint64_t fetchSinkFunctionAddress(HSTR_FUNC_HANDLE func_handle);
+    /// @brief Make the function's sink-side address available through its handle
+    /// @sa hStreams_GetFunctionHandle()
+    /// @note This function is internally synchronized
+    void bindFunctionHandle(HSTR_FUNC_HANDLE func_handle, uint64_t sink_address);
 
     /// @brief Get a logical domain in this physical domain which would match the cpu mask.
     ///
@@ -160,13 +181,16 @@ private:
     hStreams_PhysDomain &operator=(const hStreams_PhysDomain &other);
     // virtual functions don't care about access modifiers
     virtual HSTR_COIPROCESS impl_getCOIProcess() const = 0;
-    virtual hStreams_PhysStream *impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask) = 0;
+    virtual hStreams_PhysStream *impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask,
+            bool out_of_order) = 0;
 
     /// @brief Look up the internal cache of function sink-side addresses
-    /// @return Function's sink-side address, 0 if the function is not present in the cache.
+    /// @param[out] sink_address Function's sink-side address, 0 if the function
+    ///     is known not to be present in the domain
+    /// @return Whether the function is present in the cache.
     /// @sa hStreams_PhysDomain::setSinkAddress()
     /// @note This function is internally synchronized
-    uint64_t getSinkAddress(std::string const &func_name);
+    bool getSinkAddress(std::string const &func_name, uint64_t *sink_address);
     /// @brief Set the function's sink-side address for the internal cache
     /// @sa hStreams_PhysDomain::getSinkAddress()
     /// @note This function is internally synchronized
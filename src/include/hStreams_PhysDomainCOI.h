@@ -43,6 +43,12 @@ class hStreams_PhysDomainCOI : public hStreams_PhysDomain
     /// is obtained through COIProcessGetFunctionHandles and passed as an argument to
     /// hstreams_PhysDomainCOI constructor.
     const HSTR_COIFUNCTION fetch_addr_func_;
+    /// @brief A pre-obtained handle to the sink-side no-op run by marker actions
+    ///
+    /// This handle has to be pre-created before the physical domain is instantiated. It
+    /// is obtained through COIProcessGetFunctionHandles and passed as an argument to
+    /// hstreams_PhysDomainCOI constructor.
+    const HSTR_COIFUNCTION marker_func_;
     /// @brief pre-created helper pipeline used for sink-side function address lookups
     ///
     /// This pipeline has to be pre-created before the physical domain is instantiated.
@@ -59,6 +65,8 @@ public:
     /// @param[in] thunk_func A pre-looked-up COI handle to the sink-side thunk instance
     /// @param[in] fetch_addr_func A pre-looked-up COI handle to the sink-side instance of
     ///     function which looks up other functions' addresses
+    /// @param[in] marker_func A pre-looked-up COI handle to the sink-side no-op
+    ///     run by marker actions
     /// @param[in] helper_pipeline A handle to a pre-created pipeline which will
     ///     be used for sink-side function address lookups
     ///
@@ -80,6 +88,7 @@ public:
         std::vector<HSTR_COILIBRARY> const &sink_libs,
         HSTR_COIFUNCTION thunk_func,
         HSTR_COIFUNCTION fetch_addr_func,
+        HSTR_COIFUNCTION marker_func,
         HSTR_COIPIPELINE helper_pipeline
     );
 
@@ -91,7 +100,8 @@ private:
     {
         return coi_process_;
     }
-    hStreams_PhysStream *impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask);
+    hStreams_PhysStream *impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask,
+            bool out_of_order);
     /// @brief Looks up a function's address on a COI-served physical domain
     uint64_t impl_fetchSinkFunctionAddress(std::string const &func_name);
 };
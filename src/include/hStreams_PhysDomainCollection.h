@@ -46,6 +46,9 @@ public:
     /// @brief Lookup a physical domain by its id.
     /// @return A pointer to the physical domain, NULL if not found.
     hStreams_PhysDomain *lookupByPhysDomainID(HSTR_PHYS_DOM id);
+    /// @brief Write out all the physical domains in the store
+    /// @param[out] phys_doms The vector to write the domains to. It is cleared first.
+    void getAllPhysDomains(std::vector<hStreams_PhysDomain *> &phys_doms) const;
     /// @brief Check whether all the physical domains in the store have the same traits.
     ///
     /// The traits which are considered for homo/heter-geneity are:
@@ -45,7 +45,8 @@ private:
     HSTR_COIPROCESS impl_getCOIProcess() const;
     /// @brief Spawn a new physical stream.
     /// @return NULL for now as host-side streams are not implemented yet.
-    hStreams_PhysStream *impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask);
+    hStreams_PhysStream *impl_createNewPhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask,
+            bool out_of_order);
     /// @brief Looks up a function's address on the host
     uint64_t impl_fetchSinkFunctionAddress(std::string const &func_name);
 };
@@ -17,45 +17,68 @@
 
 #include <vector>
 #include <map>
+#include <string>
 
 #include "hStreams_RefCountDestroyed.h"
 #include "hStreams_PhysBuffer.h"
+#include "hStreams_XferShape.h"
 #include "hStreams_types.h"
 #include "hStreams_internal.h"
 #include "hStreams_helpers_source.h"
 
 class hStreams_LogDomain;
+struct hStreams_GraphNode;
 
 /// @brief Abstraction of a FIFO queue. Implementations - COIPipeline and CrossCommPipeline
+///
+/// A stream created with \c HSTR_STREAM_OUT_OF_ORDER doesn't chain the
+/// computes together, so they only wait for what they depend on through the
+/// buffers; an implementation may then execute them in any order satisfying
+/// their input dependencies.
+///
+/// Each action is enqueued with the priority of the logical stream it comes
+/// from. The computes of an in-order stream are chained separately for each
+/// of the priorities, so that e.g. a latency-sensitive compute of a logical
+/// stream doesn't wait for the background ones enqueued before it through
+/// another logical stream mapped onto the same physical stream, unless they
+/// access the same buffers. An implementation may then execute the actions
+/// of a higher priority ahead of the lower-priority ones.
 /// @note This is an abstract class (note the pure virtual methods). Hence, it is never
 ///     instantiated directly. Rather, the classes which inherit from this one may be
 ///     instantiated. This class however serves as the common interface to physical streams.
-/// @todo This class needs a "insert an event wait in the stream" public method, to allow
-///     putting the implementation of \c hStreams_EventStreamWait() inside this
-///     class, making it internally synchronized and thus allowing for more
-///     concurrency in the use of the API.
-/// @todo This class needs a "wait for whatever is enqueued" public method, to allow
-///     putting the implementation of \c hStreams_StreamSynchronize() inside this class,
-///     making it internally synchronized and thus allowing for more concurrency in the
-///     use of the API. One should also create a \c friend-ed path through the
-///     \c hStreams_LogStream class for \c hStreams_LogStreamCollection to
-///     query all the input dependences to be able to expose a "synchronize all
-///     streams" public method which would allow for more encapsulation in
-///     the \c hStreams_PhysStream interface.
+/// @todo One should create a \c friend-ed path through the \c hStreams_LogStream
+///     class for \c hStreams_LogStreamCollection to query all the input
+///     dependences, so that \c getInputDeps() and \c setOutputDeps() needn't be
+///     public, which would allow for more encapsulation in the
+///     \c hStreams_PhysStream interface.
 class hStreams_PhysStream : public hStreams_RefCountDestroyed
 {
     /// \brief The cpu mask assigned to this physical stream.
     const hStreams_CPUMask cpu_mask_;
 public:
-    hStreams_PhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask);
+    /// @param out_of_order Whether the stream was created with \c HSTR_STREAM_OUT_OF_ORDER
+    hStreams_PhysStream(hStreams_LogDomain &log_dom, hStreams_CPUMask const &cpu_mask,
+                        bool out_of_order);
     ~hStreams_PhysStream();
 
     /// @brief Main entry point for enqueueing "compute" actions in a stream
     /// @note buffer offsets are the offsets the user specified
     ///     (i.e. in_pArgs[i] - buffer_start_on_host. They need not include
     ///     eventual buffer padding for the sinks.
-    /// @note \c scalar_args, \c buffer_args, \c buffer_offsets, \c ret_val and
-    ///     \c ret_val_size are not validated in any way -- are presumed to be valid.
+    /// @note \c scalar_args, \c buffer_args, \c buffer_offsets, \c buffer_access,
+    ///     \c buffer_lengths, \c ret_val and \c ret_val_size are not validated in
+    ///     any way -- are presumed to be valid. \c buffer_access may be NULL, in
+    ///     which case each of the buffers is taken as both read and written.
+    ///     \c buffer_lengths, the number of bytes accessed from each of the
+    ///     offsets, may be NULL, in which case the whole buffers are taken as
+    ///     accessed.
+    ///     The argument arrays are only read during the call, so they may well live
+    ///     on the caller's stack.
+    /// @note \c priority is the priority of the logical stream the compute is
+    ///     enqueued in. It is not validated.
+    /// @note In the steady state, enqueueing doesn't allocate any memory: the
+    ///     function name and the marshalled arguments are put in scratch space
+    ///     kept by the stream between the calls.
     /// @note \c func_name is looked up in the physical domain's cache. If it's not found,
     ///     a sink-side lookup using \c hStreams_PhysStream::impl_fetchSinkFunctionAddress()
     ///     is performed and then the physical domain's cache is augmented. These two
@@ -69,21 +92,175 @@ public:
     ///     \c hStreams_PhysDomain::getSinkAddress() and
     ///     \c hStreams_PhysDomain::setSinkAddress() implementations.
     HSTR_RESULT enqueueFunction(
-        std::string func_name,
-        std::vector<uint64_t> &scalar_args,
-        std::vector<hStreams_PhysBuffer *> &buffer_args,
-        std::vector<uint64_t> &buffer_offsets,
-        void *ret_val, uint16_t ret_val_size, HSTR_EVENT *ret_event
+        const char *func_name,
+        uint64_t const *scalar_args, uint32_t num_scalar_args,
+        hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+        HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+        uint32_t num_buffer_args,
+        void *ret_val, uint16_t ret_val_size, HSTR_STREAM_PRIORITY priority,
+        HSTR_EVENT *ret_event
+    );
+
+    /// @brief As \c hStreams_PhysStream::enqueueFunction(), but with the function
+    ///     identified by a handle from \c hStreams_GetFunctionHandle()
+    /// @note The handle is resolved through a small per-stream cache, filled from
+    ///     the physical domain on first use, so that no lookup by name and no shared
+    ///     lock is involved in the steady state.
+    HSTR_RESULT enqueueFunctionByHandle(
+        HSTR_FUNC_HANDLE func_handle,
+        uint64_t const *scalar_args, uint32_t num_scalar_args,
+        hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+        HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+        uint32_t num_buffer_args,
+        void *ret_val, uint16_t ret_val_size, HSTR_STREAM_PRIORITY priority,
+        HSTR_EVENT *ret_event
     );
 
     /// @note Source and destination offsets are as requested from the API, not
-    ///     including eventual buffer padding.
+    ///     including eventual buffer padding. They are those of the first row
+    ///     of \c shape.
+    ///
+    /// However many rows there are, the transfer is a single action with a
+    /// single completion event, which depends on and is a dependency for the
+    /// whole ranges spanned by the rows on each side.
     HSTR_RESULT enqueueTransfer(
         hStreams_PhysBuffer &dst_buf,
         hStreams_PhysBuffer &src_buf,
         uint64_t dst_offset,
         uint64_t src_offset,
-        uint64_t length,
+        hStreams_XferShape const &shape,
+        HSTR_STREAM_PRIORITY priority,
+        HSTR_EVENT *ret_event
+    );
+
+    /// @brief Main entry point for \c hStreams_EnqueueDataList(): enqueue the
+    ///     transfers of unrelated regions as a single action
+    ///
+    /// The dependencies of all the regions are looked up, and the action
+    /// recorded as a dependency of the later ones, taking the stream's lock
+    /// once. There is a single completion event. The regions may be moved in
+    /// any order, or concurrently, so a region shouldn't read what another
+    /// one writes.
+    /// @note \c regions is not validated. As in \c enqueueTransfer(), the
+    ///     regions onto themselves within an aliased buffer are left out.
+    HSTR_RESULT enqueueTransferList(
+        std::vector<hStreams_PhysXferRegion> const &regions,
+        HSTR_STREAM_PRIORITY priority,
+        HSTR_EVENT *ret_event
+    );
+
+    /// @brief Enqueue an action which only completes once all of \c input_deps have
+    ///     completed, without touching any data
+    /// @param[in] input_deps The events to wait for
+    /// @param[out] completion The event signaled once the marker is reached
+    ///
+    /// @note The caller is responsible for gathering the input dependencies and
+    ///     setting the output dependencies, e.g. through
+    ///     \c hStreams_PhysStream::getInputDeps() and
+    ///     \c hStreams_PhysStream::setOutputDeps().
+    HSTR_RESULT enqueueMarker(
+        std::vector<HSTR_EVENT> &input_deps,
+        HSTR_STREAM_PRIORITY priority,
+        HSTR_EVENT *completion
+    );
+
+    /// @brief Main entry point for \c hStreams_StreamSetPriority(): have the
+    ///     computes of priority \c to wait for the last one of priority \c from
+    /// @param[in] from The priority the logical stream had so far
+    /// @param[in] to The priority of the computes the logical stream enqueues from now on
+    ///
+    /// The computes of an in-order stream are chained separately for each of
+    /// the priorities. Without this, the ones a logical stream enqueues after
+    /// changing its priority could overtake those it has enqueued before. A
+    /// marker waiting for the last computes of both priorities becomes the
+    /// last action of \c to. Nothing is enqueued if the computes aren't chained
+    /// by priority, or if either of the last computes is known to have completed.
+    /// @note The marker waits for the last compute of \c from of all the
+    ///     logical streams mapped onto the stream, not only the one changing
+    ///     its priority.
+    HSTR_RESULT enqueuePriorityChange(
+        HSTR_STREAM_PRIORITY from,
+        HSTR_STREAM_PRIORITY to
+    );
+
+    /// @brief Main entry point for \c hStreams_EventStreamWait(): enqueue a marker
+    ///     waiting for \c events and for the stream's own actions
+    /// @param[in] input_dep_type Which of the stream's actions to wait for, as in
+    ///     \c hStreams_PhysStream::getInputDeps()
+    /// @param[in] input_bufs The buffers to wait for, if \c input_dep_type is \c IS_XFER
+    /// @param[in] events Additional events to wait for
+    /// @param[in] num_events The number of \c events
+    /// @param[in] output_dep_type As in \c hStreams_PhysStream::setOutputDeps(),
+    ///     \c NONE for the marker not to become a dependency of later actions
+    /// @param[in] output_bufs The buffers whose later actions are to wait for the marker
+    /// @param[in] priority The priority of the logical stream enqueueing the marker
+    /// @param[out] completion The event signaled once the marker is reached
+    ///
+    /// Looking up the dependencies, enqueueing the marker and recording it as a
+    /// dependency happen atomically with respect to the other enqueues to the stream.
+    HSTR_RESULT enqueueEventWait(
+        DEP_TYPE input_dep_type,
+        std::vector<hStreams_PhysBuffer *> &input_bufs,
+        HSTR_EVENT const *events,
+        uint32_t num_events,
+        DEP_TYPE output_dep_type,
+        std::vector<hStreams_PhysBuffer *> &output_bufs,
+        HSTR_STREAM_PRIORITY priority,
+        HSTR_EVENT *completion
+    );
+
+    /// @brief Main entry point for \c hStreams_EnqueueHostCallback(): have
+    ///     \c callback run on the host once all of the stream's actions have
+    ///     completed, and the stream's later actions wait for it
+    /// @param[in] bufs All the buffers instantiated in the stream's logical domain,
+    ///     as for a barrier
+    /// @param[in] log_stream_id Passed to \c callback, along with \c user_data
+    /// @param[in] priority The priority of the logical stream enqueueing the callback
+    /// @param[out] completion The event signaled once \c callback has returned
+    ///
+    /// Unless all of the actions are a single event already, they are waited
+    /// for by a marker. The callback itself is run by \c hStreams_HostCallbacks,
+    /// its completion is a host event which takes the place of a barrier in the
+    /// stream.
+    HSTR_RESULT enqueueHostCallback(
+        std::vector<hStreams_PhysBuffer *> &bufs,
+        HSTR_HOST_CALLBACK callback,
+        HSTR_LOG_STR log_stream_id,
+        void *user_data,
+        HSTR_STREAM_PRIORITY priority,
+        HSTR_EVENT *completion
+    );
+
+    /// @brief Resolve the function of a compute action and marshal its
+    ///     arguments, as \c hStreams_PhysStream::enqueueFunction() does, but
+    ///     without enqueueing anything
+    /// @param[out] marshalled_args The arguments in the form taken by
+    ///     \c hStreams_PhysStream::impl_enqueueFunction()
+    ///
+    /// The function is identified by \c func_name if it's not NULL, by
+    /// \c func_handle otherwise.
+    HSTR_RESULT marshalFunction(
+        const char *func_name, HSTR_FUNC_HANDLE func_handle,
+        uint64_t const *scalar_args, uint32_t num_scalar_args,
+        hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+        uint32_t num_buffer_args,
+        std::vector<uint64_t> &marshalled_args
+    );
+
+    /// @brief Enqueue the actions of a captured graph, in the order of capture
+    /// @param[in] nodes The actions, as recorded by \c hStreams_Graph
+    /// @param[in] priority The priority of the logical stream the graph is launched in
+    /// @param[out] ret_event If not NULL, the event of a marker waiting for
+    ///     all of the actions
+    ///
+    /// The actions are enqueued atomically with respect to the other enqueues
+    /// to the stream, taking the stream's lock once. Their dependencies are
+    /// looked up as for the actions enqueued one by one, as they depend on
+    /// whatever has been enqueued before the launch.
+    /// @note Upon an error, the actions preceding the failed one stay enqueued.
+    HSTR_RESULT enqueueGraph(
+        std::vector<hStreams_GraphNode> &nodes,
+        HSTR_STREAM_PRIORITY priority,
         HSTR_EVENT *ret_event
     );
 
@@ -91,10 +268,15 @@ public:
     /// @param[out] the vector to write the events to. It is cleared by the implementation.
     ///
     /// Pretty much equivalent to \c hStreams_PhysStream::getInputDeps() with a
-    /// \c IS_BARRIER.
+    /// \c IS_BARRIER, but synchronized with the enqueues to the stream. Waiting
+    /// for the returned events is waiting for whatever has been enqueued so far,
+    /// and may be done without holding any locks.
     void getAllEvents(std::vector<HSTR_EVENT> &events);
 
     /// @brief Get the events that refer to the latest actions for given buffers
+    ///
+    /// A compute waits for the last compute of the priority of the action
+    /// being enqueued, see \c hStreams_PhysStream::enqueuePriority().
     /// @param[in] dep_type The type of dependency (transfer/compute/barrier)
     /// @param[in] buffers  A vector of buffers for which to look up the events
     /// @param[out] deps    The vector of events pertaining to the specified buffers
@@ -102,6 +284,26 @@ public:
         DEP_TYPE dep_type,
         std::vector<hStreams_PhysBuffer *> &buffers,
         std::vector<HSTR_EVENT> &deps);
+    /// @brief An overload of the above taking an array of \c num_buffers buffers
+    ///     and the ways the action accesses them
+    /// @param[in] access   The access mode of each of the buffers, NULL if all of
+    ///     them are both read and written. Only taken into account with
+    ///     \c HSTR_DEP_POLICY_ACCESS_MODES.
+    /// @param[in] offsets  The offset of the part of each of the buffers accessed
+    /// @param[in] lengths  The length of the part of each of the buffers accessed,
+    ///     NULL if the whole buffers are accessed, in which case \c offsets is
+    ///     ignored
+    ///
+    /// Only the earlier actions accessing an overlapping part of a buffer are
+    /// waited for.
+    void getInputDeps(
+        DEP_TYPE dep_type,
+        hStreams_PhysBuffer *const *buffers,
+        HSTR_ACCESS_MODE const *access,
+        uint64_t const *offsets,
+        uint64_t const *lengths,
+        uint32_t num_buffers,
+        std::vector<HSTR_EVENT> &deps);
 
     /// @brief Create an input dependency for future actions
     /// @param[in] dep_type The type of dependency (transfer/compute/barrier)
@@ -123,23 +325,235 @@ public:
         DEP_TYPE dep_type,
         std::vector<hStreams_PhysBuffer *> &buffers,
         HSTR_EVENT completion);
+    /// @brief An overload of the above taking an array of \c num_buffers buffers
+    ///     and the ways the action accesses them
+    /// @param[in] access   The access mode of each of the buffers, NULL if all of
+    ///     them are both read and written. With \c HSTR_DEP_POLICY_BUFFERS,
+    ///     only the buffers read by a transfer are told apart: they don't
+    ///     become dependencies of the later actions.
+    /// @param[in] offsets  As in \c hStreams_PhysStream::getInputDeps()
+    /// @param[in] lengths  As in \c hStreams_PhysStream::getInputDeps()
+    void setOutputDeps(
+        DEP_TYPE dep_type,
+        hStreams_PhysBuffer *const *buffers,
+        HSTR_ACCESS_MODE const *access,
+        uint64_t const *offsets,
+        uint64_t const *lengths,
+        uint32_t num_buffers,
+        HSTR_EVENT completion);
 
     /// @brief Retrieve a copy of the CPU mask the stream has been created with.
     hStreams_CPUMask getCPUMask() const;
 
+    /// @brief Whether the stream has been created with \c HSTR_STREAM_OUT_OF_ORDER
+    bool isOutOfOrder() const;
+
+    /// @brief How many dependencies the actions of the stream have been
+    ///     submitted with, and how many were pruned before the submission
+    /// @sa hStreams_HostEvent::prune()
+    void getDepStats(uint64_t &out_num_submitted, uint64_t &out_num_pruned);
+
 protected:
     /// @brief We save a "link" to the logical domain this stream is contained in.
     hStreams_LogDomain *log_dom_;
 
+    /// @brief The priority of the action being enqueued, for the implementations
+    ///     of the \c impl_enqueue*() methods to pass on
+    HSTR_STREAM_PRIORITY enqueuePriority() const;
+
+    /// @brief Interface for the implementation of "enqueue a transfer" functionality
+    ///
+    /// All of \c regions are moved by a single action, with a single completion.
+    /// The default implementation uses \c COIBufferCopy, once per row unless
+    ///     the rows of a region are contiguous, and a marker waiting for the
+    ///     copies unless there's a single one.
+    /// @note Source and destination offsets do not include the buffers' padding.
+    virtual HSTR_RESULT impl_enqueueTransfer(
+        std::vector<hStreams_PhysXferRegion> const &regions,
+        std::vector<HSTR_EVENT> &input_deps,
+        HSTR_EVENT *completion
+    );
+
+    /// @brief Interface for the implementation of "enqueue a marker" functionality
+    ///
+    /// A marker moves no data, its completion event only gets signaled once
+    /// all of its input dependencies have been met. Each type of physical
+    /// stream provides its own, cheapest way of doing that.
+    virtual HSTR_RESULT impl_enqueueMarker(
+        std::vector<HSTR_EVENT> &input_deps,
+        HSTR_EVENT *completion
+    ) = 0;
+
 private:
     /// @brief A mutex for synchronizing enqueues and waits
     hStreams_Lock lock_;
 
+    /// @brief The actions of a buffer which later actions may have to wait for,
+    ///     tracked per byte range, so that e.g. the actions on different tiles
+    ///     of a matrix don't wait for each other
+    ///
+    /// The ranges are kept in vectors rather than in a tree, so that recording
+    /// an action doesn't allocate memory once the vectors have grown enough.
+    class BufferDeps
+    {
+    public:
+        BufferDeps();
+        /// @brief Append the events of the actions an action accessing
+        ///     [\c begin, \c end) has to wait for: the last writers of the range
+        ///     and, if \c write, the readers since then
+        void getDeps(uint64_t begin, uint64_t end, bool write, std::vector<HSTR_EVENT> &deps) const;
+        /// @brief Append the events of all the actions recorded
+        void getAllDeps(std::vector<HSTR_EVENT> &deps) const;
+        /// @brief Record an action writing [\c begin, \c end), superseding the
+        ///     actions recorded for the range so far
+        void addWriter(uint64_t begin, uint64_t end, HSTR_EVENT event);
+        /// @brief Record an action reading [\c begin, \c end). Only done with
+        ///     \c HSTR_DEP_POLICY_ACCESS_MODES.
+        ///
+        /// The completed readers are dropped now and then, so that a buffer
+        /// which is only ever read doesn't accumulate them.
+        void addReader(uint64_t begin, uint64_t end, HSTR_EVENT event);
+        /// @brief The number of readers recorded
+        uint64_t numReaders() const;
+        /// @brief Append the events of the readers recorded
+        void getReaderDeps(std::vector<HSTR_EVENT> &deps) const;
+        /// @brief Replace the readers with a single one, spanning all of
+        ///     them, whose event \c stand_in completes after all of theirs
+        void foldReaders(HSTR_EVENT stand_in);
+    private:
+        /// @brief Drop the readers which are known to have completed
+        void dropCompletedReaders();
+
+        struct Range {
+            uint64_t begin;
+            uint64_t end;
+            HSTR_EVENT event;
+        };
+        /// @brief The last writer of each part of the buffer, sorted by the
+        ///     start of the range, not overlapping each other
+        std::vector<Range> writers_;
+        /// @brief The readers since the last writers, possibly overlapping
+        ///     each other, in no particular order
+        std::vector<Range> readers_;
+        /// @brief The size of \c readers_ at which the completed ones are dropped
+        uint64_t readersCleanupSize_;
+        /// @brief Scratch space of \c dropCompletedReaders()
+        std::vector<HSTR_EVENT> poll_events_scratch_;
+        std::vector<uint32_t> completed_readers_scratch_;
+    };
     /// @brief Dependence tracking meat
-    std::map<hStreams_PhysBuffer *, HSTR_EVENT> pendingBufUpdates_;
-    /// @brief Dependence tracking meat
-    HSTR_EVENT lastAction_;
+    std::map<hStreams_PhysBuffer *, BufferDeps> pendingBufUpdates_;
+    /// @brief Dependence tracking meat, the last action of each of the priorities
+    ///
+    /// In an out-of-order stream, only the barriers are recorded here. The
+    /// barriers, and all the actions with \c HSTR_DEP_POLICY_CONSERVATIVE, are
+    /// recorded for all the priorities.
+    HSTR_EVENT lastAction_[HSTR_STREAM_PRIORITY_SIZE];
+    /// @brief The last barrier, for the computes not chained through \c lastAction_
+    HSTR_EVENT lastBarrier_;
+    /// @brief Whether the computes are chained through \c lastAction_
+    const bool out_of_order_;
+    /// @brief The computes of an out-of-order stream which don't access any
+    ///     buffer, so that the next barrier can wait for them
+    std::vector<HSTR_EVENT> unorderedActions_;
+    /// @brief The size of \c unorderedActions_ at which the completed ones are dropped
+    uint64_t unorderedActionsCleanupSize_;
+    /// @brief Scratch space of \c addUnorderedAction()
+    std::vector<uint32_t> completed_actions_scratch_;
+    /// @brief Scratch space of \c addUnorderedAction() and \c foldReaders(),
+    ///     the dependencies of the marker standing in for the actions folded
+    std::vector<HSTR_EVENT> fold_deps_scratch_;
+    /// @brief The priority of the action being enqueued, guarded by lock_
+    HSTR_STREAM_PRIORITY enqueue_priority_;
+
+    /// @brief Append the last actions of all the priorities, leaving out the
+    ///     duplicates and the ones superseded by another
+    void getLastActions(std::vector<HSTR_EVENT> &deps) const;
+
+    /// @brief Record an action of an out-of-order stream for the next barrier
+    ///     to wait for, dropping the already completed ones now and then and
+    ///     folding the rest into a marker if there are still too many
+    void addUnorderedAction(HSTR_EVENT completion);
+
+    /// @brief Fold the readers of a buffer into a marker, so that they don't
+    ///     pile up while a buffer is only read. The range of the marker spans
+    ///     all of them, gaps included, so a later writer may wait a bit more.
+    void foldReaders(BufferDeps &buf_deps);
+
+    /// @brief Drop the duplicate and the completed events from the
+    ///     dependencies of an action about to be submitted, counting both.
+    ///     \c lock_ must be held.
+    void pruneInputDeps(std::vector<HSTR_EVENT> &deps);
+    /// @brief Dependencies submitted, guarded by lock_
+    uint64_t num_deps_submitted_;
+    /// @brief Dependencies pruned before the submission, guarded by lock_
+    uint64_t num_deps_pruned_;
+
+    // Scratch space of the enqueues, guarded by lock_. Kept between the
+    // calls so that the memory is only allocated by the first few enqueues.
+    std::string func_name_scratch_;
+    std::vector<uint64_t> marshalled_args_scratch_;
+    std::vector<HSTR_EVENT> input_deps_scratch_;
+    std::vector<hStreams_PhysXferRegion> regions_scratch_;
+    std::vector<hStreams_PhysXferRegion> moved_regions_scratch_;
+    std::vector<hStreams_PhysBuffer *> dep_bufs_scratch_;
+    std::vector<HSTR_ACCESS_MODE> dep_access_scratch_;
+    std::vector<uint64_t> dep_offsets_scratch_;
+    std::vector<uint64_t> dep_lengths_scratch_;
+    /// @brief Sink-side addresses of the functions enqueued by handle, indexed
+    ///     by the handle, 0 if not looked up yet. Guarded by lock_.
+    std::vector<uint64_t> sink_addresses_by_handle_;
+
+    /// @brief Common part of \c enqueueFunction() and \c enqueueFunctionByHandle()
+    ///
+    /// The function is identified by \c func_name if it's not NULL, by
+    /// \c func_handle otherwise.
+    HSTR_RESULT enqueueFunctionImpl(
+        const char *func_name, HSTR_FUNC_HANDLE func_handle,
+        uint64_t const *scalar_args, uint32_t num_scalar_args,
+        hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+        HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+        uint32_t num_buffer_args,
+        void *ret_val, uint16_t ret_val_size, HSTR_STREAM_PRIORITY priority,
+        HSTR_EVENT *ret_event
+    );
+
+    // The parts of the enqueues done under lock_, which the caller must hold.
+    // The buffers are left for the caller to notify of the new action, once
+    // the lock has been released.
 
+    /// @brief \c hStreams_PhysStream::marshalFunction() with \c lock_ held
+    HSTR_RESULT marshalFunctionLocked(
+        const char *func_name, HSTR_FUNC_HANDLE func_handle,
+        uint64_t const *scalar_args, uint32_t num_scalar_args,
+        hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+        uint32_t num_buffer_args,
+        std::vector<uint64_t> &marshalled_args
+    );
+    /// @brief Enqueue a compute action with the arguments already marshalled
+    HSTR_RESULT enqueueComputeLocked(
+        std::vector<uint64_t> &marshalled_args,
+        hStreams_PhysBuffer *const *buffer_args, uint64_t const *buffer_offsets,
+        HSTR_ACCESS_MODE const *buffer_access, uint64_t const *buffer_lengths,
+        uint32_t num_buffer_args,
+        void *ret_val, uint16_t ret_val_size, HSTR_EVENT &completion
+    );
+    /// @brief Enqueue a transfer, of the regions which aren't onto themselves
+    ///     within an aliased buffer. Only the dependencies of the others are
+    ///     enforced, by a marker if no region is left.
+    HSTR_RESULT enqueueTransferLocked(
+        std::vector<hStreams_PhysXferRegion> const &regions,
+        HSTR_EVENT &completion
+    );
+    HSTR_RESULT enqueueEventWaitLocked(
+        DEP_TYPE input_dep_type,
+        std::vector<hStreams_PhysBuffer *> &input_bufs,
+        HSTR_EVENT const *events,
+        uint32_t num_events,
+        DEP_TYPE output_dep_type,
+        std::vector<hStreams_PhysBuffer *> &output_bufs,
+        HSTR_EVENT &completion
+    );
 
     /// @brief Interface for the implementation of "enqueue a compute action" functionality
     ///
@@ -27,20 +27,24 @@ class hStreams_LogDomain;
 class hStreams_PhysStreamCOI : public hStreams_PhysStream
 {
     const HSTR_COIFUNCTION thunk_func_;
+    const HSTR_COIFUNCTION marker_func_;
     const HSTR_COIPIPELINE coi_pipeline_;
 public:
     /// @param log_dom  The logical domain this physical stream is created in
     /// @param cpu_mask The CPU mask of the stream
     /// @param coi_pipeline The pre-created COI pipeline in which to run actions
     /// @param thunk_func   A COI handle to the sink-side thunk function
+    /// @param marker_func  A COI handle to the sink-side no-op run by marker actions
     /// @param fetch_addr_func     A COI handle to the sink-side function which
     ///             performs a lookup (dlsym-like) of a function address by the
     ///             function's name
     hStreams_PhysStreamCOI(
         hStreams_LogDomain &log_dom,
         hStreams_CPUMask const &cpu_mask,
+        bool out_of_order,
         HSTR_COIPIPELINE coi_pipeline,
-        HSTR_COIFUNCTION thunk_func
+        HSTR_COIFUNCTION thunk_func,
+        HSTR_COIFUNCTION marker_func
     );
     /// @note The destructor calls COIPipelineDestroy on the pipeline the stream has
     ///         been created with.
@@ -53,6 +57,12 @@ private:
         std::vector<HSTR_EVENT> &input_deps,
         void *ret_val, uint16_t ret_val_size, HSTR_EVENT *ret_event
     );
+    /// @brief Implementation of the enqueue a "marker" action, runs the no-op
+    ///         sink-side function in the stream's pipeline
+    HSTR_RESULT impl_enqueueMarker(
+        std::vector<HSTR_EVENT> &input_deps,
+        HSTR_EVENT *completion
+    );
 };
 
 #endif /* HSTREAMS_PHYSSTREAMCOI_H */
@@ -21,6 +21,7 @@
 
 #include "hStreams_PhysStream.h"
 #include "hStreams_HostSideSinkWorker.h"
+#include "hStreams_HostEvent.h"
 #include "hStreams_COIWrapper.h"
 
 class hStreams_LogDomain;
@@ -28,23 +29,42 @@ class hStreams_LogDomain;
 /// @brief A custom implementation of physical stream on the host
 ///
 /// COI's POR does not include creating pipelines on the host/source
-/// so we had to roll our own.
+/// so we had to roll our own. All the actions enqueued in a host stream
+/// complete with host events (see \c hStreams_HostEvent).
 class hStreams_PhysStreamHost : public hStreams_PhysStream
 {
 public:
+    /// @param out_of_order Whether the worker may execute any of the actions
+    ///     whose input dependencies have completed, rather than the oldest one
     hStreams_PhysStreamHost(
         hStreams_LogDomain &log_dom,
-        hStreams_CPUMask const &cpu_mask
+        hStreams_CPUMask const &cpu_mask,
+        bool out_of_order
     );
     ~hStreams_PhysStreamHost();
 private:
     std::unique_ptr<hStreams_HostSideSinkWorker> hostSinkWorker_;
+    // Scratch space of impl_enqueueTransfer(), guarded by the stream's lock
+    std::vector<TransferRegion> host_regions_scratch_;
+    std::vector<hStreams_PhysXferRegion> coi_regions_scratch_;
 
     HSTR_RESULT impl_enqueueFunction(
         std::vector<uint64_t> &args,
         std::vector<HSTR_EVENT> &input_deps,
         void *ret_val, uint16_t ret_val_size, HSTR_EVENT *ret_event
     );
+    /// @brief Copies between buffers which both live in host memory are
+    ///     performed by the worker's \c hStreams_HostXferEngine, all the
+    ///     regions in a single action; the other ones are delegated to COI.
+    HSTR_RESULT impl_enqueueTransfer(
+        std::vector<hStreams_PhysXferRegion> const &regions,
+        std::vector<HSTR_EVENT> &input_deps,
+        HSTR_EVENT *completion
+    );
+    HSTR_RESULT impl_enqueueMarker(
+        std::vector<HSTR_EVENT> &input_deps,
+        HSTR_EVENT *completion
+    );
     uint64_t impl_fetchSinkFunctionAddress(std::string const &func_name);
 };
 
@@ -0,0 +1,140 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#ifndef HSTREAMS_RCU_H
+#define HSTREAMS_RCU_H
+
+#include <atomic>
+
+#include "hStreams_types.h"
+
+/// @brief Read-copy-update synchronization of the logical stream, domain and
+///     buffer tables
+///
+/// Enqueueing threads only read the tables. Instead of taking the global
+/// read-write locks, which makes all of them write to the same cache line,
+/// they enter a read-side critical section with \c hStreams_RCU_Read_Scope.
+/// Entering one only writes to a counter owned by the calling thread.
+///
+/// A writer publishes a new version of a table (see \c hStreams_RCU_Published)
+/// and then calls \c hStreams_RCU::synchronize(). Once that returns, no reader
+/// can still be looking at the old version or at anything removed from the
+/// table, so both can be deleted. Writers are still serialized among
+/// themselves and against the other API calls by the read-write locks.
+///
+/// Some writers change objects which readers reach through the tables, e.g.
+/// the physical buffers of a logical buffer. Those keep the readers out for
+/// the duration with \c hStreams_RCU_Exclusive_Scope.
+///
+/// A thread must not call \c hStreams_RCU::synchronize() or enter an exclusive
+/// scope from within a read-side critical section, nor start a read-side
+/// critical section from within an exclusive scope.
+class hStreams_RCU
+{
+public:
+    /// @brief Wait until all the read-side critical sections which started
+    ///     before this call have ended
+    static void synchronize();
+private:
+    friend class hStreams_RCU_Read_Scope;
+    friend class hStreams_RCU_Exclusive_Scope;
+
+    static void readLock();
+    static void readUnlock();
+    static void exclusiveLock();
+    static void exclusiveUnlock();
+
+    hStreams_RCU();
+};
+
+/// @brief A read-side critical section, for as long as the object lives
+///
+/// May be nested.
+class hStreams_RCU_Read_Scope
+{
+public:
+    hStreams_RCU_Read_Scope()
+    {
+        hStreams_RCU::readLock();
+    }
+    ~hStreams_RCU_Read_Scope()
+    {
+        hStreams_RCU::readUnlock();
+    }
+private:
+    // copy-ctor and assignment prohibited
+    hStreams_RCU_Read_Scope(hStreams_RCU_Read_Scope const &other);
+    hStreams_RCU_Read_Scope &operator=(hStreams_RCU_Read_Scope const &other);
+};
+
+/// @brief Keeps all readers out of their read-side critical sections for as
+///     long as the object lives
+///
+/// New readers wait for the scope to end. It is meant for the rare writers which
+/// modify in place the objects readers use.
+class hStreams_RCU_Exclusive_Scope
+{
+public:
+    hStreams_RCU_Exclusive_Scope()
+    {
+        hStreams_RCU::exclusiveLock();
+    }
+    ~hStreams_RCU_Exclusive_Scope()
+    {
+        hStreams_RCU::exclusiveUnlock();
+    }
+private:
+    // copy-ctor and assignment prohibited
+    hStreams_RCU_Exclusive_Scope(hStreams_RCU_Exclusive_Scope const &other);
+    hStreams_RCU_Exclusive_Scope &operator=(hStreams_RCU_Exclusive_Scope const &other);
+};
+
+/// @brief The current, immutable version of a value shared with the readers
+///
+/// \c get() may be called by the readers inside an \c hStreams_RCU_Read_Scope
+/// and by anybody holding a lock which keeps the writers out. \c publish() must
+/// be serialized by the caller.
+template <typename T>
+class hStreams_RCU_Published
+{
+public:
+    hStreams_RCU_Published() : current_(new T()) {}
+    ~hStreams_RCU_Published()
+    {
+        delete current_.load(std::memory_order_relaxed);
+    }
+
+    T const &get() const
+    {
+        return *current_.load(std::memory_order_acquire);
+    }
+
+    /// @brief Make a \c T constructed from \c source (e.g. a copy of it) the
+    ///     current version and free the previous one once no reader uses it anymore
+    template <typename Source>
+    void publish(Source const &source)
+    {
+        T const *old = current_.exchange(new T(source), std::memory_order_acq_rel);
+        hStreams_RCU::synchronize();
+        delete old;
+    }
+private:
+    std::atomic<T const *> current_;
+
+    // copy-ctor and assignment prohibited
+    hStreams_RCU_Published(hStreams_RCU_Published const &other);
+    hStreams_RCU_Published &operator=(hStreams_RCU_Published const &other);
+};
+
+#endif /* HSTREAMS_RCU_H */
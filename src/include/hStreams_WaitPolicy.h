@@ -0,0 +1,150 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#ifndef HSTREAMS_WAITPOLICY_H
+#define HSTREAMS_WAITPOLICY_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <thread>
+#include <immintrin.h>
+
+#include "hStreams_types.h"
+
+/// @brief Phases of an adaptive wait, in the order in which they are tried
+enum HSTR_WAIT_PHASE {
+    /// @brief The waited-for condition already held, no waiting at all
+    HSTR_WAIT_PHASE_IMMEDIATE,
+    /// @brief The condition started to hold while busy-polling
+    HSTR_WAIT_PHASE_SPIN,
+    /// @brief The condition started to hold while polling and yielding the CPU
+    HSTR_WAIT_PHASE_YIELD,
+    /// @brief The waiter had to go to sleep in the operating system
+    HSTR_WAIT_PHASE_PARK,
+    HSTR_WAIT_PHASE_COUNT
+};
+
+/// @brief Counts of waits which ended in each of the phases
+///
+/// Updated by the waiter only, read by anybody.
+class hStreams_WaitStats
+{
+public:
+    hStreams_WaitStats();
+
+    void record(HSTR_WAIT_PHASE phase)
+    {
+        hits_[phase].fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t get(HSTR_WAIT_PHASE phase) const
+    {
+        return hits_[phase].load(std::memory_order_relaxed);
+    }
+private:
+    std::atomic<uint64_t> hits_[HSTR_WAIT_PHASE_COUNT];
+
+    // copy-ctor and assignment prohibited
+    hStreams_WaitStats(hStreams_WaitStats const &other);
+    hStreams_WaitStats &operator=(hStreams_WaitStats const &other);
+};
+
+/// @brief Prints e.g. "immediate: 10, spin: 2, yield: 0, park: 1"
+std::ostream &operator<<(std::ostream &os, hStreams_WaitStats const &stats);
+
+/// @brief The spin-then-yield-then-park policy of the waiters on the host
+///
+/// Used by the host-side streams workers when their queue is empty and
+/// when waiting for the input dependencies of an action, and by
+/// \c hStreams_HostEvent::wait(). A waiter first busy-polls for the spin
+/// budget, then polls and yields the CPU for the yield budget and only then
+/// goes to sleep. Both budgets are in nanoseconds and are read in
+/// \c hStreams_Init from the \c HSTR_HOST_SPIN_NS and \c HSTR_HOST_YIELD_NS
+/// environment variables. Setting both to 0 makes the waiters sleep right
+/// away.
+class hStreams_WaitPolicy
+{
+public:
+    /// @brief Pick the budgets from the environment, falling back to the defaults
+    static void readFromEnv();
+
+    static uint64_t spinNs()
+    {
+        return spin_ns_.load(std::memory_order_relaxed);
+    }
+    static uint64_t yieldNs()
+    {
+        return yield_ns_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Poll \c ready() until it returns true or the budgets run out
+    /// @param ready A callable returning true once the wait is over
+    /// @param limit_ns Upper bound on the time spent, e.g. from a timeout;
+    ///     -1 if there is none
+    /// @return The phase in which \c ready() returned true, or
+    ///     \c HSTR_WAIT_PHASE_PARK if the caller should now go to sleep
+    template <typename Ready>
+    static HSTR_WAIT_PHASE spinThenYield(Ready const &ready, int64_t limit_ns = -1);
+private:
+    hStreams_WaitPolicy();
+
+    /// @brief How many polls happen between reading the clock while spinning
+    static const uint32_t polls_per_clock_check = 64;
+
+    static std::atomic<uint64_t> spin_ns_;
+    static std::atomic<uint64_t> yield_ns_;
+};
+
+template <typename Ready>
+HSTR_WAIT_PHASE hStreams_WaitPolicy::spinThenYield(Ready const &ready, int64_t limit_ns)
+{
+    if (ready()) {
+        return HSTR_WAIT_PHASE_IMMEDIATE;
+    }
+    uint64_t spin_ns = spinNs();
+    uint64_t yield_ns = yieldNs();
+    if (limit_ns >= 0) {
+        if (spin_ns > (uint64_t)limit_ns) {
+            spin_ns = (uint64_t)limit_ns;
+        }
+        if (yield_ns > (uint64_t)limit_ns - spin_ns) {
+            yield_ns = (uint64_t)limit_ns - spin_ns;
+        }
+    }
+    if (spin_ns == 0 && yield_ns == 0) {
+        return HSTR_WAIT_PHASE_PARK;
+    }
+
+    typedef std::chrono::steady_clock steady_clock;
+    const steady_clock::time_point spin_end = steady_clock::now() + std::chrono::nanoseconds(spin_ns);
+    const steady_clock::time_point yield_end = spin_end + std::chrono::nanoseconds(yield_ns);
+
+    while (spin_ns > 0 && steady_clock::now() < spin_end) {
+        for (uint32_t i = 0; i < polls_per_clock_check; ++i) {
+            _mm_pause();
+            if (ready()) {
+                return HSTR_WAIT_PHASE_SPIN;
+            }
+        }
+    }
+    while (yield_ns > 0 && steady_clock::now() < yield_end) {
+        std::this_thread::yield();
+        if (ready()) {
+            return HSTR_WAIT_PHASE_YIELD;
+        }
+    }
+    return HSTR_WAIT_PHASE_PARK;
+}
+
+#endif /* HSTREAMS_WAITPOLICY_H */
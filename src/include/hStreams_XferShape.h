@@ -0,0 +1,131 @@
+/*
+ * Hetero Streams Library - A streaming library for heterogeneous platforms
+ * Copyright (c) 2014 - 2016, Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ */
+
+#ifndef HSTREAMS_XFERSHAPE_H
+#define HSTREAMS_XFERSHAPE_H
+
+#include <algorithm>
+#include <vector>
+
+#include "hStreams_types.h"
+
+class hStreams_PhysBuffer;
+
+/// @brief The layout of the data moved by a transfer
+///
+/// \c depth slices of \c height rows of \c width bytes each. On each side of
+/// the transfer, consecutive rows start \c *_pitch bytes apart and
+/// consecutive slices \c *_slice_pitch bytes apart. A 1D transfer is a
+/// single row, see \c hStreams_XferShape::linear().
+///
+/// The rows are numbered slice by slice, from 0 to <tt>numRows() - 1</tt>.
+struct hStreams_XferShape {
+    uint64_t width;
+    uint64_t height;
+    uint64_t depth;
+    uint64_t dst_pitch;
+    uint64_t dst_slice_pitch;
+    uint64_t src_pitch;
+    uint64_t src_slice_pitch;
+
+    /// @brief The shape of a 1D transfer of \c length bytes
+    static hStreams_XferShape linear(uint64_t length)
+    {
+        hStreams_XferShape shape = {length, 1, 1, length, length, length, length};
+        return shape;
+    }
+
+    uint64_t numRows() const
+    {
+        return height * depth;
+    }
+
+    /// @brief Whether the rows follow one another without gaps on both
+    ///     sides, i.e. the transfer is really a 1D one of \c totalBytes()
+    bool isContiguous() const
+    {
+        return (height == 1 || (dst_pitch == width && src_pitch == width)) &&
+               (depth == 1 || (dst_slice_pitch == width * height && src_slice_pitch == width * height));
+    }
+
+    /// @brief Whether the rows are laid out the same on both sides
+    bool hasSamePitches() const
+    {
+        return (height == 1 || dst_pitch == src_pitch) &&
+               (depth == 1 || dst_slice_pitch == src_slice_pitch);
+    }
+
+    uint64_t totalBytes() const
+    {
+        return width * numRows();
+    }
+
+    /// @brief The number of bytes from the first to the last one written,
+    ///     i.e. the range of the destination the transfer depends on
+    uint64_t dstExtent() const
+    {
+        return extent(dst_pitch, dst_slice_pitch);
+    }
+
+    /// @brief As \c dstExtent(), for the bytes read from the source
+    uint64_t srcExtent() const
+    {
+        return extent(src_pitch, src_slice_pitch);
+    }
+
+    uint64_t dstRowOffset(uint64_t row) const
+    {
+        return (row / height) * dst_slice_pitch + (row % height) * dst_pitch;
+    }
+
+    uint64_t srcRowOffset(uint64_t row) const
+    {
+        return (row / height) * src_slice_pitch + (row % height) * src_pitch;
+    }
+
+private:
+    uint64_t extent(uint64_t pitch, uint64_t slice_pitch) const
+    {
+        return (depth - 1) * slice_pitch + (height - 1) * pitch + width;
+    }
+};
+
+/// @brief A block of memory moved by a transfer, between two physical buffers
+///
+/// A transfer action moves one or more of these, in no particular order,
+/// see \c hStreams_PhysStream::enqueueTransferList().
+struct hStreams_PhysXferRegion {
+    hStreams_PhysBuffer *dst_buf;
+    hStreams_PhysBuffer *src_buf;
+    /// @brief Offsets of the first row as requested from the API, not
+    ///     including eventual buffer padding
+    uint64_t dst_offset;
+    uint64_t src_offset;
+    hStreams_XferShape shape;
+
+    /// @brief The buffers of \c regions, each one once
+    static void getBuffers(std::vector<hStreams_PhysXferRegion> const &regions,
+                           std::vector<hStreams_PhysBuffer *> &buffers)
+    {
+        buffers.clear();
+        for (uint64_t idx = 0; idx < regions.size(); ++idx) {
+            buffers.push_back(regions[idx].dst_buf);
+            buffers.push_back(regions[idx].src_buf);
+        }
+        std::sort(buffers.begin(), buffers.end());
+        buffers.erase(std::unique(buffers.begin(), buffers.end()), buffers.end());
+    }
+};
+
+#endif /* HSTREAMS_XFERSHAPE_H */
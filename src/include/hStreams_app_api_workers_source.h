@@ -114,6 +114,33 @@ app_zgemm_impl_throw(
     const void *B, const int64_t ldb, const void *beta,
     void *C, const int64_t ldc, HSTR_EVENT    *out_pEvent);
 
+void
+app_dag_create_impl_throw(
+    uint32_t            in_NumLogStreams,
+    HSTR_LOG_STR       *in_pLogStreamIDs,
+    uint64_t            in_BytesPerCostUnit,
+    HSTR_DAG           *out_pDag);
+
+void
+app_dag_add_task_impl_throw(
+    HSTR_DAG            in_Dag,
+    const char         *in_pFunctionName,
+    uint32_t            in_NumScalarArgs,
+    uint32_t            in_NumHeapArgs,
+    uint64_t           *in_pArgs,
+    HSTR_ACCESS_MODE   *in_pHeapArgAccess,
+    uint64_t            in_Cost,
+    uint32_t           *out_pTaskID);
+
+void
+app_dag_execute_impl_throw(
+    HSTR_DAG            in_Dag,
+    HSTR_DAG_POLICY     in_Policy);
+
+void
+app_dag_destroy_impl_throw(
+    HSTR_DAG            in_Dag);
+
 
 } // namespace detail
 
@@ -123,11 +123,28 @@ void
 StreamCreate_impl_throw(
     HSTR_LOG_STR        in_LogStreamID,
     HSTR_LOG_DOM        in_LogDomainID,
-    const HSTR_CPU_MASK in_CPUmask);
+    const HSTR_CPU_MASK in_CPUmask,
+    HSTR_STREAM_FLAGS   in_Flags);
 
 void
 StreamDestroy_impl_throw(HSTR_LOG_STR in_LogStreamID);
 
+void
+GetLogStreamDepStats_impl_throw(
+    HSTR_LOG_STR      in_LogStreamID,
+    uint64_t         *out_pNumSubmitted,
+    uint64_t         *out_pNumPruned);
+
+void
+StreamSetPriority_impl_throw(
+    HSTR_LOG_STR            in_LogStreamID,
+    HSTR_STREAM_PRIORITY    in_Priority);
+
+void
+StreamGetPriority_impl_throw(
+    HSTR_LOG_STR            in_LogStreamID,
+    HSTR_STREAM_PRIORITY   *out_pPriority);
+
 void
 GetNumLogStreams_impl_throw(
     HSTR_LOG_DOM   in_LogDomainID,
@@ -155,6 +172,35 @@ EnqueueCompute_impl_throw(
     void               *out_ReturnValue,
     uint16_t            in_ReturnValueSize);
 
+void
+EnqueueComputeEx_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    const char         *in_pFunctionName,
+    uint32_t            in_numScalarArgs,
+    uint32_t            in_numHeapArgs,
+    uint64_t           *in_pArgs,
+    HSTR_ACCESS_MODE   *in_pHeapArgAccess,
+    uint64_t           *in_pHeapArgSizes,
+    HSTR_EVENT         *out_pEvent,
+    void               *out_ReturnValue,
+    uint16_t            in_ReturnValueSize);
+
+void
+GetFunctionHandle_impl_throw(
+    const char         *in_pFunctionName,
+    HSTR_FUNC_HANDLE   *out_pFunctionHandle);
+
+void
+EnqueueComputeByHandle_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    HSTR_FUNC_HANDLE    in_FunctionHandle,
+    uint32_t            in_numScalarArgs,
+    uint32_t            in_numHeapArgs,
+    uint64_t           *in_pArgs,
+    HSTR_EVENT         *out_pEvent,
+    void               *out_ReturnValue,
+    uint16_t            in_ReturnValueSize);
+
 void
 EnqueueData1D_impl_throw(
     HSTR_LOG_STR        in_LogStreamID,
@@ -174,6 +220,43 @@ EnqueueDataXDomain1D_impl_throw(
     HSTR_LOG_DOM        in_srcLogDomain,
     HSTR_EVENT         *out_pEvent);
 
+void
+EnqueueData2D_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    void               *in_pWriteAddr,
+    uint64_t            in_WritePitch,
+    void               *in_pReadAddr,
+    uint64_t            in_ReadPitch,
+    uint64_t            in_Width,
+    uint64_t            in_Height,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent);
+
+void
+EnqueueData3D_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    void               *in_pWriteAddr,
+    uint64_t            in_WritePitch,
+    uint64_t            in_WriteSlicePitch,
+    void               *in_pReadAddr,
+    uint64_t            in_ReadPitch,
+    uint64_t            in_ReadSlicePitch,
+    uint64_t            in_Width,
+    uint64_t            in_Height,
+    uint64_t            in_Depth,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent);
+
+void
+EnqueueDataList_impl_throw(
+    HSTR_LOG_STR        in_LogStreamID,
+    uint32_t            in_NumRegions,
+    void              **in_pWriteAddrs,
+    void              **in_pReadAddrs,
+    uint64_t           *in_pSizes,
+    HSTR_XFER_DIRECTION in_XferDirection,
+    HSTR_EVENT         *out_pEvent);
+
 void
 StreamSynchronize_impl_throw(HSTR_LOG_STR in_LogStreamID);
 
@@ -198,6 +281,38 @@ EventStreamWait_impl_throw(
     void             **in_pAddresses,
     HSTR_EVENT        *out_pEvent);
 
+void
+EnqueueHostCallback_impl_throw(
+    HSTR_LOG_STR       in_LogStreamID,
+    HSTR_HOST_CALLBACK in_Callback,
+    void              *in_pUserData,
+    HSTR_EVENT        *out_pEvent);
+
+void
+GraphBeginCapture_impl_throw(
+    HSTR_LOG_STR      in_LogStreamID);
+
+void
+GraphEndCapture_impl_throw(
+    HSTR_LOG_STR      in_LogStreamID,
+    HSTR_GRAPH       *out_pGraph);
+
+void
+GraphLaunch_impl_throw(
+    HSTR_GRAPH        in_Graph,
+    HSTR_EVENT       *out_pEvent);
+
+void
+GraphSetScalarArg_impl_throw(
+    HSTR_GRAPH        in_Graph,
+    uint32_t          in_ActionIndex,
+    uint32_t          in_ArgIndex,
+    uint64_t          in_Value);
+
+void
+GraphDestroy_impl_throw(
+    HSTR_GRAPH        in_Graph);
+
 void
 Alloc1DEx_impl_throw(
     void                    *in_BaseAddress,
@@ -235,6 +350,12 @@ GetBufferProps_impl_throw(
     void                *in_Address,
     HSTR_BUFFER_PROPS   *out_BufferProps);
 
+void
+GetBufferNumaNode_impl_throw(
+    void                *in_Address,
+    HSTR_LOG_DOM         in_LogDomainID,
+    int32_t             *out_pNumaNode);
+
 void
 DeAlloc_impl_throw(void *in_Address);
 
@@ -248,6 +369,9 @@ Cfg_SetLogInfoType(uint64_t in_info_type_mask);
 void
 Cfg_SetMKLInterface(HSTR_MKL_INTERFACE in_MKLInterface);
 
+void
+Cfg_SetHostBufferAliasing(bool in_Enable);
+
 void
 GetCurrentOptions_impl_throw(HSTR_OPTIONS *pCurrentOptions, uint64_t buffSize);
 
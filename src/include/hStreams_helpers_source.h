@@ -46,6 +46,14 @@ bool addition_overflow(T const &a, T const &b)
     return std::numeric_limits<T>::max() - b < a;
 }
 
+// Returns true if a * b would overflow the underlying type
+template <class T>
+bool multiplication_overflow(T const &a, T const &b)
+{
+    HSTR_STATIC_ASSERT(!std::numeric_limits<T>::is_signed, not_implemented_for_signed_types);
+    return b != 0 && std::numeric_limits<T>::max() / b < a;
+}
+
 // Returns true if a + b > c, with a safeguard against a+b overflowing
 template <class T>
 bool add_gt(T const &a, T const &b, T const &c)
@@ -83,9 +91,22 @@ class hStreams_MemAlignedAllocator
 {
 public:
     static void *alloc(uint64_t len);
+    /// @brief Allocate memory placed in the NUMA node(s) closest to the CPUs of
+    ///     \c cpu_mask. Small allocations aren't placed, they share pages with others.
+    /// @param[out] numa_node The node the memory was placed on, -1 if it wasn't,
+    ///     or it's spread over several of them
+    static void *allocNear(uint64_t len, hStreams_CPUMask const &cpu_mask, int32_t &numa_node);
     static void dealloc(void *data_ptr);
 };
 
+/// @brief Read a decimal number from an environment variable
+/// @param[in] unit What the number counts, for the warnings, or NULL
+/// @return \c default_value if the variable isn't set or is empty or, with a
+///     warning, if it isn't a non-negative number; \c max_value, with a
+///     warning, if the number is larger
+uint64_t hStreams_GetEnvNumber(const char *env_name, uint64_t default_value,
+                               uint64_t max_value = (uint64_t) - 1, const char *unit = NULL);
+
 
 class hStreams_PhysStream;
 ////////////////////////////////////////////////////////////////////
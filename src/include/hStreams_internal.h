@@ -172,6 +172,17 @@ using namespace std;
 #define HSTR_ALIGN(X) __attribute__((aligned(X)))
 #endif
 
+// Size of the cache line, for padding data shared between threads
+#define HSTR_CACHE_LINE_SIZE 64
+
+// The HSTR_THREAD_LOCAL macro gives each thread its own copy of a variable.
+// Only for POD types, as destructors of thread-local objects aren't run everywhere.
+#ifdef _WIN32
+#define HSTR_THREAD_LOCAL __declspec(thread)
+#else
+#define HSTR_THREAD_LOCAL __thread
+#endif
+
 /* The C macro: HSTR_THUNK_FILE is defined in Makefile. */
 
 // HSTR_STATIC_ASSERT is an instance of 'static assertion'.  See Google for more infromation.
@@ -231,6 +242,8 @@ typedef struct hStreamHostProcess {
     uint32_t                       myActivePhysDomains;   // 0 or more active cards in the system,
     //  as reflected by COIEngineGetHandle
     bool                           homogeneous;           // true if all domains have the same resources
+    bool                           hostOnly;              // true if there are no active cards; host buffers,
+    //  transfers and events then bypass COI
     HSTR_COIPROCESS                     dummyCOIProcess;       // Valid/dummy for COIBufferCreateFromMemory
 
 #ifdef _WIN32
@@ -239,10 +252,6 @@ typedef struct hStreamHostProcess {
 #endif
     HSTR_ALIGN(64)
     volatile long                  lastError;             // last hStreams error recorded
-    HSTR_ALIGN(64)
-    HSTR_COIBUFFER                    dummy_buf;
-    HSTR_ALIGN(64)
-    uint64_t                     dummy_data;
 #ifdef _WIN32
 #pragma warning( pop )
 #endif
@@ -37,6 +37,9 @@
 #include <string>
 #include <array>
 
+class hStreams_Graph;
+class hStreams_Dag;
+
 // Main data structure
 extern hStreamHostProcess hstr_proc;
 
@@ -59,10 +62,11 @@ extern HSTR_ALIGN(64) volatile int64_t huge_page_usage_threshold;
 extern const char *host_sink_ld_library_path_env_name;
 extern const char *mic_ld_library_path_env_name;
 extern const char *sink_ld_library_path_env_name;
-
-// This constant describe how often single PhysBuffers pending actions container is cleaned
-// from completed action. Container is cleaned once for this number of added actions.
-extern const uint32_t fixed_buffer_actions_cleanup_value;
+extern const char *host_queue_env_name;
+extern const char *host_spin_ns_env_name;
+extern const char *host_yield_ns_env_name;
+extern const char *host_xfer_threads_env_name;
+extern const char *host_xfer_nt_bytes_env_name;
 
 // Generated by the incbin script to a separate .cpp file
 extern const uint8_t x100_card_startup[];
@@ -94,12 +98,31 @@ extern hStreams_RW_Lock options_lock;
 extern std::map<HSTR_ISA_TYPE, std::vector<std::pair<std::string, int>>> libraries_to_load;
 extern hStreams_RW_Lock libraries_to_load_lock;
 
+// Set through hStreams_Cfg_SetHostBufferAliasing(): whether all the buffers
+// get HSTR_BUF_PROP_HOST_ALIASED
+extern bool host_buffer_aliasing;
+
 extern std::string target_library_search_path;
 extern std::string host_library_search_path;
 
 extern std::vector<std::string> tokenized_target_library_search_path;
 extern std::vector<std::string> tokenized_host_library_search_path;
 
+// Handles given out by hStreams_GetFunctionHandle(), by function name.
+// The sink-side addresses themselves are kept by the physical domains.
+extern std::map<std::string, HSTR_FUNC_HANDLE> function_handles;
+extern hStreams_RW_Lock function_handles_lock;
+
+// The graphs given out by hStreams_GraphEndCapture() and the DAGs given out by
+// hStreams_app_dag_create(), by handle. The handles are never reused, not even
+// after hStreams_Fini(), so that stale ones are reported as not found.
+extern std::map<HSTR_GRAPH, hStreams_Graph *> graphs;
+extern HSTR_GRAPH next_graph_handle;
+extern hStreams_RW_Lock graphs_lock;
+extern std::map<HSTR_DAG, hStreams_Dag *> dags;
+extern HSTR_DAG next_dag_handle;
+extern hStreams_RW_Lock dags_lock;
+
 // For the benefit of hStreams_Fini(), for use whenever applicable (i.e. for
 // POD types). For more complex objects prefer to use .clear() or similar
 namespace initial_values
@@ -107,6 +130,7 @@ namespace initial_values
 extern const HSTR_LOG_STR app_init_next_log_str_ID;
 extern const HSTR_LOG_DOM next_log_dom_id;
 extern const HSTR_MKL_INTERFACE mkl_interface;
+extern const bool host_buffer_aliasing;
 extern const char *interface_version;
 extern hStreams_Atomic_HSTR_STATE hStreamsState;
 extern const HSTR_OPTIONS options;